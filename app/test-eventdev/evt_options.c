@@ -409,6 +409,14 @@ evt_parse_ena_vector(struct evt_options *opt, const char *arg __rte_unused)
 	return 0;
 }
 
+static int
+evt_parse_vector_adaptive(struct evt_options *opt,
+			  const char *arg __rte_unused)
+{
+	opt->vector_adaptive = 1;
+	return 0;
+}
+
 static int
 evt_parse_vector_size(struct evt_options *opt, const char *arg)
 {
@@ -505,6 +513,7 @@ usage(char *program)
 		"\t--enable_vector    : enable event vectorization.\n"
 		"\t--vector_size      : Max vector size.\n"
 		"\t--vector_tmo_ns    : Max vector timeout in nanoseconds\n"
+		"\t--vector_adaptive  : size Rx adapter vectors by arrival rate.\n"
 		"\t--per_port_pool    : Configure unique pool per ethdev port\n"
 		"\t--tx_first         : Transmit given number of packets\n"
 		"                       across all the ethernet devices before\n"
@@ -594,6 +603,7 @@ static struct option lgopts[] = {
 	{ EVT_ENA_VECTOR,          0, 0, 0 },
 	{ EVT_VECTOR_SZ,           1, 0, 0 },
 	{ EVT_VECTOR_TMO,          1, 0, 0 },
+	{ EVT_VECTOR_ADAPTIVE,     0, 0, 0 },
 	{ EVT_PER_PORT_POOL,       0, 0, 0 },
 	{ EVT_HELP,                0, 0, 0 },
 	{ EVT_TX_FIRST,            1, 0, 0 },
@@ -644,6 +654,7 @@ evt_opts_parse_long(int opt_idx, struct evt_options *opt)
 		{ EVT_ENA_VECTOR, evt_parse_ena_vector},
 		{ EVT_VECTOR_SZ, evt_parse_vector_size},
 		{ EVT_VECTOR_TMO, evt_parse_vector_tmo_ns},
+		{ EVT_VECTOR_ADAPTIVE, evt_parse_vector_adaptive},
 		{ EVT_PER_PORT_POOL, evt_parse_per_port_pool},
 		{ EVT_TX_FIRST, evt_parse_tx_first},
 		{ EVT_TX_PKT_SZ, evt_parse_tx_pkt_sz},
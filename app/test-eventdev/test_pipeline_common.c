@@ -41,6 +41,7 @@ pipeline_opt_dump(struct evt_options *opt, uint8_t nb_queues)
 	if (opt->ena_vector) {
 		evt_dump("vector_size", "%d", opt->vector_size);
 		evt_dump("vector_tmo_ns", "%" PRIu64 "", opt->vector_tmo_nsec);
+		evt_dump("vector_adaptive", "%d", opt->vector_adaptive);
 	}
 }
 
@@ -563,6 +564,9 @@ pipeline_event_rx_adapter_setup(struct evt_options *opt, uint8_t stride,
 					opt->vector_tmo_nsec;
 				queue_conf.rx_queue_flags |=
 				RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+				if (opt->vector_adaptive)
+					queue_conf.rx_queue_flags |=
+				RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR_ADAPTIVE;
 				queue_conf.vector_mp = vector_pool;
 			} else {
 				evt_err("Rx adapter doesn't support event vector");
@@ -127,6 +127,12 @@ void app_main_loop_tx(void);
 #define APP_FLUSH 0x3FF
 #endif
 
+/* Worker rate report period (seconds), checked every 1K pipeline runs */
+#ifndef APP_STATS_PERIOD
+#define APP_STATS_PERIOD 1
+#endif
+#define APP_STATS_POLL_MASK 0x3FF
+
 #define APP_METADATA_OFFSET(offset) (sizeof(struct rte_mbuf) + (offset))
 
 #endif /* _MAIN_H_ */
@@ -11,6 +11,8 @@
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
+#include <rte_cycles.h>
+#include <rte_vect.h>
 
 #include <rte_port_ring.h>
 #include <rte_table_hash.h>
@@ -86,6 +88,7 @@ app_main_loop_worker_pipeline_hash(void) {
 	uint32_t table_id;
 	uint32_t i;
 	uint32_t special, ext, key_size;
+	uint64_t hz, tsc_prev, n_pkts;
 
 	translate_options(&special, &ext, &key_size);
 
@@ -365,19 +368,37 @@ app_main_loop_worker_pipeline_hash(void) {
 		rte_panic("Pipeline consistency check failed\n");
 
 	/* Run-time */
-#if APP_FLUSH == 0
-	while (!force_quit)
-		rte_pipeline_run(p);
-#else
+	hz = rte_get_tsc_hz();
+	tsc_prev = rte_rdtsc();
+	n_pkts = 0;
 	i = 0;
 	while (!force_quit) {
-		rte_pipeline_run(p);
+		n_pkts += rte_pipeline_run(p);
 
+#if APP_FLUSH != 0
 		if ((i & APP_FLUSH) == 0)
 			rte_pipeline_flush(p);
+#endif
 		i++;
+
+		/* Report the lookup rate, the key compare implementation of
+		 * the specialized tables follows the EAL max SIMD bitwidth.
+		 */
+		if ((i & APP_STATS_POLL_MASK) == 0) {
+			uint64_t tsc = rte_rdtsc();
+
+			if (tsc - tsc_prev >= hz * APP_STATS_PERIOD) {
+				RTE_LOG(INFO, USER1, "Core %u: %.2f Mpps "
+					"(max SIMD bitwidth %u)\n",
+					rte_lcore_id(),
+					(double)n_pkts * hz /
+					((tsc - tsc_prev) * 1E6),
+					rte_vect_get_max_simd_bitwidth());
+				tsc_prev = tsc;
+				n_pkts = 0;
+			}
+		}
 	}
-#endif
 }
 
 uint64_t test_hash(
@@ -4,9 +4,11 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <errno.h>
+#include <rte_cycles.h>
 #include <rte_lcore.h>
 #include <rte_memzone.h>
 #include <rte_metrics.h>
@@ -177,6 +179,94 @@ test_bit_packet_forward(void)
 	return (ret >= 0) ? TEST_SUCCESS : TEST_FAILED;
 }
 
+/* Get the value of a metric of a port, or 0 if not found */
+static uint64_t
+test_bit_metric_get(uint16_t port_id, const char *name)
+{
+	struct rte_metric_value *values = NULL;
+	struct rte_metric_name *names = NULL;
+	uint64_t value = 0;
+	int i, n, key = -1;
+
+	n = rte_metrics_get_names(NULL, 0);
+	if (n <= 0)
+		return 0;
+	names = calloc(n, sizeof(*names));
+	values = calloc(n, sizeof(*values));
+	if (names == NULL || values == NULL)
+		goto out;
+	if (rte_metrics_get_names(names, n) != n)
+		goto out;
+	for (i = 0; i < n; i++)
+		if (strcmp(names[i].name, name) == 0)
+			key = i;
+
+	n = rte_metrics_get_values(port_id, values, n);
+	for (i = 0; i < n; i++)
+		if ((int)values[i].key == key)
+			value = values[i].value;
+out:
+	free(names);
+	free(values);
+	return value;
+}
+
+/* To test the bit rate calculation by the control thread */
+static int
+test_stats_bitrate_thread(void)
+{
+	uint64_t rx_pkts, rxq_pkts, txq_pkts, start, stop_ms;
+	int ret;
+
+	ret = rte_stats_bitrate_queue_reg(bitrate_data, 0);
+	TEST_ASSERT(ret == -EINVAL, "Test Failed: no queue registered, ret:%d",
+			ret);
+	ret = rte_stats_bitrate_queue_reg(bitrate_data, 1);
+	TEST_ASSERT(ret == 0, "Test Failed: rte_stats_bitrate_queue_reg "
+			"ret:%d", ret);
+	ret = rte_stats_bitrate_queue_reg(bitrate_data, 1);
+	TEST_ASSERT(ret == -EEXIST, "Test Failed: queues registered twice, "
+			"ret:%d", ret);
+
+	ret = rte_stats_bitrate_start(bitrate_data, 0);
+	TEST_ASSERT(ret == -EINVAL, "Test Failed: null period, ret:%d", ret);
+	ret = rte_stats_bitrate_start(bitrate_data, 10);
+	TEST_ASSERT(ret == 0, "Test Failed: rte_stats_bitrate_start ret:%d",
+			ret);
+	ret = rte_stats_bitrate_calc(bitrate_data, portid);
+	TEST_ASSERT(ret == -EBUSY, "Test Failed: rte_stats_bitrate_calc "
+			"with calculation thread, ret:%d", ret);
+
+	/* let the thread take a first snapshot */
+	rte_delay_ms(50);
+	ret = test_bit_packet_forward();
+	rte_delay_ms(50);
+	rte_stats_bitrate_stop(bitrate_data);
+	TEST_ASSERT(ret == TEST_SUCCESS, "Test Failed: packet forward");
+
+	rx_pkts = test_bit_metric_get(portid, "peak_pkts_in");
+	/* the ring PMD does not count bytes */
+	rxq_pkts = test_bit_metric_get(portid, "rx_q0_peak_pkts");
+	txq_pkts = test_bit_metric_get(portid, "tx_q0_peak_pkts");
+	printf("peak packet rate %"PRIu64", queue 0 Rx %"PRIu64" Tx %"PRIu64
+			"\n", rx_pkts, rxq_pkts, txq_pkts);
+	TEST_ASSERT(rx_pkts > 0 && rxq_pkts > 0 && txq_pkts > 0,
+			"Test Failed: rates not calculated");
+
+	/* stopping does not wait for the end of a long period */
+	ret = rte_stats_bitrate_start(bitrate_data, 2 * 60 * 60 * 1000);
+	TEST_ASSERT(ret == 0, "Test Failed: rte_stats_bitrate_start ret:%d",
+			ret);
+	rte_delay_ms(10);
+	start = rte_get_timer_cycles();
+	rte_stats_bitrate_stop(bitrate_data);
+	stop_ms = (rte_get_timer_cycles() - start) * 1000 / rte_get_timer_hz();
+	TEST_ASSERT(stop_ms < 1000, "Test Failed: stop took %"PRIu64" ms",
+			stop_ms);
+
+	return TEST_SUCCESS;
+}
+
 static int
 test_bit_ring_setup(void)
 {
@@ -238,7 +328,13 @@ unit_test_suite bitratestats_testsuite  = {
 		 */
 		TEST_CASE_ST(test_bit_packet_forward, NULL,
 				test_stats_bitrate_calc),
-		/* TEST CASE 9: Test to do the cleanup w.r.t create */
+
+		/* TEST CASE 9: Test to calculate per-queue bit rate data
+		 * metrics in the control thread
+		 */
+		TEST_CASE(test_stats_bitrate_thread),
+
+		/* TEST CASE 10: Test to do the cleanup w.r.t create */
 		TEST_CASE(test_stats_bitrate_free),
 		TEST_CASES_END()
 	}
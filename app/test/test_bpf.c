@@ -14,6 +14,7 @@
 #include <rte_random.h>
 #include <rte_byteorder.h>
 #include <rte_errno.h>
+#include <rte_lcore.h>
 #include "test.h"
 
 #if !defined(RTE_LIB_BPF)
@@ -25,9 +26,83 @@ test_bpf(void)
 	return TEST_SKIPPED;
 }
 
+/*
+ * with RCU QSBR attached, values of deleted elements
+ * are not reused until the reader goes through a quiescent state.
+ */
+static int
+test_map_hash_rcu(void)
+{
+	int32_t ret;
+	uint32_t sz;
+	uint64_t i, key, val, *pv;
+	struct rte_bpf_map *map;
+	struct rte_rcu_qsbr *qv;
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	qv = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (qv == NULL)
+		return -1;
+	rte_rcu_qsbr_init(qv, RTE_MAX_LCORE);
+
+	map = test_map_create("test_map_hash_rcu", RTE_BPF_MAP_TYPE_HASH,
+		sizeof(key));
+	if (map == NULL) {
+		rte_free(qv);
+		return -1;
+	}
+
+	ret = rte_bpf_map_rcu_qsbr_add(map, qv);
+	if (rte_bpf_map_rcu_qsbr_add(map, qv) != -EEXIST)
+		ret |= -1;
+
+	/* act as a reader that is in a critical section */
+	rte_rcu_qsbr_thread_register(qv, 0);
+	rte_rcu_qsbr_thread_online(qv, 0);
+
+	for (i = 0; i != TEST_MAP_ENTRIES; i++) {
+		key = i;
+		val = i + 100;
+		ret |= rte_bpf_map_update_elem(map, &key, &val,
+			RTE_BPF_MAP_NOEXIST);
+	}
+
+	key = 0;
+	pv = rte_bpf_map_lookup_elem(map, &key);
+	ret |= rte_bpf_map_delete_elem(map, &key);
+	if (pv == NULL || rte_bpf_map_lookup_elem(map, &key) != NULL)
+		ret |= -1;
+
+	/* deleted value is still intact and can't be reused */
+	key = TEST_MAP_ENTRIES;
+	if (rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY) !=
+			-E2BIG || pv == NULL || *pv != 100)
+		ret |= -1;
+
+	rte_rcu_qsbr_quiescent(qv, 0);
+	ret |= rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY);
+	if (rte_bpf_map_lookup_elem(map, &key) != pv || *pv != val)
+		ret |= -1;
+
+	rte_rcu_qsbr_thread_offline(qv, 0);
+	rte_rcu_qsbr_thread_unregister(qv, 0);
+
+	rte_bpf_map_free(map);
+	rte_free(qv);
+	return ret;
+}
+
+static int
+test_bpf_map(void)
+{
+	printf("BPF not supported, skipping test\n");
+	return TEST_SKIPPED;
+}
+
 #else
 
 #include <rte_bpf.h>
+#include <rte_rcu_qsbr.h>
 #include <rte_ether.h>
 #include <rte_ip.h>
 
@@ -3216,9 +3291,14 @@ run_test(const struct bpf_test *tst)
 {
 	int32_t ret, rv;
 	int64_t rc;
+	uint32_t i, n;
 	struct rte_bpf *bpf;
 	struct rte_bpf_jit jit;
+	rte_bpf_jit_burst_t jit_burst;
 	uint8_t tbuf[tst->arg_sz];
+	uint8_t bbuf[2][tst->arg_sz];
+	void *bctx[RTE_DIM(bbuf)];
+	uint64_t brc[RTE_DIM(bbuf)];
 
 	printf("%s(%s) start\n", __func__, tst->name);
 
@@ -3253,6 +3333,35 @@ run_test(const struct bpf_test *tst)
 		}
 	}
 
+	/* and with jit burst entry, when possible */
+	if (rte_bpf_get_jit_burst(bpf, &jit_burst) == 0) {
+
+		for (i = 0; i != RTE_DIM(bbuf); i++) {
+			tst->prepare(bbuf[i]);
+			bctx[i] = bbuf[i];
+		}
+
+		n = jit_burst(bctx, brc, 0);
+		n += jit_burst(bctx, brc, RTE_DIM(bbuf));
+		if (n != RTE_DIM(bbuf)) {
+			printf("%s@%d: burst(%s) returns %u, expected %zu;\n",
+				__func__, __LINE__, tst->name,
+				n, RTE_DIM(bbuf));
+			ret |= -1;
+		}
+
+		for (i = 0; i != n; i++) {
+			rv = tst->check_result(brc[i], bbuf[i]);
+			ret |= rv;
+			if (rv != 0) {
+				printf("%s@%d: check_result(%s) failed for "
+					"burst entry, error: %d(%s);\n",
+					__func__, __LINE__, tst->name,
+					rv, strerror(rv));
+			}
+		}
+	}
+
 	rte_bpf_destroy(bpf);
 	return ret;
 
@@ -3274,9 +3383,446 @@ test_bpf(void)
 	return rc;
 }
 
+/*
+ * eBPF map tests.
+ * Maps are created at run-time, so map address in the code
+ * has to be patched before the load.
+ */
+
+#define TEST_MAP_ENTRIES	4
+#define TEST_MAP_NOT_FOUND	UINT64_MAX
+
+/*
+ * find value for the key pointed by R1,
+ * increment it and return the new value.
+ */
+static const struct ebpf_insn test_map_inc_prog[] = {
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_6,
+		.src_reg = EBPF_REG_1,
+	},
+	/* map address, to be patched */
+	{
+		.code = (BPF_LD | BPF_IMM | EBPF_DW),
+		.dst_reg = EBPF_REG_1,
+	},
+	{
+		.imm = 0,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_6,
+	},
+	{
+		.code = (BPF_JMP | EBPF_CALL),
+		.src_reg = EBPF_PSEUDO_MAP_CALL,
+		.imm = RTE_BPF_MAP_FUNC_LOOKUP,
+	},
+	{
+		.code = (BPF_JMP | BPF_JEQ | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = 0,
+		.off = 4,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_1,
+		.imm = 1,
+	},
+	{
+		.code = (BPF_STX | EBPF_XADD | EBPF_DW),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_1,
+	},
+	{
+		.code = (BPF_LDX | BPF_MEM | EBPF_DW),
+		.dst_reg = EBPF_REG_0,
+		.src_reg = EBPF_REG_0,
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_0,
+		.imm = -1,
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+};
+
+/*
+ * call update (key and value both pointed by R1) or delete helper
+ * for the key pointed by R1, return its result.
+ */
+static const struct ebpf_insn test_map_upd_prog[] = {
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_2,
+		.src_reg = EBPF_REG_1,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_X),
+		.dst_reg = EBPF_REG_3,
+		.src_reg = EBPF_REG_1,
+	},
+	{
+		.code = (EBPF_ALU64 | EBPF_MOV | BPF_K),
+		.dst_reg = EBPF_REG_4,
+		.imm = RTE_BPF_MAP_ANY,
+	},
+	/* map address, to be patched */
+	{
+		.code = (BPF_LD | BPF_IMM | EBPF_DW),
+		.dst_reg = EBPF_REG_1,
+	},
+	{
+		.imm = 0,
+	},
+	/* helper id, to be patched */
+	{
+		.code = (BPF_JMP | EBPF_CALL),
+		.src_reg = EBPF_PSEUDO_MAP_CALL,
+	},
+	{
+		.code = (BPF_JMP | EBPF_EXIT),
+	},
+};
+
+/*
+ * load given program with the map and run it with interpreter and JIT,
+ * store return values in rc[] (UINT64_MAX for JIT if not available).
+ */
+static int
+run_map_prog(const struct ebpf_insn *tmpl, uint32_t nb_ins, uint32_t func,
+	struct rte_bpf_map *map, void *arg, size_t arg_sz, uint64_t rc[2])
+{
+	uint32_t i;
+	struct rte_bpf *bpf;
+	struct rte_bpf_jit jit;
+	struct ebpf_insn ins[nb_ins];
+	struct rte_bpf_xsym xsym = {
+		.name = "test_map",
+		.type = RTE_BPF_XTYPE_MAP,
+		.map = { .val = map, },
+	};
+	struct rte_bpf_prm prm = {
+		.ins = ins,
+		.nb_ins = nb_ins,
+		.xsym = &xsym,
+		.nb_xsym = 1,
+		.prog_arg = {
+			.type = RTE_BPF_ARG_PTR,
+			.size = arg_sz,
+		},
+	};
+
+	memcpy(ins, tmpl, sizeof(ins));
+	for (i = 0; i != nb_ins; i++) {
+		if (ins[i].code == (BPF_LD | BPF_IMM | EBPF_DW)) {
+			ins[i].imm = (uintptr_t)map;
+			ins[i + 1].imm = (uint64_t)(uintptr_t)map >> 32;
+			i++;
+		} else if (ins[i].code == (BPF_JMP | EBPF_CALL) &&
+				ins[i].imm == 0)
+			ins[i].imm = func;
+	}
+
+	bpf = rte_bpf_load(&prm);
+	if (bpf == NULL) {
+		printf("%s@%d: failed to load bpf code, error=%d(%s);\n",
+			__func__, __LINE__, rte_errno, strerror(rte_errno));
+		return -1;
+	}
+
+	rc[0] = rte_bpf_exec(bpf, arg);
+
+	rte_bpf_get_jit(bpf, &jit);
+	rc[1] = (jit.func != NULL) ? jit.func(arg) : UINT64_MAX;
+
+	rte_bpf_destroy(bpf);
+	return 0;
+}
+
+/*
+ * run increment program twice (interpreter and JIT)
+ * and check the value stored in the map.
+ */
+static int
+test_map_inc(struct rte_bpf_map *map, void *key, size_t key_sz,
+	uint64_t *val, uint64_t start)
+{
+	int32_t ret;
+	uint64_t exp, rc[2];
+
+	ret = run_map_prog(test_map_inc_prog, RTE_DIM(test_map_inc_prog), 0,
+		map, key, key_sz, rc);
+	if (ret != 0)
+		return ret;
+
+	exp = (start == TEST_MAP_NOT_FOUND) ? start : start + 1;
+	ret = cmp_res(__func__, exp, rc[0], &exp, &rc[0], sizeof(exp));
+
+	if (rc[1] != UINT64_MAX || start == TEST_MAP_NOT_FOUND) {
+		if (start != TEST_MAP_NOT_FOUND)
+			exp++;
+		ret |= cmp_res(__func__, exp, rc[1], &exp, &rc[1],
+			sizeof(exp));
+	}
+
+	if (val != NULL)
+		ret |= cmp_res(__func__, exp, *val, &exp, val, sizeof(exp));
+
+	return ret;
+}
+
+static struct rte_bpf_map *
+test_map_create(const char *name, enum rte_bpf_map_type type,
+	uint32_t key_size)
+{
+	struct rte_bpf_map *map;
+	struct rte_bpf_map_prm prm = {
+		.name = name,
+		.type = type,
+		.key_size = key_size,
+		.value_size = sizeof(uint64_t),
+		.max_entries = TEST_MAP_ENTRIES,
+		.socket_id = SOCKET_ID_ANY,
+	};
+
+	map = rte_bpf_map_create(&prm);
+	if (map == NULL)
+		printf("%s@%d: failed to create map %s, error=%d(%s);\n",
+			__func__, __LINE__, name, rte_errno,
+			strerror(rte_errno));
+	return map;
+}
+
+static int
+test_map_array(void)
+{
+	int32_t ret;
+	uint32_t key;
+	uint64_t val;
+	struct rte_bpf_map *map;
+
+	map = test_map_create("test_map_array", RTE_BPF_MAP_TYPE_ARRAY,
+		sizeof(key));
+	if (map == NULL)
+		return -1;
+
+	key = TEST_MAP_ENTRIES - 1;
+	ret = test_map_inc(map, &key, sizeof(key),
+		rte_bpf_map_lookup_elem(map, &key), 0);
+
+	val = 100;
+	ret |= rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_EXIST);
+	ret |= test_map_inc(map, &key, sizeof(key),
+		rte_bpf_map_lookup_elem(map, &key), val);
+
+	/* out of range */
+	key = TEST_MAP_ENTRIES;
+	ret |= test_map_inc(map, &key, sizeof(key), NULL,
+		TEST_MAP_NOT_FOUND);
+	if (rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY) !=
+			-E2BIG || rte_bpf_map_delete_elem(map, &key) != -EINVAL)
+		ret |= -1;
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+static int
+test_map_percpu_array(void)
+{
+	int32_t ret;
+	uint32_t key;
+	struct rte_bpf_map *map;
+
+	map = test_map_create("test_map_percpu", RTE_BPF_MAP_TYPE_PERCPU_ARRAY,
+		sizeof(key));
+	if (map == NULL)
+		return -1;
+
+	key = 1;
+	ret = test_map_inc(map, &key, sizeof(key),
+		rte_bpf_map_lookup_lcore_elem(map, &key, rte_lcore_id()), 0);
+
+	/* other lcores copies are intact */
+	if (*(uint64_t *)rte_bpf_map_lookup_lcore_elem(map, &key,
+			(rte_lcore_id() + 1) % RTE_MAX_LCORE) != 0)
+		ret |= -1;
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+static int
+test_map_hash(void)
+{
+	int32_t ret;
+	uint64_t key, val, rc[2];
+	struct rte_bpf_map *map;
+
+	map = test_map_create("test_map_hash", RTE_BPF_MAP_TYPE_HASH,
+		sizeof(key));
+	if (map == NULL)
+		return -1;
+
+	key = 0x1234567890;
+	ret = test_map_inc(map, &key, sizeof(key), NULL, TEST_MAP_NOT_FOUND);
+
+	val = 10;
+	ret |= rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_NOEXIST);
+	ret |= test_map_inc(map, &key, sizeof(key),
+		rte_bpf_map_lookup_elem(map, &key), val);
+
+	/* delete from the eBPF program */
+	ret |= run_map_prog(test_map_upd_prog, RTE_DIM(test_map_upd_prog),
+		RTE_BPF_MAP_FUNC_DELETE, map, &key, sizeof(key), rc);
+	if (rc[0] != 0 || rte_bpf_map_lookup_elem(map, &key) != NULL)
+		ret |= -1;
+
+	/* insert from the eBPF program, key is used as a value */
+	ret |= run_map_prog(test_map_upd_prog, RTE_DIM(test_map_upd_prog),
+		RTE_BPF_MAP_FUNC_UPDATE, map, &key, sizeof(key), rc);
+	if (rc[0] != 0)
+		ret |= -1;
+	ret |= test_map_inc(map, &key, sizeof(key),
+		rte_bpf_map_lookup_elem(map, &key), key);
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+static int
+test_map_lpm(void)
+{
+	int32_t ret;
+	uint64_t val;
+	struct rte_bpf_map_lpm_key key;
+	struct rte_bpf_map *map;
+
+	map = test_map_create("test_map_lpm", RTE_BPF_MAP_TYPE_LPM,
+		sizeof(key));
+	if (map == NULL)
+		return -1;
+
+	key.prefixlen = 32;
+	key.addr = rte_cpu_to_be_32(RTE_IPV4(10, 1, 2, 3));
+	ret = test_map_inc(map, &key, sizeof(key), NULL, TEST_MAP_NOT_FOUND);
+
+	key.prefixlen = 8;
+	key.addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 0, 0));
+	val = 100;
+	ret |= rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY);
+
+	key.prefixlen = 32;
+	key.addr = rte_cpu_to_be_32(RTE_IPV4(10, 1, 2, 3));
+	ret |= test_map_inc(map, &key, sizeof(key),
+		rte_bpf_map_lookup_elem(map, &key), val);
+
+	key.prefixlen = 8;
+	ret |= rte_bpf_map_delete_elem(map, &key);
+	if (rte_bpf_map_lookup_elem(map, &key) != NULL ||
+			rte_bpf_map_delete_elem(map, &key) != -ENOENT)
+		ret |= -1;
+
+	rte_bpf_map_free(map);
+	return ret;
+}
+
+/*
+ * with RCU QSBR attached, values of deleted elements
+ * are not reused until the reader goes through a quiescent state.
+ */
+static int
+test_map_hash_rcu(void)
+{
+	int32_t ret;
+	uint32_t sz;
+	uint64_t i, key, val, *pv;
+	struct rte_bpf_map *map;
+	struct rte_rcu_qsbr *qv;
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	qv = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (qv == NULL)
+		return -1;
+	rte_rcu_qsbr_init(qv, RTE_MAX_LCORE);
+
+	map = test_map_create("test_map_hash_rcu", RTE_BPF_MAP_TYPE_HASH,
+		sizeof(key));
+	if (map == NULL) {
+		rte_free(qv);
+		return -1;
+	}
+
+	ret = rte_bpf_map_rcu_qsbr_add(map, qv);
+	if (rte_bpf_map_rcu_qsbr_add(map, qv) != -EEXIST)
+		ret |= -1;
+
+	/* act as a reader that is in a critical section */
+	rte_rcu_qsbr_thread_register(qv, 0);
+	rte_rcu_qsbr_thread_online(qv, 0);
+
+	for (i = 0; i != TEST_MAP_ENTRIES; i++) {
+		key = i;
+		val = i + 100;
+		ret |= rte_bpf_map_update_elem(map, &key, &val,
+			RTE_BPF_MAP_NOEXIST);
+	}
+
+	key = 0;
+	pv = rte_bpf_map_lookup_elem(map, &key);
+	ret |= rte_bpf_map_delete_elem(map, &key);
+	if (pv == NULL || rte_bpf_map_lookup_elem(map, &key) != NULL)
+		ret |= -1;
+
+	/* deleted value is still intact and can't be reused */
+	key = TEST_MAP_ENTRIES;
+	if (rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY) !=
+			-E2BIG || pv == NULL || *pv != 100)
+		ret |= -1;
+
+	rte_rcu_qsbr_quiescent(qv, 0);
+	ret |= rte_bpf_map_update_elem(map, &key, &val, RTE_BPF_MAP_ANY);
+	if (rte_bpf_map_lookup_elem(map, &key) != pv || *pv != val)
+		ret |= -1;
+
+	rte_rcu_qsbr_thread_offline(qv, 0);
+	rte_rcu_qsbr_thread_unregister(qv, 0);
+
+	rte_bpf_map_free(map);
+	rte_free(qv);
+	return ret;
+}
+
+static int
+test_bpf_map(void)
+{
+	int32_t rc;
+
+	/* map helpers are function calls, not supported on 32 bit */
+	if (sizeof(uint64_t) != sizeof(uintptr_t))
+		return TEST_SKIPPED;
+
+	rc = test_map_array();
+	rc |= test_map_percpu_array();
+	rc |= test_map_hash();
+	rc |= test_map_hash_rcu();
+	rc |= test_map_lpm();
+
+	return rc;
+}
+
 #endif /* !RTE_LIB_BPF */
 
 REGISTER_FAST_TEST(bpf_autotest, true, true, test_bpf);
+REGISTER_FAST_TEST(bpf_map_autotest, true, true, test_bpf_map);
 
 #ifndef RTE_HAS_LIBPCAP
 
@@ -58,6 +58,7 @@ enum operations {
 	LOOKUP,
 	LOOKUP_MULTI,
 	DELETE,
+	LOOKUP_CHURN,
 	NUM_OPERATIONS
 };
 
@@ -308,6 +309,114 @@ timed_deletes(struct efd_perf_params *params)
 	return 0;
 }
 
+/* Stops the writers of the churn test */
+static RTE_ATOMIC(uint32_t) churn_stop;
+
+struct churn_writer_params {
+	struct efd_perf_params *params;
+	unsigned int id;
+	unsigned int num_writers;
+	uint64_t num_updates;
+};
+
+static struct churn_writer_params churn_writers[RTE_MAX_LCORE];
+
+/*
+ * Keep changing the values of the second half of the keys, each writer
+ * updating its own share of them, until told to stop.
+ */
+static int
+churn_writer(void *arg)
+{
+	struct churn_writer_params *w = arg;
+	efd_value_t flip = 1;
+	unsigned int j;
+
+	while (!rte_atomic_load_explicit(&churn_stop,
+			rte_memory_order_relaxed)) {
+		for (j = KEYS_TO_ADD / 2 + w->id; j < KEYS_TO_ADD;
+				j += w->num_writers) {
+			rte_efd_update(w->params->efd_table, test_socket_id,
+					keys[j], (data[j] ^ flip) & VALUE_BITMASK);
+			w->num_updates++;
+		}
+		flip ^= 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Bulk lookups of the first half of the keys, while the worker lcores update
+ * the second half. The groups of both halves are shared, so the lookups must
+ * stay correct while the groups are recomputed.
+ */
+static int
+timed_lookups_churn(struct efd_perf_params *params)
+{
+	unsigned int i, j, k, lcore_id;
+	unsigned int num_writers = rte_lcore_count() - 1;
+	efd_value_t result[RTE_EFD_BURST_MAX] = {0};
+	const void *keys_burst[RTE_EFD_BURST_MAX];
+	uint64_t num_updates = 0;
+	int ret = 0;
+
+	if (num_writers == 0)
+		return 0;
+
+	rte_atomic_store_explicit(&churn_stop, 0, rte_memory_order_relaxed);
+	i = 0;
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		churn_writers[i].params = params;
+		churn_writers[i].id = i;
+		churn_writers[i].num_writers = num_writers;
+		churn_writers[i].num_updates = 0;
+		rte_eal_remote_launch(churn_writer, &churn_writers[i],
+				lcore_id);
+		i++;
+	}
+
+	const uint64_t start_tsc = rte_rdtsc();
+
+	for (i = 0; i < NUM_LOOKUPS / KEYS_TO_ADD && ret == 0; i++) {
+		for (j = 0; j < KEYS_TO_ADD / 2 / RTE_EFD_BURST_MAX; j++) {
+			for (k = 0; k < RTE_EFD_BURST_MAX; k++)
+				keys_burst[k] = keys[j * RTE_EFD_BURST_MAX + k];
+
+			rte_efd_lookup_bulk(params->efd_table, test_socket_id,
+					RTE_EFD_BURST_MAX,
+					keys_burst, result);
+
+			for (k = 0; k < RTE_EFD_BURST_MAX; k++) {
+				uint32_t data_idx = j * RTE_EFD_BURST_MAX + k;
+
+				if (result[k] != data[data_idx]) {
+					printf("Value mismatch under churn: "
+						"key #%u, expected %d, got %d\n",
+						data_idx, data[data_idx],
+						result[k]);
+					ret = -1;
+				}
+			}
+		}
+	}
+
+	const uint64_t end_tsc = rte_rdtsc();
+
+	rte_atomic_store_explicit(&churn_stop, 1, rte_memory_order_relaxed);
+	rte_eal_mp_wait_lcore();
+
+	for (i = 0; i < num_writers; i++)
+		num_updates += churn_writers[i].num_updates;
+
+	cycles[params->cycle][LOOKUP_CHURN] = (end_tsc - start_tsc) /
+			(NUM_LOOKUPS / 2);
+	printf("\n%u writer(s) made %"PRIu64" updates during the lookups\n",
+			num_writers, num_updates);
+
+	return ret;
+}
+
 static void
 perform_frees(struct efd_perf_params *params)
 {
@@ -358,6 +467,9 @@ run_all_tbl_perf_tests(void)
 		if (timed_lookups_multi(&params) < 0)
 			return exit_with_fail("timed_lookups_multi", &params, i);
 
+		if (timed_lookups_churn(&params) < 0)
+			return exit_with_fail("timed_lookups_churn", &params, i);
+
 		if (timed_deletes(&params) < 0)
 			return exit_with_fail("timed_deletes", &params, i);
 
@@ -370,8 +482,9 @@ run_all_tbl_perf_tests(void)
 
 	printf("\nResults (in CPU cycles/operation)\n");
 	printf("-----------------------------------\n");
-	printf("\n%-18s%-18s%-18s%-18s%-18s\n",
-			"Keysize", "Add", "Lookup", "Lookup_bulk", "Delete");
+	printf("\n%-18s%-18s%-18s%-18s%-18s%-18s\n",
+			"Keysize", "Add", "Lookup", "Lookup_bulk", "Delete",
+			"Lookup_churn");
 	for (i = 0; i < NUM_KEYSIZES; i++) {
 		printf("%-18d", hashtest_key_lens[i]);
 		for (j = 0; j < NUM_OPERATIONS; j++)
@@ -1341,6 +1341,43 @@ test_eventdev_selftest_impl(const char *pmd, const char *opts)
 	return rte_event_dev_selftest(rte_event_dev_get_dev_id(pmd));
 }
 
+/* The DSW remote migration penalty is reported in percent, as configured. */
+static int
+test_eventdev_dsw_penalty_check(const char *name, const char *opts,
+				uint64_t expected)
+{
+	uint64_t value;
+	int dev_id;
+
+	if (rte_vdev_init(name, opts))
+		return TEST_SKIPPED;
+
+	dev_id = rte_event_dev_get_dev_id(name);
+	value = rte_event_dev_xstats_by_name_get(dev_id,
+			"dev_remote_migration_penalty", NULL);
+	rte_vdev_uninit(name);
+
+	TEST_ASSERT_EQUAL(value, expected,
+			"%s: remote migration penalty %" PRIu64 " instead of %" PRIu64,
+			name, value, expected);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_eventdev_dsw_xstats(void)
+{
+	int ret;
+
+	/* Default value */
+	ret = test_eventdev_dsw_penalty_check("event_dsw_xstats0", NULL, 10);
+	if (ret != TEST_SUCCESS)
+		return ret;
+
+	return test_eventdev_dsw_penalty_check("event_dsw_xstats1",
+			"remote_migration_penalty=20", 20);
+}
+
 static int
 test_eventdev_selftest_sw(void)
 {
@@ -1383,6 +1420,7 @@ REGISTER_FAST_TEST(eventdev_common_autotest, true, true, test_eventdev_common);
 
 #ifndef RTE_EXEC_ENV_WINDOWS
 REGISTER_FAST_TEST(eventdev_selftest_sw, true, true, test_eventdev_selftest_sw);
+REGISTER_FAST_TEST(eventdev_dsw_xstats_autotest, true, true, test_eventdev_dsw_xstats);
 REGISTER_DRIVER_TEST(eventdev_selftest_octeontx, test_eventdev_selftest_octeontx);
 REGISTER_DRIVER_TEST(eventdev_selftest_dpaa2, test_eventdev_selftest_dpaa2);
 REGISTER_DRIVER_TEST(eventdev_selftest_dlb2, test_eventdev_selftest_dlb2);
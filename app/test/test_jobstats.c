@@ -0,0 +1,411 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2015 Intel Corporation
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <rte_bitops.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_jobstats.h>
+
+#include "test.h"
+
+#define NB_EXECS 16
+#define SHORT_DELAY_US 1
+#define LONG_DELAY_US 1000
+#define TELEMETRY_BUF_SIZE 4096
+
+static struct rte_jobstats_context ctx;
+static struct rte_jobstats job, sub_job, nested_job;
+static struct rte_jobstats_ext job_ext, sub_ext, nested_ext;
+
+/* Bucket of an execution time, as documented for RTE_JOBSTATS_HIST_BUCKETS */
+static uint32_t
+hist_bucket(uint64_t exec_time)
+{
+	return RTE_MIN(rte_fls_u64(exec_time),
+		(uint32_t)RTE_JOBSTATS_HIST_BUCKETS - 1);
+}
+
+static uint64_t
+hist_total(const struct rte_jobstats_ext *j)
+{
+	uint64_t total = 0;
+	unsigned int i;
+
+	for (i = 0; i < RTE_JOBSTATS_HIST_BUCKETS; i++)
+		total += j->hist[i];
+
+	return total;
+}
+
+static int
+run_job(struct rte_jobstats_ext *ext, unsigned int delay_us)
+{
+	if (rte_jobstats_start(&ctx, ext->job) != 0)
+		return -1;
+	rte_delay_us_block(delay_us);
+	if (rte_jobstats_ext_finish(ext, ext->job->target) < 0)
+		return -1;
+
+	return 0;
+}
+
+static int
+test_jobstats_setup(void)
+{
+	TEST_ASSERT_SUCCESS(rte_jobstats_context_init(&ctx),
+		"Failed to init context");
+	TEST_ASSERT_SUCCESS(rte_jobstats_init(&job, "test_job", 0, 0, 0, 0),
+		"Failed to init job");
+	TEST_ASSERT_SUCCESS(rte_jobstats_init(&sub_job, "test_sub_job",
+		0, 0, 0, 0), "Failed to init sub-job");
+	TEST_ASSERT_SUCCESS(rte_jobstats_init(&nested_job, "test_nested_job",
+		0, 0, 0, 0), "Failed to init nested sub-job");
+	TEST_ASSERT_EQUAL(rte_jobstats_ext_init(NULL, &job), -EINVAL,
+		"Extension initialized without object");
+	TEST_ASSERT_SUCCESS(rte_jobstats_ext_init(&job_ext, &job),
+		"Failed to init job extension");
+	TEST_ASSERT_SUCCESS(rte_jobstats_ext_init(&sub_ext, &sub_job),
+		"Failed to init sub-job extension");
+	TEST_ASSERT_SUCCESS(rte_jobstats_ext_init(&nested_ext, &nested_job),
+		"Failed to init nested sub-job extension");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_jobstats_hist(void)
+{
+	uint64_t expected[RTE_JOBSTATS_HIST_BUCKETS] = { 0 };
+	uint64_t prev_time = 0, exec_time;
+	uint32_t bucket;
+	unsigned int i;
+
+	/* disabled by default */
+	TEST_ASSERT_SUCCESS(run_job(&job_ext, SHORT_DELAY_US), "Job failed");
+	TEST_ASSERT_EQUAL(hist_total(&job_ext), 0,
+		"Histogram filled while disabled");
+
+	rte_jobstats_ext_reset(&job_ext);
+	rte_jobstats_set_histogram(&job_ext, true);
+
+	for (i = 0; i < NB_EXECS; i++) {
+		TEST_ASSERT_SUCCESS(run_job(&job_ext,
+			i % 2 ? LONG_DELAY_US : SHORT_DELAY_US), "Job failed");
+
+		exec_time = job.exec_time - prev_time;
+		prev_time = job.exec_time;
+		bucket = hist_bucket(exec_time);
+		expected[bucket]++;
+		TEST_ASSERT(memcmp(job_ext.hist, expected, sizeof(expected)) == 0,
+			"Execution of %" PRIu64 " cycles not in bucket %u",
+			exec_time, bucket);
+
+		/* bucket i holds the executions of [2^(i-1), 2^i) cycles */
+		TEST_ASSERT(bucket > 0, "Execution of 0 cycles");
+		TEST_ASSERT(bucket == RTE_JOBSTATS_HIST_BUCKETS - 1 ||
+			exec_time < (UINT64_C(1) << bucket), "Bucket too low");
+		TEST_ASSERT(exec_time >= (UINT64_C(1) << (bucket - 1)),
+			"Bucket too high");
+
+		/* the long executions take at least the delay */
+		if (i % 2)
+			TEST_ASSERT(bucket >= hist_bucket(rte_get_timer_hz() /
+				(US_PER_S / LONG_DELAY_US)),
+				"Long execution in a short bucket");
+	}
+
+	/* the jobs finished with the stable API are not accounted */
+	TEST_ASSERT_SUCCESS(rte_jobstats_start(&ctx, &job), "Job not started");
+	TEST_ASSERT(rte_jobstats_finish(&job, job.target) >= 0,
+		"Job not finished");
+	TEST_ASSERT_EQUAL(hist_total(&job_ext), NB_EXECS,
+		"Histogram filled by rte_jobstats_finish");
+
+	rte_jobstats_ext_reset(&job_ext);
+	TEST_ASSERT_EQUAL(hist_total(&job_ext), 0, "Histogram not reset");
+	TEST_ASSERT_EQUAL(job.exec_cnt, 0, "Job not reset");
+
+	/* the sub-jobs fill their histogram too */
+	rte_jobstats_set_histogram(&sub_ext, true);
+	TEST_ASSERT_SUCCESS(rte_jobstats_start(&ctx, &job), "Job not started");
+	TEST_ASSERT_SUCCESS(rte_jobstats_sub_start(&job_ext, &sub_ext),
+		"Sub-job not started");
+	rte_delay_us_block(SHORT_DELAY_US);
+	TEST_ASSERT_SUCCESS(rte_jobstats_sub_finish(&sub_ext),
+		"Sub-job not finished");
+	TEST_ASSERT(rte_jobstats_ext_finish(&job_ext, job.target) >= 0,
+		"Job not finished");
+	TEST_ASSERT_EQUAL(sub_ext.hist[hist_bucket(sub_job.exec_time)], 1,
+		"Sub-job execution not in its bucket");
+	TEST_ASSERT_EQUAL(hist_total(&sub_ext), 1,
+		"Sub-job execution not counted once");
+	TEST_ASSERT_EQUAL(job_ext.hist[hist_bucket(job.exec_time)], 1,
+		"Job execution not in its bucket");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_jobstats_sub_jobs(void)
+{
+	uint64_t job_exec_cnt = ctx.job_exec_cnt;
+	uint64_t ctx_exec_time = ctx.exec_time;
+
+	rte_jobstats_ext_reset(&job_ext);
+	rte_jobstats_ext_reset(&sub_ext);
+	rte_jobstats_ext_reset(&nested_ext);
+
+	TEST_ASSERT_EQUAL(rte_jobstats_sub_start(&job_ext, &sub_ext), -EINVAL,
+		"Sub-job started in a job not running");
+	TEST_ASSERT_EQUAL(rte_jobstats_sub_finish(&sub_ext), -EINVAL,
+		"Sub-job finished while not started");
+
+	TEST_ASSERT_SUCCESS(rte_jobstats_start(&ctx, &job), "Job not started");
+	TEST_ASSERT_SUCCESS(rte_jobstats_sub_start(&job_ext, &sub_ext),
+		"Sub-job not started");
+	TEST_ASSERT_EQUAL(rte_jobstats_sub_start(&job_ext, &sub_ext), -EINVAL,
+		"Sub-job started twice");
+	TEST_ASSERT_EQUAL(rte_jobstats_ext_finish(&sub_ext, 0), -EINVAL,
+		"Sub-job finished as a job");
+	TEST_ASSERT_EQUAL(rte_jobstats_finish(&sub_job, 0), -EINVAL,
+		"Sub-job finished as a job");
+	TEST_ASSERT_EQUAL(rte_jobstats_abort(&sub_job), -EINVAL,
+		"Sub-job aborted as a job");
+	TEST_ASSERT_EQUAL(rte_jobstats_ext_finish(&job_ext, job.target),
+		-EINVAL, "Job finished while its sub-job is running");
+
+	/* nested sub-job */
+	TEST_ASSERT_SUCCESS(rte_jobstats_sub_start(&sub_ext, &nested_ext),
+		"Nested sub-job not started");
+	rte_delay_us_block(SHORT_DELAY_US);
+	TEST_ASSERT_EQUAL(rte_jobstats_sub_finish(&sub_ext), -EINVAL,
+		"Sub-job finished while its nested sub-job is running");
+	TEST_ASSERT_SUCCESS(rte_jobstats_sub_finish(&nested_ext),
+		"Nested sub-job not finished");
+	rte_delay_us_block(SHORT_DELAY_US);
+	TEST_ASSERT_SUCCESS(rte_jobstats_sub_finish(&sub_ext),
+		"Sub-job not finished");
+
+	/* a second execution of the sub-job in the same job */
+	TEST_ASSERT_SUCCESS(rte_jobstats_sub_start(&job_ext, &sub_ext),
+		"Sub-job not restarted");
+	rte_delay_us_block(SHORT_DELAY_US);
+	TEST_ASSERT_SUCCESS(rte_jobstats_sub_finish(&sub_ext),
+		"Sub-job not finished");
+	rte_delay_us_block(SHORT_DELAY_US);
+	TEST_ASSERT(rte_jobstats_ext_finish(&job_ext, job.target) >= 0,
+		"Job not finished");
+
+	TEST_ASSERT_EQUAL(sub_job.exec_cnt, 2, "Sub-job executions not counted");
+	TEST_ASSERT_EQUAL(nested_job.exec_cnt, 1,
+		"Nested sub-job execution not counted");
+	TEST_ASSERT(sub_ext.parent == &job_ext && nested_ext.parent == &sub_ext,
+		"Wrong parent of sub-job");
+
+	/* the time of the sub-jobs is part of the time of their parent */
+	TEST_ASSERT_EQUAL(job_ext.sub_exec_time, sub_job.exec_time,
+		"Sub-job time not accounted in the parent");
+	TEST_ASSERT_EQUAL(sub_ext.sub_exec_time, nested_job.exec_time,
+		"Nested sub-job time not accounted in the sub-job");
+	TEST_ASSERT(job.exec_time > job_ext.sub_exec_time,
+		"Job time %" PRIu64 " not above its sub-jobs time %" PRIu64,
+		job.exec_time, job_ext.sub_exec_time);
+	TEST_ASSERT(sub_job.max_exec_time > nested_job.exec_time,
+		"Sub-job time not above its nested sub-job time");
+
+	/* only the parent is a job of the context */
+	TEST_ASSERT_EQUAL(ctx.job_exec_cnt, job_exec_cnt + 1,
+		"Sub-jobs counted in the context");
+	TEST_ASSERT_EQUAL(ctx.exec_time - ctx_exec_time, job.exec_time,
+		"Sub-jobs time counted in the context");
+
+	return TEST_SUCCESS;
+}
+
+static int
+connect_to_telemetry(void)
+{
+	struct sockaddr_un addr;
+	char buf[TELEMETRY_BUF_SIZE];
+	int s;
+
+	s = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (s < 0)
+		return -1;
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/dpdk_telemetry.v2",
+			rte_eal_get_runtime_dir());
+	if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+			read(s, buf, sizeof(buf)) < 0) {
+		close(s);
+		return -1;
+	}
+
+	return s;
+}
+
+/* Send a telemetry command and return its reply in buf */
+static int
+telemetry_request(int sock, const char *request, char *buf, size_t len)
+{
+	ssize_t bytes;
+
+	if (write(sock, request, strlen(request)) < 0)
+		return -1;
+	bytes = read(sock, buf, len - 1);
+	if (bytes < 0)
+		return -1;
+	buf[bytes] = '\0';
+	printf("%s: %s\n", request, buf);
+
+	return 0;
+}
+
+/* Check an unsigned value of the reply */
+static int
+telemetry_check_value(const char *buf, const char *name, uint64_t value)
+{
+	char key[64];
+	const char *p;
+
+	snprintf(key, sizeof(key), "\"%s\":", name);
+	p = strstr(buf, key);
+	if (p == NULL || strtoull(p + strlen(key), NULL, 10) != value) {
+		printf("Wrong %s, expected %" PRIu64 "\n", name, value);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+telemetry_check_hist(const char *buf, const struct rte_jobstats_ext *j)
+{
+	const char *p;
+	char *end;
+	unsigned int i;
+
+	p = strstr(buf, "\"hist\":[");
+	if (p == NULL)
+		return -1;
+	p += strlen("\"hist\":[");
+
+	for (i = 0; i < RTE_JOBSTATS_HIST_BUCKETS; i++) {
+		if (strtoull(p, &end, 10) != j->hist[i] || end == p ||
+				*end != (i < RTE_JOBSTATS_HIST_BUCKETS - 1 ? ',' : ']'))
+			return -1;
+		p = end + 1;
+	}
+
+	return 0;
+}
+
+static int
+test_jobstats_telemetry(void)
+{
+	char buf[TELEMETRY_BUF_SIZE];
+	int sock, ret = TEST_FAILED;
+
+	sock = connect_to_telemetry();
+	if (sock < 0) {
+		printf("Telemetry not available, skipping test\n");
+		return TEST_SKIPPED;
+	}
+
+	if (rte_jobstats_telemetry_register(NULL) != -EINVAL ||
+			rte_jobstats_telemetry_register(&job_ext) != 0 ||
+			rte_jobstats_telemetry_register(&sub_ext) != 0 ||
+			rte_jobstats_telemetry_register(&job_ext) != -EEXIST) {
+		printf("Wrong registration of jobs\n");
+		goto out;
+	}
+
+	if (telemetry_request(sock, "/jobstats/list", buf, sizeof(buf)) < 0 ||
+			strstr(buf, "\"test_job\"") == NULL ||
+			strstr(buf, "\"test_sub_job\"") == NULL ||
+			strstr(buf, "\"test_nested_job\"") != NULL) {
+		printf("Wrong list of jobs\n");
+		goto out;
+	}
+
+	if (telemetry_request(sock, "/jobstats/info,test_job",
+				buf, sizeof(buf)) < 0 ||
+			strstr(buf, "\"name\":\"test_job\"") == NULL ||
+			strstr(buf, "\"parent\":\"\"") == NULL ||
+			telemetry_check_value(buf, "exec_cnt", job.exec_cnt) < 0 ||
+			telemetry_check_value(buf, "exec_time", job.exec_time) < 0 ||
+			telemetry_check_value(buf, "min_exec_time",
+				job.min_exec_time) < 0 ||
+			telemetry_check_value(buf, "max_exec_time",
+				job.max_exec_time) < 0 ||
+			telemetry_check_value(buf, "sub_exec_time",
+				job_ext.sub_exec_time) < 0 ||
+			telemetry_check_value(buf, "period", job.period) < 0 ||
+			telemetry_check_hist(buf, &job_ext) < 0) {
+		printf("Wrong info of job\n");
+		goto out;
+	}
+
+	/* the histogram of the sub-job is disabled */
+	rte_jobstats_set_histogram(&sub_ext, false);
+	if (telemetry_request(sock, "/jobstats/info,test_sub_job",
+				buf, sizeof(buf)) < 0 ||
+			strstr(buf, "\"parent\":\"test_job\"") == NULL ||
+			telemetry_check_value(buf, "exec_cnt",
+				sub_job.exec_cnt) < 0 ||
+			telemetry_check_value(buf, "sub_exec_time",
+				sub_ext.sub_exec_time) < 0 ||
+			strstr(buf, "\"hist\"") != NULL) {
+		printf("Wrong info of sub-job\n");
+		goto out;
+	}
+
+	if (rte_jobstats_telemetry_unregister(&sub_ext) != 0 ||
+			rte_jobstats_telemetry_unregister(&sub_ext) != -ENOENT) {
+		printf("Wrong unregistration of sub-job\n");
+		goto out;
+	}
+	if (telemetry_request(sock, "/jobstats/info,test_sub_job",
+				buf, sizeof(buf)) < 0 ||
+			strstr(buf, "\"name\"") != NULL) {
+		printf("Unregistered sub-job still reported\n");
+		goto out;
+	}
+
+	ret = TEST_SUCCESS;
+out:
+	rte_jobstats_telemetry_unregister(&job_ext);
+	rte_jobstats_telemetry_unregister(&sub_ext);
+	close(sock);
+	return ret;
+}
+
+static struct unit_test_suite jobstats_testsuite = {
+	.suite_name = "jobstats autotest",
+	.setup = test_jobstats_setup,
+	.unit_test_cases = {
+		TEST_CASE(test_jobstats_hist),
+		TEST_CASE(test_jobstats_sub_jobs),
+		TEST_CASE(test_jobstats_telemetry),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_jobstats(void)
+{
+	return unit_test_suite_runner(&jobstats_testsuite);
+}
+
+REGISTER_FAST_TEST(jobstats_autotest, true, true, test_jobstats);
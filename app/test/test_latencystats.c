@@ -14,7 +14,7 @@
 #include "sample_packet_forward.h"
 #include "test.h"
 
-#define NUM_STATS 4
+#define NUM_STATS 8
 #define LATENCY_NUM_PACKETS 10
 #define QUEUE_ID 0
 
@@ -26,6 +26,10 @@ static struct rte_metric_name lat_stats_strings[] = {
 	{"avg_latency_ns"},
 	{"max_latency_ns"},
 	{"jitter_ns"},
+	{"p50_latency_ns"},
+	{"p90_latency_ns"},
+	{"p99_latency_ns"},
+	{"p99_9_latency_ns"},
 };
 
 /* Test case for latency init with metrics init */
@@ -120,6 +124,15 @@ static int test_latencystats_get(void)
 	TEST_ASSERT((ret == NUM_STATS), "Test Failed to get latency metrics"
 			" values");
 
+	/* Percentiles are ordered and bounded by the max latency */
+	for (i = 5; i < NUM_STATS; i++)
+		TEST_ASSERT(values[i - 1].value <= values[i].value,
+			"Test Failed: %s above %s", lat_stats_strings[i - 1].name,
+			lat_stats_strings[i].name);
+	TEST_ASSERT(values[NUM_STATS - 1].value <= values[2].value,
+		"Test Failed: %s above %s", lat_stats_strings[NUM_STATS - 1].name,
+		lat_stats_strings[2].name);
+
 	/* Failure Test: Invalid values and valid size */
 	ret = rte_latencystats_get(NULL, size);
 	TEST_ASSERT((ret == NUM_STATS), "Test Failed to get the stats count,"
@@ -2,17 +2,23 @@
  * Copyright(c) 2010-2014 Intel Corporation
  */
 
+#include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/queue.h>
 
+#include <rte_cycles.h>
 #include <rte_log.h>
 #include <rte_memory.h>
 #include <rte_launch.h>
 #include <rte_eal.h>
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
+#include <rte_stdatomic.h>
 
 #include "test.h"
 
@@ -60,6 +66,134 @@ test_legacy_logs(void)
 	return 0;
 }
 
+#ifndef RTE_EXEC_ENV_WINDOWS
+/*
+ * Asynchronous logs
+ * =================
+ *
+ * - Queue more messages than the rings can hold, and a critical message.
+ * - Check the queued messages are written before the critical one,
+ *   and the others are counted as dropped.
+ * - Disable the asynchronous mode while a worker lcore is logging,
+ *   and check that all the queued messages are written.
+ */
+static RTE_ATOMIC(bool) async_logs_stop;
+
+static int
+async_logs_worker(void *arg)
+{
+	int logtype = (int)(uintptr_t)arg;
+	unsigned int i = 0;
+
+	while (!rte_atomic_load_explicit(&async_logs_stop,
+			rte_memory_order_acquire))
+		rte_log(RTE_LOG_ERR, logtype, "worker message %u\n", i++);
+
+	return 0;
+}
+
+static int
+test_async_logs_disable(int logtype)
+{
+	struct rte_log_async_stats prev, stats;
+	unsigned int worker;
+	char *buf = NULL;
+	size_t size = 0;
+	FILE *f;
+
+	worker = rte_get_next_lcore(-1, 1, 0);
+	if (worker >= RTE_MAX_LCORE) {
+		printf("no worker lcore, skipping asynchronous disable test\n");
+		return 0;
+	}
+
+	f = open_memstream(&buf, &size);
+	TEST_ASSERT_NOT_NULL(f, "cannot open memory stream");
+	rte_openlog_stream(f);
+
+	TEST_ASSERT_SUCCESS(rte_log_async_enable(0),
+		"cannot enable asynchronous logs");
+	rte_log_async_stats_get(&prev);
+
+	rte_atomic_store_explicit(&async_logs_stop, false,
+		rte_memory_order_relaxed);
+	rte_eal_remote_launch(async_logs_worker, (void *)(uintptr_t)logtype,
+		worker);
+	rte_delay_ms(10);
+	rte_log_async_disable();
+	rte_atomic_store_explicit(&async_logs_stop, true,
+		rte_memory_order_release);
+	rte_eal_wait_lcore(worker);
+
+	rte_log_async_stats_get(&stats);
+	rte_openlog_stream(NULL);
+	fclose(f);
+	free(buf);
+
+	printf("%"PRIu64" worker messages queued, %"PRIu64" written\n",
+		stats.records - prev.records, stats.written - prev.written);
+	TEST_ASSERT_EQUAL(stats.written - prev.written,
+		stats.records - prev.records,
+		"queued messages not written after disable");
+
+	return 0;
+}
+
+static int
+test_async_logs(int logtype)
+{
+	struct rte_log_async_stats prev, stats;
+	uint64_t records, drops;
+	size_t size = 0, lines = 0;
+	const char *last;
+	char *buf = NULL;
+	FILE *f;
+	int i;
+
+	printf("== asynchronous logs\n");
+
+	TEST_ASSERT_EQUAL(rte_log_async_enable(1000), -EINVAL,
+		"invalid ring size accepted");
+
+	f = open_memstream(&buf, &size);
+	TEST_ASSERT_NOT_NULL(f, "cannot open memory stream");
+	rte_openlog_stream(f);
+
+	TEST_ASSERT_SUCCESS(rte_log_async_enable(4096),
+		"cannot enable asynchronous logs");
+	TEST_ASSERT_EQUAL(rte_log_async_enable(0), -EALREADY,
+		"asynchronous logs enabled twice");
+	TEST_ASSERT_SUCCESS(rte_log_async_stats_get(&prev),
+		"cannot get asynchronous log stats");
+
+	for (i = 0; i < 200; i++)
+		rte_log(RTE_LOG_ERR, logtype, "async message %d\n", i);
+	rte_log(RTE_LOG_CRIT, logtype, "critical message\n");
+
+	rte_log_async_disable();
+	rte_log_async_stats_get(&stats);
+	rte_openlog_stream(NULL);
+	fclose(f);
+
+	records = stats.records - prev.records;
+	drops = stats.drops - prev.drops;
+	printf("%"PRIu64" messages written, %"PRIu64" dropped\n", records, drops);
+	for (last = buf; (last = strchr(last, '\n')) != NULL; last++)
+		lines++;
+	last = strstr(buf, "critical message\n");
+
+	TEST_ASSERT_EQUAL(records + drops, 200, "messages lost");
+	TEST_ASSERT_EQUAL(stats.written - prev.written, records,
+		"queued messages not written");
+	TEST_ASSERT_EQUAL(lines, records + 1, "unexpected number of lines");
+	TEST_ASSERT(last != NULL && last[strlen("critical message\n")] == '\0',
+		"critical message not written last");
+
+	free(buf);
+	return test_async_logs_disable(logtype);
+}
+#endif
+
 static int
 test_logs(void)
 {
@@ -153,6 +287,12 @@ test_logs(void)
 	if (ret < 0)
 		return ret;
 
+#ifndef RTE_EXEC_ENV_WINDOWS
+	ret = test_async_logs(logtype1);
+	if (ret < 0)
+		return ret;
+#endif
+
 #undef CHECK_LEVELS
 
 	return 0;
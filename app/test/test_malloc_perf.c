@@ -6,8 +6,11 @@
 #include <string.h>
 #include <rte_cycles.h>
 #include <rte_errno.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
 #include <rte_malloc.h>
 #include <rte_memzone.h>
+#include <rte_ring.h>
 
 #include "test.h"
 
@@ -147,6 +150,153 @@ memzone_free(void *addr)
 	rte_memzone_free((struct rte_memzone *)addr);
 }
 
+#define MT_BURST 32
+#define MT_ROUNDS 20000
+
+struct mt_params {
+	size_t size;
+	bool cross;
+	struct rte_ring *rings[RTE_MAX_LCORE];
+	uint64_t cycles[RTE_MAX_LCORE];
+	uint64_t ops[RTE_MAX_LCORE];
+	RTE_ATOMIC(uint32_t) failures;
+};
+
+static struct rte_ring *
+mt_next_ring(struct mt_params *p, unsigned int lcore_id)
+{
+	lcore_id = rte_get_next_lcore(lcore_id, 0, 1);
+	return p->rings[lcore_id];
+}
+
+/*
+ * Allocate bursts of objects, and free them on the same lcore,
+ * or on the next lcore when testing cross-lcore frees.
+ */
+static int
+mt_alloc_free(void *arg)
+{
+	struct mt_params *p = arg;
+	const unsigned int lcore_id = rte_lcore_id();
+	struct rte_ring *next = mt_next_ring(p, lcore_id);
+	struct rte_ring *own = p->rings[lcore_id];
+	void *ptrs[MT_BURST];
+	uint64_t tsc, ops = 0;
+	unsigned int i, j, n;
+
+	tsc = rte_rdtsc_precise();
+	for (i = 0; i < MT_ROUNDS; i++) {
+		for (j = 0; j < MT_BURST; j++) {
+			ptrs[j] = rte_malloc(NULL, p->size, 0);
+			if (ptrs[j] == NULL) {
+				rte_atomic_fetch_add_explicit(&p->failures, 1,
+						rte_memory_order_relaxed);
+				return -1;
+			}
+		}
+		ops += MT_BURST;
+
+		/* free locally what the next lcore cannot take */
+		n = 0;
+		if (p->cross)
+			n = rte_ring_enqueue_burst(next, ptrs, MT_BURST, NULL);
+		for (j = n; j < MT_BURST; j++)
+			rte_free(ptrs[j]);
+
+		if (p->cross) {
+			n = rte_ring_dequeue_burst(own, ptrs, MT_BURST, NULL);
+			for (j = 0; j < n; j++)
+				rte_free(ptrs[j]);
+		}
+	}
+	p->cycles[lcore_id] = rte_rdtsc_precise() - tsc;
+	p->ops[lcore_id] = ops;
+
+	return 0;
+}
+
+static int
+test_alloc_perf_mt(const char *name, bool cross)
+{
+	static const size_t SIZES[] = { 1 << 6, 1 << 8, 1 << 10, 1 << 12, 1 << 14 };
+
+	struct mt_params *p;
+	char ring_name[RTE_RING_NAMESIZE];
+	unsigned int lcore_id, n_lcores;
+	uint64_t cycles, ops;
+	void *ptrs[MT_BURST];
+	unsigned int j, n;
+	size_t i;
+	int ret = -1;
+
+	n_lcores = rte_lcore_count();
+	if (cross && n_lcores < 2) {
+		TEST_LOG(INFO, "Not enough lcores for %s, skipping\n\n", name);
+		return 0;
+	}
+
+	p = calloc(1, sizeof(*p));
+	if (p == NULL) {
+		TEST_LOG(ERR, "Cannot allocate memory for parameters\n");
+		return -1;
+	}
+	p->cross = cross;
+	RTE_LCORE_FOREACH(lcore_id) {
+		if (!cross)
+			continue;
+		snprintf(ring_name, sizeof(ring_name), "mperf_%u", lcore_id);
+		p->rings[lcore_id] = rte_ring_create(ring_name, MT_BURST * 4,
+				SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (p->rings[lcore_id] == NULL) {
+			TEST_LOG(ERR, "Cannot create ring\n");
+			goto out;
+		}
+	}
+
+	TEST_LOG(INFO, "Performance: %s on %u lcores\n", name, n_lcores);
+	TEST_LOG(INFO, "%12s%12s%20s\n", "Size (B)", "Ops",
+			"Alloc+free (cycles)");
+	for (i = 0; i < RTE_DIM(SIZES); i++) {
+		p->size = SIZES[i];
+		rte_eal_mp_remote_launch(mt_alloc_free, p, CALL_MAIN);
+		rte_eal_mp_wait_lcore();
+		if (rte_atomic_load_explicit(&p->failures,
+				rte_memory_order_relaxed) != 0) {
+			TEST_LOG(ERR, "rte_malloc(size=%zu) failed\n", p->size);
+			goto out;
+		}
+
+		/* free what is left in the rings */
+		RTE_LCORE_FOREACH(lcore_id) {
+			if (!cross)
+				break;
+			do {
+				n = rte_ring_dequeue_burst(p->rings[lcore_id],
+						ptrs, MT_BURST, NULL);
+				for (j = 0; j < n; j++)
+					rte_free(ptrs[j]);
+			} while (n != 0);
+		}
+
+		cycles = 0;
+		ops = 0;
+		RTE_LCORE_FOREACH(lcore_id) {
+			cycles += p->cycles[lcore_id];
+			ops += p->ops[lcore_id];
+		}
+		TEST_LOG(INFO, "%12zu%12"PRIu64"%20"PRIu64"\n",
+				p->size, ops, cycles / ops);
+	}
+	ret = 0;
+
+out:
+	RTE_LCORE_FOREACH(lcore_id)
+		rte_ring_free(p->rings[lcore_id]);
+	free(p);
+	TEST_LOG(INFO, "\n");
+	return ret;
+}
+
 static int
 test_malloc_perf(void)
 {
@@ -168,6 +318,11 @@ test_malloc_perf(void)
 			NULL, memset_us_gb, rte_memzone_max_get() - 1) < 0)
 		return -1;
 
+	if (test_alloc_perf_mt("rte_malloc/rte_free", false) < 0)
+		return -1;
+	if (test_alloc_perf_mt("rte_malloc/rte_free on next lcore", true) < 0)
+		return -1;
+
 	return 0;
 }
 
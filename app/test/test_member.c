@@ -30,6 +30,8 @@ struct rte_member_setsum *setsum_ht;
 struct rte_member_setsum *setsum_cache;
 struct rte_member_setsum *setsum_vbf;
 struct rte_member_setsum *setsum_sketch;
+struct rte_member_setsum *setsum_cuckoo;
+struct rte_member_setsum *setsum_cbf;
 
 /* 5-tuple key type */
 struct flow_key {
@@ -93,6 +95,8 @@ static struct flow_key keys[NUM_SAMPLES] = {
 uint32_t test_set[NUM_SAMPLES] = {1, 2, 3, 4, 5};
 
 #define ITERATIONS  3
+/* Keys deleted from the full cuckoo filter */
+#define CUCKOO_DELETED_KEYS 800
 #define KEY_SIZE  4
 
 #define MAX_ENTRIES (1 << 16)
@@ -692,12 +696,186 @@ test_member_loadfactor(void)
 	return 0;
 }
 
+/*
+ * Sequence of operations for the set-summaries supporting deletion
+ * (cuckoo filter and counting vBF)
+ *
+ *  - add, single and bulk lookup: hit
+ *  - add same keys to several sets, single and bulk multimatch lookup
+ *  - delete: lookup miss, second delete returns -ENOENT
+ *  - cuckoo filter: fill until full, no false negative
+ */
+static int
+test_member_deletable(void)
+{
+	struct rte_member_setsum *ss[2];
+	const void *key_array[NUM_SAMPLES];
+	member_set_t set_ids[NUM_SAMPLES];
+	member_set_t set_ids_m[NUM_SAMPLES][MAX_MATCH];
+	uint32_t match_count[NUM_SAMPLES];
+	unsigned int added_keys;
+	uint32_t i, j, k, mask;
+	uint16_t set;
+	int ret, prev_ret;
+
+	params.key_len = sizeof(struct flow_key);
+	params.num_keys = MAX_ENTRIES;
+	params.name = "test_member_cuckoo";
+	params.type = RTE_MEMBER_TYPE_CUCKOO_FILTER;
+	setsum_cuckoo = rte_member_create(&params);
+
+	params.name = "test_member_cbf";
+	params.type = RTE_MEMBER_TYPE_CBF;
+	setsum_cbf = rte_member_create(&params);
+
+	TEST_ASSERT(setsum_cuckoo != NULL && setsum_cbf != NULL,
+			"Creation of deletable setsums fail");
+	ss[0] = setsum_cuckoo;
+	ss[1] = setsum_cbf;
+
+	for (i = 0; i < NUM_SAMPLES; i++)
+		key_array[i] = &keys[i];
+
+	for (k = 0; k < RTE_DIM(ss); k++) {
+		for (i = 0; i < NUM_SAMPLES; i++) {
+			ret = rte_member_add(ss[k], &keys[i], test_set[i]);
+			TEST_ASSERT(ret >= 0, "insert error");
+		}
+
+		for (i = 0; i < NUM_SAMPLES; i++) {
+			ret = rte_member_lookup(ss[k], &keys[i], &set);
+			TEST_ASSERT(ret == 1 && set == test_set[i],
+					"single lookup error");
+		}
+
+		ret = rte_member_lookup_bulk(ss[k], key_array, NUM_SAMPLES,
+				set_ids);
+		TEST_ASSERT(ret == NUM_SAMPLES, "bulk lookup function error");
+		for (i = 0; i < NUM_SAMPLES; i++)
+			TEST_ASSERT(set_ids[i] == test_set[i],
+					"bulk lookup result error");
+
+		for (i = 0; i < NUM_SAMPLES; i++) {
+			ret = rte_member_delete(ss[k], &keys[i], test_set[i]);
+			TEST_ASSERT(ret == 0, "key deletion function error");
+			ret = rte_member_delete(ss[k], &keys[i], test_set[i]);
+			TEST_ASSERT(ret == -ENOENT,
+					"deleted key deletion not detected");
+		}
+
+		ret = rte_member_lookup_bulk(ss[k], key_array, NUM_SAMPLES,
+				set_ids);
+		TEST_ASSERT(ret == 0, "deleted keys still found");
+
+		/* Multimatch */
+		for (i = M_MATCH_S; i <= M_MATCH_E; i += M_MATCH_STEP) {
+			for (j = 0; j < NUM_SAMPLES; j++) {
+				ret = rte_member_add(ss[k], &keys[j], i);
+				TEST_ASSERT(ret >= 0, "insert function error");
+			}
+		}
+
+		ret = rte_member_lookup_multi_bulk(ss[k], key_array,
+				NUM_SAMPLES, MAX_MATCH, match_count,
+				(member_set_t *)set_ids_m);
+		TEST_ASSERT(ret == NUM_SAMPLES, "bulk multimatch lookup error");
+		for (j = 0; j < NUM_SAMPLES; j++) {
+			TEST_ASSERT(match_count[j] == M_MATCH_CNT,
+				"bulk multimatch lookup match count error");
+			TEST_ASSERT(rte_member_lookup_multi(ss[k], &keys[j],
+					MAX_MATCH, set_ids_m[0]) == M_MATCH_CNT,
+				"single multimatch lookup error");
+
+			/* Cuckoo filter does not return the sets in order */
+			mask = 0;
+			for (i = 0; i < M_MATCH_CNT; i++)
+				mask |= 1U << set_ids_m[j][i];
+			for (i = M_MATCH_S; i <= M_MATCH_E; i += M_MATCH_STEP)
+				TEST_ASSERT(mask & (1U << i),
+					"bulk multimatch lookup set value error");
+		}
+
+		for (i = M_MATCH_S; i <= M_MATCH_E; i += M_MATCH_STEP) {
+			for (j = 0; j < NUM_SAMPLES; j++) {
+				ret = rte_member_delete(ss[k], &keys[j], i);
+				TEST_ASSERT(ret == 0,
+					"key deletion function error");
+			}
+		}
+
+		for (j = 0; j < NUM_SAMPLES; j++) {
+			ret = rte_member_lookup(ss[k], &keys[j], &set);
+			TEST_ASSERT(ret == 0 && set == RTE_MEMBER_NO_MATCH,
+					"key deletion failed");
+		}
+	}
+	printf("deletable setsums success\n");
+
+	/* Cuckoo filter load: 4096 buckets of 4 entries */
+	rte_member_free(setsum_cuckoo);
+	setup_keys_and_data();
+	params.key_len = KEY_SIZE;
+	params.num_keys = 4096 * 4 * 95 / 100;
+	params.name = "test_member_cuckoo";
+	params.type = RTE_MEMBER_TYPE_CUCKOO_FILTER;
+	setsum_cuckoo = rte_member_create(&params);
+	TEST_ASSERT(setsum_cuckoo != NULL, "Creation of cuckoo filter fail");
+
+	/*
+	 * Once an entry is kept aside as a victim, the next insertion is
+	 * refused since the victim cannot be placed back.
+	 */
+	ret = 0;
+	for (added_keys = 0; added_keys < MAX_ENTRIES; added_keys++) {
+		prev_ret = ret;
+		ret = rte_member_add(setsum_cuckoo, &generated_keys[added_keys],
+				(added_keys & 0xf) + 1);
+		if (ret < 0)
+			break;
+	}
+	TEST_ASSERT(ret == -ENOSPC && prev_ret == RTE_MEMBER_ADD_VICTIM,
+			"Unexpected error when adding keys");
+
+	for (i = 0; i < added_keys; i++) {
+		ret = rte_member_lookup(setsum_cuckoo, &generated_keys[i], &set);
+		TEST_ASSERT(ret == 1, "cuckoo filter false negative");
+	}
+
+	printf("Keys inserted when no space(cuckoo filter) = %.2f%% (%u/%u)\n",
+		((double) added_keys / (4096 * 4) * 100),
+		added_keys, 4096 * 4);
+
+	/* Room made by deletions is used for the victim and the new keys */
+	for (i = 0; i < CUCKOO_DELETED_KEYS; i++) {
+		ret = rte_member_delete(setsum_cuckoo, &generated_keys[i],
+				(i & 0xf) + 1);
+		TEST_ASSERT(ret == 0, "key deletion function error");
+	}
+	for (i = added_keys; i < added_keys + CUCKOO_DELETED_KEYS / 2; i++) {
+		ret = rte_member_add(setsum_cuckoo, &generated_keys[i],
+				(i & 0xf) + 1);
+		TEST_ASSERT(ret >= 0 && ret != RTE_MEMBER_ADD_VICTIM,
+				"insertion after deletion failed");
+	}
+	for (i = CUCKOO_DELETED_KEYS; i < added_keys + CUCKOO_DELETED_KEYS / 2;
+			i++) {
+		ret = rte_member_lookup(setsum_cuckoo, &generated_keys[i], &set);
+		TEST_ASSERT(ret == 1, "cuckoo filter false negative");
+	}
+
+	params.num_keys = MAX_ENTRIES;
+
+	return 0;
+}
+
 static void
 perform_free(void)
 {
 	rte_member_free(setsum_ht);
 	rte_member_free(setsum_cache);
 	rte_member_free(setsum_vbf);
+	rte_member_free(setsum_cuckoo);
+	rte_member_free(setsum_cbf);
 }
 
 static void
@@ -985,6 +1163,10 @@ test_member(void)
 		rte_member_free(setsum_cache);
 		return -1;
 	}
+	if (test_member_deletable() < 0) {
+		perform_free();
+		return -1;
+	}
 
 	if (test_member_sketch() < 0) {
 		perform_free();
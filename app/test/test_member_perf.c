@@ -51,6 +51,8 @@ enum sstype {
 	HT = 0,
 	CACHE,
 	VBF,
+	CUCKOO,
+	CBF,
 	SKETCH,
 	SKETCH_BOUNDED,
 	SKETCH_BYTE,
@@ -167,7 +169,8 @@ setup_keys_and_data(struct member_perf_params *params, unsigned int cycle,
 			keys[i][j] = rte_rand() & 0xFF;
 
 		data[HT][i] = data[CACHE][i] = (rte_rand() & 0x7FFE) + 1;
-		data[VBF][i] = rte_rand() % VBF_SET_CNT + 1;
+		data[VBF][i] = data[CUCKOO][i] = data[CBF][i] =
+				rte_rand() % VBF_SET_CNT + 1;
 	}
 
 	/* Remove duplicates from the keys array */
@@ -242,6 +245,18 @@ setup_keys_and_data(struct member_perf_params *params, unsigned int cycle,
 	if (params->setsum[VBF] == NULL)
 		fprintf(stderr, "VBF create fail\n");
 
+	member_params.name = "test_member_cuckoo";
+	member_params.type = RTE_MEMBER_TYPE_CUCKOO_FILTER;
+	params->setsum[CUCKOO] = rte_member_create(&member_params);
+	if (params->setsum[CUCKOO] == NULL)
+		fprintf(stderr, "CUCKOO create fail\n");
+
+	member_params.name = "test_member_cbf";
+	member_params.type = RTE_MEMBER_TYPE_CBF;
+	params->setsum[CBF] = rte_member_create(&member_params);
+	if (params->setsum[CBF] == NULL)
+		fprintf(stderr, "CBF create fail\n");
+
 	member_params.name = "test_member_sketch";
 	member_params.key_len = params->key_size;
 	member_params.type = RTE_MEMBER_TYPE_SKETCH;
@@ -8,7 +8,9 @@
 #include <errno.h>
 
 #include <rte_lcore.h>
+#include <rte_launch.h>
 #include <rte_metrics.h>
+#include <rte_stdatomic.h>
 
 #include "test.h"
 
@@ -271,6 +273,110 @@ test_metrics_get_values(void)
 	return TEST_SUCCESS;
 }
 
+#define CONCURRENT_SET_SIZE 4
+#define CONCURRENT_UPDATES 100000
+
+static int concurrent_key;
+static bool concurrent_same_port;
+static RTE_ATOMIC(unsigned int) concurrent_done;
+
+/* Update a set of metrics of a port with equal values, unique to
+ * the worker
+ */
+static int
+test_metrics_update_worker(void *arg)
+{
+	unsigned int worker = (uintptr_t)arg;
+	int port_id = concurrent_same_port ? 0 : (int)worker;
+	uint64_t value[CONCURRENT_SET_SIZE];
+	uint64_t i;
+	unsigned int j;
+
+	for (i = 1; i <= CONCURRENT_UPDATES; i++) {
+		for (j = 0; j < CONCURRENT_SET_SIZE; j++)
+			value[j] = (i << 8) | worker;
+		rte_metrics_update_values(port_id, concurrent_key, value,
+				CONCURRENT_SET_SIZE);
+	}
+	rte_atomic_fetch_add_explicit(&concurrent_done, 1,
+			rte_memory_order_release);
+
+	return 0;
+}
+
+/* Check that a set of values is read consistently while updated
+ * from several lcores, each on its own port or all on the same port
+ */
+static int
+metrics_update_concurrent(bool same_port)
+{
+	const char * const mnames[CONCURRENT_SET_SIZE] = {
+		"concurrent_0", "concurrent_1",
+		"concurrent_2", "concurrent_3",
+	};
+	struct rte_metric_value getvalues[RTE_METRICS_MAX_METRICS];
+	unsigned int lcore_id, nb_workers = 0, nb_ports, j;
+	int port_id, cnt, err = 0;
+
+	if (rte_lcore_count() < 2)
+		return TEST_SKIPPED;
+
+	concurrent_key = rte_metrics_reg_names(mnames, CONCURRENT_SET_SIZE);
+	TEST_ASSERT(concurrent_key >= 0, "%s, %d", __func__, __LINE__);
+
+	concurrent_same_port = same_port;
+	rte_atomic_store_explicit(&concurrent_done, 0, rte_memory_order_relaxed);
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (nb_workers == RTE_MAX_ETHPORTS)
+			break;
+		rte_eal_remote_launch(test_metrics_update_worker,
+			(void *)(uintptr_t)nb_workers, lcore_id);
+		nb_workers++;
+	}
+	nb_ports = same_port ? 1 : nb_workers;
+
+	while (err == 0 && rte_atomic_load_explicit(&concurrent_done,
+			rte_memory_order_acquire) < nb_workers) {
+		for (port_id = 0; port_id < (int)nb_ports; port_id++) {
+			cnt = rte_metrics_get_values(port_id, getvalues,
+					RTE_DIM(getvalues));
+			if (cnt < concurrent_key + CONCURRENT_SET_SIZE) {
+				err = -1;
+				break;
+			}
+			for (j = 1; j < CONCURRENT_SET_SIZE; j++)
+				if (getvalues[concurrent_key + j].value !=
+						getvalues[concurrent_key].value)
+					err = -1;
+		}
+	}
+	rte_eal_mp_wait_lcore();
+	TEST_ASSERT(err == 0, "%s, %d", __func__, __LINE__);
+
+	/* The last update of a set is never mixed with another one */
+	cnt = rte_metrics_get_values(0, getvalues, RTE_DIM(getvalues));
+	TEST_ASSERT(cnt >= concurrent_key + CONCURRENT_SET_SIZE,
+			"%s, %d", __func__, __LINE__);
+	for (j = 1; j < CONCURRENT_SET_SIZE; j++)
+		TEST_ASSERT(getvalues[concurrent_key + j].value ==
+				getvalues[concurrent_key].value,
+				"%s, %d", __func__, __LINE__);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_metrics_update_concurrent(void)
+{
+	return metrics_update_concurrent(false);
+}
+
+static int
+test_metrics_update_concurrent_port(void)
+{
+	return metrics_update_concurrent(true);
+}
+
 static struct unit_test_suite metrics_testsuite  = {
 	.suite_name = "Metrics Unit Test Suite",
 	.setup = NULL,
@@ -313,7 +419,17 @@ static struct unit_test_suite metrics_testsuite  = {
 		 */
 		TEST_CASE(test_metrics_get_values),
 
-		/* TEST CASE 8: Test to unregister metrics*/
+		/* TEST CASE 8: Test to read a set of metrics
+		 * updated concurrently from several lcores
+		 */
+		TEST_CASE(test_metrics_update_concurrent),
+
+		/* TEST CASE 9: Test to read a set of metrics of a port
+		 * updated concurrently from several lcores
+		 */
+		TEST_CASE(test_metrics_update_concurrent_port),
+
+		/* TEST CASE 10: Test to unregister metrics*/
 		TEST_CASE(test_metrics_deinitialize),
 
 		TEST_CASES_END()
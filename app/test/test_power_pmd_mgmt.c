@@ -0,0 +1,284 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Intel Corporation
+ */
+
+#ifdef RTE_EXEC_ENV_WINDOWS
+#include "test.h"
+
+static int
+test_power_pmd_mgmt(void)
+{
+	printf("PMD power management not supported on Windows, skipping test\n");
+	return TEST_SKIPPED;
+}
+
+#else
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_eth_ring.h>
+#include <rte_ethdev.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_power_pmd_mgmt.h>
+#include <rte_ring.h>
+#include <rte_thread.h>
+
+#include "test.h"
+
+#define RING_SIZE 256
+#define BURST_SIZE 32
+#define NB_MBUF 512
+#define EMPTYPOLL_MAX 16
+#define LATENCY_SLO_US 100
+/* Time between two packets of the sparse traffic, above the latency target */
+#define SPARSE_GAP_US 2000
+#define NB_SPARSE_PKTS 8
+#define POLL_TIMEOUT_S 1
+#define TELEMETRY_BUF_SIZE 4096
+
+static struct rte_ring *rx_ring;
+static struct rte_mempool *mp;
+static uint16_t port_id;
+static int sock = -1;
+static struct rte_mbuf *rx_pkts[BURST_SIZE];
+
+/*
+ * Poll the Rx queue until some packets are received, the empty polls let
+ * the lcore go to sleep, with monitoring or pausing.
+ */
+static int
+poll_until_rx(struct rte_mbuf **pkts)
+{
+	const uint64_t timeout = rte_get_timer_cycles() +
+			POLL_TIMEOUT_S * rte_get_timer_hz();
+	uint16_t nb_rx;
+
+	do {
+		nb_rx = rte_eth_rx_burst(port_id, 0, pkts, BURST_SIZE);
+		if (nb_rx != 0)
+			return nb_rx;
+	} while (rte_get_timer_cycles() < timeout);
+
+	return -1;
+}
+
+/*
+ * Enqueue packets in the Rx ring after a delay, from a control thread, so
+ * that the lcore can be woken up from monitoring as well as from pausing.
+ */
+static uint32_t
+delayed_rx(void *arg)
+{
+	unsigned int nb_pkts = (uintptr_t)arg;
+
+	rte_delay_us_sleep(SPARSE_GAP_US);
+	rte_ring_enqueue_bulk(rx_ring, (void **)rx_pkts, nb_pkts, NULL);
+
+	return 0;
+}
+
+static int
+delayed_poll(struct rte_mbuf **pkts, unsigned int nb_pkts)
+{
+	rte_thread_t thread;
+	int nb_rx;
+
+	if (rte_pktmbuf_alloc_bulk(mp, rx_pkts, nb_pkts) != 0)
+		return -1;
+	if (rte_thread_create_control(&thread, "dpdk-test-rx", delayed_rx,
+			(void *)(uintptr_t)nb_pkts) != 0) {
+		rte_pktmbuf_free_bulk(rx_pkts, nb_pkts);
+		return -1;
+	}
+	nb_rx = poll_until_rx(pkts);
+	rte_thread_join(thread, NULL);
+	if (nb_rx > 0)
+		rte_pktmbuf_free_bulk(pkts, nb_rx);
+
+	return nb_rx;
+}
+
+static int
+connect_to_telemetry(void)
+{
+	struct sockaddr_un addr;
+	char buf[TELEMETRY_BUF_SIZE];
+	int s;
+
+	s = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (s < 0)
+		return -1;
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s/dpdk_telemetry.v2",
+			rte_eal_get_runtime_dir());
+	if (connect(s, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+			read(s, buf, sizeof(buf)) < 0) {
+		close(s);
+		return -1;
+	}
+
+	return s;
+}
+
+/* Send a telemetry command and return its reply in buf */
+static int
+telemetry_request(const char *request, char *buf, size_t len)
+{
+	ssize_t bytes;
+
+	if (write(sock, request, strlen(request)) < 0)
+		return -1;
+	bytes = read(sock, buf, len - 1);
+	if (bytes < 0)
+		return -1;
+	buf[bytes] = '\0';
+	printf("%s: %s\n", request, buf);
+
+	return 0;
+}
+
+/* Get an unsigned value of the reply, -1 if not found */
+static long
+telemetry_value(const char *buf, const char *name)
+{
+	char key[64];
+	const char *p;
+
+	snprintf(key, sizeof(key), "\"%s\":", name);
+	p = strstr(buf, key);
+	if (p == NULL)
+		return -1;
+
+	return strtol(p + strlen(key), NULL, 10);
+}
+
+static int
+test_adaptive_transitions(void)
+{
+	struct rte_mbuf *pkts[BURST_SIZE];
+	char request[64], buf[TELEMETRY_BUF_SIZE];
+	unsigned int lcore_id = rte_lcore_id();
+	long sleep_decisions, poll_decisions;
+	int i;
+
+	TEST_ASSERT_SUCCESS(rte_power_ethdev_pmgmt_queue_enable(lcore_id,
+			port_id, 0, RTE_POWER_MGMT_TYPE_ADAPTIVE),
+			"Failed to enable adaptive mode");
+	TEST_ASSERT_SUCCESS(rte_eth_dev_start(port_id),
+			"Failed to start port");
+
+	/* sparse traffic: the lcore sleeps between the packets */
+	for (i = 0; i < NB_SPARSE_PKTS; i++)
+		TEST_ASSERT(delayed_poll(pkts, 1) == 1,
+				"Sparse packet not received");
+
+	snprintf(request, sizeof(request), "/power/pmd_mgmt/stats,%u",
+			lcore_id);
+	TEST_ASSERT_SUCCESS(telemetry_request(request, buf, sizeof(buf)),
+			"Telemetry request failed");
+	TEST_ASSERT(strstr(buf, "\"mode\":\"adaptive\"") != NULL,
+			"Wrong mode reported");
+	sleep_decisions = telemetry_value(buf, "sleep_decisions");
+	TEST_ASSERT(sleep_decisions >= NB_SPARSE_PKTS,
+			"Lcore did not sleep between sparse packets");
+	TEST_ASSERT(telemetry_value(buf, "avg_gap_us") >= LATENCY_SLO_US,
+			"Sparse traffic not learnt");
+	poll_decisions = telemetry_value(buf, "poll_decisions");
+
+	/* a full burst after sleeping goes back to busy polling */
+	TEST_ASSERT(delayed_poll(pkts, BURST_SIZE) == BURST_SIZE,
+			"Burst not received");
+
+	TEST_ASSERT_SUCCESS(telemetry_request(request, buf, sizeof(buf)),
+			"Telemetry request failed");
+	TEST_ASSERT(strstr(buf, "\"state\":\"poll\"") != NULL,
+			"Full burst did not go back to polling");
+	TEST_ASSERT(telemetry_value(buf, "poll_decisions") == poll_decisions + 1,
+			"Poll decision not counted");
+	TEST_ASSERT(telemetry_value(buf, "sleep_decisions") ==
+			sleep_decisions + 1,
+			"Sleep decision not counted");
+
+	TEST_ASSERT_SUCCESS(rte_eth_dev_stop(port_id), "Failed to stop port");
+	TEST_ASSERT_SUCCESS(rte_power_ethdev_pmgmt_queue_disable(lcore_id,
+			port_id, 0), "Failed to disable adaptive mode");
+
+	/* the queues of a disabled lcore are not reported */
+	TEST_ASSERT_SUCCESS(telemetry_request(request, buf, sizeof(buf)),
+			"Telemetry request failed");
+	TEST_ASSERT(strstr(buf, "port0_queue0") == NULL &&
+			telemetry_value(buf, "empty_polls") < 0,
+			"Disabled queue still reported");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_power_pmd_mgmt(void)
+{
+	struct rte_eth_conf null_conf;
+	struct rte_ring *tx_ring;
+	unsigned int emptypoll_max, latency_slo;
+	int ret, port;
+
+	sock = connect_to_telemetry();
+	if (sock < 0) {
+		printf("Telemetry not available, skipping test\n");
+		return TEST_SKIPPED;
+	}
+
+	mp = rte_pktmbuf_pool_create("pmd_mgmt_pool", NB_MBUF, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	rx_ring = rte_ring_create("pmd_mgmt_rx", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	tx_ring = rte_ring_create("pmd_mgmt_tx", RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	ret = -1;
+	if (mp == NULL || rx_ring == NULL || tx_ring == NULL)
+		goto out;
+
+	port = rte_eth_from_rings("net_ring_pmd_mgmt", &rx_ring, 1,
+			&tx_ring, 1, SOCKET_ID_ANY);
+	if (port < 0)
+		goto out;
+	port_id = port;
+
+	memset(&null_conf, 0, sizeof(null_conf));
+	if (rte_eth_dev_configure(port_id, 1, 1, &null_conf) < 0 ||
+			rte_eth_rx_queue_setup(port_id, 0, RING_SIZE,
+				SOCKET_ID_ANY, NULL, mp) < 0 ||
+			rte_eth_tx_queue_setup(port_id, 0, RING_SIZE,
+				SOCKET_ID_ANY, NULL) < 0)
+		goto close;
+
+	emptypoll_max = rte_power_pmd_mgmt_get_emptypoll_max();
+	latency_slo = rte_power_pmd_mgmt_get_latency_slo();
+	rte_power_pmd_mgmt_set_emptypoll_max(EMPTYPOLL_MAX);
+	rte_power_pmd_mgmt_set_latency_slo(LATENCY_SLO_US);
+
+	ret = test_adaptive_transitions();
+
+	rte_power_pmd_mgmt_set_emptypoll_max(emptypoll_max);
+	rte_power_pmd_mgmt_set_latency_slo(latency_slo);
+close:
+	rte_eth_dev_stop(port_id);
+	rte_eth_dev_close(port_id);
+out:
+	rte_ring_free(rx_ring);
+	rte_ring_free(tx_ring);
+	rte_mempool_free(mp);
+	close(sock);
+	return ret;
+}
+
+#endif /* !RTE_EXEC_ENV_WINDOWS */
+
+REGISTER_FAST_TEST(power_pmd_mgmt_autotest, true, true, test_power_pmd_mgmt);
@@ -104,14 +104,14 @@ test_rcu_qsbr_get_memsize(void)
 
 	sz = rte_rcu_qsbr_get_memsize(128);
 	/* For 128 threads,
-	 * for machines with cache line size of 64B - 8384
-	 * for machines with cache line size of 128 - 16768
+	 * for machines with cache line size of 64B - 8448
+	 * for machines with cache line size of 128 - 16896
 	 */
 	if (RTE_CACHE_LINE_SIZE == 64)
-		TEST_RCU_QSBR_RETURN_IF_ERROR((sz != 8384),
+		TEST_RCU_QSBR_RETURN_IF_ERROR((sz != 8448),
 			"Get Memsize for 128 threads");
 	else if (RTE_CACHE_LINE_SIZE == 128)
-		TEST_RCU_QSBR_RETURN_IF_ERROR((sz != 16768),
+		TEST_RCU_QSBR_RETURN_IF_ERROR((sz != 16896),
 			"Get Memsize for 128 threads");
 
 	return 0;
@@ -603,6 +603,69 @@ test_rcu_qsbr_thread_offline(void)
 	return 0;
 }
 
+/*
+ * Interleave a reader thread coming online with the writer polling for a
+ * grace period: the reader loads a token before the writer starts the grace
+ * period, but stores it after a first poll. That poll fails on another group,
+ * so the next one must not take the group of the reader as acknowledged.
+ */
+static int
+test_rcu_qsbr_online_check_interleave(unsigned int skip_register)
+{
+	unsigned int i, n = 2 * 16, late = 3, lagging = 16;
+	uint64_t token, t_old;
+	int ret;
+
+	rte_rcu_qsbr_init(t[0], n);
+	for (i = 0; i < n; i++) {
+		if (i == late && skip_register)
+			continue;
+		rte_rcu_qsbr_thread_register(t[0], i);
+		if (i != late)
+			rte_rcu_qsbr_thread_online(t[0], i);
+	}
+
+	/* First half of rte_rcu_qsbr_thread_online() for the late reader */
+	t_old = rte_atomic_load_explicit(&t[0]->token, rte_memory_order_relaxed);
+
+	token = rte_rcu_qsbr_start(t[0]);
+	for (i = 0; i < n; i++)
+		if (i != late && i != lagging)
+			rte_rcu_qsbr_quiescent(t[0], i);
+
+	ret = rte_rcu_qsbr_check(t[0], token, false);
+	TEST_RCU_QSBR_RETURN_IF_ERROR((ret != 0), "lagging reader not waited upon");
+
+	/* Second half of rte_rcu_qsbr_thread_online() for the late reader */
+	if (skip_register)
+		rte_rcu_qsbr_thread_register(t[0], late);
+	rte_atomic_store_explicit(&t[0]->qsbr_cnt[late].cnt, t_old,
+		rte_memory_order_relaxed);
+
+	rte_rcu_qsbr_quiescent(t[0], lagging);
+	ret = rte_rcu_qsbr_check(t[0], token, false);
+	TEST_RCU_QSBR_RETURN_IF_ERROR((ret != 0), "late online reader not waited upon");
+
+	rte_rcu_qsbr_quiescent(t[0], late);
+	ret = rte_rcu_qsbr_check(t[0], token, false);
+	TEST_RCU_QSBR_RETURN_IF_ERROR((ret == 0), "all readers reported QS");
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr_online_check(void)
+{
+	printf("\nTest rte_rcu_qsbr_thread_online() and rte_rcu_qsbr_check() interleaving\n");
+
+	/* Late reader registered but offline during the first poll */
+	if (test_rcu_qsbr_online_check_interleave(0) < 0)
+		return -1;
+
+	/* Late reader not registered yet during the first poll */
+	return test_rcu_qsbr_online_check_interleave(1);
+}
+
 static void
 test_rcu_qsbr_free_resource1(void *p, void *e, unsigned int n)
 {
@@ -1375,6 +1438,9 @@ test_rcu_qsbr_main(void)
 	if (test_rcu_qsbr_thread_offline() < 0)
 		goto test_fail;
 
+	if (test_rcu_qsbr_online_check() < 0)
+		goto test_fail;
+
 	if (test_rcu_qsbr_dq_create() < 0)
 		goto test_fail;
 
@@ -280,6 +280,80 @@ test_rcu_qsbr_wperf(void)
 	return 0;
 }
 
+/*
+ * Perf test: Writer latency
+ * Single writer, Single QS variable, Non-blocking rcu_qsbr_check, with
+ * an increasing number of readers. The readers are simulated on the
+ * writer lcore so that the number of threads is not limited by the
+ * number of cores provided. The reader with the highest thread ID
+ * reports its quiescent state after the writer polled a few times.
+ */
+#define WLATENCY_MAX_THREADS 1024
+#define WLATENCY_GRACE_PERIODS 10000
+#define WLATENCY_POLLS 8
+
+static int
+test_rcu_qsbr_wlatency(void)
+{
+	struct rte_rcu_qsbr *v;
+	uint64_t token, begin, cycles;
+	unsigned int i, j, k, n;
+	size_t sz;
+
+	printf("\nPerf test: 1 writer, simulated readers, 1 lagging reader, %d polls per grace period\n",
+		WLATENCY_POLLS);
+
+	for (n = 16; n <= WLATENCY_MAX_THREADS; n <<= 1) {
+		sz = rte_rcu_qsbr_get_memsize(n);
+		v = (struct rte_rcu_qsbr *)rte_zmalloc("rcu0", sz,
+						RTE_CACHE_LINE_SIZE);
+		if (v == NULL) {
+			printf("QS variable allocation failed\n");
+			return -1;
+		}
+		rte_rcu_qsbr_init(v, n);
+
+		for (i = 0; i < n; i++) {
+			rte_rcu_qsbr_thread_register(v, i);
+			rte_rcu_qsbr_thread_online(v, i);
+		}
+
+		cycles = 0;
+		for (j = 0; j < WLATENCY_GRACE_PERIODS; j++) {
+			token = rte_rcu_qsbr_start(v);
+			for (i = 0; i < n - 1; i++)
+				rte_rcu_qsbr_quiescent(v, i);
+
+			begin = rte_rdtsc_precise();
+			for (k = 0; k < WLATENCY_POLLS; k++) {
+				if (rte_rcu_qsbr_check(v, token, false) != 0) {
+					printf("Grace period over with a reader lagging\n");
+					rte_free(v);
+					return -1;
+				}
+			}
+			cycles += rte_rdtsc_precise() - begin;
+
+			rte_rcu_qsbr_quiescent(v, n - 1);
+
+			begin = rte_rdtsc_precise();
+			if (rte_rcu_qsbr_check(v, token, false) != 1) {
+				printf("Grace period not over\n");
+				rte_free(v);
+				return -1;
+			}
+			cycles += rte_rdtsc_precise() - begin;
+		}
+
+		printf("Readers = %4u, cycles per grace period: %"PRIu64"\n",
+			n, cycles / WLATENCY_GRACE_PERIODS);
+
+		rte_free(v);
+	}
+
+	return 0;
+}
+
 /*
  * RCU test cases using rte_hash data structure.
  */
@@ -651,6 +725,9 @@ test_rcu_qsbr_main(void)
 	if (test_rcu_qsbr_wperf() < 0)
 		goto test_fail;
 
+	if (test_rcu_qsbr_wlatency() < 0)
+		goto test_fail;
+
 	if (test_rcu_qsbr_sw_sv_1qs() < 0)
 		goto test_fail;
 
@@ -1055,6 +1055,257 @@ service_active_two_cores(void)
 	return unregister_all();
 }
 
+/* calls per lcore of the counting service */
+static RTE_ATOMIC(uint64_t) lcore_calls[RTE_MAX_LCORE];
+
+static int32_t
+count_cb(void *args)
+{
+	RTE_SET_USED(args);
+
+	rte_atomic_fetch_add_explicit(&lcore_calls[rte_lcore_id()], 1,
+			rte_memory_order_relaxed);
+	rte_delay_us(10);
+
+	return 0;
+}
+
+static int
+count_register(const char *name, uint32_t *id)
+{
+	struct rte_service_spec service;
+
+	memset(&service, 0, sizeof(struct rte_service_spec));
+	service.callback = count_cb;
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	snprintf(service.name, sizeof(service.name), "%s", name);
+
+	TEST_ASSERT_EQUAL(0, rte_service_component_register(&service, id),
+			"Failed to register counting service");
+	rte_service_component_runstate_set(*id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_runstate_set(*id, 1),
+			"Starting counting service failed");
+
+	return TEST_SUCCESS;
+}
+
+/* check the scheduling parameters are validated */
+static int
+service_sched_params(void)
+{
+	const uint32_t sid = 0;
+
+	TEST_ASSERT_EQUAL(RTE_SERVICE_SCHED_MAPPED, rte_service_sched_mode_get(),
+			"Default scheduling mode is not mapped");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_sched_mode_set(
+			(enum rte_service_sched_mode)100),
+			"Invalid scheduling mode accepted");
+
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_set_priority(sid, 0),
+			"Zero priority accepted");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_set_priority(sid,
+			RTE_SERVICE_PRIORITY_MAX + 1),
+			"Too large priority accepted");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_set_priority(10000, 1),
+			"Priority of invalid service set");
+	TEST_ASSERT_EQUAL(0, rte_service_set_priority(sid,
+			RTE_SERVICE_PRIORITY_MAX),
+			"Valid priority not accepted");
+
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_set_cycle_budget(10000, 1),
+			"Cycle budget of invalid service set");
+	TEST_ASSERT_EQUAL(0, rte_service_set_cycle_budget(sid, 0),
+			"Removing the cycle budget failed");
+
+	TEST_ASSERT_EQUAL(-ENOTSUP, rte_service_lcore_rebalance(),
+			"Rebalance without service cores did not fail");
+
+	return unregister_all();
+}
+
+/* in shared mode, a service mapped to one core runs on all service cores */
+static int
+service_shared_mode(void)
+{
+	uint32_t lcore1, lcore2, sid;
+	int ret;
+
+	lcore1 = rte_get_next_lcore(-1, 1, 0);
+	lcore2 = rte_get_next_lcore(lcore1, 1, 0);
+	if (lcore1 >= RTE_MAX_LCORE || lcore2 >= RTE_MAX_LCORE)
+		return TEST_SKIPPED;
+
+	unregister_all();
+	memset(lcore_calls, 0, sizeof(lcore_calls));
+	ret = count_register("count_service", &sid);
+	if (ret != TEST_SUCCESS)
+		return ret;
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(lcore1),
+			"Add service core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(lcore2),
+			"Add service core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(sid, lcore1, 1),
+			"Mapping the service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_sched_mode_set(RTE_SERVICE_SCHED_SHARED),
+			"Setting shared mode failed");
+	TEST_ASSERT_EQUAL(RTE_SERVICE_SCHED_SHARED, rte_service_sched_mode_get(),
+			"Shared mode not reported");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(lcore1),
+			"Service core start failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(lcore2),
+			"Service core start failed");
+
+	rte_delay_ms(100);
+
+	/* no core runs the service once it is unmapped */
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(sid, lcore1, 0),
+			"Unmapping the service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_may_be_active(sid),
+			"Unmapped service still active in shared mode");
+
+	TEST_ASSERT_EQUAL(0, rte_service_runstate_set(sid, 0),
+			"Stopping counting service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(lcore1),
+			"Service core stop failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(lcore2),
+			"Service core stop failed");
+	TEST_ASSERT_EQUAL(0, rte_service_sched_mode_set(RTE_SERVICE_SCHED_MAPPED),
+			"Setting mapped mode failed");
+	wait_slcore_inactive(lcore1);
+	wait_slcore_inactive(lcore2);
+
+	TEST_ASSERT_NOT_EQUAL(0, lcore_calls[lcore1],
+			"Service did not run on its mapped core");
+	TEST_ASSERT_NOT_EQUAL(0, lcore_calls[lcore2],
+			"Service did not run on the unmapped core in shared mode");
+
+	return unregister_all();
+}
+
+/* check a service does not use much more than its cycle budget */
+static int
+service_cycle_budget(void)
+{
+	const uint64_t hz = rte_get_tsc_hz();
+	uint64_t start, elapsed, cycles;
+	uint32_t sid;
+	int ret;
+
+	if (slcore_id >= RTE_MAX_LCORE)
+		return TEST_SKIPPED;
+
+	unregister_all();
+	ret = count_register("count_service", &sid);
+	if (ret != TEST_SUCCESS)
+		return ret;
+
+	/* a tenth of a core */
+	TEST_ASSERT_EQUAL(0, rte_service_set_cycle_budget(sid, hz / 10),
+			"Setting the cycle budget failed");
+	TEST_ASSERT_EQUAL(0, rte_service_set_stats_enable(sid, 1),
+			"Enabling stats failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(slcore_id),
+			"Add service core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(sid, slcore_id, 1),
+			"Mapping the service failed");
+
+	start = rte_rdtsc();
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(slcore_id),
+			"Service core start failed");
+	rte_delay_us_sleep(200 * 1000);
+	TEST_ASSERT_EQUAL(0, rte_service_runstate_set(sid, 0),
+			"Stopping counting service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(slcore_id),
+			"Service core stop failed");
+	wait_slcore_inactive(slcore_id);
+	elapsed = rte_rdtsc() - start;
+
+	TEST_ASSERT_EQUAL(0, rte_service_attr_get(sid, RTE_SERVICE_ATTR_CYCLES,
+			&cycles), "Getting service cycles failed");
+	TEST_ASSERT_NOT_EQUAL(0, cycles, "Service did not run");
+	/* allow one call over the budget in each period */
+	TEST_ASSERT(cycles < elapsed / 4,
+			"Service used %"PRIu64" of %"PRIu64" cycles, over its budget",
+			cycles, elapsed);
+
+	return unregister_all();
+}
+
+/* move services away from an overloaded service core */
+static int
+service_rebalance(void)
+{
+	uint32_t lcore1, lcore2, sid1, sid2;
+	int ret, map1;
+
+	lcore1 = rte_get_next_lcore(-1, 1, 0);
+	lcore2 = rte_get_next_lcore(lcore1, 1, 0);
+	if (lcore1 >= RTE_MAX_LCORE || lcore2 >= RTE_MAX_LCORE)
+		return TEST_SKIPPED;
+
+	unregister_all();
+	ret = count_register("count_service_1", &sid1);
+	if (ret != TEST_SUCCESS)
+		return ret;
+	ret = count_register("count_service_2", &sid2);
+	if (ret != TEST_SUCCESS)
+		return ret;
+	rte_service_set_stats_enable(sid1, 1);
+	rte_service_set_stats_enable(sid2, 1);
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(lcore1),
+			"Add service core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(lcore2),
+			"Add service core failed");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(sid1, lcore1, 1),
+			"Mapping the service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(sid2, lcore1, 1),
+			"Mapping the service failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(lcore1),
+			"Service core start failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(lcore2),
+			"Service core start failed");
+
+	rte_delay_ms(50);
+
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_rebalance(),
+			"Rebalance did not move one service");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_count_services(lcore1),
+			"Overloaded core still runs both services");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_count_services(lcore2),
+			"Idle core did not get a service");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(sid1, lcore1) +
+			rte_service_map_lcore_get(sid1, lcore2),
+			"Service mapped to several cores after rebalance");
+	map1 = rte_service_map_lcore_get(sid1, lcore1);
+
+	/* balanced services stay where they are */
+	rte_delay_ms(50);
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_rebalance(),
+			"Rebalance moved a service between balanced cores");
+	TEST_ASSERT_EQUAL(map1, rte_service_map_lcore_get(sid1, lcore1),
+			"Service mapping changed by rebalance");
+	TEST_ASSERT_EQUAL(1 - map1, rte_service_map_lcore_get(sid2, lcore1),
+			"Service mapping changed by rebalance");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_count_services(lcore1),
+			"Service mapping changed by rebalance");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_count_services(lcore2),
+			"Service mapping changed by rebalance");
+
+	rte_service_runstate_set(sid1, 0);
+	rte_service_runstate_set(sid2, 0);
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(lcore1),
+			"Service core stop failed");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(lcore2),
+			"Service core stop failed");
+	wait_slcore_inactive(lcore1);
+	wait_slcore_inactive(lcore2);
+
+	return unregister_all();
+}
+
 static struct unit_test_suite service_tests  = {
 	.suite_name = "service core test suite",
 	.setup = testsuite_setup,
@@ -1072,6 +1323,10 @@ static struct unit_test_suite service_tests  = {
 		TEST_CASE_ST(dummy_register, NULL, service_mt_safe_poll),
 		TEST_CASE_ST(dummy_register, NULL, service_may_be_active),
 		TEST_CASE_ST(dummy_register, NULL, service_active_two_cores),
+		TEST_CASE_ST(dummy_register, NULL, service_sched_params),
+		TEST_CASE_ST(NULL, NULL, service_shared_mode),
+		TEST_CASE_ST(NULL, NULL, service_cycle_budget),
+		TEST_CASE_ST(NULL, NULL, service_rebalance),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
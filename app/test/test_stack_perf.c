@@ -16,6 +16,8 @@
 #define STACK_NAME "STACK_PERF"
 #define MAX_BURST 32
 #define STACK_SIZE (RTE_MAX_LCORE * MAX_BURST)
+/* Largest lcore count of the scaling runs, before the all lcores run */
+#define MAX_SCALING_LCORES 128
 
 /*
  * Push/pop bulk sizes, marked volatile so they aren't treated as compile-time
@@ -241,6 +243,8 @@ run_on_n_cores(struct rte_stack *s, lcore_function_t fn, int n)
 
 		printf("Average cycles per object push/pop (bulk size: %u): %.2F\n",
 		       bulk_sizes[i], avg / n);
+		printf("Throughput (bulk size: %u): %.2F Mobjs/s\n",
+		       bulk_sizes[i], n * n * rte_get_tsc_hz() / avg / 1E6);
 	}
 }
 
@@ -299,6 +303,7 @@ __test_stack_perf(uint32_t flags)
 {
 	struct lcore_pair cores;
 	struct rte_stack *s;
+	unsigned int n;
 
 	rte_atomic_store_explicit(&lcore_barrier, 0, rte_memory_order_relaxed);
 
@@ -331,6 +336,11 @@ __test_stack_perf(uint32_t flags)
 		run_on_core_pair(&cores, s, bulk_push_pop);
 	}
 
+	for (n = 2; n < rte_lcore_count() && n <= MAX_SCALING_LCORES; n *= 2) {
+		printf("\n### Testing on %u lcores ###\n", n);
+		run_on_n_cores(s, bulk_push_pop, n);
+	}
+
 	printf("\n### Testing on all %u lcores ###\n", rte_lcore_count());
 	run_on_n_cores(s, bulk_push_pop, rte_lcore_count());
 
@@ -354,5 +364,16 @@ test_lf_stack_perf(void)
 #endif
 }
 
+static int
+test_elim_stack_perf(void)
+{
+#if defined(RTE_STACK_LF_SUPPORTED)
+	return __test_stack_perf(RTE_STACK_F_ELIM);
+#else
+	return TEST_SKIPPED;
+#endif
+}
+
 REGISTER_PERF_TEST(stack_perf_autotest, test_stack_perf);
 REGISTER_PERF_TEST(stack_lf_perf_autotest, test_lf_stack_perf);
+REGISTER_PERF_TEST(stack_elim_perf_autotest, test_elim_stack_perf);
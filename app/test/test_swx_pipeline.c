@@ -0,0 +1,453 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+
+#include "test.h"
+
+#ifdef RTE_EXEC_ENV_WINDOWS
+static int
+test_swx_pipeline(void)
+{
+	printf("SWX pipeline not supported on Windows, skipping test\n");
+	return TEST_SKIPPED;
+}
+#else
+
+#include <rte_swx_pipeline.h>
+#include <rte_swx_ctl.h>
+#include <rte_swx_port_ring.h>
+
+/* The parent pipeline and one worker, each with its own input and output ring. */
+#define SWX_TEST_INSTANCES	2
+#define SWX_TEST_COMMITS	64
+#define SWX_TEST_RING_SIZE	64
+#define SWX_TEST_POOL_SIZE	1023
+#define SWX_TEST_WAIT_US	(1000 * 1000)
+
+struct swx_test_hdr {
+	rte_be32_t key;
+	rte_be32_t val;
+};
+
+static struct rte_swx_pipeline *swx_p;
+static struct rte_swx_pipeline *swx_w;
+static struct rte_swx_ctl_pipeline *swx_ctl;
+static struct rte_ring *swx_rx[SWX_TEST_INSTANCES];
+static struct rte_ring *swx_tx[SWX_TEST_INSTANCES];
+static struct rte_mempool *swx_pool;
+static RTE_ATOMIC(uint32_t) swx_stop;
+
+static int
+swx_test_instance_ports(struct rte_swx_pipeline *p, uint32_t id)
+{
+	char name[RTE_RING_NAMESIZE];
+	struct rte_swx_port_ring_reader_params rp = {
+		.name = name,
+		.burst_size = 1,
+	};
+	struct rte_swx_port_ring_writer_params wp = {
+		.name = name,
+		.burst_size = 1,
+	};
+	int status;
+
+	snprintf(name, sizeof(name), "swx_test_rx%u", id);
+	swx_rx[id] = rte_ring_create(name, SWX_TEST_RING_SIZE, SOCKET_ID_ANY,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (swx_rx[id] == NULL)
+		return -ENOMEM;
+
+	status = rte_swx_pipeline_port_in_config(p, 0, "ring", &rp);
+	if (status)
+		return status;
+
+	snprintf(name, sizeof(name), "swx_test_tx%u", id);
+	swx_tx[id] = rte_ring_create(name, SWX_TEST_RING_SIZE, SOCKET_ID_ANY,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (swx_tx[id] == NULL)
+		return -ENOMEM;
+
+	return rte_swx_pipeline_port_out_config(p, 0, "ring", &wp);
+}
+
+/*
+ * The packet header value is set by the default action of the table,
+ * which is changed by each commit.
+ */
+static int
+swx_test_pipeline_build(void)
+{
+	struct rte_swx_field_params hdr_fields[] = {
+		{ .name = "key", .n_bits = 32 },
+		{ .name = "val", .n_bits = 32 },
+	};
+	struct rte_swx_field_params meta_fields[] = {
+		{ .name = "port", .n_bits = 32 },
+	};
+	struct rte_swx_field_params args_fields[] = {
+		{ .name = "val", .n_bits = 32 },
+	};
+	const char *action_instr[] = {
+		"mov h.tag.val t.val",
+		"return",
+	};
+	const char *action_names[] = { "set_val" };
+	struct rte_swx_pipeline_table_params table_params = {
+		.action_names = action_names,
+		.n_actions = 1,
+		.default_action_name = "set_val",
+		.default_action_args = "val 0",
+	};
+	const char *instr[] = {
+		"rx m.port",
+		"extract h.tag",
+		"table t",
+		"emit h.tag",
+		"tx m.port",
+	};
+	int status;
+
+	status = rte_swx_pipeline_config(&swx_p, "swx_test", SOCKET_ID_ANY);
+	if (status)
+		return status;
+
+	status = swx_test_instance_ports(swx_p, 0);
+	status = status ? status :
+		rte_swx_pipeline_struct_type_register(swx_p, "tag_h", hdr_fields,
+			RTE_DIM(hdr_fields), 0);
+	status = status ? status :
+		rte_swx_pipeline_struct_type_register(swx_p, "meta_t", meta_fields,
+			RTE_DIM(meta_fields), 0);
+	status = status ? status :
+		rte_swx_pipeline_struct_type_register(swx_p, "set_val_args_t",
+			args_fields, RTE_DIM(args_fields), 0);
+	status = status ? status :
+		rte_swx_pipeline_packet_header_register(swx_p, "tag", "tag_h");
+	status = status ? status :
+		rte_swx_pipeline_packet_metadata_register(swx_p, "meta_t");
+	status = status ? status :
+		rte_swx_pipeline_action_config(swx_p, "set_val", "set_val_args_t",
+			action_instr, RTE_DIM(action_instr));
+	status = status ? status :
+		rte_swx_pipeline_table_config(swx_p, "t", &table_params, NULL, NULL, 0);
+	status = status ? status :
+		rte_swx_pipeline_instructions_config(swx_p, instr, RTE_DIM(instr));
+	status = status ? status : rte_swx_pipeline_build(swx_p);
+	if (status)
+		return status;
+
+	status = rte_swx_pipeline_worker_create(&swx_w, swx_p);
+	status = status ? status : swx_test_instance_ports(swx_w, 1);
+	status = status ? status : rte_swx_pipeline_build(swx_w);
+	if (status)
+		return status;
+
+	swx_ctl = rte_swx_ctl_pipeline_create(swx_p);
+	if (swx_ctl == NULL)
+		return -ENOMEM;
+
+	swx_pool = rte_pktmbuf_pool_create("swx_test_pool", SWX_TEST_POOL_SIZE, 0, 0,
+		RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (swx_pool == NULL)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void
+swx_test_pipeline_free(void)
+{
+	uint32_t i;
+
+	rte_swx_ctl_pipeline_free(swx_ctl);
+	swx_ctl = NULL;
+
+	/* The worker is freed with its parent. */
+	rte_swx_pipeline_free(swx_p);
+	swx_p = NULL;
+	swx_w = NULL;
+
+	for (i = 0; i < SWX_TEST_INSTANCES; i++) {
+		rte_ring_free(swx_rx[i]);
+		rte_ring_free(swx_tx[i]);
+		swx_rx[i] = NULL;
+		swx_tx[i] = NULL;
+	}
+
+	rte_mempool_free(swx_pool);
+	swx_pool = NULL;
+}
+
+static int
+swx_test_run(void *arg)
+{
+	struct rte_swx_pipeline *p = arg;
+
+	while (!rte_atomic_load_explicit(&swx_stop, rte_memory_order_relaxed))
+		rte_swx_pipeline_run(p, 16);
+
+	return 0;
+}
+
+static int
+swx_test_default_set(uint32_t val)
+{
+	struct rte_swx_table_entry *entry;
+	char line[64];
+	int status;
+
+	snprintf(line, sizeof(line), "action set_val val 0x%x", val);
+	entry = rte_swx_ctl_pipeline_table_entry_read(swx_ctl, "t", line, NULL);
+	if (entry == NULL)
+		return -EINVAL;
+
+	status = rte_swx_ctl_pipeline_table_default_entry_add(swx_ctl, "t", entry);
+
+	free(entry->key);
+	free(entry->key_mask);
+	free(entry->action_data);
+	free(entry);
+
+	return status ? status : rte_swx_ctl_pipeline_commit(swx_ctl, 1);
+}
+
+/* Send one packet through the given pipeline instance and return the value it got. */
+static int
+swx_test_packet(uint32_t id, uint32_t *val)
+{
+	struct swx_test_hdr *h;
+	struct rte_mbuf *m;
+	uint64_t deadline;
+	void *obj;
+
+	m = rte_pktmbuf_alloc(swx_pool);
+	if (m == NULL)
+		return -ENOMEM;
+
+	h = (struct swx_test_hdr *)rte_pktmbuf_append(m, sizeof(*h));
+	h->key = 0;
+	h->val = RTE_BE32(UINT32_MAX);
+
+	if (rte_ring_enqueue(swx_rx[id], m) != 0) {
+		rte_pktmbuf_free(m);
+		return -ENOSPC;
+	}
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz() * SWX_TEST_WAIT_US / 1000000;
+	while (rte_ring_dequeue(swx_tx[id], &obj) != 0) {
+		if (rte_get_timer_cycles() > deadline)
+			return -ETIMEDOUT;
+		rte_pause();
+	}
+
+	m = obj;
+	h = rte_pktmbuf_mtod(m, struct swx_test_hdr *);
+	*val = rte_be_to_cpu_32(h->val);
+	rte_pktmbuf_free(m);
+
+	return 0;
+}
+
+static int
+swx_test_check(const char *func, uint32_t v)
+{
+	uint32_t i, val = 0;
+	int status;
+
+	for (i = 0; i < SWX_TEST_INSTANCES; i++) {
+		status = swx_test_packet(i, &val);
+		if (status || val != v) {
+			printf("%s: instance %u got value %u instead of %u (%d)\n",
+			       func, i, val, v, status);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static void
+swx_test_launch(uint32_t lcore_p, uint32_t lcore_w)
+{
+	rte_atomic_store_explicit(&swx_stop, 0, rte_memory_order_relaxed);
+	rte_eal_remote_launch(swx_test_run, swx_p, lcore_p);
+	rte_eal_remote_launch(swx_test_run, swx_w, lcore_w);
+}
+
+static void
+swx_test_stop(uint32_t lcore_p, uint32_t lcore_w)
+{
+	rte_atomic_store_explicit(&swx_stop, 1, rte_memory_order_relaxed);
+	rte_eal_wait_lcore(lcore_p);
+	rte_eal_wait_lcore(lcore_w);
+}
+
+/*
+ * Commit while the parent pipeline and its worker are running: once the commit returned, both
+ * of them must use the new table state.
+ */
+static int
+test_swx_pipeline_commit(void)
+{
+	uint32_t v;
+	int status;
+
+	for (v = 1; v <= SWX_TEST_COMMITS; v++) {
+		status = swx_test_default_set(v);
+		if (status) {
+			printf("%s: commit %u failed (%d)\n", __func__, v, status);
+			return -1;
+		}
+
+		if (swx_test_check(__func__, v))
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * With the pipeline instances stopped after having used the current table state, a new table
+ * state can't get in sync and the wait has to give up after the timeout.
+ */
+static int
+test_swx_pipeline_sync_timeout(void)
+{
+	struct rte_swx_ctl_pipeline_info info;
+	struct rte_swx_table_state *ts, *ts_copy;
+	uint64_t start, elapsed_us;
+	uint32_t n;
+	int status, ret = 0;
+
+	if (rte_swx_ctl_pipeline_info_get(swx_p, &info) ||
+	    rte_swx_pipeline_table_state_get(swx_p, &ts))
+		return -1;
+
+	n = info.n_tables + info.n_selectors + info.n_learners;
+	ts_copy = calloc(n, sizeof(*ts_copy));
+	if (ts_copy == NULL)
+		return -1;
+	memcpy(ts_copy, ts, n * sizeof(*ts_copy));
+
+	rte_swx_pipeline_table_state_set(swx_p, ts_copy);
+
+	start = rte_get_tsc_cycles();
+	status = rte_swx_pipeline_table_state_sync(swx_p);
+	elapsed_us = (rte_get_tsc_cycles() - start) * 1000000 / rte_get_tsc_hz();
+
+	/* 10 ms timeout, give some room for the sleep granularity */
+	if (status != -ETIMEDOUT || elapsed_us < 10000 || elapsed_us > 100000) {
+		printf("%s: sync returned %d after %" PRIu64 " us\n",
+		       __func__, status, elapsed_us);
+		ret = -1;
+	}
+
+	/* Back to the state the threads are using. */
+	rte_swx_pipeline_table_state_set(swx_p, ts);
+	if (rte_swx_pipeline_table_state_sync(swx_p) != 0)
+		ret = -1;
+
+	free(ts_copy);
+	return ret;
+}
+
+/*
+ * Commit while the pipeline instances are stopped after having run: the commit can't be completed,
+ * so it stays pending and blocks any further table update until the instances run again.
+ */
+static int
+test_swx_pipeline_commit_stopped(uint32_t lcore_p, uint32_t lcore_w)
+{
+	uint32_t v = SWX_TEST_COMMITS + 1;
+	int status, ret = 0;
+
+	status = swx_test_default_set(v);
+	if (status != -EBUSY) {
+		printf("%s: commit returned %d instead of -EBUSY\n", __func__, status);
+		return -1;
+	}
+
+	status = swx_test_default_set(v + 1);
+	if (status != -EBUSY) {
+		printf("%s: update returned %d instead of -EBUSY\n", __func__, status);
+		return -1;
+	}
+
+	swx_test_launch(lcore_p, lcore_w);
+
+	status = rte_swx_ctl_pipeline_commit(swx_ctl, 1);
+	if (status) {
+		printf("%s: pending commit failed (%d)\n", __func__, status);
+		ret = -1;
+	}
+
+	if (ret == 0)
+		ret = swx_test_check(__func__, v);
+
+	/* Both table states are in sync again, so the next commit has to work as usual. */
+	if (ret == 0 && swx_test_default_set(v + 2))
+		ret = -1;
+
+	if (ret == 0)
+		ret = swx_test_check(__func__, v + 2);
+
+	swx_test_stop(lcore_p, lcore_w);
+	return ret;
+}
+
+static int
+test_swx_pipeline(void)
+{
+	uint32_t lcore_p, lcore_w;
+	int ret;
+
+	lcore_p = rte_get_next_lcore(-1, 1, 0);
+	lcore_w = rte_get_next_lcore(lcore_p, 1, 0);
+	if (lcore_w >= RTE_MAX_LCORE) {
+		printf("At least 3 lcores are needed, skipping test\n");
+		return TEST_SKIPPED;
+	}
+
+	if (swx_test_pipeline_build() != 0) {
+		printf("Failed to build the pipeline\n");
+		swx_test_pipeline_free();
+		return -1;
+	}
+
+	/* The pipeline instances never ran, so they can't hold any table state. */
+	ret = swx_test_default_set(0);
+	if (ret)
+		printf("Commit before the first run failed (%d)\n", ret);
+
+	if (ret == 0) {
+		swx_test_launch(lcore_p, lcore_w);
+		ret = test_swx_pipeline_commit();
+		swx_test_stop(lcore_p, lcore_w);
+	}
+
+	if (ret == 0)
+		ret = test_swx_pipeline_sync_timeout();
+
+	if (ret == 0)
+		ret = test_swx_pipeline_commit_stopped(lcore_p, lcore_w);
+
+	swx_test_pipeline_free();
+	return ret;
+}
+
+#endif /* !RTE_EXEC_ENV_WINDOWS */
+
+REGISTER_FAST_TEST(swx_pipeline_autotest, true, true, test_swx_pipeline);
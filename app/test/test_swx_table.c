@@ -0,0 +1,471 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_memory.h>
+#include <rte_pause.h>
+#include <rte_random.h>
+
+#include "test.h"
+
+#ifdef RTE_EXEC_ENV_WINDOWS
+static int
+test_swx_table(void)
+{
+	printf("SWX table not supported on Windows, skipping test\n");
+	return TEST_SKIPPED;
+}
+
+static int
+test_swx_table_perf(void)
+{
+	printf("SWX table not supported on Windows, skipping test\n");
+	return TEST_SKIPPED;
+}
+#else
+
+#include <rte_swx_table_em.h>
+#include <rte_swx_table_learner.h>
+
+#define EM_TEST_KEYS		64
+#define EM_TEST_DATA_SIZE	8
+
+/* Lookups in flight, as many as the pipeline threads. */
+#define EM_PERF_BURST		16
+#define EM_PERF_LOOKUPS		(1 << 22)
+#define EM_PERF_KEYS		(1 << 16)
+
+static uint64_t em_perf_keys[EM_PERF_KEYS];
+
+/* All the keys in the same bucket, with a different signature each. */
+static uint32_t
+em_test_hash_same_bucket(const void *key, uint32_t length __rte_unused,
+			 uint32_t seed __rte_unused)
+{
+	return *(const uint32_t *)key << 16;
+}
+
+/* All the keys in the same bucket, with the same signature. */
+static uint32_t
+em_test_hash_same_sig(const void *key __rte_unused, uint32_t length __rte_unused,
+		      uint32_t seed __rte_unused)
+{
+	return 0x12340000;
+}
+
+static void *
+em_test_create(rte_swx_hash_func_t hash_func, uint32_t n_keys_max)
+{
+	struct rte_swx_table_params params = {
+		.match_type = RTE_SWX_TABLE_MATCH_EXACT,
+		.key_size = sizeof(uint64_t),
+		.action_data_size = EM_TEST_DATA_SIZE,
+		.hash_func = hash_func,
+		.n_keys_max = n_keys_max,
+	};
+
+	return rte_swx_table_exact_match_ops.create(&params, NULL, NULL, SOCKET_ID_ANY);
+}
+
+static int
+em_test_add(void *t, uint64_t key)
+{
+	uint64_t data = ~key;
+	struct rte_swx_table_entry entry = {
+		.key = (uint8_t *)&key,
+		.action_id = key & 0xF,
+		.action_data = (uint8_t *)&data,
+	};
+
+	return rte_swx_table_exact_match_ops.add(t, &entry);
+}
+
+static int
+em_test_del(void *t, uint64_t key)
+{
+	struct rte_swx_table_entry entry = {
+		.key = (uint8_t *)&key,
+	};
+
+	return rte_swx_table_exact_match_ops.del(t, &entry);
+}
+
+/* Returns 1 on hit with the expected action, 0 on miss and -1 on wrong action. */
+static int
+em_test_lookup(void *t, void *mailbox, uint64_t key)
+{
+	uint8_t *key_ptr = (uint8_t *)&key;
+	uint8_t *action_data;
+	uint64_t action_id;
+	size_t entry_id;
+	int hit;
+
+	while (!rte_swx_table_exact_match_ops.lkp(t, mailbox, &key_ptr, &action_id,
+						   &action_data, &entry_id, &hit))
+		;
+
+	if (!hit)
+		return 0;
+
+	if (action_id != (key & 0xF) || *(uint64_t *)action_data != ~key)
+		return -1;
+
+	return 1;
+}
+
+static int
+em_test_run(const char *name, rte_swx_hash_func_t hash_func)
+{
+	void *t, *mailbox;
+	uint64_t key;
+	int ret = 0;
+
+	t = em_test_create(hash_func, EM_TEST_KEYS);
+	mailbox = calloc(1, rte_swx_table_exact_match_ops.mailbox_size_get());
+	if (t == NULL || mailbox == NULL) {
+		printf("%s: table create failed\n", name);
+		ret = -1;
+		goto out;
+	}
+
+	for (key = 0; key < EM_TEST_KEYS / 2; key++)
+		if (em_test_add(t, key)) {
+			printf("%s: failed to add key %" PRIu64 "\n", name, key);
+			ret = -1;
+			goto out;
+		}
+
+	for (key = 0; key < EM_TEST_KEYS; key++)
+		if (em_test_lookup(t, mailbox, key) != (key < EM_TEST_KEYS / 2)) {
+			printf("%s: wrong lookup result for key %" PRIu64 "\n", name, key);
+			ret = -1;
+			goto out;
+		}
+
+	/* Delete the odd keys, so that the remaining ones are spread over the bucket. */
+	for (key = 1; key < EM_TEST_KEYS / 2; key += 2)
+		em_test_del(t, key);
+
+	for (key = 0; key < EM_TEST_KEYS; key++)
+		if (em_test_lookup(t, mailbox, key) !=
+		    ((key < EM_TEST_KEYS / 2) && !(key & 1))) {
+			printf("%s: wrong lookup result for key %" PRIu64 " after delete\n",
+			       name, key);
+			ret = -1;
+			goto out;
+		}
+
+out:
+	free(mailbox);
+	if (t)
+		rte_swx_table_exact_match_ops.free(t);
+	return ret;
+}
+
+static int
+test_swx_table_em(void)
+{
+	int ret;
+
+	ret = em_test_run("em_default_hash", NULL);
+	ret |= em_test_run("em_same_bucket", em_test_hash_same_bucket);
+	ret |= em_test_run("em_same_sig", em_test_hash_same_sig);
+
+	return ret;
+}
+
+/* Few buckets and more keys than positions, so that the key positions keep being reused. */
+#define LEARNER_TEST_KEYS_MAX	16
+#define LEARNER_TEST_KEYS	256
+#define LEARNER_TEST_LOOKUPS	(1 << 20)
+#define LEARNER_TEST_DATA_WORDS	8
+
+static void *learner_t;
+static RTE_ATOMIC(uint32_t) learner_stop;
+static RTE_ATOMIC(uint32_t) learner_errors;
+
+/* Returns the lookup hit flag. The action ID of a key and all the words of its action data are
+ * always the key itself, and they must stay so while other lcores keep updating the table.
+ */
+static int
+learner_test_lookup(void *mailbox, uint64_t *key, uint64_t time)
+{
+	uint8_t *key_ptr = (uint8_t *)key;
+	uint8_t *action_data;
+	uint64_t action_id, data[LEARNER_TEST_DATA_WORDS];
+	size_t entry_id;
+	uint32_t i;
+	int hit;
+
+	while (!rte_swx_table_learner_lookup(learner_t, mailbox, time, &key_ptr, &action_id,
+					     &action_data, &entry_id, &hit))
+		;
+
+	if (!hit)
+		return 0;
+
+	rte_pause();
+	memcpy(data, action_data, sizeof(data));
+
+	if (action_id != *key)
+		rte_atomic_fetch_add_explicit(&learner_errors, 1, rte_memory_order_relaxed);
+
+	for (i = 0; i < LEARNER_TEST_DATA_WORDS; i++)
+		if (data[i] != *key) {
+			rte_atomic_fetch_add_explicit(&learner_errors, 1,
+						      rte_memory_order_relaxed);
+			break;
+		}
+
+	return 1;
+}
+
+static void
+learner_test_add(void *mailbox, uint64_t key, uint64_t time)
+{
+	uint64_t data[LEARNER_TEST_DATA_WORDS];
+	uint32_t i;
+
+	for (i = 0; i < LEARNER_TEST_DATA_WORDS; i++)
+		data[i] = key;
+
+	rte_swx_table_learner_add(learner_t, mailbox, time, key, (uint8_t *)data, 0);
+}
+
+/* Add, rearm and delete random keys. */
+static int
+learner_test_writer(void *arg __rte_unused)
+{
+	uint64_t key;
+	void *mailbox;
+
+	mailbox = calloc(1, rte_swx_table_learner_mailbox_size_get());
+	if (mailbox == NULL) {
+		rte_atomic_fetch_add_explicit(&learner_errors, 1, rte_memory_order_relaxed);
+		return -1;
+	}
+
+	while (!rte_atomic_load_explicit(&learner_stop, rte_memory_order_relaxed)) {
+		uint64_t time = rte_get_tsc_cycles();
+
+		key = rte_rand_max(LEARNER_TEST_KEYS);
+
+		if (!learner_test_lookup(mailbox, &key, time)) {
+			learner_test_add(mailbox, key, time);
+			continue;
+		}
+
+		switch (rte_rand_max(3)) {
+		case 0:
+			rte_swx_table_learner_delete(learner_t, mailbox);
+			break;
+		case 1:
+			rte_swx_table_learner_rearm(learner_t, mailbox, time);
+			break;
+		default:
+			learner_test_add(mailbox, key, time);
+		}
+	}
+
+	free(mailbox);
+	return 0;
+}
+
+/*
+ * Lookups concurrent with add, rearm and delete operations from other lcores
+ * always return the action ID and the action data of the input key.
+ */
+static int
+test_swx_table_learner(void)
+{
+	uint32_t key_timeout[] = { 60 };
+	struct rte_swx_table_learner_params params = {
+		.key_size = sizeof(uint64_t),
+		.action_data_size = LEARNER_TEST_DATA_WORDS * sizeof(uint64_t),
+		.n_keys_max = LEARNER_TEST_KEYS_MAX,
+		.key_timeout = key_timeout,
+		.n_key_timeouts = RTE_DIM(key_timeout),
+		.concurrent = 1,
+	};
+	uint32_t lcore_id, i, n_hit = 0, n_writers = 0;
+	uint64_t key;
+	void *mailbox;
+	int ret = 0;
+
+	learner_t = rte_swx_table_learner_create(&params, SOCKET_ID_ANY);
+	mailbox = calloc(1, rte_swx_table_learner_mailbox_size_get());
+	if (learner_t == NULL || mailbox == NULL) {
+		printf("%s: table create failed\n", __func__);
+		ret = -1;
+		goto out;
+	}
+
+	rte_atomic_store_explicit(&learner_stop, 0, rte_memory_order_relaxed);
+	rte_atomic_store_explicit(&learner_errors, 0, rte_memory_order_relaxed);
+
+	RTE_LCORE_FOREACH_WORKER(lcore_id) {
+		if (n_writers == 2)
+			break;
+		rte_eal_remote_launch(learner_test_writer, NULL, lcore_id);
+		n_writers++;
+	}
+
+	if (n_writers == 0) {
+		printf("%s: no worker lcore, skipping\n", __func__);
+		goto out;
+	}
+
+	for (i = 0; i < LEARNER_TEST_LOOKUPS; i++) {
+		key = rte_rand_max(LEARNER_TEST_KEYS);
+		n_hit += learner_test_lookup(mailbox, &key, rte_get_tsc_cycles());
+	}
+
+	rte_atomic_store_explicit(&learner_stop, 1, rte_memory_order_relaxed);
+	rte_eal_mp_wait_lcore();
+
+	/* Once quiet, all the keys found can be deleted. */
+	for (key = 0; key < LEARNER_TEST_KEYS; key++)
+		if (learner_test_lookup(mailbox, &key, rte_get_tsc_cycles()))
+			rte_swx_table_learner_delete(learner_t, mailbox);
+
+	for (key = 0; key < LEARNER_TEST_KEYS; key++)
+		if (learner_test_lookup(mailbox, &key, rte_get_tsc_cycles())) {
+			printf("%s: key %" PRIu64 " found after delete\n", __func__, key);
+			ret = -1;
+		}
+
+	if (rte_atomic_load_explicit(&learner_errors, rte_memory_order_relaxed) || !n_hit) {
+		printf("%s: %u lookups with the action (data) of another key, %u hits\n", __func__,
+		       rte_atomic_load_explicit(&learner_errors, rte_memory_order_relaxed),
+		       n_hit);
+		ret = -1;
+	}
+
+out:
+	free(mailbox);
+	if (learner_t)
+		rte_swx_table_learner_free(learner_t);
+	learner_t = NULL;
+	return ret;
+}
+
+static int
+test_swx_table(void)
+{
+	if (test_swx_table_em())
+		return -1;
+
+	if (test_swx_table_learner())
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Exact match lookups interleaved the way the pipeline threads do:
+ * each lookup yields after prefetching the bucket, then the key and data.
+ */
+static int
+em_perf_run(uint32_t n_keys)
+{
+	uint8_t *mailbox[EM_PERF_BURST];
+	uint64_t keys[EM_PERF_BURST];
+	uint8_t *key_ptr[EM_PERF_BURST];
+	uint8_t *action_data;
+	uint64_t action_id, start, cycles, key;
+	uint32_t i, j, done, n_hit = 0;
+	size_t entry_id;
+	int hit, ret = 0;
+	void *t;
+
+	memset(mailbox, 0, sizeof(mailbox));
+	t = em_test_create(NULL, n_keys);
+	if (t == NULL) {
+		printf("%s: table create failed\n", __func__);
+		return -1;
+	}
+
+	for (j = 0; j < EM_PERF_BURST; j++) {
+		mailbox[j] = calloc(1, rte_swx_table_exact_match_ops.mailbox_size_get());
+		if (mailbox[j] == NULL) {
+			ret = -1;
+			goto out;
+		}
+		key_ptr[j] = (uint8_t *)&keys[j];
+	}
+
+	for (key = 0; key < n_keys; key++)
+		if (em_test_add(t, key)) {
+			printf("%s: failed to add key %" PRIu64 "\n", __func__, key);
+			ret = -1;
+			goto out;
+		}
+
+	for (i = 0; i < EM_PERF_KEYS; i++)
+		em_perf_keys[i] = rte_rand_max(n_keys);
+
+	start = rte_rdtsc_precise();
+
+	for (i = 0; i < EM_PERF_LOOKUPS; i += EM_PERF_BURST) {
+		for (j = 0; j < EM_PERF_BURST; j++)
+			keys[j] = em_perf_keys[(i + j) & (EM_PERF_KEYS - 1)];
+
+		done = 0;
+		while (done != RTE_LEN2MASK(EM_PERF_BURST, uint32_t))
+			for (j = 0; j < EM_PERF_BURST; j++) {
+				if (done & (1 << j))
+					continue;
+
+				if (rte_swx_table_exact_match_ops.lkp(t, mailbox[j], &key_ptr[j],
+					&action_id, &action_data, &entry_id, &hit)) {
+					done |= 1 << j;
+					n_hit += hit;
+				}
+			}
+	}
+
+	cycles = rte_rdtsc_precise() - start;
+
+	printf("%8u keys: %.1f cycles per lookup\n", n_keys, (double)cycles / EM_PERF_LOOKUPS);
+
+	if (n_hit != EM_PERF_LOOKUPS) {
+		printf("%s: %u lookups out of %u missed\n", __func__,
+		       EM_PERF_LOOKUPS - n_hit, EM_PERF_LOOKUPS);
+		ret = -1;
+	}
+
+out:
+	for (j = 0; j < EM_PERF_BURST; j++)
+		free(mailbox[j]);
+	rte_swx_table_exact_match_ops.free(t);
+	return ret;
+}
+
+static int
+test_swx_table_perf(void)
+{
+	static const uint32_t n_keys[] = { 1 << 10, 1 << 16, 1 << 20, 10 * 1000 * 1000 };
+	uint32_t i;
+
+	printf("SWX exact match table, %u lookups in flight:\n", EM_PERF_BURST);
+
+	for (i = 0; i < RTE_DIM(n_keys); i++)
+		if (em_perf_run(n_keys[i]))
+			return -1;
+
+	return 0;
+}
+
+#endif /* !RTE_EXEC_ENV_WINDOWS */
+
+REGISTER_FAST_TEST(swx_table_autotest, true, true, test_swx_table);
+REGISTER_PERF_TEST(swx_table_perf_autotest, test_swx_table_perf);
@@ -13,6 +13,7 @@ telemetry_data_autotest(void)
 
 #else
 
+#include <inttypes.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -31,6 +32,7 @@ telemetry_data_autotest(void)
 #define REQUEST_CMD "/test"
 #define BUF_SIZE 1024
 #define CHECK_OUTPUT(exp) check_output(__func__, "{\"" REQUEST_CMD "\":" exp "}")
+#define CHECK_REQUEST(req, exp) check_request_output(__func__, req, exp)
 
 /*
  * Runs a series of test cases, checking the output of telemetry for various different types of
@@ -82,11 +84,12 @@ telemetry_test_cb(const char *cmd __rte_unused, const char *params __rte_unused,
  * and is compared to the actual response received from Telemetry.
  */
 static int
-check_output(const char *func_name, const char *expected)
+check_request_output(const char *func_name, const char *request,
+		const char *expected)
 {
 	int bytes;
 	char buf[BUF_SIZE * 16];
-	if (write(sock, REQUEST_CMD, strlen(REQUEST_CMD)) < 0) {
+	if (write(sock, request, strlen(request)) < 0) {
 		printf("%s: Error with socket write - %s\n", __func__,
 				strerror(errno));
 		return -1;
@@ -102,6 +105,12 @@ check_output(const char *func_name, const char *expected)
 	return strncmp(expected, buf, sizeof(buf));
 }
 
+static int
+check_output(const char *func_name, const char *expected)
+{
+	return check_request_output(func_name, REQUEST_CMD, expected);
+}
+
 static int
 test_null_return(void)
 {
@@ -528,6 +537,117 @@ test_dict_char_escaping(void)
 	return CHECK_OUTPUT("{\"name\":\"escaped\\n\\tvalue\"}");
 }
 
+/*
+ * Reads an update of the subscription, which must fit in one message.
+ */
+static int
+read_stream_update(struct rte_tel_stream_entry *entries, unsigned int *nb_entries)
+{
+	struct rte_tel_stream_hdr hdr;
+	char buf[BUF_SIZE * 16];
+	int bytes;
+
+	bytes = read(sock, buf, sizeof(buf));
+	if (bytes < (int)sizeof(hdr)) {
+		printf("%s: Error with socket read\n", __func__);
+		return -1;
+	}
+	memcpy(&hdr, buf, sizeof(hdr));
+	if (hdr.magic != RTE_TEL_STREAM_MAGIC ||
+			hdr.version != RTE_TEL_STREAM_VERSION ||
+			!(hdr.flags & RTE_TEL_STREAM_F_LAST) ||
+			hdr.nb_entries > *nb_entries ||
+			bytes != (int)(sizeof(hdr) + hdr.nb_entries * sizeof(entries[0]))) {
+		printf("%s: Invalid update message\n", __func__);
+		return -1;
+	}
+	memcpy(entries, buf + sizeof(hdr), hdr.nb_entries * sizeof(entries[0]));
+	*nb_entries = hdr.nb_entries;
+
+	return 0;
+}
+
+static int
+check_stream_entry(const struct rte_tel_stream_entry *entry, uint32_t index,
+		int64_t delta)
+{
+	if (entry->index != index || entry->delta != delta) {
+		printf("%s: entry %u:%"PRId64", expected %u:%"PRId64"\n", __func__,
+				entry->index, entry->delta, index, delta);
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Subscribes to the numeric values returned by "/test", and checks that the
+ * binary updates only include the values which changed.
+ * A nested value with a name too long to be sent to the client is not part
+ * of the subscription.
+ */
+static int
+test_stream_subscription(void)
+{
+	struct rte_tel_stream_entry entries[8];
+	struct rte_tel_data *values, *long_values;
+	char long_name[RTE_TEL_MAX_STRING_LEN - 1];
+	unsigned int nb;
+	int ret = -1;
+
+	/* kept, since the callback returns the same container at each update */
+	values = rte_tel_data_alloc();
+	long_values = rte_tel_data_alloc();
+	if (values == NULL || long_values == NULL)
+		goto out;
+	rte_tel_data_start_array(values, RTE_TEL_UINT_VAL);
+	rte_tel_data_add_array_uint(values, 3);
+	rte_tel_data_add_array_uint(values, 4);
+	/* "e/<long_name>" does not fit in a telemetry string */
+	memset(long_name, 'x', sizeof(long_name) - 1);
+	long_name[sizeof(long_name) - 1] = '\0';
+	rte_tel_data_start_dict(long_values);
+	if (rte_tel_data_add_dict_uint(long_values, long_name, 7) != 0)
+		goto out;
+
+	rte_tel_data_start_dict(&response_data);
+	rte_tel_data_add_dict_uint(&response_data, "a", 1);
+	rte_tel_data_add_dict_int(&response_data, "b", -2);
+	rte_tel_data_add_dict_string(&response_data, "c", "not a value");
+	rte_tel_data_add_dict_container(&response_data, "d", values, 1);
+	rte_tel_data_add_dict_container(&response_data, "e", long_values, 1);
+
+	if (CHECK_REQUEST("/subscribe/add," REQUEST_CMD,
+			"{\"/subscribe/add\":{\"first\":0,"
+			"\"values\":[\"a\",\"b\",\"d/0\",\"d/1\"]}}") != 0)
+		goto out;
+	if (CHECK_REQUEST("/subscribe/start,10",
+			"{\"/subscribe/start\":{\"interval_ms\":10,\"nb_values\":4}}") != 0)
+		goto out;
+
+	/* first update has all the values, as deltas from 0 */
+	nb = RTE_DIM(entries);
+	if (read_stream_update(entries, &nb) != 0 || nb != 4 ||
+			check_stream_entry(&entries[0], 0, 1) != 0 ||
+			check_stream_entry(&entries[1], 1, -2) != 0 ||
+			check_stream_entry(&entries[2], 2, 3) != 0 ||
+			check_stream_entry(&entries[3], 3, 4) != 0)
+		goto out;
+
+	/* then only the values which changed */
+	response_data.data.dict[0].value.uval = 5;
+	nb = RTE_DIM(entries);
+	if (read_stream_update(entries, &nb) != 0 || nb != 1 ||
+			check_stream_entry(&entries[0], 0, 4) != 0)
+		goto out;
+
+	/* no update without change, so the next message is the reply */
+	ret = CHECK_REQUEST("/subscribe/stop", "{\"/subscribe/stop\":{\"updates\":2}}");
+out:
+	rte_tel_data_free(values);
+	rte_tel_data_free(long_values);
+	return ret;
+}
+
 static int
 connect_to_socket(void)
 {
@@ -600,6 +720,7 @@ telemetry_data_autotest(void)
 			test_string_char_escaping,
 			test_array_char_escaping,
 			test_dict_char_escaping,
+			test_stream_subscription,
 	};
 
 	rte_telemetry_register_cmd(REQUEST_CMD, telemetry_test_cb, "Test");
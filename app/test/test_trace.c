@@ -2,6 +2,12 @@
  * Copyright(C) 2020 Marvell International Ltd.
  */
 
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
 #include <rte_eal_trace.h>
 #include <rte_lcore.h>
 #include <rte_random.h>
@@ -132,6 +138,9 @@ test_trace_mode(void)
 	enum rte_trace_mode current;
 
 	current = rte_trace_mode_get();
+	/* the streaming mode is kept once the buffers are allocated */
+	if (current == RTE_TRACE_MODE_STREAM)
+		return TEST_SKIPPED;
 
 	rte_trace_mode_set(RTE_TRACE_MODE_DISCARD);
 	if (rte_trace_mode_get() != RTE_TRACE_MODE_DISCARD)
@@ -149,6 +158,146 @@ test_trace_mode(void)
 
 }
 
+static int
+test_trace_stream_stats(void)
+{
+	struct rte_trace_stream_stats stats;
+
+	TEST_ASSERT_EQUAL(rte_trace_stream_stats_get(NULL), -EINVAL,
+		"NULL stats accepted");
+	if (rte_trace_mode_get() != RTE_TRACE_MODE_STREAM) {
+		TEST_ASSERT_EQUAL(rte_trace_stream_stats_get(&stats), -ENOTSUP,
+			"stats available out of streaming mode");
+		return TEST_SUCCESS;
+	}
+
+	TEST_ASSERT_SUCCESS(rte_trace_stream_stats_get(&stats),
+		"cannot get streaming stats");
+	TEST_ASSERT_SUCCESS(rte_trace_save(), "cannot flush trace buffers");
+	return TEST_SUCCESS;
+}
+
+/* Get the trace directory and buffer length from the trace dump. */
+static int
+trace_stream_params_get(char *dir, size_t dir_len, uint32_t *buff_len)
+{
+	char line[PATH_MAX + 16];
+	char *dump = NULL;
+	size_t dump_len;
+	int found = 0;
+	FILE *f;
+
+	f = open_memstream(&dump, &dump_len);
+	if (f == NULL)
+		return -1;
+	rte_trace_dump(f);
+	fclose(f);
+
+	f = fmemopen(dump, dump_len, "r");
+	if (f == NULL) {
+		free(dump);
+		return -1;
+	}
+	while (fgets(line, sizeof(line), f) != NULL) {
+		line[strcspn(line, "\n")] = '\0';
+		if (strncmp(line, "dir = ", 6) == 0) {
+			strlcpy(dir, line + 6, dir_len);
+			found++;
+		} else if (sscanf(line, "buffer len = %" SCNu32, buff_len) == 1) {
+			found++;
+		}
+	}
+	fclose(f);
+	free(dump);
+
+	return found == 2 ? 0 : -1;
+}
+
+/* Total size of the streaming mode trace files. */
+static int64_t
+trace_stream_files_size(const char *dir)
+{
+	char path[PATH_MAX];
+	struct dirent *ent;
+	struct stat st;
+	int64_t size = 0;
+	DIR *d;
+
+	d = opendir(dir);
+	if (d == NULL)
+		return -1;
+	while ((ent = readdir(d)) != NULL) {
+		if (strncmp(ent->d_name, "channel0_", 9) != 0)
+			continue;
+		snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+		if (stat(path, &st) < 0) {
+			size = -1;
+			break;
+		}
+		size += st.st_size;
+	}
+	closedir(d);
+
+	return size;
+}
+
+static int
+test_trace_stream_write(void)
+{
+	struct rte_trace_stream_stats prev, stats;
+	uint64_t n_events, written;
+	int64_t size_prev, size;
+	char dir[PATH_MAX];
+	uint32_t buff_len;
+	uint64_t i;
+
+	if (rte_trace_mode_get() != RTE_TRACE_MODE_STREAM ||
+			!rte_trace_point_is_enabled(&__rte_eal_trace_generic_u64))
+		return TEST_SKIPPED;
+
+	/* first flush, which creates the trace directory and the trace file
+	 * of this thread
+	 */
+	rte_eal_trace_generic_u64(0);
+	TEST_ASSERT_SUCCESS(rte_trace_save(), "cannot flush trace buffers");
+	TEST_ASSERT_SUCCESS(trace_stream_params_get(dir, sizeof(dir), &buff_len),
+		"cannot get trace parameters");
+	TEST_ASSERT_SUCCESS(rte_trace_stream_stats_get(&prev),
+		"cannot get streaming stats");
+	size_prev = trace_stream_files_size(dir);
+	TEST_ASSERT(size_prev > 0, "no trace file in %s", dir);
+
+	/* events of 16 bytes, filling the buffer 4 times */
+	n_events = 4 * buff_len / 16;
+	for (i = 0; i < n_events; i++)
+		rte_eal_trace_generic_u64(i);
+	/* the half being filled is handed over on the next event */
+	TEST_ASSERT_SUCCESS(rte_trace_save(), "cannot flush trace buffers");
+	rte_eal_trace_generic_u64(n_events);
+	TEST_ASSERT_SUCCESS(rte_trace_save(), "cannot flush trace buffers");
+
+	TEST_ASSERT_SUCCESS(rte_trace_stream_stats_get(&stats),
+		"cannot get streaming stats");
+	size = trace_stream_files_size(dir);
+	written = stats.bytes - prev.bytes;
+
+	TEST_ASSERT(stats.flushes - prev.flushes >= 2,
+		"halves not switched: %" PRIu64 " flushes",
+		stats.flushes - prev.flushes);
+	TEST_ASSERT(written >= buff_len / 2,
+		"only %" PRIu64 " bytes written", written);
+	TEST_ASSERT_EQUAL(size - size_prev, (int64_t)written,
+		"trace files grew by %" PRId64 " bytes, %" PRIu64 " written",
+		size - size_prev, written);
+	/* the events not written are either dropped or still buffered */
+	TEST_ASSERT(written / 16 + stats.drops - prev.drops + buff_len / 16 >=
+		n_events, "%" PRIu64 " events written, %" PRIu64
+		" dropped out of %" PRIu64, written / 16,
+		stats.drops - prev.drops, n_events);
+
+	return TEST_SUCCESS;
+}
+
 static int
 test_trace_points_lookup(void)
 {
@@ -236,6 +385,8 @@ static struct unit_test_suite trace_tests = {
 		TEST_CASE(test_trace_point_globbing),
 		TEST_CASE(test_trace_point_regex),
 		TEST_CASE(test_trace_points_lookup),
+		TEST_CASE(test_trace_stream_stats),
+		TEST_CASE(test_trace_stream_write),
 		TEST_CASE(test_trace_dump),
 		TEST_CASE(test_trace_metadata_dump),
 		TEST_CASES_END()
@@ -2,11 +2,16 @@
  * Copyright(c) 2018 Ericsson AB
  */
 
+#include <errno.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <rte_cycles.h>
 #include <eventdev_pmd.h>
 #include <eventdev_pmd_vdev.h>
+#include <rte_kvargs.h>
+#include <rte_malloc.h>
 #include <rte_random.h>
 #include <rte_ring_elem.h>
 
@@ -14,6 +19,9 @@
 
 #define EVENTDEV_NAME_DSW_PMD event_dsw
 
+#define REMOTE_MIGRATION_PENALTY_ARG "remote_migration_penalty"
+#define FLOW_MIGRATION_HOLDOFF_ARG "flow_migration_holdoff"
+
 static int
 dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	       const struct rte_event_port_conf *conf)
@@ -36,7 +44,8 @@ dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		.dequeue_depth = conf->dequeue_depth,
 		.enqueue_depth = conf->enqueue_depth,
 		.new_event_threshold = conf->new_event_threshold,
-		.implicit_release = implicit_release
+		.implicit_release = implicit_release,
+		.socket_id = SOCKET_ID_ANY
 	};
 
 	snprintf(ring_name, sizeof(ring_name), "dsw%d_p%u", dev->data->dev_id,
@@ -234,6 +243,46 @@ dsw_info_get(struct rte_eventdev *dev __rte_unused,
 	};
 }
 
+static void
+dsw_flow_migration_times_free(struct dsw_evdev *dsw)
+{
+	uint8_t queue_id;
+
+	for (queue_id = 0; queue_id < DSW_MAX_QUEUES; queue_id++)
+		dsw->queues[queue_id].flow_migration_time = NULL;
+
+	rte_free(dsw->flow_migration_times);
+	dsw->flow_migration_times = NULL;
+}
+
+/* The flow migration times are only needed, and only take up memory,
+ * if the migration hold-off is enabled.
+ */
+static int
+dsw_flow_migration_times_alloc(struct dsw_evdev *dsw, int socket_id)
+{
+	uint8_t queue_id;
+
+	dsw_flow_migration_times_free(dsw);
+
+	if (dsw->flow_migration_holdoff == 0 || dsw->num_queues == 0)
+		return 0;
+
+	dsw->flow_migration_times =
+		rte_calloc_socket("dsw_flow_migration_times",
+				  (size_t)dsw->num_queues * DSW_MAX_FLOWS,
+				  sizeof(uint64_t), RTE_CACHE_LINE_SIZE,
+				  socket_id);
+	if (dsw->flow_migration_times == NULL)
+		return -ENOMEM;
+
+	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++)
+		dsw->queues[queue_id].flow_migration_time =
+			&dsw->flow_migration_times[queue_id * DSW_MAX_FLOWS];
+
+	return 0;
+}
+
 static int
 dsw_configure(const struct rte_eventdev *dev)
 {
@@ -251,7 +300,7 @@ dsw_configure(const struct rte_eventdev *dev)
 
 	dsw->max_inflight = RTE_MAX(conf->nb_events_limit, min_max_in_flight);
 
-	return 0;
+	return dsw_flow_migration_times_alloc(dsw, dev->data->socket_id);
 }
 
 
@@ -280,6 +329,10 @@ initial_flow_to_port_assignment(struct dsw_evdev *dsw)
 			dsw->queues[queue_id].flow_to_port_map[flow_hash] =
 				port_id;
 		}
+
+		if (queue->flow_migration_time != NULL)
+			memset(queue->flow_migration_time, 0,
+			       DSW_MAX_FLOWS * sizeof(uint64_t));
 	}
 }
 
@@ -389,6 +442,8 @@ dsw_close(struct rte_eventdev *dev)
 	dsw->num_ports = 0;
 	dsw->num_queues = 0;
 
+	dsw_flow_migration_times_free(dsw);
+
 	return 0;
 }
 
@@ -442,15 +497,99 @@ static struct eventdev_ops dsw_evdev_ops = {
 	.xstats_get_by_name = dsw_xstats_get_by_name
 };
 
+static int
+set_remote_migration_penalty(const char *key __rte_unused, const char *value,
+			     void *opaque)
+{
+	int *penalty = opaque;
+	char *end;
+
+	errno = 0;
+	*penalty = strtol(value, &end, 0);
+	if (errno != 0 || *end != '\0' || *penalty < 0 || *penalty > 100)
+		return -EINVAL;
+	return 0;
+}
+
+static int
+set_flow_migration_holdoff(const char *key __rte_unused, const char *value,
+			   void *opaque)
+{
+	uint64_t *holdoff = opaque;
+	char *end;
+
+	errno = 0;
+	*holdoff = strtoull(value, &end, 0);
+	if (errno != 0 || *end != '\0')
+		return -EINVAL;
+	return 0;
+}
+
+static int
+dsw_parse_params(const char *name, const char *params,
+		 int *remote_migration_penalty,
+		 uint64_t *flow_migration_holdoff)
+{
+	static const char *const args[] = {
+		REMOTE_MIGRATION_PENALTY_ARG,
+		FLOW_MIGRATION_HOLDOFF_ARG,
+		NULL
+	};
+	struct rte_kvargs *kvlist;
+	int ret;
+
+	if (params == NULL || params[0] == '\0')
+		return 0;
+
+	kvlist = rte_kvargs_parse(params, args);
+	if (kvlist == NULL) {
+		RTE_LOG_LINE(ERR, EVENT_DSW, "Invalid parameters when "
+			     "creating device '%s'", name);
+		return -EINVAL;
+	}
+
+	ret = rte_kvargs_process(kvlist, REMOTE_MIGRATION_PENALTY_ARG,
+				 set_remote_migration_penalty,
+				 remote_migration_penalty);
+	if (ret != 0) {
+		RTE_LOG_LINE(ERR, EVENT_DSW, "%s: Error parsing %s parameter",
+			     name, REMOTE_MIGRATION_PENALTY_ARG);
+		ret = -EINVAL;
+		goto out;
+	}
+
+	ret = rte_kvargs_process(kvlist, FLOW_MIGRATION_HOLDOFF_ARG,
+				 set_flow_migration_holdoff,
+				 flow_migration_holdoff);
+	if (ret != 0) {
+		RTE_LOG_LINE(ERR, EVENT_DSW, "%s: Error parsing %s parameter",
+			     name, FLOW_MIGRATION_HOLDOFF_ARG);
+		ret = -EINVAL;
+	}
+out:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
 static int
 dsw_probe(struct rte_vdev_device *vdev)
 {
 	const char *name;
 	struct rte_eventdev *dev;
 	struct dsw_evdev *dsw;
+	int remote_migration_penalty =
+		DSW_DEFAULT_REMOTE_MIGRATION_PENALTY_PERCENT;
+	uint64_t flow_migration_holdoff = DSW_DEFAULT_FLOW_MIGRATION_HOLDOFF;
+	int ret;
 
 	name = rte_vdev_device_name(vdev);
 
+	ret = dsw_parse_params(name, rte_vdev_device_args(vdev),
+			       &remote_migration_penalty,
+			       &flow_migration_holdoff);
+	if (ret != 0)
+		return ret;
+
 	dev = rte_event_pmd_vdev_init(name, sizeof(struct dsw_evdev),
 				      rte_socket_id(), vdev);
 	if (dev == NULL)
@@ -470,6 +609,11 @@ dsw_probe(struct rte_vdev_device *vdev)
 
 	dsw = dev->data->dev_private;
 	dsw->data = dev->data;
+	dsw->remote_migration_penalty_percent = remote_migration_penalty;
+	dsw->remote_migration_penalty =
+		DSW_LOAD_FROM_PERCENT(remote_migration_penalty);
+	dsw->flow_migration_holdoff =
+		(flow_migration_holdoff * rte_get_timer_hz()) / US_PER_S;
 
 	event_dev_probing_finish(dev);
 	return 0;
@@ -493,4 +637,7 @@ static struct rte_vdev_driver evdev_dsw_pmd_drv = {
 };
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_DSW_PMD, evdev_dsw_pmd_drv);
+RTE_PMD_REGISTER_PARAM_STRING(EVENTDEV_NAME_DSW_PMD,
+		REMOTE_MIGRATION_PENALTY_ARG "=<percent> "
+		FLOW_MIGRATION_HOLDOFF_ARG "=<us>");
 RTE_LOG_REGISTER_DEFAULT(event_dsw_logtype, NOTICE);
@@ -97,6 +97,24 @@
 #define DSW_MAX_TARGET_LOAD_FOR_MIGRATION (DSW_LOAD_FROM_PERCENT(95))
 #define DSW_REBALANCE_THRESHOLD (DSW_LOAD_FROM_PERCENT(3))
 
+/* Moving a flow to a port operated by an lcore on a different NUMA
+ * node has a cost beyond the pause/unpause procedure: the flow's
+ * state, and the memory of its events, will be accessed across the
+ * socket interconnect. Such a migration is only made if it is
+ * expected to remedy a load imbalance larger than the penalty, and a
+ * local target port is preferred over an equally suitable remote
+ * one. The penalty is given in percent of a core's capacity, and kept
+ * as such for reporting, since the conversion to a load truncates.
+ */
+#define DSW_DEFAULT_REMOTE_MIGRATION_PENALTY_PERCENT (10)
+
+/* A flow just migrated to a port is cache-cold there, and its load
+ * may not yet have shown up in the port's load estimate. To avoid
+ * bouncing flows between ports, a migrated flow is not considered
+ * for another migration until this time (in us) has passed.
+ */
+#define DSW_DEFAULT_FLOW_MIGRATION_HOLDOFF (10*DSW_MIGRATION_INTERVAL)
+
 #define DSW_MAX_EVENTS_RECORDED (128)
 
 #define DSW_MAX_FLOWS_PER_MIGRATION (8)
@@ -175,7 +193,9 @@ struct __rte_cache_aligned dsw_port {
 
 	uint64_t emigration_start;
 	uint64_t emigrations;
+	uint64_t remote_emigrations;
 	uint64_t emigration_latency;
+	uint64_t emigrations_held_off;
 
 	uint8_t emigration_target_port_ids[DSW_MAX_FLOWS_PER_MIGRATION];
 	struct dsw_queue_flow
@@ -231,6 +251,10 @@ struct __rte_cache_aligned dsw_port {
 
 	/* Estimate of current port load. */
 	alignas(RTE_CACHE_LINE_SIZE) RTE_ATOMIC(int16_t) load;
+	/* NUMA node of the lcore operating the port, or SOCKET_ID_ANY
+	 * if not yet known.
+	 */
+	RTE_ATOMIC(int32_t) socket_id;
 	/* Estimate of flows currently migrating to this port. */
 	alignas(RTE_CACHE_LINE_SIZE) RTE_ATOMIC(int32_t) immigration_load;
 };
@@ -241,6 +265,11 @@ struct dsw_queue {
 	uint16_t num_serving_ports;
 
 	alignas(RTE_CACHE_LINE_SIZE) uint8_t flow_to_port_map[DSW_MAX_FLOWS];
+	/* Time of the latest migration of each flow, or NULL if the
+	 * migration hold-off is disabled. Only accessed by the port
+	 * currently serving the flow.
+	 */
+	uint64_t *flow_migration_time;
 };
 
 /* Limited by the size of the 'serving_ports' bitmask */
@@ -255,6 +284,13 @@ struct dsw_evdev {
 	uint8_t num_queues;
 	int32_t max_inflight;
 
+	/* Migration policy parameters. */
+	uint8_t remote_migration_penalty_percent;
+	int16_t remote_migration_penalty;
+	uint64_t flow_migration_holdoff;
+	/* Backing memory of the queues' flow_migration_time arrays. */
+	uint64_t *flow_migration_times;
+
 	alignas(RTE_CACHE_LINE_SIZE) RTE_ATOMIC(int32_t) credits_on_loan;
 };
 
@@ -13,6 +13,7 @@
 #include <string.h>
 
 #include <rte_cycles.h>
+#include <rte_lcore.h>
 #include <rte_memcpy.h>
 #include <rte_random.h>
 
@@ -172,6 +173,12 @@ dsw_port_load_update(struct dsw_port *port, uint64_t now)
 	rte_atomic_store_explicit(&port->load, new_load,
 				  rte_memory_order_relaxed);
 
+	/* The lcore operating a port may change over time, so keep
+	 * the port's NUMA node up to date for the migration policy.
+	 */
+	rte_atomic_store_explicit(&port->socket_id, (int32_t)rte_socket_id(),
+				  rte_memory_order_relaxed);
+
 	/* The load of the recently immigrated flows should hopefully
 	 * be reflected the load estimate by now.
 	 */
@@ -422,19 +429,67 @@ dsw_flow_load(uint16_t num_events, int16_t port_load)
 		DSW_MAX_EVENTS_RECORDED;
 }
 
+static bool
+dsw_is_remote_port(struct dsw_evdev *dsw, uint8_t source_port_id,
+		   uint8_t target_port_id)
+{
+	int32_t source_socket_id =
+		rte_atomic_load_explicit(&dsw->ports[source_port_id].socket_id,
+					 rte_memory_order_relaxed);
+	int32_t target_socket_id =
+		rte_atomic_load_explicit(&dsw->ports[target_port_id].socket_id,
+					 rte_memory_order_relaxed);
+
+	/* Ports not yet operated are assumed to be local. */
+	return source_socket_id != SOCKET_ID_ANY &&
+		target_socket_id != SOCKET_ID_ANY &&
+		source_socket_id != target_socket_id;
+}
+
+static bool
+dsw_is_flow_held_off(struct dsw_evdev *dsw, const struct dsw_queue_flow *qf,
+		     uint64_t now)
+{
+	const uint64_t *migration_time =
+		dsw->queues[qf->queue_id].flow_migration_time;
+
+	/* The migration may have been recorded by another port after
+	 * 'now' was sampled, hence the signed comparison.
+	 */
+	return migration_time != NULL &&
+		(int64_t)(now - migration_time[qf->flow_hash]) <
+		(int64_t)dsw->flow_migration_holdoff;
+}
+
+/* Record the time a flow was moved to its new port. This is done
+ * before the flow table update is made visible, and thus before the
+ * new port may consider the flow for another migration.
+ */
+static void
+dsw_record_flow_migration(struct dsw_evdev *dsw,
+			  const struct dsw_queue_flow *qf)
+{
+	uint64_t *migration_time =
+		dsw->queues[qf->queue_id].flow_migration_time;
+
+	if (migration_time != NULL)
+		migration_time[qf->flow_hash] = rte_get_timer_cycles();
+}
+
 static int16_t
 dsw_evaluate_migration(int16_t source_load, int16_t target_load,
-		       int16_t flow_load)
+		       int16_t flow_load, int16_t penalty)
 {
 	int32_t res_target_load;
 	int32_t imbalance;
+	int32_t weight;
 
 	if (target_load > DSW_MAX_TARGET_LOAD_FOR_MIGRATION)
 		return -1;
 
 	imbalance = source_load - target_load;
 
-	if (imbalance < DSW_REBALANCE_THRESHOLD)
+	if (imbalance < DSW_REBALANCE_THRESHOLD + penalty)
 		return -1;
 
 	res_target_load = target_load + flow_load;
@@ -448,9 +503,12 @@ dsw_evaluate_migration(int16_t source_load, int16_t target_load,
 
 	/* The more idle the target will be, the better. This will
 	 * make migration prefer moving smaller flows, and flows to
-	 * lightly loaded ports.
+	 * lightly loaded ports. The migration cost, if any, is
+	 * deducted so that local targets win over remote ones.
 	 */
-	return DSW_MAX_LOAD - res_target_load;
+	weight = DSW_MAX_LOAD - res_target_load - penalty;
+
+	return weight >= 0 ? weight : -1;
 }
 
 static bool
@@ -470,13 +528,14 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 			     int16_t *port_loads, uint16_t num_ports,
 			     uint8_t *target_port_ids,
 			     struct dsw_queue_flow *target_qfs,
-			     uint8_t *targets_len)
+			     uint8_t *targets_len, uint64_t now)
 {
 	int16_t source_port_load = port_loads[source_port->id];
 	struct dsw_queue_flow *candidate_qf = NULL;
 	uint8_t candidate_port_id = 0;
 	int16_t candidate_weight = -1;
 	int16_t candidate_flow_load = -1;
+	int16_t held_off_weight = -1;
 	uint16_t i;
 
 	if (source_port_load < DSW_MIN_SOURCE_LOAD_FOR_MIGRATION)
@@ -487,14 +546,21 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 		struct dsw_queue_flow *qf = &burst->queue_flow;
 		int16_t flow_load;
 		uint16_t port_id;
+		bool held_off;
 
 		if (dsw_is_queue_flow_in_ary(target_qfs, *targets_len,
 					     qf->queue_id, qf->flow_hash))
 			continue;
 
+		/* Leave recently migrated flows alone, to allow them
+		 * to warm up the caches of their new port.
+		 */
+		held_off = dsw_is_flow_held_off(dsw, qf, now);
+
 		flow_load = dsw_flow_load(burst->count, source_port_load);
 
 		for (port_id = 0; port_id < num_ports; port_id++) {
+			int16_t penalty = 0;
 			int16_t weight;
 
 			if (port_id == source_port->id)
@@ -503,9 +569,18 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 			if (!dsw_is_serving_port(dsw, port_id, qf->queue_id))
 				continue;
 
+			if (dsw_is_remote_port(dsw, source_port->id, port_id))
+				penalty = dsw->remote_migration_penalty;
+
 			weight = dsw_evaluate_migration(source_port_load,
 							port_loads[port_id],
-							flow_load);
+							flow_load, penalty);
+
+			if (held_off) {
+				held_off_weight = RTE_MAX(held_off_weight,
+							  weight);
+				continue;
+			}
 
 			if (weight > candidate_weight) {
 				candidate_qf = qf;
@@ -516,6 +591,12 @@ dsw_select_emigration_target(struct dsw_evdev *dsw,
 		}
 	}
 
+	/* Count a held-off emigration once, when it would have been
+	 * made, rather than every time a held-off flow is looked at.
+	 */
+	if (held_off_weight > candidate_weight)
+		source_port->emigrations_held_off++;
+
 	if (candidate_weight < 0)
 		return false;
 
@@ -545,7 +626,8 @@ static void
 dsw_select_emigration_targets(struct dsw_evdev *dsw,
 			      struct dsw_port *source_port,
 			      struct dsw_queue_flow_burst *bursts,
-			      uint16_t num_bursts, int16_t *port_loads)
+			      uint16_t num_bursts, int16_t *port_loads,
+			      uint64_t now)
 {
 	struct dsw_queue_flow *target_qfs = source_port->emigration_target_qfs;
 	uint8_t *target_port_ids = source_port->emigration_target_port_ids;
@@ -560,7 +642,7 @@ dsw_select_emigration_targets(struct dsw_evdev *dsw,
 						     port_loads, dsw->num_ports,
 						     target_port_ids,
 						     target_qfs,
-						     targets_len);
+						     targets_len, now);
 		if (!found)
 			break;
 	}
@@ -774,6 +856,10 @@ dsw_port_end_emigration(struct dsw_evdev *dsw, struct dsw_port *port,
 			continue;
 		}
 
+		if (dsw_is_remote_port(dsw, port->id,
+				       port->emigration_target_port_ids[i]))
+			port->remote_emigrations++;
+
 		DSW_LOG_DP_PORT_LINE(DEBUG, port->id, "Migration completed for "
 				"queue_id %d flow_hash %d.", queue_id,
 				flow_hash);
@@ -814,6 +900,8 @@ dsw_port_move_parallel_flows(struct dsw_evdev *dsw,
 				source_port->emigration_target_port_ids[i];
 			uint16_t flow_hash = qf->flow_hash;
 
+			dsw_record_flow_migration(dsw, qf);
+
 			/* Single byte-sized stores are always atomic. */
 			dsw->queues[queue_id].flow_to_port_map[flow_hash] =
 				dest_port_id;
@@ -925,7 +1013,7 @@ dsw_port_consider_emigration(struct dsw_evdev *dsw,
 	}
 
 	dsw_select_emigration_targets(dsw, source_port, bursts, num_bursts,
-				      port_loads);
+				      port_loads, now);
 
 	if (source_port->emigration_targets_len == 0)
 		return;
@@ -1186,6 +1274,8 @@ dsw_port_move_emigrating_flows(struct dsw_evdev *dsw,
 		uint8_t dest_port_id =
 			source_port->emigration_target_port_ids[i];
 
+		dsw_record_flow_migration(dsw, qf);
+
 		dsw->queues[qf->queue_id].flow_to_port_map[qf->flow_hash] =
 		    dest_port_id;
 	}
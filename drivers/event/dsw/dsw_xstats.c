@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include <rte_cycles.h>
 #include <rte_debug.h>
 
 /* The high bits in the xstats id is used to store an additional
@@ -51,8 +52,23 @@ dsw_xstats_dev_credits_on_loan(struct dsw_evdev *dsw)
 	return rte_atomic_load_explicit(&dsw->credits_on_loan, rte_memory_order_relaxed);
 }
 
+static uint64_t
+dsw_xstats_dev_remote_migration_penalty(struct dsw_evdev *dsw)
+{
+	return dsw->remote_migration_penalty_percent;
+}
+
+static uint64_t
+dsw_xstats_dev_flow_migration_holdoff(struct dsw_evdev *dsw)
+{
+	return (dsw->flow_migration_holdoff * US_PER_S) / rte_get_timer_hz();
+}
+
 static struct dsw_xstat_dev dsw_dev_xstats[] = {
-	{ "dev_credits_on_loan", dsw_xstats_dev_credits_on_loan }
+	{ "dev_credits_on_loan", dsw_xstats_dev_credits_on_loan },
+	{ "dev_remote_migration_penalty",
+	  dsw_xstats_dev_remote_migration_penalty },
+	{ "dev_flow_migration_holdoff", dsw_xstats_dev_flow_migration_holdoff }
 };
 
 #define DSW_GEN_PORT_ACCESS_FN(_variable)				\
@@ -85,6 +101,8 @@ dsw_xstats_port_get_queue_dequeued(struct dsw_evdev *dsw, uint8_t port_id,
 }
 
 DSW_GEN_PORT_ACCESS_FN(emigrations)
+DSW_GEN_PORT_ACCESS_FN(remote_emigrations)
+DSW_GEN_PORT_ACCESS_FN(emigrations_held_off)
 DSW_GEN_PORT_ACCESS_FN(immigrations)
 
 static uint64_t
@@ -148,6 +166,10 @@ static struct dsw_xstats_port dsw_port_xstats[] = {
 	  true },
 	{ "port_%u_emigrations", dsw_xstats_port_get_emigrations,
 	  false },
+	{ "port_%u_remote_emigrations", dsw_xstats_port_get_remote_emigrations,
+	  false },
+	{ "port_%u_emigrations_held_off",
+	  dsw_xstats_port_get_emigrations_held_off, false },
 	{ "port_%u_migration_latency", dsw_xstats_port_get_migration_latency,
 	  false },
 	{ "port_%u_immigrations", dsw_xstats_port_get_immigrations,
@@ -24,6 +24,7 @@
 #define MIN_BURST_SIZE_ARG "min_burst"
 #define DEQ_BURST_SIZE_ARG "deq_burst"
 #define REFIL_ONCE_ARG "refill_once"
+#define SCHED_MT_ARG "sched_mt"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
@@ -152,7 +153,9 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 		 * available in the port (p->inflight_credits). We must return
 		 * the sum to no leak credits
 		 */
-		int possible_inflights = p->inflight_credits + p->inflights;
+		int possible_inflights = p->inflight_credits +
+			rte_atomic_load_explicit(&p->inflights,
+					rte_memory_order_relaxed);
 		rte_atomic32_sub(&sw->inflights, possible_inflights);
 	}
 
@@ -199,6 +202,25 @@ sw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
 	}
 	sw->cq_ring_space[port_id] = conf->dequeue_depth;
 
+	if (sw->sched_mt) {
+		snprintf(buf, sizeof(buf), "sw%d_p%u_%s", dev->data->dev_id,
+				port_id, "sched_ring");
+		existing_ring = rte_event_ring_lookup(buf);
+		rte_event_ring_free(existing_ring);
+
+		p->sched_ring = rte_event_ring_create(buf,
+				MAX_SW_PROD_Q_DEPTH, dev->data->socket_id,
+				RING_F_SP_ENQ | RING_F_SC_DEQ |
+				RING_F_EXACT_SZ);
+		if (p->sched_ring == NULL) {
+			rte_event_ring_free(p->cq_worker_ring);
+			rte_event_ring_free(p->rx_worker_ring);
+			SW_LOG_ERR("Error creating scheduler ring for port %d",
+					port_id);
+			return -1;
+		}
+	}
+
 	/* set hist list contents to empty */
 	for (i = 0; i < SW_PORT_HIST_LIST; i++) {
 		p->hist_list[i].fid = -1;
@@ -220,6 +242,7 @@ sw_port_release(void *port)
 
 	rte_event_ring_free(p->rx_worker_ring);
 	rte_event_ring_free(p->cq_worker_ring);
+	rte_event_ring_free(p->sched_ring);
 	memset(p, 0, sizeof(*p));
 }
 
@@ -387,6 +410,9 @@ sw_ports_empty(struct sw_evdev *sw)
 		if ((rte_event_ring_count(sw->ports[i].rx_worker_ring)) ||
 		     rte_event_ring_count(sw->ports[i].cq_worker_ring))
 			return 0;
+		if (sw->ports[i].sched_ring &&
+		    rte_event_ring_count(sw->ports[i].sched_ring))
+			return 0;
 	}
 
 	return 1;
@@ -650,13 +676,15 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		}
 		fprintf(f, "  Port %d %s\n", i,
 			p->is_directed ? " (SingleCons)" : "");
+		uint16_t port_inflights = rte_atomic_load_explicit(
+				&p->inflights, rte_memory_order_relaxed);
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64
 			"\t%sinflight %d%s\n", sw->ports[i].stats.rx_pkts,
 			sw->ports[i].stats.rx_dropped,
 			sw->ports[i].stats.tx_pkts,
-			(p->inflights == p->inflight_max) ?
+			(port_inflights == p->inflight_max) ?
 				COL_RED : COL_RESET,
-			sw->ports[i].inflights, COL_RESET);
+			port_inflights, COL_RESET);
 
 		fprintf(f, "\tMax New: %u"
 			"\tAvg cycles PP: %"PRIu64"\tCredits: %u\n",
@@ -835,7 +863,10 @@ sw_stop(struct rte_eventdev *dev)
 
 	/* Flush all events out of the device */
 	while (!(sw_qids_empty(sw) && sw_ports_empty(sw))) {
-		sw_event_schedule(dev);
+		if (sw->sched_mt)
+			sw_event_schedule_mt(dev);
+		else
+			sw_event_schedule(dev);
 		sw_drain_ports(dev);
 		sw_drain_queues(dev);
 	}
@@ -932,12 +963,28 @@ set_refill_once(const char *key __rte_unused, const char *value, void *opaque)
 	return 0;
 }
 
+static int
+set_sched_mt(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *sched_mt = opaque;
+	*sched_mt = atoi(value);
+	if (*sched_mt < 0 || *sched_mt > 1)
+		return -1;
+	return 0;
+}
+
 static int32_t sw_sched_service_func(void *args)
 {
 	struct rte_eventdev *dev = args;
 	return sw_event_schedule(dev);
 }
 
+static int32_t sw_sched_mt_service_func(void *args)
+{
+	struct rte_eventdev *dev = args;
+	return sw_event_schedule_mt(dev);
+}
+
 static int
 sw_probe(struct rte_vdev_device *vdev)
 {
@@ -980,6 +1027,7 @@ sw_probe(struct rte_vdev_device *vdev)
 		MIN_BURST_SIZE_ARG,
 		DEQ_BURST_SIZE_ARG,
 		REFIL_ONCE_ARG,
+		SCHED_MT_ARG,
 		NULL
 	};
 	const char *name;
@@ -992,6 +1040,7 @@ sw_probe(struct rte_vdev_device *vdev)
 	int min_burst_size = 1;
 	int deq_burst_size = SCHED_DEQUEUE_DEFAULT_BURST_SIZE;
 	int refill_once = 0;
+	int sched_mt = 0;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -1063,6 +1112,16 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, SCHED_MT_ARG,
+					set_sched_mt, &sched_mt);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing two-stage scheduling switch",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
@@ -1070,9 +1129,10 @@ sw_probe(struct rte_vdev_device *vdev)
 	SW_LOG_INFO(
 			"Creating eventdev sw device %s, numa_node=%d, "
 			"sched_quanta=%d, credit_quanta=%d "
-			"min_burst=%d, deq_burst=%d, refill_once=%d",
+			"min_burst=%d, deq_burst=%d, refill_once=%d, "
+			"sched_mt=%d",
 			name, socket_id, sched_quanta, credit_quanta,
-			min_burst_size, deq_burst_size, refill_once);
+			min_burst_size, deq_burst_size, refill_once, sched_mt);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id, vdev);
@@ -1100,6 +1160,9 @@ sw_probe(struct rte_vdev_device *vdev)
 	sw->sched_min_burst_size = min_burst_size;
 	sw->sched_deq_burst_size = deq_burst_size;
 	sw->refill_once_per_iter = refill_once;
+	sw->sched_mt = sched_mt;
+	rte_spinlock_init(&sw->sched_ingress_lock);
+	rte_spinlock_init(&sw->sched_egress_lock);
 
 	/* register service with EAL */
 	struct rte_service_spec service;
@@ -1110,6 +1173,11 @@ sw_probe(struct rte_vdev_device *vdev)
 	service.socket_id = socket_id;
 	service.callback = sw_sched_service_func;
 	service.callback_userdata = (void *)dev;
+	if (sched_mt) {
+		/* the stages serialize themselves, see sw_event_schedule_mt */
+		service.callback = sw_sched_mt_service_func;
+		service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	}
 
 	int32_t ret = rte_service_component_register(&service, &sw->service_id);
 	if (ret) {
@@ -1148,5 +1216,5 @@ RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
 		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>"
 		MIN_BURST_SIZE_ARG "=<int>" DEQ_BURST_SIZE_ARG "=<int>"
-		REFIL_ONCE_ARG "=<int>");
+		REFIL_ONCE_ARG "=<int>" SCHED_MT_ARG "=<int>");
 RTE_LOG_REGISTER_DEFAULT(eventdev_sw_log_level, NOTICE);
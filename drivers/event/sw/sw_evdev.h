@@ -9,6 +9,7 @@
 #include <rte_eventdev.h>
 #include <eventdev_pmd_vdev.h>
 #include <rte_atomic.h>
+#include <rte_spinlock.h>
 
 #define SW_DEFAULT_CREDIT_QUANTA 32
 #define SW_DEFAULT_SCHED_QUANTA 128
@@ -80,16 +81,26 @@ struct sw_point_stats {
 
 /* structure used to track what port a flow (FID) is pinned to */
 struct sw_fid_t {
-	/* which CQ this FID is currently pinned to */
-	int32_t cq;
-	/* number of packets gone to the CQ with this FID */
-	uint32_t pcount;
+	union {
+		struct {
+			/* which CQ this FID is currently pinned to */
+			int32_t cq;
+			/* number of packets gone to the CQ with this FID */
+			uint32_t pcount;
+		};
+		/* cq and pcount, updated together with a CAS when the
+		 * ingress and egress stages run on different cores
+		 */
+		RTE_ATOMIC(uint64_t) state;
+		/* plain view of state, for the local copies used in a CAS */
+		uint64_t val;
+	};
 };
 
 struct reorder_buffer_entry {
 	uint16_t num_fragments;		/**< Number of packet fragments */
 	uint16_t fragment_index;	/**< Points to the oldest valid frag */
-	uint8_t ready;			/**< Entry is ready to be reordered */
+	RTE_ATOMIC(uint8_t) ready;	/**< Entry is ready to be reordered */
 	struct rte_event fragments[SW_FRAGMENTS_MAX];
 };
 
@@ -173,6 +184,10 @@ struct sw_port {
 	alignas(RTE_CACHE_LINE_SIZE) struct rte_event_ring *rx_worker_ring;
 	/** Ring and buffer for pushing packets to workers after scheduling */
 	struct rte_event_ring *cq_worker_ring;
+	/** Ring handing pulled events from the ingress to the egress stage of
+	 * the scheduler, only used with sched_mt
+	 */
+	struct rte_event_ring *sched_ring;
 
 	/* hole */
 
@@ -193,7 +208,7 @@ struct sw_port {
 	/* History list structs, containing info on pkts egressed to worker */
 	alignas(RTE_CACHE_LINE_SIZE) uint16_t hist_head;
 	uint16_t hist_tail;
-	uint16_t inflights;
+	RTE_ATOMIC(uint16_t) inflights;
 	struct sw_hist_list_entry hist_list[SW_PORT_HIST_LIST];
 
 	/* track packets in and out of this port */
@@ -226,6 +241,8 @@ struct sw_evdev {
 	uint32_t sched_deq_burst_size;
 	/* Refill pp buffers only once per scheduler call*/
 	uint32_t refill_once_per_iter;
+	/* Run ingress and egress scheduler stages on separate cores */
+	uint32_t sched_mt;
 	/* Current values */
 	uint32_t sched_flush_count;
 	uint32_t sched_min_burst;
@@ -274,6 +291,10 @@ struct sw_evdev {
 
 	uint32_t service_id;
 	char service_name[SW_PMD_NAME_MAX];
+
+	/* Held by the service core running each stage, with sched_mt */
+	alignas(RTE_CACHE_LINE_SIZE) rte_spinlock_t sched_ingress_lock;
+	rte_spinlock_t sched_egress_lock;
 };
 
 static inline struct sw_evdev *
@@ -296,6 +317,7 @@ uint16_t sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
 uint16_t sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 			uint64_t wait);
 int32_t sw_event_schedule(struct rte_eventdev *dev);
+int32_t sw_event_schedule_mt(struct rte_eventdev *dev);
 int sw_xstats_init(struct sw_evdev *dev);
 int sw_xstats_uninit(struct sw_evdev *dev);
 int sw_xstats_get_names(const struct rte_eventdev *dev,
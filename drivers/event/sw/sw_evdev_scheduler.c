@@ -27,14 +27,147 @@
 /* use cheap bit mixing, we only need to lose a few bits */
 #define SW_HASH_FLOWID(f) (((f) ^ (f >> 10)) & FLOWID_MASK)
 
+/* With sched_mt the ingress stage (pulling from ports, completing events)
+ * and the egress stage (scheduling IQs to CQs) may run on different service
+ * cores. The port inflight counts, the flow pinning state and the reorder
+ * buffer ready flags are the only state written by both stages; the "mt"
+ * argument of the helpers below is a compile time constant selecting the
+ * thread-safe variant.
+ */
+static __rte_always_inline uint16_t
+sw_port_inflights(struct sw_port *p)
+{
+	return rte_atomic_load_explicit(&p->inflights,
+			rte_memory_order_relaxed);
+}
+
+static __rte_always_inline void
+sw_port_inflights_add(struct sw_port *p, uint16_t n, int mt)
+{
+	if (mt)
+		rte_atomic_fetch_add_explicit(&p->inflights, n,
+				rte_memory_order_relaxed);
+	else
+		rte_atomic_store_explicit(&p->inflights,
+				sw_port_inflights(p) + n,
+				rte_memory_order_relaxed);
+}
+
+static __rte_always_inline void
+sw_port_inflights_sub(struct sw_port *p, uint16_t n, int mt)
+{
+	if (mt)
+		rte_atomic_fetch_sub_explicit(&p->inflights, n,
+				rte_memory_order_relaxed);
+	else
+		rte_atomic_store_explicit(&p->inflights,
+				sw_port_inflights(p) - n,
+				rte_memory_order_relaxed);
+}
+
+static __rte_always_inline int
+sw_cq_full(struct sw_evdev *sw, uint32_t cq)
+{
+	return sw->cq_ring_space[cq] == 0 ||
+			sw_port_inflights(&sw->ports[cq]) == SW_PORT_HIST_LIST;
+}
+
+static __rte_always_inline int
+sw_atomic_pick_cq(struct sw_evdev *sw, struct sw_qid * const qid)
+{
+	uint32_t cq_idx;
+	int cq;
+
+	if (qid->cq_next_tx >= qid->cq_num_mapped_cqs)
+		qid->cq_next_tx = 0;
+	cq_idx = qid->cq_next_tx++;
+
+	cq = qid->cq_map[cq_idx];
+
+	/* find least used */
+	int cq_free_cnt = sw->cq_ring_space[cq];
+	for (cq_idx = 0; cq_idx < qid->cq_num_mapped_cqs; cq_idx++) {
+		int test_cq = qid->cq_map[cq_idx];
+		int test_cq_free = sw->cq_ring_space[test_cq];
+		if (test_cq_free > cq_free_cnt) {
+			cq = test_cq;
+			cq_free_cnt = test_cq_free;
+		}
+	}
+
+	return cq;
+}
+
+/* Pin a flow to a CQ, and count one more of its events in flight if that CQ
+ * has room. Returns the CQ to use, or -1 if the event has to wait.
+ */
+static __rte_always_inline int
+sw_fid_pin(struct sw_evdev *sw, struct sw_qid * const qid,
+		struct sw_fid_t *fid, int mt)
+{
+	struct sw_fid_t old, new;
+	int blocked;
+
+	if (!mt) {
+		int cq = fid->cq;
+
+		if (cq < 0) {
+			cq = sw_atomic_pick_cq(sw, qid);
+			fid->cq = cq; /* this pins early */
+		}
+		if (sw_cq_full(sw, cq))
+			return -1;
+		fid->pcount++;
+		return cq;
+	}
 
-static inline uint32_t
+	/* The ingress stage may concurrently complete the last event in
+	 * flight and unpin the flow, so pin and count in a single CAS.
+	 */
+	old.val = rte_atomic_load_explicit(&fid->state,
+			rte_memory_order_relaxed);
+	do {
+		new.cq = old.cq < 0 ? sw_atomic_pick_cq(sw, qid) : old.cq;
+		blocked = sw_cq_full(sw, new.cq);
+		new.pcount = old.pcount + !blocked;
+	} while (!rte_atomic_compare_exchange_weak_explicit(&fid->state,
+			&old.val, new.val, rte_memory_order_relaxed,
+			rte_memory_order_relaxed));
+
+	return blocked ? -1 : new.cq;
+}
+
+static __rte_always_inline void
+sw_fid_complete(struct sw_fid_t *fid, uint32_t eop, int mt)
+{
+	struct sw_fid_t old, new;
+
+	if (!mt) {
+		fid->pcount -= eop;
+		if (fid->pcount == 0)
+			fid->cq = -1;
+		return;
+	}
+
+	old.val = rte_atomic_load_explicit(&fid->state,
+			rte_memory_order_relaxed);
+	do {
+		new.pcount = old.pcount - eop;
+		new.cq = new.pcount == 0 ? -1 : old.cq;
+	} while (!rte_atomic_compare_exchange_weak_explicit(&fid->state,
+			&old.val, new.val, rte_memory_order_relaxed,
+			rte_memory_order_relaxed));
+}
+
+
+static __rte_always_inline uint32_t
 sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count)
+		uint32_t iq_num, unsigned int count, int mt)
 {
 	struct rte_event qes[MAX_PER_IQ_DEQUEUE]; /* count <= MAX */
 	struct rte_event blocked_qes[MAX_PER_IQ_DEQUEUE];
 	uint32_t nb_blocked = 0;
+	uint64_t blocked_fids = 0;
 	uint32_t i;
 
 	if (count > MAX_PER_IQ_DEQUEUE)
@@ -50,33 +183,19 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 		const struct rte_event *qe = &qes[i];
 		const uint16_t flow_id = SW_HASH_FLOWID(qes[i].flow_id);
 		struct sw_fid_t *fid = &qid->fids[flow_id];
-		int cq = fid->cq;
+		const uint64_t fid_bit = RTE_BIT64(flow_id % 64);
+		int cq = -1;
 
-		if (cq < 0) {
-			uint32_t cq_idx;
-			if (qid->cq_next_tx >= qid->cq_num_mapped_cqs)
-				qid->cq_next_tx = 0;
-			cq_idx = qid->cq_next_tx++;
-
-			cq = qid->cq_map[cq_idx];
-
-			/* find least used */
-			int cq_free_cnt = sw->cq_ring_space[cq];
-			for (cq_idx = 0; cq_idx < qid->cq_num_mapped_cqs;
-					cq_idx++) {
-				int test_cq = qid->cq_map[cq_idx];
-				int test_cq_free = sw->cq_ring_space[test_cq];
-				if (test_cq_free > cq_free_cnt) {
-					cq = test_cq;
-					cq_free_cnt = test_cq_free;
-				}
-			}
-
-			fid->cq = cq; /* this pins early */
-		}
+		/* With sched_mt, the ingress stage may unpin a blocked flow
+		 * before the end of the burst, so keep its later events
+		 * behind the blocked ones.
+		 */
+		if (!(blocked_fids & fid_bit))
+			cq = sw_fid_pin(sw, qid, fid, mt);
 
-		if (sw->cq_ring_space[cq] == 0 ||
-				sw->ports[cq].inflights == SW_PORT_HIST_LIST) {
+		if (cq < 0) {
+			if (mt)
+				blocked_fids |= fid_bit;
 			blocked_qes[nb_blocked++] = *qe;
 			continue;
 		}
@@ -84,9 +203,7 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 		struct sw_port *p = &sw->ports[cq];
 
 		/* at this point we can queue up the packet on the cq_buf */
-		fid->pcount++;
 		p->cq_buf[p->cq_buf_count++] = *qe;
-		p->inflights++;
 		sw->cq_ring_space[cq]--;
 
 		int head = (p->hist_head++ & (SW_PORT_HIST_LIST-1));
@@ -94,6 +211,7 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			.qid = qid_id,
 			.fid = flow_id,
 		};
+		sw_port_inflights_add(p, 1, mt);
 
 		p->stats.tx_pkts++;
 		qid->stats.tx_pkts++;
@@ -113,9 +231,9 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	return count - nb_blocked;
 }
 
-static inline uint32_t
+static __rte_always_inline uint32_t
 sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count, int keep_order)
+		uint32_t iq_num, unsigned int count, int keep_order, int mt)
 {
 	uint32_t i;
 	uint32_t cq_idx = qid->cq_next_tx;
@@ -150,13 +268,13 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 				cq_idx = 0;
 			cq = qid->cq_map[cq_idx++];
 
-		} while (sw->ports[cq].inflights == SW_PORT_HIST_LIST ||
+		} while (sw_port_inflights(&sw->ports[cq]) ==
+					SW_PORT_HIST_LIST ||
 				rte_event_ring_free_count(
 					sw->ports[cq].cq_worker_ring) == 0);
 
 		struct sw_port *p = &sw->ports[cq];
-		if (sw->cq_ring_space[cq] == 0 ||
-				p->inflights == SW_PORT_HIST_LIST)
+		if (sw_cq_full(sw, cq))
 			break;
 
 		sw->cq_ring_space[cq]--;
@@ -177,7 +295,7 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 		iq_pop(sw, &qid->iq[iq_num]);
 
 		rte_compiler_barrier();
-		p->inflights++;
+		sw_port_inflights_add(p, 1, mt);
 		p->stats.tx_pkts++;
 		p->hist_head++;
 	}
@@ -214,8 +332,8 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	return ret;
 }
 
-static uint32_t
-sw_schedule_qid_to_cq(struct sw_evdev *sw)
+static __rte_always_inline uint32_t
+sw_schedule_qid_to_cq(struct sw_evdev *sw, int mt)
 {
 	uint32_t pkts = 0;
 	uint32_t qid_idx;
@@ -241,11 +359,11 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
 						iq_num, count);
 			else if (type == RTE_SCHED_TYPE_ATOMIC)
 				pkts_done += sw_schedule_atomic_to_cq(sw, qid,
-						iq_num, count);
+						iq_num, count, mt);
 			else
 				pkts_done += sw_schedule_parallel_to_cq(sw, qid,
 						iq_num, count,
-						type == RTE_SCHED_TYPE_ORDERED);
+						type == RTE_SCHED_TYPE_ORDERED, mt);
 		}
 
 		/* Check if the IQ that was polled is now empty, and unset it
@@ -264,8 +382,8 @@ sw_schedule_qid_to_cq(struct sw_evdev *sw)
  * the appropriate QID IQ. As LB and DIR QIDs are in the same array, but *NOT*
  * contiguous in that array, this function accepts a "range" of QIDs to scan.
  */
-static uint16_t
-sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
+static __rte_always_inline uint16_t
+sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end, int mt)
 {
 	/* Perform egress reordering */
 	struct rte_event *qe;
@@ -290,7 +408,12 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 
 			entry = &qid->reorder_buffer[qid->reorder_buffer_index];
 
-			if (!entry->ready)
+			/* pairs with the release in __pull_port_lb(): the
+			 * fragments are visible once the entry is ready
+			 */
+			if (!rte_atomic_load_explicit(&entry->ready, mt ?
+					rte_memory_order_acquire :
+					rte_memory_order_relaxed))
 				break;
 
 			for (j = 0; j < entry->num_fragments; j++) {
@@ -322,11 +445,13 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 				q->stats.rx_pkts++;
 			}
 
-			entry->ready = (j != entry->num_fragments);
+			const uint8_t ready = (j != entry->num_fragments);
+			rte_atomic_store_explicit(&entry->ready, ready,
+					rte_memory_order_relaxed);
 			entry->num_fragments -= j;
 			entry->fragment_index += j;
 
-			if (!entry->ready) {
+			if (!ready) {
 				entry->fragment_index = 0;
 
 				rob_ring_enqueue(
@@ -342,29 +467,55 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 }
 
 static __rte_always_inline void
-sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
+sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port, int mt)
 {
-	RTE_SET_USED(sw);
 	struct rte_event_ring *worker = port->rx_worker_ring;
+	uint32_t burst = sw->sched_deq_burst_size;
+
+	/* only pull what the egress stage is guaranteed to take */
+	if (mt)
+		burst = RTE_MIN(burst,
+				rte_event_ring_free_count(port->sched_ring));
+
 	port->pp_buf_start = 0;
 	port->pp_buf_count = rte_event_ring_dequeue_burst(worker, port->pp_buf,
-			sw->sched_deq_burst_size, NULL);
+			burst, NULL);
+}
+
+/* Pass the events compacted at the head of pp_buf to the egress stage. The
+ * ring can't be full: the refill was capped to its free space.
+ */
+static __rte_always_inline void
+sw_handoff_pp_buf(struct sw_port *port, uint32_t count)
+{
+	if (count)
+		rte_event_ring_enqueue_burst(port->sched_ring, port->pp_buf,
+				count, NULL);
 }
 
 static __rte_always_inline uint32_t
-__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
+__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder,
+		int mt)
 {
 	static struct reorder_buffer_entry dummy_rob;
 	uint32_t pkts_iter = 0;
+	uint32_t nb_handoff = 0;
 	struct sw_port *port = &sw->ports[port_id];
 
 	/* If shadow ring has 0 pkts, pull from worker ring */
 	if (!sw->refill_once_per_iter && port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+		sw_refill_pp_buf(sw, port, mt);
+
+	/* Completions are accounted locally and published once; the egress
+	 * stage only ever sees an inflight count higher than the real one.
+	 */
+	const uint16_t inflights_start = sw_port_inflights(port);
+	uint16_t inflights = inflights_start;
 
 	while (port->pp_buf_count) {
 		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
 		struct sw_hist_list_entry *hist_entry = NULL;
+		struct reorder_buffer_entry *rob_done = NULL;
 		uint8_t flags = qe->op;
 		const uint16_t eop = !(flags & QE_FLAG_NOT_EOP);
 		int needs_reorder = 0;
@@ -380,7 +531,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 		 * valid flag. This makes FWD and PARTIAL enqueues just
 		 * NEW type, and makes DROPS no-op calls.
 		 */
-		if ((flags & QE_FLAG_COMPLETE) && port->inflights > 0) {
+		if ((flags & QE_FLAG_COMPLETE) && inflights > 0) {
 			const uint32_t hist_tail = port->hist_tail &
 					(SW_PORT_HIST_LIST - 1);
 
@@ -390,24 +541,23 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 
 			struct sw_fid_t *fid =
 				&sw->qids[hist_qid].fids[hist_fid];
-			fid->pcount -= eop;
-			if (fid->pcount == 0)
-				fid->cq = -1;
+			sw_fid_complete(fid, eop, mt);
 
 			if (allow_reorder) {
-				/* set reorder ready if an ordered QID */
+				/* set reorder ready if an ordered QID, once
+				 * the fragment below has been stored
+				 */
 				uintptr_t rob_ptr =
 					(uintptr_t)hist_entry->rob_entry;
 				const uintptr_t valid = (rob_ptr != 0);
 				needs_reorder = valid;
 				rob_ptr |=
 					((valid - 1) & (uintptr_t)&dummy_rob);
-				struct reorder_buffer_entry *tmp_rob_ptr =
+				rob_done =
 					(struct reorder_buffer_entry *)rob_ptr;
-				tmp_rob_ptr->ready = eop * needs_reorder;
 			}
 
-			port->inflights -= eop;
+			inflights -= eop;
 			port->hist_tail += eop;
 		}
 		if (flags & QE_FLAG_VALID) {
@@ -429,6 +579,21 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 					int idx = rob_entry->num_fragments++;
 					rob_entry->fragments[idx] = *qe;
 				}
+				/* the reorder stage runs in the egress
+				 * stage, count the event as received here
+				 */
+				pkts_iter += mt;
+				goto end_qe;
+			}
+
+			pkts_iter++;
+
+			/* The egress stage owns the IQs, hand it the QE.
+			 * pp_buf is compacted in place: nb_handoff never
+			 * passes pp_buf_start.
+			 */
+			if (mt) {
+				port->pp_buf[nb_handoff++] = *qe;
 				goto end_qe;
 			}
 
@@ -440,38 +605,47 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 			iq_enqueue(sw, &qid->iq[iq_num], qe);
 			qid->iq_pkt_count[iq_num]++;
 			qid->stats.rx_pkts++;
-			pkts_iter++;
 		}
 
 end_qe:
+		if (allow_reorder && rob_done != NULL)
+			rte_atomic_store_explicit(&rob_done->ready,
+					eop * needs_reorder, mt ?
+					rte_memory_order_release :
+					rte_memory_order_relaxed);
+
 		port->pp_buf_start++;
 		port->pp_buf_count--;
 	} /* while (avail_qes) */
 
+	if (mt)
+		sw_handoff_pp_buf(port, nb_handoff);
+	sw_port_inflights_sub(port, inflights_start - inflights, mt);
+
 	return pkts_iter;
 }
 
 static uint32_t
 sw_schedule_pull_port_lb(struct sw_evdev *sw, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 1);
+	return __pull_port_lb(sw, port_id, 1, 0);
 }
 
 static uint32_t
 sw_schedule_pull_port_no_reorder(struct sw_evdev *sw, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 0);
+	return __pull_port_lb(sw, port_id, 0, 0);
 }
 
-static uint32_t
-sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+static __rte_always_inline uint32_t
+__pull_port_dir(struct sw_evdev *sw, uint32_t port_id, int mt)
 {
 	uint32_t pkts_iter = 0;
 	struct sw_port *port = &sw->ports[port_id];
 
 	/* If shadow ring has 0 pkts, pull from worker ring */
 	if (!sw->refill_once_per_iter && port->pp_buf_count == 0)
-		sw_refill_pp_buf(sw, port);
+		sw_refill_pp_buf(sw, port, mt);
 
 	while (port->pp_buf_count) {
 		const struct rte_event *qe = &port->pp_buf[port->pp_buf_start];
@@ -486,6 +660,12 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 
 		port->stats.rx_pkts++;
 
+		/* hand the QE to the egress stage, see __pull_port_lb() */
+		if (mt) {
+			port->pp_buf[pkts_iter++] = *qe;
+			goto end_qe;
+		}
+
 		/* Use the iq_num from above to push the QE
 		 * into the qid at the right priority
 		 */
@@ -500,9 +680,100 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 		port->pp_buf_count--;
 	} /* while port->pp_buf_count */
 
+	if (mt)
+		sw_handoff_pp_buf(port, pkts_iter);
+
 	return pkts_iter;
 }
 
+static uint32_t
+sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+{
+	return __pull_port_dir(sw, port_id, 0);
+}
+
+/* Egress stage counterpart of the port pulls: move the events handed over
+ * by the ingress stage into the IQs of their QIDs.
+ */
+static uint32_t
+sw_schedule_pull_handoff(struct sw_evdev *sw, struct sw_port *port)
+{
+	struct rte_event qes[SCHED_DEQUEUE_MAX_BURST_SIZE];
+	uint32_t i, n;
+
+	n = rte_event_ring_dequeue_burst(port->sched_ring, qes,
+			sw->sched_deq_burst_size, NULL);
+
+	for (i = 0; i < n; i++) {
+		const struct rte_event *qe = &qes[i];
+		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
+		struct sw_qid *qid = &sw->qids[qe->queue_id];
+
+		qid->iq_pkt_mask |= (1 << (iq_num));
+		iq_enqueue(sw, &qid->iq[iq_num], qe);
+		qid->iq_pkt_count[iq_num]++;
+		qid->stats.rx_pkts++;
+	}
+
+	return n;
+}
+
+/* Push all the internal buffered QEs in port->cq_ring to the worker cores:
+ * aka, do the ring transfers batched.
+ */
+static __rte_always_inline void
+sw_schedule_flush_cqs(struct sw_evdev *sw, int mt)
+{
+	uint64_t cqs_scheds_last_iter = 0;
+	int no_enq = 1;
+	uint32_t i;
+
+	for (i = 0; i < sw->port_count; i++) {
+		struct sw_port *port = &sw->ports[i];
+		struct rte_event_ring *worker = port->cq_worker_ring;
+
+		/* If shadow ring has 0 pkts, pull from worker ring. With
+		 * sched_mt, the ingress stage refills on its own.
+		 */
+		if (!mt && sw->refill_once_per_iter && port->pp_buf_count == 0)
+			sw_refill_pp_buf(sw, port, mt);
+
+		if (port->cq_buf_count >= sw->sched_min_burst) {
+			rte_event_ring_enqueue_burst(worker,
+					port->cq_buf,
+					port->cq_buf_count,
+					&sw->cq_ring_space[i]);
+			port->cq_buf_count = 0;
+			no_enq = 0;
+			cqs_scheds_last_iter |= (1ULL << i);
+		} else {
+			sw->cq_ring_space[i] =
+					rte_event_ring_free_count(worker) -
+					port->cq_buf_count;
+		}
+	}
+
+	if (no_enq) {
+		if (unlikely(sw->sched_flush_count > SCHED_NO_ENQ_CYCLE_FLUSH))
+			sw->sched_min_burst = 1;
+		else
+			sw->sched_flush_count++;
+	} else {
+		if (sw->sched_flush_count)
+			sw->sched_flush_count--;
+		else
+			sw->sched_min_burst = sw->sched_min_burst_size;
+	}
+
+	/* Provide stats on what eventdev ports were scheduled to this
+	 * iteration. If more than 64 ports are active, always report that
+	 * all Eventdev ports have been scheduled events.
+	 */
+	sw->sched_last_iter_bitmask = cqs_scheds_last_iter;
+	if (unlikely(sw->port_count >= 64))
+		sw->sched_last_iter_bitmask = UINT64_MAX;
+}
+
 int32_t
 sw_event_schedule(struct rte_eventdev *dev)
 {
@@ -537,12 +808,12 @@ sw_event_schedule(struct rte_eventdev *dev)
 
 			/* QID scan for re-ordered */
 			in_pkts += sw_schedule_reorder(sw, 0,
-					sw->qid_count);
+					sw->qid_count, 0);
 			in_pkts_this_iteration += in_pkts;
 		} while (in_pkts > 4 &&
 				(int)in_pkts_this_iteration < sched_quanta);
 
-		out_pkts = sw_schedule_qid_to_cq(sw);
+		out_pkts = sw_schedule_qid_to_cq(sw, 0);
 		out_pkts_total += out_pkts;
 		in_pkts_total += in_pkts_this_iteration;
 
@@ -559,54 +830,112 @@ sw_event_schedule(struct rte_eventdev *dev)
 	uint64_t work_done = (in_pkts_total + out_pkts_total) != 0;
 	sw->sched_progress_last_iter = work_done;
 
-	uint64_t cqs_scheds_last_iter = 0;
+	sw_schedule_flush_cqs(sw, 0);
 
-	/* push all the internal buffered QEs in port->cq_ring to the
-	 * worker cores: aka, do the ring transfers batched.
-	 */
-	int no_enq = 1;
-	for (i = 0; i < sw->port_count; i++) {
-		struct sw_port *port = &sw->ports[i];
-		struct rte_event_ring *worker = port->cq_worker_ring;
+	return work_done ? 0 : -EAGAIN;
+}
 
-		/* If shadow ring has 0 pkts, pull from worker ring */
-		if (sw->refill_once_per_iter && port->pp_buf_count == 0)
-			sw_refill_pp_buf(sw, port);
+/* Ingress stage of the split scheduler: pull events from the ports, complete
+ * the events they release and hand the new ones to the egress stage.
+ */
+static uint32_t
+sw_schedule_ingress(struct sw_evdev *sw)
+{
+	uint32_t in_pkts, in_pkts_total = 0;
+	int32_t sched_quanta = sw->sched_quanta;
+	uint32_t i;
 
-		if (port->cq_buf_count >= sw->sched_min_burst) {
-			rte_event_ring_enqueue_burst(worker,
-					port->cq_buf,
-					port->cq_buf_count,
-					&sw->cq_ring_space[i]);
-			port->cq_buf_count = 0;
-			no_enq = 0;
-			cqs_scheds_last_iter |= (1ULL << i);
-		} else {
-			sw->cq_ring_space[i] =
-					rte_event_ring_free_count(worker) -
-					port->cq_buf_count;
+	do {
+		in_pkts = 0;
+		for (i = 0; i < sw->port_count; i++) {
+			if (sw->ports[i].is_directed)
+				in_pkts += __pull_port_dir(sw, i, 1);
+			else if (sw->ports[i].num_ordered_qids > 0)
+				in_pkts += __pull_port_lb(sw, i, 1, 1);
+			else
+				in_pkts += __pull_port_lb(sw, i, 0, 1);
 		}
+		in_pkts_total += in_pkts;
+	} while (in_pkts > 4 && (int)in_pkts_total < sched_quanta);
+
+	if (sw->refill_once_per_iter) {
+		for (i = 0; i < sw->port_count; i++)
+			if (sw->ports[i].pp_buf_count == 0)
+				sw_refill_pp_buf(sw, &sw->ports[i], 1);
 	}
 
-	if (no_enq) {
-		if (unlikely(sw->sched_flush_count > SCHED_NO_ENQ_CYCLE_FLUSH))
-			sw->sched_min_burst = 1;
-		else
-			sw->sched_flush_count++;
-	} else {
-		if (sw->sched_flush_count)
-			sw->sched_flush_count--;
-		else
-			sw->sched_min_burst = sw->sched_min_burst_size;
+	sw->stats.rx_pkts += in_pkts_total;
+	sw->sched_no_iq_enqueues += (in_pkts_total == 0);
+
+	return in_pkts_total;
+}
+
+/* Egress stage of the split scheduler: fill the IQs from the ingress stage
+ * and the reorder buffers, then schedule them to the CQs.
+ */
+static uint32_t
+sw_schedule_egress(struct sw_evdev *sw)
+{
+	uint32_t in_pkts, out_pkts;
+	uint32_t out_pkts_total = 0, in_pkts_total = 0;
+	int32_t sched_quanta = sw->sched_quanta;
+	uint32_t i;
+
+	sw->sched_called++;
+
+	do {
+		in_pkts = 0;
+		for (i = 0; i < sw->port_count; i++) {
+			/* ack the unlinks in progress as done */
+			if (sw->ports[i].unlinks_in_progress)
+				sw->ports[i].unlinks_in_progress = 0;
+
+			in_pkts += sw_schedule_pull_handoff(sw, &sw->ports[i]);
+		}
+
+		/* QID scan for re-ordered */
+		in_pkts += sw_schedule_reorder(sw, 0, sw->qid_count, 1);
+
+		out_pkts = sw_schedule_qid_to_cq(sw, 1);
+		out_pkts_total += out_pkts;
+		in_pkts_total += in_pkts;
+
+		if (in_pkts == 0 && out_pkts == 0)
+			break;
+	} while ((int)out_pkts_total < sched_quanta);
+
+	sw->stats.tx_pkts += out_pkts_total;
+	sw->sched_no_cq_enqueues += (out_pkts_total == 0);
+	sw->sched_progress_last_iter = (in_pkts_total + out_pkts_total) != 0;
+
+	sw_schedule_flush_cqs(sw, 1);
+
+	return in_pkts_total + out_pkts_total;
+}
+
+/* Scheduler entry point with sched_mt. Each stage is run by at most one core
+ * at a time: a service core that finds a stage busy moves on to the other,
+ * so mapping the service to two cores runs the stages in parallel, while a
+ * single core runs them back to back.
+ */
+int32_t
+sw_event_schedule_mt(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t work = 0;
+
+	if (unlikely(!sw->started))
+		return -EAGAIN;
+
+	if (rte_spinlock_trylock(&sw->sched_ingress_lock)) {
+		work += sw_schedule_ingress(sw);
+		rte_spinlock_unlock(&sw->sched_ingress_lock);
 	}
 
-	/* Provide stats on what eventdev ports were scheduled to this
-	 * iteration. If more than 64 ports are active, always report that
-	 * all Eventdev ports have been scheduled events.
-	 */
-	sw->sched_last_iter_bitmask = cqs_scheds_last_iter;
-	if (unlikely(sw->port_count >= 64))
-		sw->sched_last_iter_bitmask = UINT64_MAX;
+	if (rte_spinlock_trylock(&sw->sched_egress_lock)) {
+		work += sw_schedule_egress(sw);
+		rte_spinlock_unlock(&sw->sched_egress_lock);
+	}
 
-	return work_done ? 0 : -EAGAIN;
+	return work ? 0 : -EAGAIN;
 }
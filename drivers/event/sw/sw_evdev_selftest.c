@@ -3303,6 +3303,220 @@ worker_loopback(struct test *t, uint8_t disable_implicit_release)
 	return 0;
 }
 
+#define SCHED_MT_EVENTS (1 << 14)
+#define SCHED_MT_FLOWS 8
+#define SCHED_MT_BURST 16
+
+static RTE_ATOMIC(uint32_t) sched_mt_stop;
+static uint32_t sched_mt_service_id;
+
+static int
+sched_mt_service_fn(void *arg __rte_unused)
+{
+	while (!rte_atomic_load_explicit(&sched_mt_stop,
+			rte_memory_order_acquire))
+		rte_service_run_iter_on_app_lcore(sched_mt_service_id, 0);
+
+	return 0;
+}
+
+static int
+sched_mt_release(uint8_t port, uint16_t n)
+{
+	struct rte_event ev[SCHED_MT_BURST];
+	uint16_t i, enq = 0;
+
+	for (i = 0; i < n; i++)
+		ev[i] = release_ev;
+	while (enq < n)
+		enq += rte_event_enqueue_burst(evdev, port, &ev[enq], n - enq);
+
+	return 0;
+}
+
+static int
+sched_mt_run(struct test *t)
+{
+	const uint8_t rx_port = 0;
+	const uint8_t w1_port = 1;
+	const uint8_t w2_port = 2;
+	const uint8_t tx1_port = 3;
+	const uint8_t tx2_port = 4;
+	struct rte_event w1_ev[SCHED_MT_BURST], w2_ev[SCHED_MT_BURST];
+	struct rte_event tx1_ev[SCHED_MT_BURST], tx2_ev[SCHED_MT_BURST];
+	uint64_t expected[SCHED_MT_FLOWS];
+	bool tx1_held[SCHED_MT_FLOWS];
+	uint64_t sent = 0, received = 0;
+	uint64_t deadline;
+	uint16_t n1, n2, i, enq;
+
+	/*
+	 * Two stages, run by two scheduler cores. The reorder of the
+	 * ordered qid0 must restore the enqueue order, which is checked per
+	 * flow after the atomic qid1, and a flow of qid1 must never be held
+	 * by the two tx ports at the same time.
+	 *
+	 * rx_port - qid0 - w1_port, w2_port - qid1 - tx1_port, tx2_port
+	 */
+	if (init(t, 2, tx2_port + 1) < 0 ||
+			create_ports(t, tx2_port + 1) < 0 ||
+			create_ordered_qids(t, 1) < 0 ||
+			create_atomic_qids(t, 1) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	for (i = w1_port; i <= tx2_port; i++) {
+		uint8_t qid = i <= w2_port ? t->qid[0] : t->qid[1];
+
+		if (rte_event_port_link(evdev, t->port[i], &qid, NULL, 1) != 1) {
+			printf("%d: error mapping lb qid\n", __LINE__);
+			return -1;
+		}
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < SCHED_MT_FLOWS; i++)
+		expected[i] = i;
+
+	deadline = rte_get_timer_cycles() + 10 * rte_get_timer_hz();
+	while (received < SCHED_MT_EVENTS) {
+		if (rte_get_timer_cycles() > deadline) {
+			printf("%d: timeout, sent %"PRIu64" received %"PRIu64"\n",
+					__LINE__, sent, received);
+			rte_event_dev_dump(evdev, stdout);
+			return -1;
+		}
+
+		for (i = 0; i < SCHED_MT_BURST && sent < SCHED_MT_EVENTS; i++) {
+			struct rte_event ev = {
+				.op = RTE_EVENT_OP_NEW,
+				.queue_id = t->qid[0],
+				.sched_type = RTE_SCHED_TYPE_ORDERED,
+				.event_type = RTE_EVENT_TYPE_CPU,
+				.flow_id = sent % SCHED_MT_FLOWS,
+				.u64 = sent,
+			};
+
+			if (rte_event_enqueue_burst(evdev, t->port[rx_port],
+					&ev, 1) != 1)
+				break;
+			sent++;
+		}
+
+		/* forward in reverse order of dequeue, so qid0 reorders */
+		n1 = rte_event_dequeue_burst(evdev, t->port[w1_port], w1_ev,
+				SCHED_MT_BURST, 0);
+		n2 = rte_event_dequeue_burst(evdev, t->port[w2_port], w2_ev,
+				SCHED_MT_BURST, 0);
+		for (i = 0; i < n1; i++) {
+			w1_ev[i].op = RTE_EVENT_OP_FORWARD;
+			w1_ev[i].queue_id = t->qid[1];
+			w1_ev[i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+		}
+		for (i = 0; i < n2; i++) {
+			w2_ev[i].op = RTE_EVENT_OP_FORWARD;
+			w2_ev[i].queue_id = t->qid[1];
+			w2_ev[i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+		}
+		for (enq = 0; enq < n2; )
+			enq += rte_event_enqueue_burst(evdev, t->port[w2_port],
+					&w2_ev[enq], n2 - enq);
+		for (enq = 0; enq < n1; )
+			enq += rte_event_enqueue_burst(evdev, t->port[w1_port],
+					&w1_ev[enq], n1 - enq);
+
+		/* hold the events of both tx ports before releasing them */
+		n1 = rte_event_dequeue_burst(evdev, t->port[tx1_port], tx1_ev,
+				SCHED_MT_BURST, 0);
+		n2 = rte_event_dequeue_burst(evdev, t->port[tx2_port], tx2_ev,
+				SCHED_MT_BURST, 0);
+
+		memset(tx1_held, 0, sizeof(tx1_held));
+		for (i = 0; i < n1; i++)
+			tx1_held[tx1_ev[i].flow_id] = true;
+		for (i = 0; i < n2; i++) {
+			if (tx1_held[tx2_ev[i].flow_id]) {
+				printf("%d: flow %u held by two ports\n",
+						__LINE__, tx2_ev[i].flow_id);
+				return -1;
+			}
+		}
+
+		for (i = 0; i < n1 + n2; i++) {
+			const struct rte_event *ev = i < n1 ?
+					&tx1_ev[i] : &tx2_ev[i - n1];
+
+			if (ev->u64 != expected[ev->flow_id]) {
+				printf("%d: flow %u: got event %"PRIu64
+						", expected %"PRIu64"\n",
+						__LINE__, ev->flow_id, ev->u64,
+						expected[ev->flow_id]);
+				return -1;
+			}
+			expected[ev->flow_id] += SCHED_MT_FLOWS;
+		}
+		received += n1 + n2;
+
+		sched_mt_release(t->port[tx1_port], n1);
+		sched_mt_release(t->port[tx2_port], n2);
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+/* Run the split scheduler of a sched_mt device on two service cores. */
+static int
+sched_mt(struct test *t)
+{
+	const char *eventdev_name = "event_sw_mt";
+	const int main_evdev = evdev;
+	unsigned int lcores[2];
+	unsigned int i;
+	int ret;
+
+	if (rte_vdev_init(eventdev_name, "sched_mt=1") < 0) {
+		printf("%d: Error creating eventdev\n", __LINE__);
+		return -1;
+	}
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0 ||
+			rte_event_dev_service_id_get(evdev,
+				&sched_mt_service_id) < 0) {
+		printf("%d: Error finding sched_mt eventdev\n", __LINE__);
+		evdev = main_evdev;
+		rte_vdev_uninit(eventdev_name);
+		return -1;
+	}
+	rte_service_runstate_set(sched_mt_service_id, 1);
+	rte_service_set_runstate_mapped_check(sched_mt_service_id, 0);
+
+	rte_atomic_store_explicit(&sched_mt_stop, 0, rte_memory_order_relaxed);
+	lcores[0] = rte_get_next_lcore(-1, 1, 0);
+	lcores[1] = rte_get_next_lcore(lcores[0], 1, 0);
+	for (i = 0; i < RTE_DIM(lcores); i++)
+		rte_eal_remote_launch(sched_mt_service_fn, NULL, lcores[i]);
+
+	ret = sched_mt_run(t);
+
+	rte_atomic_store_explicit(&sched_mt_stop, 1, rte_memory_order_release);
+	for (i = 0; i < RTE_DIM(lcores); i++)
+		rte_eal_wait_lcore(lcores[i]);
+
+	if (ret != 0)
+		cleanup(t);
+	rte_service_runstate_set(sched_mt_service_id, 0);
+	rte_vdev_uninit(eventdev_name);
+	evdev = main_evdev;
+
+	return ret;
+}
+
 static struct rte_mempool *eventdev_func_mempool;
 
 int
@@ -3535,8 +3749,15 @@ test_sw_eventdev(void)
 			printf("ERROR - Worker loopback test FAILED.\n");
 			goto test_fail;
 		}
+
+		printf("*** Running Two-stage Scheduler test...\n");
+		ret = sched_mt(t);
+		if (ret != 0) {
+			printf("ERROR - Two-stage Scheduler test FAILED.\n");
+			goto test_fail;
+		}
 	} else {
-		printf("### Not enough cores for worker loopback tests.\n");
+		printf("### Not enough cores for worker loopback and two-stage scheduler tests.\n");
 		printf("### Need at least 3 cores for the tests.\n");
 	}
 
@@ -76,7 +76,8 @@ get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 	case rx: return p->stats.rx_pkts;
 	case tx: return p->stats.tx_pkts;
 	case dropped: return p->stats.rx_dropped;
-	case inflight: return p->inflights;
+	case inflight: return rte_atomic_load_explicit(&p->inflights,
+				rte_memory_order_relaxed);
 	case pkt_cycles: return p->avg_pkt_ticks;
 	case calls: return p->total_polls;
 	case credits: return p->inflight_credits;
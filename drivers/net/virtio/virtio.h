@@ -222,6 +222,8 @@ struct virtio_hw {
 	uint64_t req_guest_features;
 	struct virtnet_ctl *cvq;
 	bool use_va;
+	uint64_t tx_notify_delay; /* max timer cycles a Tx kick is held back */
+	uint32_t tx_notify_delay_us; /* same in microseconds, period of the flush */
 };
 
 struct virtio_ops {
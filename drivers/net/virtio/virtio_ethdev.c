@@ -28,6 +28,7 @@
 #include <dev_driver.h>
 #include <rte_cycles.h>
 #include <rte_kvargs.h>
+#include <rte_alarm.h>
 
 #include "virtio_ethdev.h"
 #include "virtio.h"
@@ -134,6 +135,7 @@ static const struct rte_virtio_xstats_name_off rte_virtio_txq_stat_strings[] = {
 	{"size_512_1023_packets",  offsetof(struct virtnet_tx, stats.size_bins[5])},
 	{"size_1024_1518_packets", offsetof(struct virtnet_tx, stats.size_bins[6])},
 	{"size_1519_max_packets",  offsetof(struct virtnet_tx, stats.size_bins[7])},
+	{"notifications",          offsetof(struct virtnet_tx, stats.notifications)},
 };
 
 #define VIRTIO_NB_RXQ_XSTATS (sizeof(rte_virtio_rxq_stat_strings) / \
@@ -818,6 +820,7 @@ virtio_dev_stats_reset(struct rte_eth_dev *dev)
 		txvq->stats.broadcast = 0;
 		memset(txvq->stats.size_bins, 0,
 		       sizeof(txvq->stats.size_bins[0]) * 8);
+		txvq->stats.notifications = 0;
 	}
 
 	for (i = 0; i < dev->data->nb_rx_queues; i++) {
@@ -2327,6 +2330,27 @@ virtio_dev_configure(struct rte_eth_dev *dev)
 	return 0;
 }
 
+/*
+ * Send the Tx notifications held back on queues which are not polled
+ * anymore, so that the notify_delay latency budget holds when the
+ * traffic stops.
+ */
+static void
+virtio_tx_notify_alarm(void *param)
+{
+	struct rte_eth_dev *dev = param;
+	struct virtio_hw *hw = dev->data->dev_private;
+	uint16_t i;
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++)
+		virtqueue_xmit_timer_notify(
+			virtnet_txq_to_vq(dev->data->tx_queues[i]));
+
+	if (rte_eal_alarm_set(hw->tx_notify_delay_us,
+			      virtio_tx_notify_alarm, dev) < 0)
+		PMD_DRV_LOG(ERR, "Failed to rearm Tx notification alarm");
+}
+
 
 static int
 virtio_dev_start(struct rte_eth_dev *dev)
@@ -2417,6 +2441,11 @@ virtio_dev_start(struct rte_eth_dev *dev)
 	set_rxtx_funcs(dev);
 	hw->started = 1;
 
+	if (hw->tx_notify_delay_us != 0 &&
+			rte_eal_alarm_set(hw->tx_notify_delay_us,
+					  virtio_tx_notify_alarm, dev) < 0)
+		PMD_INIT_LOG(ERR, "Failed to set Tx notification alarm");
+
 	for (i = 0; i < dev->data->nb_rx_queues; i++)
 		dev->data->rx_queue_state[i] = RTE_ETH_QUEUE_STATE_STARTED;
 	for (i = 0; i < dev->data->nb_tx_queues; i++)
@@ -2516,6 +2545,9 @@ virtio_dev_stop(struct rte_eth_dev *dev)
 	PMD_INIT_LOG(DEBUG, "stop");
 	dev->data->dev_started = 0;
 
+	if (hw->tx_notify_delay_us != 0)
+		rte_eal_alarm_cancel(virtio_tx_notify_alarm, dev);
+
 	rte_spinlock_lock(&hw->state_lock);
 	if (!hw->started)
 		goto out_unlock;
@@ -128,7 +128,7 @@ struct vring {
  * versa. They are at the end for backwards compatibility.
  */
 #define vring_used_event(vr)  ((vr)->avail->ring[(vr)->num])
-#define vring_avail_event(vr) (*(uint16_t *)&(vr)->used->ring[(vr)->num])
+#define vring_avail_event(vr) (*(uint16_t *)((vr)->used->ring + (vr)->num))
 
 static inline size_t
 vring_size(struct virtio_hw *hw, unsigned int num, unsigned long align)
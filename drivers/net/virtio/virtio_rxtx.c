@@ -1777,6 +1777,8 @@ virtio_xmit_pkts_packed(void *tx_queue, struct rte_mbuf **tx_pkts,
 	if (unlikely(hw->started == 0 && tx_pkts != hw->inject_pkts))
 		return nb_tx;
 
+	virtqueue_xmit_flush_notify(vq);
+
 	if (unlikely(nb_pkts < 1))
 		return nb_pkts;
 
@@ -1835,12 +1837,8 @@ virtio_xmit_pkts_packed(void *tx_queue, struct rte_mbuf **tx_pkts,
 
 	txvq->stats.packets += nb_tx;
 
-	if (likely(nb_tx)) {
-		if (unlikely(virtqueue_kick_prepare_packed(vq))) {
-			virtqueue_notify(vq);
-			PMD_TX_LOG(DEBUG, "Notified backend after xmit");
-		}
-	}
+	if (likely(nb_tx))
+		virtqueue_xmit_notify(vq);
 
 	return nb_tx;
 }
@@ -1857,6 +1855,8 @@ virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 	if (unlikely(hw->started == 0 && tx_pkts != hw->inject_pkts))
 		return nb_tx;
 
+	virtqueue_xmit_flush_notify(vq);
+
 	if (unlikely(nb_pkts < 1))
 		return nb_pkts;
 
@@ -1920,10 +1920,7 @@ virtio_xmit_pkts(void *tx_queue, struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 	if (likely(nb_tx)) {
 		vq_update_avail_idx(vq);
 
-		if (unlikely(virtqueue_kick_prepare(vq))) {
-			virtqueue_notify(vq);
-			PMD_TX_LOG(DEBUG, "Notified backend after xmit");
-		}
+		virtqueue_xmit_notify(vq);
 	}
 
 	return nb_tx;
@@ -1959,6 +1956,8 @@ virtio_xmit_pkts_inorder(void *tx_queue,
 	if (unlikely(hw->started == 0 && tx_pkts != hw->inject_pkts))
 		return nb_tx;
 
+	virtqueue_xmit_flush_notify(vq);
+
 	if (unlikely(nb_pkts < 1))
 		return nb_pkts;
 
@@ -2045,10 +2044,7 @@ virtio_xmit_pkts_inorder(void *tx_queue,
 	if (likely(nb_tx)) {
 		vq_update_avail_idx(vq);
 
-		if (unlikely(virtqueue_kick_prepare(vq))) {
-			virtqueue_notify(vq);
-			PMD_TX_LOG(DEBUG, "Notified backend after xmit");
-		}
+		virtqueue_xmit_notify(vq);
 	}
 
 	VIRTQUEUE_DUMP(vq);
@@ -15,6 +15,7 @@ struct virtnet_stats {
 	uint64_t	broadcast;
 	/* Size bins in array as RFC 2819, undersized [0], 64 [1], etc */
 	uint64_t	size_bins[8];
+	uint64_t	notifications; /* Tx only: backend kicks */
 };
 
 struct virtnet_rx {
@@ -30,6 +31,9 @@ struct virtnet_rx {
 struct virtnet_tx {
 	const struct rte_memzone *hdr_mz; /**< memzone to populate hdr. */
 	rte_iova_t hdr_mem;               /**< hdr for each xmit packet */
+	/** Held back kick deadline, 0 if none. */
+	RTE_ATOMIC(uint64_t) notify_deadline;
+	uint64_t notify_timer_deadline;   /**< last deadline kicked by timer */
 
 	struct virtnet_stats stats;       /* Statistics */
 };
@@ -35,6 +35,8 @@ virtio_xmit_pkts_packed_vec(void *tx_queue, struct rte_mbuf **tx_pkts,
 	if (unlikely(hw->started == 0 && tx_pkts != hw->inject_pkts))
 		return nb_tx;
 
+	virtqueue_xmit_flush_notify(vq);
+
 	if (unlikely(nb_pkts < 1))
 		return nb_pkts;
 
@@ -65,12 +67,8 @@ virtio_xmit_pkts_packed_vec(void *tx_queue, struct rte_mbuf **tx_pkts,
 
 	txvq->stats.packets += nb_tx;
 
-	if (likely(nb_tx)) {
-		if (unlikely(virtqueue_kick_prepare_packed(vq))) {
-			virtqueue_notify(vq);
-			PMD_TX_LOG(DEBUG, "Notified backend after xmit");
-		}
-	}
+	if (likely(nb_tx))
+		virtqueue_xmit_notify(vq);
 
 	return nb_tx;
 }
@@ -363,6 +363,8 @@ static const char *valid_args[] = {
 	VIRTIO_USER_ARG_SPEED,
 #define VIRTIO_USER_ARG_VECTORIZED     "vectorized"
 	VIRTIO_USER_ARG_VECTORIZED,
+#define VIRTIO_USER_ARG_NOTIFY_DELAY   "notify_delay"
+	VIRTIO_USER_ARG_NOTIFY_DELAY,
 	NULL
 };
 
@@ -370,6 +372,7 @@ static const char *valid_args[] = {
 #define VIRTIO_USER_DEF_Q_NUM	1
 #define VIRTIO_USER_DEF_Q_SZ	256
 #define VIRTIO_USER_DEF_SERVER_MODE	0
+#define VIRTIO_USER_NOTIFY_DELAY_MAX	1000 /* us */
 
 static int
 get_string_arg(const char *key __rte_unused,
@@ -514,6 +517,7 @@ virtio_user_pmd_probe(struct rte_vdev_device *vdev)
 	uint64_t in_order = 1;
 	uint64_t packed_vq = 0;
 	uint64_t vectorized = 0;
+	uint64_t notify_delay = 0;
 	char *path = NULL;
 	char *ifname = NULL;
 	char *mac_addr = NULL;
@@ -671,6 +675,21 @@ virtio_user_pmd_probe(struct rte_vdev_device *vdev)
 		}
 	}
 
+	if (rte_kvargs_count(kvlist, VIRTIO_USER_ARG_NOTIFY_DELAY) == 1) {
+		if (rte_kvargs_process(kvlist, VIRTIO_USER_ARG_NOTIFY_DELAY,
+				       &get_integer_arg, &notify_delay) < 0) {
+			PMD_INIT_LOG(ERR, "error to parse %s",
+				     VIRTIO_USER_ARG_NOTIFY_DELAY);
+			goto end;
+		}
+		if (notify_delay > VIRTIO_USER_NOTIFY_DELAY_MAX) {
+			PMD_INIT_LOG(ERR, "%s must be at most %u us",
+				     VIRTIO_USER_ARG_NOTIFY_DELAY,
+				     VIRTIO_USER_NOTIFY_DELAY_MAX);
+			goto end;
+		}
+	}
+
 	eth_dev = virtio_user_eth_dev_alloc(vdev);
 	if (!eth_dev) {
 		PMD_INIT_LOG(ERR, "virtio_user fails to alloc device");
@@ -721,6 +740,9 @@ virtio_user_pmd_probe(struct rte_vdev_device *vdev)
 		}
 	}
 
+	hw->tx_notify_delay = notify_delay * rte_get_timer_hz() / US_PER_S;
+	hw->tx_notify_delay_us = notify_delay;
+
 	rte_eth_dev_probing_finish(eth_dev);
 	ret = 0;
 
@@ -824,4 +846,5 @@ RTE_PMD_REGISTER_PARAM_STRING(net_virtio_user,
 	"in_order=<0|1> "
 	"packed_vq=<0|1> "
 	"speed=<int> "
-	"vectorized=<0|1>");
+	"vectorized=<0|1> "
+	"notify_delay=<int>");
@@ -208,9 +208,12 @@ virtqueue_rxvq_reset_packed(struct virtqueue *vq)
 	vq->vq_desc_tail_idx = (uint16_t)(vq->vq_nentries - 1);
 	vq->vq_free_cnt = vq->vq_nentries;
 
+	vq->vq_kick_idx = 0;
+	vq->vq_kick_added = 0;
 	vq->vq_packed.used_wrap_counter = 1;
 	vq->vq_packed.cached_flags = VRING_PACKED_DESC_F_AVAIL;
 	vq->vq_packed.event_flags_shadow = 0;
+	vq->vq_packed.kick_wrap_counter = 1;
 	vq->vq_packed.cached_flags |= VRING_DESC_F_WRITE;
 
 	memset(vq->mz->addr, 0, vq->mz->len);
@@ -242,9 +245,15 @@ virtqueue_txvq_reset_packed(struct virtqueue *vq)
 	vq->vq_desc_tail_idx = (uint16_t)(vq->vq_nentries - 1);
 	vq->vq_free_cnt = vq->vq_nentries;
 
+	vq->vq_kick_idx = 0;
+	vq->vq_kick_added = 0;
 	vq->vq_packed.used_wrap_counter = 1;
 	vq->vq_packed.cached_flags = VRING_PACKED_DESC_F_AVAIL;
 	vq->vq_packed.event_flags_shadow = 0;
+	vq->vq_packed.kick_wrap_counter = 1;
+	rte_atomic_store_explicit(&vq->txq.notify_deadline, 0,
+		rte_memory_order_relaxed);
+	vq->txq.notify_timer_deadline = 0;
 
 	memset(vq->mz->addr, 0, vq->mz->len);
 	memset(vq->txq.hdr_mz->addr, 0, vq->txq.hdr_mz->len);
@@ -278,10 +287,13 @@ virtio_init_vring(struct virtqueue *vq)
 	vq->vq_used_cons_idx = 0;
 	vq->vq_desc_head_idx = 0;
 	vq->vq_avail_idx = 0;
+	vq->vq_kick_idx = 0;
+	vq->vq_kick_added = 0;
 	vq->vq_desc_tail_idx = (uint16_t)(vq->vq_nentries - 1);
 	vq->vq_free_cnt = vq->vq_nentries;
 	memset(vq->vq_descx, 0, sizeof(struct vq_desc_extra) * vq->vq_nentries);
 	if (virtio_with_packed_queue(vq->hw)) {
+		vq->vq_packed.kick_wrap_counter = 1;
 		vring_init_packed(&vq->vq_packed.ring, ring_mem, vq->vq_ring_mem,
 				  VIRTIO_VRING_ALIGN, size);
 		vring_desc_init_packed(vq, size);
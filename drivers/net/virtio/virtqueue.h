@@ -8,6 +8,7 @@
 #include <stdint.h>
 
 #include <rte_atomic.h>
+#include <rte_cycles.h>
 #include <rte_memory.h>
 #include <rte_mempool.h>
 #include <rte_net.h>
@@ -182,6 +183,7 @@ struct virtqueue {
 			bool used_wrap_counter;
 			uint16_t cached_flags; /**< cached flags for descs */
 			uint16_t event_flags_shadow;
+			bool kick_wrap_counter; /**< avail wrap at last kick accounting */
 		} vq_packed;
 	};
 
@@ -190,6 +192,8 @@ struct virtqueue {
 	uint16_t vq_free_cnt;  /**< num of desc available */
 	uint16_t vq_avail_idx; /**< sync until needed */
 	uint16_t vq_free_thresh; /**< free threshold */
+	uint16_t vq_kick_idx;  /**< avail index at last kick accounting */
+	uint16_t vq_kick_added; /**< num of desc made available since kick */
 
 	/**
 	 * Head of the free chain in the descriptor table. If
@@ -367,6 +371,9 @@ static inline void
 virtqueue_enable_intr_split(struct virtqueue *vq)
 {
 	vq->vq_split.ring.avail->flags &= (~VRING_AVAIL_F_NO_INTERRUPT);
+	/* With event index the flag is ignored, ask for the next used entry. */
+	if (virtio_with_feature(vq->hw, VIRTIO_RING_F_EVENT_IDX))
+		vring_used_event(&vq->vq_split.ring) = vq->vq_used_cons_idx;
 }
 
 /**
@@ -490,29 +497,103 @@ vq_update_avail_ring(struct virtqueue *vq, uint16_t desc_idx)
 	vq->vq_avail_idx++;
 }
 
+/*
+ * Account the descriptors made available since the previous call.
+ *
+ * The packed ring index only counts up to the ring size, so the position
+ * is tracked modulo twice the ring size with the wrap counter. It is
+ * correct as long as less than twice the ring size is made available
+ * between two calls, which holds since one burst cannot fill more than
+ * the whole ring. The sum is kept in vq_kick_added, saturated so that it
+ * can be used as the distance between the old and new 16-bit indexes.
+ */
+static inline void
+virtqueue_kick_account(struct virtqueue *vq)
+{
+	uint16_t idx = vq->vq_avail_idx;
+	uint32_t added;
+	bool wrap;
+
+	if (virtio_with_packed_queue(vq->hw)) {
+		wrap = !!(vq->vq_packed.cached_flags & VRING_PACKED_DESC_F_AVAIL);
+		added = (uint32_t)idx + 2 * vq->vq_nentries - vq->vq_kick_idx;
+		if (wrap != vq->vq_packed.kick_wrap_counter)
+			added += vq->vq_nentries;
+		added %= 2 * vq->vq_nentries;
+		vq->vq_packed.kick_wrap_counter = wrap;
+	} else {
+		added = (uint16_t)(idx - vq->vq_kick_idx);
+	}
+
+	vq->vq_kick_idx = idx;
+	vq->vq_kick_added = RTE_MIN(vq->vq_kick_added + added,
+				    (uint32_t)UINT16_MAX);
+}
+
 static inline int
 virtqueue_kick_prepare(struct virtqueue *vq)
 {
+	uint16_t new_idx = vq->vq_avail_idx;
+	uint16_t added;
+
+	virtqueue_kick_account(vq);
+	added = vq->vq_kick_added;
+	vq->vq_kick_added = 0;
+
 	/*
 	 * Ensure updated avail->idx is visible to vhost before reading
 	 * the used->flags.
 	 */
 	virtio_mb(vq->hw->weak_barriers);
+
+	/*
+	 * With event index, only notify if the index the device asked to
+	 * be woken up at was made available since the last check.
+	 */
+	if (virtio_with_feature(vq->hw, VIRTIO_RING_F_EVENT_IDX)) {
+		if (unlikely(added == UINT16_MAX))
+			return 1;
+		return vring_need_event(vring_avail_event(&vq->vq_split.ring),
+					new_idx, (uint16_t)(new_idx - added));
+	}
+
 	return !(vq->vq_split.ring.used->flags & VRING_USED_F_NO_NOTIFY);
 }
 
 static inline int
 virtqueue_kick_prepare_packed(struct virtqueue *vq)
 {
-	uint16_t flags;
+	struct vring_packed_desc_event *event = vq->vq_packed.ring.device;
+	uint16_t new_idx = vq->vq_avail_idx;
+	uint16_t flags, off_wrap, event_idx, added;
+	bool wrap;
+
+	virtqueue_kick_account(vq);
+	added = vq->vq_kick_added;
+	vq->vq_kick_added = 0;
+	wrap = vq->vq_packed.kick_wrap_counter;
 
 	/*
 	 * Ensure updated data is visible to vhost before reading the flags.
 	 */
 	virtio_mb(vq->hw->weak_barriers);
-	flags = vq->vq_packed.ring.device->desc_event_flags;
-
-	return flags != RING_EVENT_FLAGS_DISABLE;
+	flags = event->desc_event_flags;
+
+	if (flags != RING_EVENT_FLAGS_DESC)
+		return flags != RING_EVENT_FLAGS_DISABLE;
+	if (unlikely(added == UINT16_MAX))
+		return 1;
+
+	/* Device writes the offset before setting the flags. */
+	virtio_rmb(vq->hw->weak_barriers);
+	off_wrap = event->desc_event_off_wrap;
+	event_idx = off_wrap & ~(1 << 15);
+	/* Express the event index relative to the current wrap. */
+	if (!!(off_wrap >> 15) != wrap)
+		event_idx -= vq->vq_nentries;
+
+	return vring_need_event(event_idx, new_idx,
+				(uint16_t)(new_idx - added));
 }
 
 /*
@@ -525,6 +606,98 @@ virtqueue_notify(struct virtqueue *vq)
 	VIRTIO_OPS(vq->hw)->notify_queue(vq->hw, vq);
 }
 
+/* Number of descriptors made available since the last kick check. */
+static inline uint16_t
+virtqueue_nb_unnotified(struct virtqueue *vq)
+{
+	virtqueue_kick_account(vq);
+	return vq->vq_kick_added;
+}
+
+/*
+ * Notify the backend after descriptors were made available on a Tx queue.
+ *
+ * If hw->tx_notify_delay is set, the notification is held back until the
+ * oldest pending descriptor waited that many timer cycles or a quarter of
+ * the ring is pending, so a single kick covers several bursts.
+ * Held back notifications are sent by virtqueue_xmit_flush_notify(),
+ * or by virtqueue_xmit_timer_notify() if the queue is not polled anymore.
+ */
+static inline void
+virtqueue_xmit_notify(struct virtqueue *vq)
+{
+	struct virtnet_tx *txvq = &vq->txq;
+	uint64_t delay = vq->hw->tx_notify_delay;
+	uint64_t now, deadline;
+	int kick;
+
+	if (delay != 0) {
+		now = rte_get_timer_cycles();
+		deadline = rte_atomic_load_explicit(&txvq->notify_deadline,
+						    rte_memory_order_relaxed);
+		if (deadline == 0) {
+			deadline = now + delay;
+			rte_atomic_store_explicit(&txvq->notify_deadline,
+						  deadline,
+						  rte_memory_order_relaxed);
+		}
+		if (now < deadline &&
+				virtqueue_nb_unnotified(vq) < vq->vq_nentries / 4)
+			return;
+		rte_atomic_store_explicit(&txvq->notify_deadline, 0,
+					  rte_memory_order_relaxed);
+	}
+
+	if (virtio_with_packed_queue(vq->hw))
+		kick = virtqueue_kick_prepare_packed(vq);
+	else
+		kick = virtqueue_kick_prepare(vq);
+
+	if (unlikely(kick)) {
+		virtqueue_notify(vq);
+		txvq->stats.notifications++;
+		PMD_TX_LOG(DEBUG, "Notified backend after xmit");
+	}
+}
+
+/* Send a held back Tx notification once its deadline has passed. */
+static inline void
+virtqueue_xmit_flush_notify(struct virtqueue *vq)
+{
+	uint64_t deadline;
+
+	deadline = rte_atomic_load_explicit(&vq->txq.notify_deadline,
+					    rte_memory_order_relaxed);
+	if (unlikely(deadline != 0) && rte_get_timer_cycles() >= deadline)
+		virtqueue_xmit_notify(vq);
+}
+
+/*
+ * Kick the backend from a control thread if a held back Tx notification
+ * expired without the queue being polled again.
+ *
+ * The descriptors were made visible before the notification was held back,
+ * so an unconditional kick is enough and the state of the data path is
+ * left untouched. The queue still checks for a kick on its next burst,
+ * which may result in a spurious notification.
+ */
+static inline void
+virtqueue_xmit_timer_notify(struct virtqueue *vq)
+{
+	struct virtnet_tx *txvq = &vq->txq;
+	uint64_t deadline;
+
+	deadline = rte_atomic_load_explicit(&txvq->notify_deadline,
+					    rte_memory_order_relaxed);
+	if (deadline == 0 || deadline == txvq->notify_timer_deadline ||
+			rte_get_timer_cycles() < deadline)
+		return;
+
+	txvq->notify_timer_deadline = deadline;
+	virtqueue_notify(vq);
+	PMD_TX_LOG(DEBUG, "Notified backend after held back xmit");
+}
+
 #ifdef RTE_LIBRTE_VIRTIO_DEBUG_DUMP
 #define VIRTQUEUE_DUMP(vq) do { \
 	uint16_t used_idx, nused; \
@@ -2,10 +2,17 @@
  * Copyright(c) 2017 Intel Corporation
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <rte_common.h>
+#include <rte_cycles.h>
 #include <rte_ethdev.h>
 #include <rte_malloc.h>
 #include <rte_metrics.h>
+#include <rte_stdatomic.h>
+#include <rte_thread.h>
 #include <rte_bitrate.h>
 
 /*
@@ -23,11 +30,84 @@ struct rte_stats_bitrate {
 	uint64_t ewma_obits;
 };
 
+/*
+ * Counters read from the extended statistics by the calculation thread:
+ * the port counters, then the counters of each queue,
+ * each byte counter being followed by the matching packet counter.
+ */
+static const char * const bitrate_port_xstats[] = {
+	"rx_good_bytes", "rx_good_packets", "tx_good_bytes", "tx_good_packets",
+};
+
+static const char * const bitrate_queue_xstats[][2] = {
+	{"rx", "bytes"}, {"rx", "packets"}, {"tx", "bytes"}, {"tx", "packets"},
+};
+
+#define BITRATE_NB_PORT_XSTATS RTE_DIM(bitrate_port_xstats)
+#define BITRATE_NB_QUEUE_XSTATS RTE_DIM(bitrate_queue_xstats)
+#define BITRATE_MAX_XSTATS (BITRATE_NB_PORT_XSTATS + \
+	BITRATE_NB_QUEUE_XSTATS * RTE_ETHDEV_QUEUE_STAT_CNTRS)
+
+/* Longest sleep of the calculation thread before checking for a stop */
+#define BITRATE_SLEEP_MS 100u
+
+/*
+ * Rates of a port calculated from extended statistics snapshots,
+ * in bits per second for the byte counters.
+ * @internal
+ */
+struct rte_stats_bitrate_xstats {
+	uint64_t ids[BITRATE_MAX_XSTATS]; /**< ids of the counters found */
+	uint16_t cnt[BITRATE_MAX_XSTATS]; /**< counter index of each id */
+	uint16_t nb_ids;
+	int nb_xstats; /**< number of xstats of the port when ids were found */
+	uint64_t last_tsc;
+	uint64_t last[BITRATE_MAX_XSTATS];
+	uint64_t mean[BITRATE_MAX_XSTATS];
+	uint64_t ewma[BITRATE_MAX_XSTATS];
+	uint64_t peak[BITRATE_MAX_XSTATS];
+};
+
 struct rte_stats_bitrates {
 	struct rte_stats_bitrate port_stats[RTE_MAX_ETHPORTS];
 	uint16_t id_stats_set;
+	bool stats_reg;
+	uint16_t id_queue_set;
+	uint16_t nb_queues; /**< queues with metrics, 0 if not registered */
+	bool running;
+	RTE_ATOMIC(bool) stop;
+	uint32_t period_ms;
+	rte_thread_t thread;
+	struct rte_stats_bitrate_xstats xstats[RTE_MAX_ETHPORTS];
 };
 
+/*
+ * Update an EWMA (Exponentially Weighted Moving Average) that uses a
+ * weighting factor of alpha_percent.
+ */
+static uint64_t
+bitrate_ewma(uint64_t ewma, uint64_t sample)
+{
+	const int64_t alpha_percent = 20;
+	int64_t delta;
+
+	delta = sample;
+	delta -= ewma;
+	/* The +-50 fixes integer rounding during division */
+	if (delta > 0)
+		delta = (delta * alpha_percent + 50) / 100;
+	else
+		delta = (delta * alpha_percent - 50) / 100;
+	ewma += delta;
+	/* Integer roundoff prevents EWMA between 0 and (100/alpha_percent)
+	 * ever reaching zero in no-traffic conditions
+	 */
+	if (sample == 0 && delta == 0)
+		ewma = 0;
+
+	return ewma;
+}
+
 struct rte_stats_bitrates *
 rte_stats_bitrate_create(void)
 {
@@ -38,6 +118,8 @@ rte_stats_bitrate_create(void)
 void
 rte_stats_bitrate_free(struct rte_stats_bitrates *bitrate_data)
 {
+	if (bitrate_data != NULL)
+		rte_stats_bitrate_stop(bitrate_data);
 	rte_free(bitrate_data);
 }
 
@@ -57,11 +139,66 @@ rte_stats_bitrate_reg(struct rte_stats_bitrates *bitrate_data)
 	return_value = rte_metrics_reg_names(&names[0], RTE_DIM(names));
 	if (return_value >= 0) {
 		bitrate_data->id_stats_set = return_value;
+		bitrate_data->stats_reg = true;
 		return 0;
 	}
 	return return_value;
 }
 
+int
+rte_stats_bitrate_queue_reg(struct rte_stats_bitrates *bitrate_data,
+	uint16_t nb_queues)
+{
+	static const char * const port_names[] = {
+		"ewma_pkts_in", "ewma_pkts_out", "peak_pkts_in", "peak_pkts_out",
+	};
+	static const char * const queue_names[][2] = {
+		{"rx", "ewma_bits"}, {"rx", "peak_bits"},
+		{"rx", "ewma_pkts"}, {"rx", "peak_pkts"},
+		{"tx", "ewma_bits"}, {"tx", "peak_bits"},
+		{"tx", "ewma_pkts"}, {"tx", "peak_pkts"},
+	};
+	const unsigned int nb_names = RTE_DIM(port_names) +
+		nb_queues * RTE_DIM(queue_names);
+	char (*buf)[RTE_METRICS_MAX_NAME_LEN];
+	const char **names;
+	unsigned int i, q;
+	int ret;
+
+	if (bitrate_data == NULL || nb_queues == 0 ||
+			nb_queues > RTE_ETHDEV_QUEUE_STAT_CNTRS)
+		return -EINVAL;
+	if (bitrate_data->nb_queues != 0)
+		return -EEXIST;
+	if (bitrate_data->running)
+		return -EBUSY;
+
+	names = malloc(nb_names * (sizeof(*names) + sizeof(*buf)));
+	if (names == NULL)
+		return -ENOMEM;
+	buf = (void *)&names[nb_names];
+
+	for (i = 0; i < RTE_DIM(port_names); i++)
+		names[i] = port_names[i];
+	for (q = 0; q < nb_queues; q++) {
+		for (i = 0; i < RTE_DIM(queue_names); i++) {
+			snprintf(*buf, sizeof(*buf), "%s_q%u_%s",
+				queue_names[i][0], q, queue_names[i][1]);
+			names[RTE_DIM(port_names) + q * RTE_DIM(queue_names) + i] = *buf;
+			buf++;
+		}
+	}
+
+	ret = rte_metrics_reg_names(names, nb_names);
+	free(names);
+	if (ret < 0)
+		return ret;
+
+	bitrate_data->id_queue_set = ret;
+	bitrate_data->nb_queues = nb_queues;
+	return 0;
+}
+
 int
 rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
 			uint16_t port_id)
@@ -70,13 +207,13 @@ rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
 	struct rte_eth_stats eth_stats;
 	int ret_code;
 	uint64_t cnt_bits;
-	int64_t delta;
-	const int64_t alpha_percent = 20;
 	uint64_t values[6];
 	int ret;
 
 	if (bitrate_data == NULL)
 		return -EINVAL;
+	if (bitrate_data->running)
+		return -EBUSY;
 
 	ret_code = rte_eth_stats_get(port_id, &eth_stats);
 	if (ret_code != 0)
@@ -94,19 +231,7 @@ rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
 	port_data->last_ibytes = eth_stats.ibytes;
 	if (cnt_bits > port_data->peak_ibits)
 		port_data->peak_ibits = cnt_bits;
-	delta = cnt_bits;
-	delta -= port_data->ewma_ibits;
-	/* The +-50 fixes integer rounding during division */
-	if (delta > 0)
-		delta = (delta * alpha_percent + 50) / 100;
-	else
-		delta = (delta * alpha_percent - 50) / 100;
-	port_data->ewma_ibits += delta;
-	/* Integer roundoff prevents EWMA between 0 and (100/alpha_percent)
-	 * ever reaching zero in no-traffic conditions
-	 */
-	if (cnt_bits == 0 && delta == 0)
-		port_data->ewma_ibits = 0;
+	port_data->ewma_ibits = bitrate_ewma(port_data->ewma_ibits, cnt_bits);
 	port_data->mean_ibits = cnt_bits;
 
 	/* Outgoing bitrate (also EWMA) */
@@ -114,15 +239,7 @@ rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
 	port_data->last_obytes = eth_stats.obytes;
 	if (cnt_bits > port_data->peak_obits)
 		port_data->peak_obits = cnt_bits;
-	delta = cnt_bits;
-	delta -= port_data->ewma_obits;
-	if (delta > 0)
-		delta = (delta * alpha_percent + 50) / 100;
-	else
-		delta = (delta * alpha_percent - 50) / 100;
-	port_data->ewma_obits += delta;
-	if (cnt_bits == 0 && delta == 0)
-		port_data->ewma_obits = 0;
+	port_data->ewma_obits = bitrate_ewma(port_data->ewma_obits, cnt_bits);
 	port_data->mean_obits = cnt_bits;
 
 	values[0] = port_data->ewma_ibits;
@@ -138,3 +255,184 @@ rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
 
 	return 0;
 }
+
+/* Find the ids of the counters of a port, which change with its queues. */
+static void
+bitrate_xstats_resolve(struct rte_stats_bitrates *bitrate_data,
+	uint16_t port_id, int nb_xstats)
+{
+	struct rte_stats_bitrate_xstats *xs = &bitrate_data->xstats[port_id];
+	char name[RTE_ETH_XSTATS_NAME_SIZE];
+	unsigned int i, q;
+	uint16_t cnt;
+
+	memset(xs, 0, sizeof(*xs));
+	xs->nb_xstats = nb_xstats;
+
+	for (i = 0; i < BITRATE_NB_PORT_XSTATS; i++) {
+		if (rte_eth_xstats_get_id_by_name(port_id, bitrate_port_xstats[i],
+				&xs->ids[xs->nb_ids]) == 0)
+			xs->cnt[xs->nb_ids++] = i;
+	}
+	for (q = 0; q < bitrate_data->nb_queues; q++) {
+		for (i = 0; i < BITRATE_NB_QUEUE_XSTATS; i++) {
+			cnt = BITRATE_NB_PORT_XSTATS + q * BITRATE_NB_QUEUE_XSTATS + i;
+			snprintf(name, sizeof(name), "%s_q%u_%s",
+				bitrate_queue_xstats[i][0], q,
+				bitrate_queue_xstats[i][1]);
+			/* not all drivers report the queue counters */
+			if (rte_eth_xstats_get_id_by_name(port_id, name,
+					&xs->ids[xs->nb_ids]) == 0)
+				xs->cnt[xs->nb_ids++] = cnt;
+		}
+	}
+}
+
+static int
+bitrate_xstats_calc(struct rte_stats_bitrates *bitrate_data, uint16_t port_id)
+{
+	struct rte_stats_bitrate_xstats *xs = &bitrate_data->xstats[port_id];
+	uint64_t values[BITRATE_MAX_XSTATS];
+	uint64_t metrics[BITRATE_NB_PORT_XSTATS +
+		2 * BITRATE_NB_QUEUE_XSTATS * RTE_ETHDEV_QUEUE_STAT_CNTRS];
+	uint64_t now, elapsed, sample;
+	unsigned int i, q, n;
+	bool first = false;
+	uint16_t cnt;
+	int ret;
+
+	ret = rte_eth_xstats_get_names(port_id, NULL, 0);
+	if (ret < 0)
+		return ret;
+	if (ret != xs->nb_xstats) {
+		bitrate_xstats_resolve(bitrate_data, port_id, ret);
+		first = true;
+	}
+
+	ret = rte_eth_xstats_get_by_id(port_id, xs->ids, values, xs->nb_ids);
+	if (ret < 0)
+		return ret;
+	now = rte_get_timer_cycles();
+	elapsed = now - xs->last_tsc;
+	xs->last_tsc = now;
+
+	for (i = 0; i < xs->nb_ids; i++) {
+		cnt = xs->cnt[i];
+		sample = values[i] - xs->last[cnt];
+		xs->last[cnt] = values[i];
+		if (first || elapsed == 0)
+			continue;
+
+		/* rate in bits for the byte counters */
+		if ((cnt & 1) == 0)
+			sample <<= 3;
+		sample = (double)sample * rte_get_timer_hz() / elapsed;
+		xs->mean[cnt] = sample;
+		if (sample > xs->peak[cnt])
+			xs->peak[cnt] = sample;
+		xs->ewma[cnt] = bitrate_ewma(xs->ewma[cnt], sample);
+	}
+	if (first)
+		return 0;
+
+	if (bitrate_data->stats_reg) {
+		/* rx_good_bytes and tx_good_bytes */
+		metrics[0] = xs->ewma[0];
+		metrics[1] = xs->ewma[2];
+		metrics[2] = xs->mean[0];
+		metrics[3] = xs->mean[2];
+		metrics[4] = xs->peak[0];
+		metrics[5] = xs->peak[2];
+		ret = rte_metrics_update_values(port_id,
+			bitrate_data->id_stats_set, metrics, 6);
+		if (ret < 0)
+			return ret;
+	}
+
+	if (bitrate_data->nb_queues == 0)
+		return 0;
+
+	/* rx_good_packets and tx_good_packets */
+	n = 0;
+	metrics[n++] = xs->ewma[1];
+	metrics[n++] = xs->ewma[3];
+	metrics[n++] = xs->peak[1];
+	metrics[n++] = xs->peak[3];
+	for (q = 0; q < bitrate_data->nb_queues; q++) {
+		/* bytes and packets of Rx, then Tx */
+		for (i = 0; i < BITRATE_NB_QUEUE_XSTATS; i++) {
+			cnt = BITRATE_NB_PORT_XSTATS + q * BITRATE_NB_QUEUE_XSTATS + i;
+			metrics[n++] = xs->ewma[cnt];
+			metrics[n++] = xs->peak[cnt];
+		}
+	}
+
+	return rte_metrics_update_values(port_id, bitrate_data->id_queue_set,
+		metrics, n);
+}
+
+static uint32_t
+bitrate_thread(void *arg)
+{
+	struct rte_stats_bitrates *bitrate_data = arg;
+	uint32_t ms, sleep_ms;
+	uint16_t port_id;
+
+	while (!rte_atomic_load_explicit(&bitrate_data->stop,
+			rte_memory_order_acquire)) {
+		RTE_ETH_FOREACH_DEV(port_id)
+			bitrate_xstats_calc(bitrate_data, port_id);
+
+		/* sleep by slices, so that stopping does not wait a period */
+		for (ms = bitrate_data->period_ms; ms != 0; ms -= sleep_ms) {
+			if (rte_atomic_load_explicit(&bitrate_data->stop,
+					rte_memory_order_acquire))
+				break;
+			sleep_ms = RTE_MIN(ms, BITRATE_SLEEP_MS);
+			rte_delay_us_sleep(sleep_ms * 1000);
+		}
+	}
+
+	return 0;
+}
+
+int
+rte_stats_bitrate_start(struct rte_stats_bitrates *bitrate_data,
+	uint32_t period_ms)
+{
+	int ret;
+
+	if (bitrate_data == NULL || period_ms == 0 ||
+			(!bitrate_data->stats_reg && bitrate_data->nb_queues == 0))
+		return -EINVAL;
+	if (bitrate_data->running)
+		return -EBUSY;
+
+	memset(bitrate_data->xstats, 0, sizeof(bitrate_data->xstats));
+	bitrate_data->period_ms = period_ms;
+	rte_atomic_store_explicit(&bitrate_data->stop, false,
+		rte_memory_order_relaxed);
+	ret = rte_thread_create_internal_control(&bitrate_data->thread,
+		"bitrate", bitrate_thread, bitrate_data);
+	if (ret != 0)
+		return -ret;
+
+	bitrate_data->running = true;
+	return 0;
+}
+
+int
+rte_stats_bitrate_stop(struct rte_stats_bitrates *bitrate_data)
+{
+	if (bitrate_data == NULL)
+		return -EINVAL;
+	if (!bitrate_data->running)
+		return 0;
+
+	rte_atomic_store_explicit(&bitrate_data->stop, true,
+		rte_memory_order_release);
+	rte_thread_join(bitrate_data->thread, NULL);
+	bitrate_data->running = false;
+
+	return 0;
+}
@@ -7,6 +7,8 @@
 
 #include <stdint.h>
 
+#include <rte_compat.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -61,11 +63,94 @@ int rte_stats_bitrate_reg(struct rte_stats_bitrates *bitrate_data);
  *
  * @return
  *  - Zero on success
+ *  - (-EBUSY) if the calculation thread is running
  *  - Negative value on error
  */
 int rte_stats_bitrate_calc(struct rte_stats_bitrates *bitrate_data,
 			   uint16_t port_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Register the packet rate and per-queue statistics with the metric library.
+ *
+ * These statistics are calculated by the thread started with
+ * rte_stats_bitrate_start(), from the extended statistics of the ports:
+ * ewma_pkts_in, ewma_pkts_out, peak_pkts_in, peak_pkts_out, then
+ * rx_qN_ewma_bits, rx_qN_peak_bits, rx_qN_ewma_pkts, rx_qN_peak_pkts
+ * and the same for tx_qN, for each queue N.
+ *
+ * Queues with no per-queue extended statistics are reported with zero rates.
+ *
+ * @param bitrate_data
+ *   Pointer allocated by rte_stats_bitrate_create()
+ * @param nb_queues
+ *   Number of Rx and Tx queues of each port with statistics,
+ *   at most RTE_ETHDEV_QUEUE_STAT_CNTRS.
+ *
+ * @return
+ *   - Zero on success
+ *   - (-EINVAL) if a parameter is invalid
+ *   - (-EEXIST) if already registered
+ *   - (-EBUSY) if the calculation thread is running
+ *   - Other negative value on metric registration error
+ */
+__rte_experimental
+int rte_stats_bitrate_queue_reg(struct rte_stats_bitrates *bitrate_data,
+	uint16_t nb_queues);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Start a control thread calculating the statistics of all the ports
+ * periodically, so that no forwarding lcore calls rte_stats_bitrate_calc().
+ *
+ * The rates are calculated from snapshots of the extended statistics
+ * and published per second, in bits for the bit rates, the mean values
+ * being the rates of the last period.
+ * The statistics registered with rte_stats_bitrate_reg()
+ * and rte_stats_bitrate_queue_reg() are updated.
+ *
+ * The thread reads the extended statistics of every port with
+ * rte_eth_xstats_get_by_id(), so it must be stopped with
+ * rte_stats_bitrate_stop() before any port is stopped or closed.
+ *
+ * @param bitrate_data
+ *   Bitrate statistics data pointer
+ * @param period_ms
+ *   Calculation period in milliseconds.
+ *
+ * @return
+ *   - Zero on success
+ *   - (-EINVAL) if a parameter is invalid or no statistic is registered
+ *   - (-EBUSY) if the thread is already running
+ *   - Other negative value if the thread cannot be created
+ */
+__rte_experimental
+int rte_stats_bitrate_start(struct rte_stats_bitrates *bitrate_data,
+	uint32_t period_ms);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Stop the thread started with rte_stats_bitrate_start().
+ *
+ * The thread checks for the stop at least every 100 ms,
+ * whatever the calculation period.
+ *
+ * @param bitrate_data
+ *   Bitrate statistics data pointer
+ *
+ * @return
+ *   - Zero on success
+ *   - (-EINVAL) if bitrate_data is NULL
+ */
+__rte_experimental
+int rte_stats_bitrate_stop(struct rte_stats_bitrates *bitrate_data);
+
 #ifdef __cplusplus
 }
 #endif
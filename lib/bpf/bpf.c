@@ -30,6 +30,19 @@ rte_bpf_get_jit(const struct rte_bpf *bpf, struct rte_bpf_jit *jit)
 	return 0;
 }
 
+int
+rte_bpf_get_jit_burst(const struct rte_bpf *bpf, rte_bpf_jit_burst_t *burst)
+{
+	if (bpf == NULL || burst == NULL)
+		return -EINVAL;
+
+	if (bpf->jit_burst == NULL)
+		return -ENOTSUP;
+
+	*burst = bpf->jit_burst;
+	return 0;
+}
+
 int
 __rte_bpf_jit(struct rte_bpf *bpf)
 {
@@ -128,6 +128,14 @@ enum {
  */
 #define	EBPF_PSEUDO_CALL	EBPF_REG_1
 
+/*
+ * DPDK specific: when EBPF_CALL instruction has
+ * src_reg == EBPF_PSEUDO_MAP_CALL, it is a call to one of built-in
+ * map helpers, where imm value contains helper id
+ * (see enum rte_bpf_map_func) instead of the external symbol index.
+ */
+#define	EBPF_PSEUDO_MAP_CALL	EBPF_REG_3
+
 /*
  * eBPF instruction format
  */
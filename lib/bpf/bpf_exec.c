@@ -9,6 +9,7 @@
 #include <rte_log.h>
 #include <rte_debug.h>
 #include <rte_byteorder.h>
+#include <rte_prefetch.h>
 
 #include "bpf_impl.h"
 
@@ -453,6 +454,12 @@ bpf_exec(const struct rte_bpf *bpf, uint64_t reg[EBPF_REG_NUM])
 			break;
 		/* call instructions */
 		case (BPF_JMP | EBPF_CALL):
+			if (ins->src_reg == EBPF_PSEUDO_MAP_CALL) {
+				reg[EBPF_REG_0] = __rte_bpf_map_call(ins->imm,
+					reg[EBPF_REG_1], reg[EBPF_REG_2],
+					reg[EBPF_REG_3], reg[EBPF_REG_4]);
+				break;
+			}
 			reg[EBPF_REG_0] = bpf->prm.xsym[ins->imm].func.val(
 				reg[EBPF_REG_1], reg[EBPF_REG_2],
 				reg[EBPF_REG_3], reg[EBPF_REG_4],
@@ -485,6 +492,9 @@ rte_bpf_exec_burst(const struct rte_bpf *bpf, void *ctx[], uint64_t rc[],
 
 	for (i = 0; i != num; i++) {
 
+		if (i + 1 != num)
+			rte_prefetch0(ctx[i + 1]);
+
 		reg[EBPF_REG_1] = (uintptr_t)ctx[i];
 		reg[EBPF_REG_10] = (uintptr_t)(stack + RTE_DIM(stack));
 
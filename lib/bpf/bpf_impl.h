@@ -6,6 +6,7 @@
 #define BPF_IMPL_H
 
 #include <rte_bpf.h>
+#include <rte_spinlock.h>
 #include <sys/mman.h>
 
 #define MAX_BPF_STACK_SIZE	0x200
@@ -13,10 +14,28 @@
 struct rte_bpf {
 	struct rte_bpf_prm prm;
 	struct rte_bpf_jit jit;
+	rte_bpf_jit_burst_t jit_burst; /* NULL if not supported */
 	size_t sz;
 	uint32_t stack_sz;
 };
 
+struct rte_bpf_map {
+	char name[RTE_BPF_MAP_NAMESIZE];
+	enum rte_bpf_map_type type;
+	uint32_t key_size;
+	uint32_t value_size;
+	uint32_t max_entries;
+	uint32_t elem_size;   /* value_size aligned to 8B */
+	uint8_t *values;      /* max_entries elements (per lcore for percpu) */
+	size_t lcore_stride;  /* distance between per-lcore copies */
+	struct rte_hash *hash;
+	struct rte_lpm *lpm;
+	uint32_t *free_slots; /* hash/LPM: stack of unused values */
+	uint32_t nb_free;
+	rte_spinlock_t lock;  /* serializes hash/LPM updates */
+	struct rte_rcu_qsbr_dq *dq; /* deleted values waiting for readers */
+};
+
 /*
  * Use '__rte' prefix for non-static internal functions
  * to avoid potential name conflict with other libraries.
@@ -26,6 +45,20 @@ int __rte_bpf_jit(struct rte_bpf *bpf);
 int __rte_bpf_jit_x86(struct rte_bpf *bpf);
 int __rte_bpf_jit_arm64(struct rte_bpf *bpf);
 
+/*
+ * Entry point for map helper calls from the interpreter.
+ */
+uint64_t __rte_bpf_map_call(uint32_t func, uint64_t r1, uint64_t r2,
+	uint64_t r3, uint64_t r4);
+
+/*
+ * Native address of the map helper for JIT,
+ * specialised for the given map when it is known (not NULL).
+ * Returned functions follow C ABI and return 64-bit values.
+ */
+uintptr_t __rte_bpf_map_jit_func(const struct rte_bpf_map *map,
+	uint32_t func);
+
 extern int rte_bpf_logtype;
 #define RTE_LOGTYPE_BPF rte_bpf_logtype
 
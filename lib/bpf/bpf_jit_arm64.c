@@ -927,6 +927,24 @@ emit_call(struct a64_jit_ctx *ctx, uint8_t tmp, void *func)
 	emit_mov_64(ctx, r0, A64_R(0));
 }
 
+#define A64_CSEL 0x1a800000
+static void
+emit_csel(struct a64_jit_ctx *ctx, bool is64, uint8_t rd, uint8_t rn,
+	  uint8_t rm, uint8_t cond)
+{
+	uint32_t insn;
+
+	insn = A64_CSEL;
+	insn |= (!!is64) << 31;
+	insn |= rm << 16;
+	insn |= cond << 12;
+	insn |= rn << 5;
+	insn |= rd;
+
+	emit_insn(ctx, insn, check_reg(rd) || check_reg(rn) || check_reg(rm) ||
+		  check_cond(cond));
+}
+
 static void
 emit_cbnz(struct a64_jit_ctx *ctx, bool is64, uint8_t rt, int32_t imm19)
 {
@@ -1090,6 +1108,50 @@ emit_branch(struct a64_jit_ctx *ctx, uint8_t op, uint32_t i, int16_t off)
 	emit_b_cond(ctx, ebpf_to_a64_cond(op), jump_offset_get(ctx, i, off));
 }
 
+/*
+ * Inline lookup into RTE_BPF_MAP_TYPE_ARRAY map:
+ * R0 = (idx < max_entries) ? values + idx * elem_size : NULL;
+ */
+static void
+emit_map_array_lookup(struct a64_jit_ctx *ctx, uint8_t tmp,
+		      const struct rte_bpf_map *map)
+{
+	uint8_t r0 = ebpf_to_a64_reg(ctx, EBPF_REG_0);
+	uint8_t rk = ebpf_to_a64_reg(ctx, EBPF_REG_2);
+
+	emit_mov_imm(ctx, 1, tmp, 0);
+	emit_ldr(ctx, BPF_W, r0, rk, tmp);
+	emit_mov_imm(ctx, 1, tmp, map->max_entries);
+	emit_cmp(ctx, 1, r0, tmp);
+	emit_mov_imm(ctx, 1, tmp, map->elem_size);
+	emit_mul(ctx, 1, r0, tmp);
+	emit_mov_imm(ctx, 1, tmp, (uintptr_t)map->values);
+	emit_add(ctx, 1, r0, tmp);
+	emit_csel(ctx, 1, r0, A64_ZR, r0, A64_CS);
+}
+
+/*
+ * Call one of built-in map helpers.
+ * When the validator was able to tell which map is used,
+ * lookup in array maps is done inline, otherwise call map type
+ * specific helper directly.
+ */
+static void
+emit_map_call(struct a64_jit_ctx *ctx, uint8_t tmp, const struct rte_bpf *bpf,
+	      const struct ebpf_insn *ins)
+{
+	const struct rte_bpf_map *map;
+
+	map = (ins->off > 0) ? bpf->prm.xsym[ins->off - 1].map.val : NULL;
+
+	if (map != NULL && map->type == RTE_BPF_MAP_TYPE_ARRAY &&
+	    ins->imm == RTE_BPF_MAP_FUNC_LOOKUP)
+		emit_map_array_lookup(ctx, tmp, map);
+	else
+		emit_call(ctx, tmp,
+			  (void *)__rte_bpf_map_jit_func(map, ins->imm));
+}
+
 static void
 check_program_has_call(struct a64_jit_ctx *ctx, struct rte_bpf *bpf)
 {
@@ -1371,7 +1433,11 @@ emit(struct a64_jit_ctx *ctx, struct rte_bpf *bpf)
 			break;
 		/* Call imm */
 		case (BPF_JMP | EBPF_CALL):
-			emit_call(ctx, tmp1, bpf->prm.xsym[ins->imm].func.val);
+			if (ins->src_reg == EBPF_PSEUDO_MAP_CALL)
+				emit_map_call(ctx, tmp1, bpf, ins);
+			else
+				emit_call(ctx, tmp1,
+					  bpf->prm.xsym[ins->imm].func.val);
 			break;
 		/* Return r0 */
 		case (BPF_JMP | EBPF_EXIT):
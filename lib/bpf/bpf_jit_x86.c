@@ -96,6 +96,18 @@ enum {
  */
 static const uint32_t save_regs[] = {RBX, R12, R13, R14, R15, RBP};
 
+/*
+ * burst entry keeps its state in the stack frame,
+ * just above the saved registers.
+ */
+enum {
+	BURST_CTX_SLOT,   /* pointer to the current context */
+	BURST_RC_SLOT,    /* pointer to the current return value */
+	BURST_NUM_SLOT,   /* number of contexts left */
+	BURST_TOTAL_SLOT, /* total number of contexts */
+	BURST_SLOT_NUM
+};
+
 struct bpf_jit_state {
 	uint32_t idx;
 	size_t sz;
@@ -106,6 +118,15 @@ struct bpf_jit_state {
 	struct {
 		uint32_t stack_ofs;
 	} ldmb;
+	struct {
+		uint32_t on;      /* generating burst entry */
+		int32_t start;    /* offset of burst entry */
+		int32_t loop;     /* offset of the loop head */
+		int32_t done;     /* offset of the loop exit */
+		int32_t slot_ofs; /* offset of state slots from RSP */
+		int32_t exit;     /* saved exit.off for burst code */
+		int32_t *off;     /* saved per-instruction offsets */
+	} burst;
 	uint32_t reguse;
 	int32_t *off;
 	uint8_t *ins;
@@ -690,6 +711,21 @@ emit_call(struct bpf_jit_state *st, uintptr_t trg)
 	emit_modregrm(st, MOD_DIRECT, mods, RAX);
 }
 
+/*
+ * emit imul <imm>, %<sreg>, %<dreg>
+ */
+static void
+emit_imul_imm(struct bpf_jit_state *st, uint32_t op, uint32_t sreg,
+	uint32_t dreg, uint32_t imm)
+{
+	const uint8_t ops = 0x69;
+
+	emit_rex(st, op, dreg, sreg);
+	emit_bytes(st, &ops, sizeof(ops));
+	emit_modregrm(st, MOD_DIRECT, dreg, sreg);
+	emit_imm(st, imm, sizeof(imm));
+}
+
 /*
  * emit jmp <ofs>
  * where 'ofs' is the target offset for the native code.
@@ -1190,23 +1226,192 @@ emit_ld_mbuf(struct bpf_jit_state *st, uint32_t op, uint32_t sreg, uint32_t imm)
 	emit_ldmb_fin(st, rg[EBPF_REG_0], opsz, sz);
 }
 
+/*
+ * emit inline lookup into RTE_BPF_MAP_TYPE_ARRAY map:
+ * mov (%rsi), %eax
+ * mov <values>, %r11
+ * xor %r10, %r10
+ * cmp <max_entries>, %rax
+ * cmovae %r10, %r11
+ * cmovae %r10, %rax
+ * imul <elem_size>, %rax, %rax
+ * add %r11, %rax
+ * i.e. R0 = (idx < max_entries) ? values + idx * elem_size : NULL;
+ */
 static void
-emit_prolog(struct bpf_jit_state *st, int32_t stack_size)
+emit_map_array_lookup(struct bpf_jit_state *st, const struct rte_bpf_map *map)
+{
+	uint32_t rk, r0;
+	const uint32_t cmov = EBPF_ALU64 | BPF_JGE | BPF_X;
+
+	rk = ebpf2x86[EBPF_REG_2];
+	r0 = ebpf2x86[EBPF_REG_0];
+
+	emit_ld_reg(st, BPF_LDX | BPF_MEM | BPF_W, rk, r0, 0);
+	emit_ld_imm64(st, REG_TMP0, (uintptr_t)map->values,
+		(uint64_t)(uintptr_t)map->values >> 32);
+	emit_mov_imm(st, EBPF_ALU64 | EBPF_MOV | BPF_K, REG_TMP1, 0);
+	emit_cmp_imm(st, EBPF_ALU64, r0, map->max_entries);
+	emit_movcc_reg(st, cmov, REG_TMP1, REG_TMP0);
+	emit_movcc_reg(st, cmov, REG_TMP1, r0);
+	emit_imul_imm(st, EBPF_ALU64, r0, r0, map->elem_size);
+	emit_alu_reg(st, EBPF_ALU64 | BPF_ADD | BPF_X, REG_TMP0, r0);
+}
+
+/*
+ * emit call to one of built-in map helpers.
+ * When the validator was able to tell which map is used,
+ * lookup in array maps is done inline, otherwise call map type
+ * specific helper directly.
+ */
+static void
+emit_map_call(struct bpf_jit_state *st, const struct rte_bpf *bpf,
+	const struct ebpf_insn *ins)
+{
+	const struct rte_bpf_map *map;
+
+	map = (ins->off > 0) ? bpf->prm.xsym[ins->off - 1].map.val : NULL;
+
+	if (map != NULL && map->type == RTE_BPF_MAP_TYPE_ARRAY &&
+			ins->imm == RTE_BPF_MAP_FUNC_LOOKUP &&
+			map->max_entries <= INT32_MAX &&
+			map->elem_size <= INT32_MAX)
+		emit_map_array_lookup(st, map);
+	else
+		emit_call(st, __rte_bpf_map_jit_func(map, ins->imm));
+}
+
+/*
+ * emit prefetcht0 (%<reg>)
+ */
+static void
+emit_prefetch(struct bpf_jit_state *st, uint32_t reg)
+{
+	const uint8_t ops[] = {0x0F, 0x18};
+	const uint32_t mods = 1;
+
+	emit_rex(st, BPF_LDX | BPF_MEM | BPF_W, 0, reg);
+	emit_bytes(st, ops, sizeof(ops));
+	emit_modregrm(st, MOD_IDISP8, mods, reg);
+	if (reg == RSP || reg == R12)
+		emit_sib(st, SIB_SCALE_1, reg, reg);
+	emit_imm(st, 0, sizeof(uint8_t));
+}
+
+static int32_t
+burst_slot(const struct bpf_jit_state *st, uint32_t slot)
+{
+	return st->burst.slot_ofs + slot * sizeof(uint64_t);
+}
+
+/*
+ * head of the burst loop:
+ * mov BURST_CTX_SLOT(%rsp), %r11
+ * mov (%r11), %rdi
+ * mov BURST_NUM_SLOT(%rsp), %r9
+ * mov %r11, %r10
+ * add $8, %r10
+ * cmp $1, %r9
+ * cmovbe %r11, %r10
+ * mov (%r10), %r10
+ * prefetcht0 (%r10)
+ * i.e. R1 = ctx[i]; prefetch(ctx[i + 1]);
+ */
+static void
+emit_burst_head(struct bpf_jit_state *st)
+{
+	const uint32_t ldop = BPF_LDX | BPF_MEM | EBPF_DW;
+
+	st->burst.loop = st->sz;
+
+	emit_ld_reg(st, ldop, RSP, REG_TMP0,
+		burst_slot(st, BURST_CTX_SLOT));
+	emit_ld_reg(st, ldop, REG_TMP0, ebpf2x86[EBPF_REG_1], 0);
+
+	emit_ld_reg(st, ldop, RSP, REG_DIV_IMM,
+		burst_slot(st, BURST_NUM_SLOT));
+	emit_mov_reg(st, EBPF_ALU64 | EBPF_MOV | BPF_X, REG_TMP0, REG_TMP1);
+	emit_alu_imm(st, EBPF_ALU64 | BPF_ADD | BPF_K, REG_TMP1,
+		sizeof(uintptr_t));
+	emit_cmp_imm(st, EBPF_ALU64, REG_DIV_IMM, 1);
+	emit_movcc_reg(st, EBPF_ALU64 | EBPF_JLE | BPF_X, REG_TMP0, REG_TMP1);
+	emit_ld_reg(st, ldop, REG_TMP1, REG_TMP1, 0);
+	emit_prefetch(st, REG_TMP1);
+}
+
+/*
+ * tail of the burst loop, R0 contains return value:
+ * mov BURST_RC_SLOT(%rsp), %r11
+ * mov %rax, (%r11)
+ * add $8, %r11
+ * mov %r11, BURST_RC_SLOT(%rsp)
+ * mov BURST_CTX_SLOT(%rsp), %r11
+ * add $8, %r11
+ * mov %r11, BURST_CTX_SLOT(%rsp)
+ * mov BURST_NUM_SLOT(%rsp), %r10
+ * sub $1, %r10
+ * mov %r10, BURST_NUM_SLOT(%rsp)
+ * jne <loop_head>
+ * done:
+ * mov BURST_TOTAL_SLOT(%rsp), %eax
+ */
+static void
+emit_burst_tail(struct bpf_jit_state *st)
+{
+	const uint32_t ldop = BPF_LDX | BPF_MEM | EBPF_DW;
+	const uint32_t stop = BPF_STX | BPF_MEM | EBPF_DW;
+	const uint32_t addop = EBPF_ALU64 | BPF_ADD | BPF_K;
+
+	emit_ld_reg(st, ldop, RSP, REG_TMP0, burst_slot(st, BURST_RC_SLOT));
+	emit_st_reg(st, stop, ebpf2x86[EBPF_REG_0], REG_TMP0, 0);
+	emit_alu_imm(st, addop, REG_TMP0, sizeof(uint64_t));
+	emit_st_reg(st, stop, REG_TMP0, RSP, burst_slot(st, BURST_RC_SLOT));
+
+	emit_ld_reg(st, ldop, RSP, REG_TMP0, burst_slot(st, BURST_CTX_SLOT));
+	emit_alu_imm(st, addop, REG_TMP0, sizeof(uintptr_t));
+	emit_st_reg(st, stop, REG_TMP0, RSP, burst_slot(st, BURST_CTX_SLOT));
+
+	emit_ld_reg(st, ldop, RSP, REG_TMP1, burst_slot(st, BURST_NUM_SLOT));
+	emit_alu_imm(st, EBPF_ALU64 | BPF_SUB | BPF_K, REG_TMP1, 1);
+	emit_st_reg(st, stop, REG_TMP1, RSP, burst_slot(st, BURST_NUM_SLOT));
+	emit_abs_jcc(st, BPF_JMP | EBPF_JNE | BPF_K, st->burst.loop);
+
+	st->burst.done = st->sz;
+	emit_ld_reg(st, BPF_LDX | BPF_MEM | BPF_W, RSP, ebpf2x86[EBPF_REG_0],
+		burst_slot(st, BURST_TOTAL_SLOT));
+}
+
+/*
+ * number of 8B slots in the stack frame (except eBPF stack itself).
+ */
+static int32_t
+frame_slots(const struct bpf_jit_state *st)
 {
 	uint32_t i;
-	int32_t spil, ofs;
+	int32_t spil;
 
 	spil = 0;
 	for (i = 0; i != RTE_DIM(save_regs); i++)
 		spil += INUSE(st->reguse, save_regs[i]);
 
+	return spil;
+}
+
+static void
+emit_prolog(struct bpf_jit_state *st, int32_t stack_size)
+{
+	uint32_t i;
+	int32_t frame, spil, ofs;
+
+	spil = frame_slots(st);
+	frame = spil + (st->burst.on ? BURST_SLOT_NUM : 0);
+
 	/* we can avoid touching the stack at all */
-	if (spil == 0)
+	if (frame == 0)
 		return;
 
-
 	emit_alu_imm(st, EBPF_ALU64 | BPF_SUB | BPF_K, RSP,
-		spil * sizeof(uint64_t));
+		frame * sizeof(uint64_t));
 
 	ofs = 0;
 	for (i = 0; i != RTE_DIM(save_regs); i++) {
@@ -1217,9 +1422,31 @@ emit_prolog(struct bpf_jit_state *st, int32_t stack_size)
 		}
 	}
 
+	/* burst entry: (void *ctx[], uint64_t rc[], uint32_t num) */
+	if (st->burst.on) {
+		st->burst.slot_ofs = ofs;
+		emit_mov_reg(st, BPF_ALU | EBPF_MOV | BPF_X, RDX, RDX);
+		emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, RDI, RSP,
+			burst_slot(st, BURST_CTX_SLOT));
+		emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, RSI, RSP,
+			burst_slot(st, BURST_RC_SLOT));
+		emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, RDX, RSP,
+			burst_slot(st, BURST_NUM_SLOT));
+		emit_st_reg(st, BPF_STX | BPF_MEM | EBPF_DW, RDX, RSP,
+			burst_slot(st, BURST_TOTAL_SLOT));
+	}
+
 	if (INUSE(st->reguse, RBP) != 0) {
 		emit_mov_reg(st, EBPF_ALU64 | EBPF_MOV | BPF_X, RSP, RBP);
 		emit_alu_imm(st, EBPF_ALU64 | BPF_SUB | BPF_K, RSP, stack_size);
+		if (st->burst.on)
+			st->burst.slot_ofs += stack_size;
+	}
+
+	if (st->burst.on) {
+		emit_tst_reg(st, EBPF_ALU64, RDX, RDX);
+		emit_abs_jcc(st, BPF_JMP | BPF_JEQ | BPF_K, st->burst.done);
+		emit_burst_head(st);
 	}
 }
 
@@ -1238,7 +1465,7 @@ static void
 emit_epilog(struct bpf_jit_state *st)
 {
 	uint32_t i;
-	int32_t spil, ofs;
+	int32_t frame, spil, ofs;
 
 	/* if we already have an epilog generate a jump to it */
 	if (st->exit.num++ != 0) {
@@ -1249,11 +1476,14 @@ emit_epilog(struct bpf_jit_state *st)
 	/* store offset of epilog block */
 	st->exit.off = st->sz;
 
-	spil = 0;
-	for (i = 0; i != RTE_DIM(save_regs); i++)
-		spil += INUSE(st->reguse, save_regs[i]);
+	/* store return value and proceed with the next context */
+	if (st->burst.on)
+		emit_burst_tail(st);
+
+	spil = frame_slots(st);
+	frame = spil + (st->burst.on ? BURST_SLOT_NUM : 0);
 
-	if (spil != 0) {
+	if (frame != 0) {
 
 		if (INUSE(st->reguse, RBP) != 0)
 			emit_mov_reg(st, EBPF_ALU64 | EBPF_MOV | BPF_X,
@@ -1269,7 +1499,7 @@ emit_epilog(struct bpf_jit_state *st)
 		}
 
 		emit_alu_imm(st, EBPF_ALU64 | BPF_ADD | BPF_K, RSP,
-			spil * sizeof(uint64_t));
+			frame * sizeof(uint64_t));
 	}
 
 	emit_ret(st);
@@ -1285,7 +1515,6 @@ emit(struct bpf_jit_state *st, const struct rte_bpf *bpf)
 	const struct ebpf_insn *ins;
 
 	/* reset state fields */
-	st->sz = 0;
 	st->exit.num = 0;
 	st->ldmb.stack_ofs = bpf->stack_sz;
 
@@ -1468,8 +1697,11 @@ emit(struct bpf_jit_state *st, const struct rte_bpf *bpf)
 			break;
 		/* call instructions */
 		case (BPF_JMP | EBPF_CALL):
-			emit_call(st,
-				(uintptr_t)bpf->prm.xsym[ins->imm].func.val);
+			if (ins->src_reg == EBPF_PSEUDO_MAP_CALL)
+				emit_map_call(st, bpf, ins);
+			else
+				emit_call(st,
+					(uintptr_t)bpf->prm.xsym[ins->imm].func.val);
 			break;
 		/* return instruction */
 		case (BPF_JMP | EBPF_EXIT):
@@ -1486,6 +1718,41 @@ emit(struct bpf_jit_state *st, const struct rte_bpf *bpf)
 	return 0;
 }
 
+/*
+ * generate code for both entry points:
+ * per context function first, then burst function that runs
+ * the program in a loop over an array of contexts.
+ * Each of them has its own set of native code offsets.
+ */
+static int
+emit_all(struct bpf_jit_state *st, const struct rte_bpf *bpf)
+{
+	int32_t rc, exit_off;
+	int32_t *off;
+
+	st->sz = 0;
+	st->burst.on = 0;
+	rc = emit(st, bpf);
+	if (rc != 0)
+		return rc;
+
+	off = st->off;
+	exit_off = st->exit.off;
+	st->off = st->burst.off;
+	st->exit.off = st->burst.exit;
+
+	st->burst.on = 1;
+	st->burst.start = st->sz;
+	rc = emit(st, bpf);
+
+	st->burst.off = st->off;
+	st->burst.exit = st->exit.off;
+	st->off = off;
+	st->exit.off = exit_off;
+
+	return rc;
+}
+
 /*
  * produce a native ISA version of the given BPF code.
  */
@@ -1499,13 +1766,16 @@ __rte_bpf_jit_x86(struct rte_bpf *bpf)
 
 	/* init state */
 	memset(&st, 0, sizeof(st));
-	st.off = malloc(bpf->prm.nb_ins * sizeof(st.off[0]));
+	st.off = malloc(2 * bpf->prm.nb_ins * sizeof(st.off[0]));
 	if (st.off == NULL)
 		return -ENOMEM;
+	st.burst.off = st.off + bpf->prm.nb_ins;
 
 	/* fill with fake offsets */
 	st.exit.off = INT32_MAX;
-	for (i = 0; i != bpf->prm.nb_ins; i++)
+	st.burst.exit = INT32_MAX;
+	st.burst.done = INT32_MAX;
+	for (i = 0; i != 2 * bpf->prm.nb_ins; i++)
 		st.off[i] = INT32_MAX;
 
 	/*
@@ -1514,7 +1784,7 @@ __rte_bpf_jit_x86(struct rte_bpf *bpf)
 	 */
 	do {
 		sz = st.sz;
-		rc = emit(&st, bpf);
+		rc = emit_all(&st, bpf);
 	} while (rc == 0 && sz != st.sz);
 
 	if (rc == 0) {
@@ -1526,7 +1796,7 @@ __rte_bpf_jit_x86(struct rte_bpf *bpf)
 			rc = -ENOMEM;
 		else
 			/* generate code */
-			rc = emit(&st, bpf);
+			rc = emit_all(&st, bpf);
 	}
 
 	if (rc == 0 && mprotect(st.ins, st.sz, PROT_READ | PROT_EXEC) != 0)
@@ -1536,6 +1806,7 @@ __rte_bpf_jit_x86(struct rte_bpf *bpf)
 		munmap(st.ins, st.sz);
 	else {
 		bpf->jit.func = (void *)st.ins;
+		bpf->jit_burst = (void *)(st.ins + st.burst.start);
 		bpf->jit.sz = st.sz;
 	}
 
@@ -73,6 +73,9 @@ bpf_check_xsym(const struct rte_bpf_xsym *xsym)
 		if (xsym->func.ret.type != RTE_BPF_ARG_UNDEF &&
 				xsym->func.ret.size == 0)
 			return -EINVAL;
+	} else if (xsym->type == RTE_BPF_XTYPE_MAP) {
+		if (xsym->map.val == NULL)
+			return -EINVAL;
 	} else
 		return -EINVAL;
 
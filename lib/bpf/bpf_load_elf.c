@@ -49,6 +49,38 @@ bpf_find_xsym(const char *sn, enum rte_bpf_xtype type,
 	return (i != fn) ? i : UINT32_MAX;
 }
 
+/*
+ * find built-in map helper by name,
+ * accept both our and Linux kernel names.
+ */
+static uint32_t
+bpf_find_map_func(const char *sn)
+{
+	uint32_t i;
+
+	static const struct {
+		const char *name;
+		uint32_t id;
+	} map_func[] = {
+		{ "rte_bpf_map_lookup_elem", RTE_BPF_MAP_FUNC_LOOKUP, },
+		{ "rte_bpf_map_update_elem", RTE_BPF_MAP_FUNC_UPDATE, },
+		{ "rte_bpf_map_delete_elem", RTE_BPF_MAP_FUNC_DELETE, },
+		{ "bpf_map_lookup_elem", RTE_BPF_MAP_FUNC_LOOKUP, },
+		{ "bpf_map_update_elem", RTE_BPF_MAP_FUNC_UPDATE, },
+		{ "bpf_map_delete_elem", RTE_BPF_MAP_FUNC_DELETE, },
+	};
+
+	if (sn == NULL)
+		return UINT32_MAX;
+
+	for (i = 0; i != RTE_DIM(map_func); i++) {
+		if (strcmp(sn, map_func[i].name) == 0)
+			return map_func[i].id;
+	}
+
+	return UINT32_MAX;
+}
+
 /*
  * update BPF code at offset *ofs* with a proper address(index) for external
  * symbol *sn*
@@ -73,6 +105,29 @@ resolve_xsym(const char *sn, size_t ofs, struct ebpf_insn *ins, size_t ins_sz,
 		return -EINVAL;
 
 	fidx = bpf_find_xsym(sn, type, prm->xsym, prm->nb_xsym);
+
+	/* not a variable, might be a map */
+	if (fidx == UINT32_MAX && type == RTE_BPF_XTYPE_VAR) {
+		fidx = bpf_find_xsym(sn, RTE_BPF_XTYPE_MAP, prm->xsym,
+			prm->nb_xsym);
+		if (fidx != UINT32_MAX) {
+			ins[idx].imm = (uintptr_t)prm->xsym[fidx].map.val;
+			ins[idx + 1].imm =
+				(uint64_t)(uintptr_t)prm->xsym[fidx].map.val >> 32;
+			return 0;
+		}
+	}
+
+	/* not an external function, might be one of map helpers */
+	if (fidx == UINT32_MAX && type == RTE_BPF_XTYPE_FUNC) {
+		fidx = bpf_find_map_func(sn);
+		if (fidx != UINT32_MAX) {
+			ins[idx].src_reg = EBPF_PSEUDO_MAP_CALL;
+			ins[idx].imm = fidx;
+			return 0;
+		}
+	}
+
 	if (fidx == UINT32_MAX)
 		return -ENOENT;
 
@@ -0,0 +1,724 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2018 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_hash.h>
+#include <rte_lpm.h>
+#include <rte_rcu_qsbr.h>
+
+#include "bpf_impl.h"
+
+/* rte_hash needs at least one full bucket of entries */
+#define BPF_MAP_HASH_MIN_ENTRIES	8
+
+/* rte_lpm keeps only 24 bits of the next hop */
+#define BPF_MAP_LPM_MAX_ENTRIES		(1 << 24)
+
+#define BPF_MAP_TYPE_NUM	(RTE_BPF_MAP_TYPE_LPM + 1)
+
+/* element of the defer queue of hash and LPM maps */
+struct bpf_map_dq_elem {
+	int32_t key_pos; /* hash key position to free, -1 for LPM */
+	uint32_t idx;    /* value to free */
+};
+
+struct bpf_map_ops {
+	void *(*lookup)(const struct rte_bpf_map *map, const void *key);
+	int64_t (*update)(struct rte_bpf_map *map, const void *key,
+		const void *value, uint64_t flags);
+	int64_t (*delete)(struct rte_bpf_map *map, const void *key);
+};
+
+static inline void *
+bpf_map_value(const struct rte_bpf_map *map, uint32_t idx)
+{
+	return map->values + (size_t)idx * map->elem_size;
+}
+
+/*
+ * Values of hash and LPM maps are taken from the free_slots stack,
+ * the lock is expected to be held.
+ */
+static inline int32_t
+bpf_map_slot_get(struct rte_bpf_map *map)
+{
+	/* try to get back values of the deleted elements first */
+	if (map->nb_free == 0 && map->dq != NULL)
+		rte_rcu_qsbr_dq_reclaim(map->dq, UINT32_MAX, NULL, NULL, NULL);
+
+	if (map->nb_free == 0)
+		return -E2BIG;
+
+	return map->free_slots[--map->nb_free];
+}
+
+static void
+bpf_map_slot_free(struct rte_bpf_map *map, int32_t key_pos, uint32_t idx)
+{
+	/* new element in that slot should start with zero value */
+	memset(bpf_map_value(map, idx), 0, map->value_size);
+	map->free_slots[map->nb_free++] = idx;
+
+	/* lock-free mode doesn't free key slot on delete */
+	if (key_pos >= 0)
+		rte_hash_free_key_with_position(map->hash, key_pos);
+}
+
+/* Called by the defer queue, with the lock held. */
+static void
+bpf_map_dq_free(void *p, void *e, unsigned int n)
+{
+	unsigned int i;
+	struct rte_bpf_map *map = p;
+	const struct bpf_map_dq_elem *de = e;
+
+	for (i = 0; i != n; i++)
+		bpf_map_slot_free(map, de[i].key_pos, de[i].idx);
+}
+
+/*
+ * Release the value of a deleted element, the lock is expected to be held.
+ * Without RCU the value is reused right away.
+ */
+static void
+bpf_map_slot_release(struct rte_bpf_map *map, int32_t key_pos, uint32_t idx)
+{
+	struct bpf_map_dq_elem de = {
+		.key_pos = key_pos,
+		.idx = idx,
+	};
+
+	/* defer queue is sized to hold all values, enqueue can't fail */
+	if (map->dq == NULL ||
+			rte_rcu_qsbr_dq_enqueue(map->dq, &de) != 0)
+		bpf_map_slot_free(map, key_pos, idx);
+}
+
+/*
+ * RTE_BPF_MAP_TYPE_ARRAY
+ */
+
+static void *
+array_lookup(const struct rte_bpf_map *map, const void *key)
+{
+	uint32_t idx;
+
+	idx = *(const uint32_t *)key;
+	if (idx >= map->max_entries)
+		return NULL;
+
+	return bpf_map_value(map, idx);
+}
+
+static int64_t
+array_update(struct rte_bpf_map *map, const void *key, const void *value,
+	uint64_t flags)
+{
+	void *val;
+
+	if (flags == RTE_BPF_MAP_NOEXIST)
+		return -EEXIST;
+
+	val = array_lookup(map, key);
+	if (val == NULL)
+		return -E2BIG;
+
+	memcpy(val, value, map->value_size);
+	return 0;
+}
+
+static int64_t
+array_delete(struct rte_bpf_map *map, const void *key)
+{
+	RTE_SET_USED(map);
+	RTE_SET_USED(key);
+	return -EINVAL;
+}
+
+/*
+ * RTE_BPF_MAP_TYPE_PERCPU_ARRAY
+ */
+
+static inline void *
+percpu_array_lookup_lcore(const struct rte_bpf_map *map, const void *key,
+	uint32_t lcore_id)
+{
+	uint32_t idx;
+
+	idx = *(const uint32_t *)key;
+	if (idx >= map->max_entries || lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	return (uint8_t *)bpf_map_value(map, idx) +
+		lcore_id * map->lcore_stride;
+}
+
+static void *
+percpu_array_lookup(const struct rte_bpf_map *map, const void *key)
+{
+	return percpu_array_lookup_lcore(map, key, rte_lcore_id());
+}
+
+static int64_t
+percpu_array_update(struct rte_bpf_map *map, const void *key,
+	const void *value, uint64_t flags)
+{
+	uint32_t idx;
+	void *val;
+
+	if (flags == RTE_BPF_MAP_NOEXIST)
+		return -EEXIST;
+
+	idx = *(const uint32_t *)key;
+	if (idx >= map->max_entries)
+		return -E2BIG;
+
+	val = percpu_array_lookup(map, key);
+	if (val == NULL)
+		return -EINVAL;
+
+	memcpy(val, value, map->value_size);
+	return 0;
+}
+
+/*
+ * RTE_BPF_MAP_TYPE_HASH
+ */
+
+static void *
+hash_lookup(const struct rte_bpf_map *map, const void *key)
+{
+	void *val;
+
+	if (rte_hash_lookup_data(map->hash, key, &val) < 0)
+		return NULL;
+
+	return val;
+}
+
+static int64_t
+hash_update(struct rte_bpf_map *map, const void *key, const void *value,
+	uint64_t flags)
+{
+	int32_t rc, idx;
+	void *val;
+
+	rte_spinlock_lock(&map->lock);
+
+	if (rte_hash_lookup_data(map->hash, key, &val) >= 0) {
+		if (flags == RTE_BPF_MAP_NOEXIST)
+			rc = -EEXIST;
+		else {
+			memcpy(val, value, map->value_size);
+			rc = 0;
+		}
+	} else if (flags == RTE_BPF_MAP_EXIST) {
+		rc = -ENOENT;
+	} else {
+		idx = bpf_map_slot_get(map);
+		if (idx < 0) {
+			rc = idx;
+			goto out;
+		}
+
+		/*
+		 * fill the value before the key becomes visible,
+		 * rte_hash publishes the key with a release store.
+		 */
+		val = bpf_map_value(map, idx);
+		memcpy(val, value, map->value_size);
+		rc = rte_hash_add_key_data(map->hash, key, val);
+		if (rc != 0) {
+			map->free_slots[map->nb_free++] = idx;
+			if (rc == -ENOSPC)
+				rc = -E2BIG;
+		}
+	}
+out:
+	rte_spinlock_unlock(&map->lock);
+	return rc;
+}
+
+static int64_t
+hash_delete(struct rte_bpf_map *map, const void *key)
+{
+	int32_t pos;
+	void *val;
+
+	rte_spinlock_lock(&map->lock);
+
+	pos = rte_hash_lookup_data(map->hash, key, &val);
+	if (pos >= 0)
+		pos = rte_hash_del_key(map->hash, key);
+	if (pos >= 0)
+		bpf_map_slot_release(map, pos,
+			((uint8_t *)val - map->values) / map->elem_size);
+
+	rte_spinlock_unlock(&map->lock);
+	return (pos < 0) ? -ENOENT : 0;
+}
+
+/*
+ * RTE_BPF_MAP_TYPE_LPM
+ * Next hop stored in rte_lpm is the index of the value,
+ * unused values are kept in the free_slots stack.
+ */
+
+static void *
+lpm_lookup(const struct rte_bpf_map *map, const void *key)
+{
+	uint32_t idx;
+	const struct rte_bpf_map_lpm_key *lk;
+
+	lk = key;
+	if (rte_lpm_lookup(map->lpm, rte_be_to_cpu_32(lk->addr), &idx) != 0)
+		return NULL;
+
+	return bpf_map_value(map, idx);
+}
+
+static int
+lpm_check_key(const struct rte_bpf_map_lpm_key *lk)
+{
+	return (lk->prefixlen == 0 || lk->prefixlen > RTE_LPM_MAX_DEPTH) ?
+		-EINVAL : 0;
+}
+
+static int64_t
+lpm_update(struct rte_bpf_map *map, const void *key, const void *value,
+	uint64_t flags)
+{
+	int32_t rc;
+	uint32_t idx, ip;
+	const struct rte_bpf_map_lpm_key *lk;
+
+	lk = key;
+	rc = lpm_check_key(lk);
+	if (rc != 0)
+		return rc;
+
+	ip = rte_be_to_cpu_32(lk->addr);
+
+	rte_spinlock_lock(&map->lock);
+
+	if (rte_lpm_is_rule_present(map->lpm, ip, lk->prefixlen, &idx) == 1) {
+		if (flags == RTE_BPF_MAP_NOEXIST)
+			rc = -EEXIST;
+		else
+			memcpy(bpf_map_value(map, idx), value, map->value_size);
+	} else if (flags == RTE_BPF_MAP_EXIST) {
+		rc = -ENOENT;
+	} else if ((rc = bpf_map_slot_get(map)) >= 0) {
+		/* fill the value before the prefix becomes visible */
+		idx = rc;
+		memcpy(bpf_map_value(map, idx), value, map->value_size);
+		rc = rte_lpm_add(map->lpm, ip, lk->prefixlen, idx);
+		if (rc != 0) {
+			map->free_slots[map->nb_free++] = idx;
+			if (rc == -ENOSPC)
+				rc = -E2BIG;
+		}
+	}
+
+	rte_spinlock_unlock(&map->lock);
+	return rc;
+}
+
+static int64_t
+lpm_delete(struct rte_bpf_map *map, const void *key)
+{
+	int32_t rc;
+	uint32_t idx, ip;
+	const struct rte_bpf_map_lpm_key *lk;
+
+	lk = key;
+	rc = lpm_check_key(lk);
+	if (rc != 0)
+		return rc;
+
+	ip = rte_be_to_cpu_32(lk->addr);
+
+	rte_spinlock_lock(&map->lock);
+
+	if (rte_lpm_is_rule_present(map->lpm, ip, lk->prefixlen, &idx) != 1)
+		rc = -ENOENT;
+	else {
+		rc = rte_lpm_delete(map->lpm, ip, lk->prefixlen);
+		if (rc == 0)
+			bpf_map_slot_release(map, -1, idx);
+	}
+
+	rte_spinlock_unlock(&map->lock);
+	return rc;
+}
+
+static const struct bpf_map_ops bpf_map_ops[BPF_MAP_TYPE_NUM] = {
+	[RTE_BPF_MAP_TYPE_ARRAY] = {
+		.lookup = array_lookup,
+		.update = array_update,
+		.delete = array_delete,
+	},
+	[RTE_BPF_MAP_TYPE_PERCPU_ARRAY] = {
+		.lookup = percpu_array_lookup,
+		.update = percpu_array_update,
+		.delete = array_delete,
+	},
+	[RTE_BPF_MAP_TYPE_HASH] = {
+		.lookup = hash_lookup,
+		.update = hash_update,
+		.delete = hash_delete,
+	},
+	[RTE_BPF_MAP_TYPE_LPM] = {
+		.lookup = lpm_lookup,
+		.update = lpm_update,
+		.delete = lpm_delete,
+	},
+};
+
+/*
+ * generic versions, dispatch on map type.
+ */
+
+static void *
+bpf_map_lookup(const struct rte_bpf_map *map, const void *key)
+{
+	return bpf_map_ops[map->type].lookup(map, key);
+}
+
+static int64_t
+bpf_map_update(struct rte_bpf_map *map, const void *key, const void *value,
+	uint64_t flags)
+{
+	if (flags > RTE_BPF_MAP_EXIST)
+		return -EINVAL;
+
+	return bpf_map_ops[map->type].update(map, key, value, flags);
+}
+
+static int64_t
+bpf_map_delete(struct rte_bpf_map *map, const void *key)
+{
+	return bpf_map_ops[map->type].delete(map, key);
+}
+
+uint64_t
+__rte_bpf_map_call(uint32_t func, uint64_t r1, uint64_t r2, uint64_t r3,
+	uint64_t r4)
+{
+	struct rte_bpf_map *map;
+
+	map = (struct rte_bpf_map *)(uintptr_t)r1;
+
+	switch (func) {
+	case RTE_BPF_MAP_FUNC_LOOKUP:
+		return (uintptr_t)bpf_map_lookup(map,
+			(const void *)(uintptr_t)r2);
+	case RTE_BPF_MAP_FUNC_UPDATE:
+		return bpf_map_update(map, (const void *)(uintptr_t)r2,
+			(const void *)(uintptr_t)r3, r4);
+	case RTE_BPF_MAP_FUNC_DELETE:
+		return bpf_map_delete(map, (const void *)(uintptr_t)r2);
+	default:
+		return -EINVAL;
+	}
+}
+
+uintptr_t
+__rte_bpf_map_jit_func(const struct rte_bpf_map *map, uint32_t func)
+{
+	const struct bpf_map_ops *ops;
+
+	switch (func) {
+	case RTE_BPF_MAP_FUNC_LOOKUP:
+		if (map == NULL)
+			return (uintptr_t)bpf_map_lookup;
+		ops = bpf_map_ops + map->type;
+		return (uintptr_t)ops->lookup;
+	case RTE_BPF_MAP_FUNC_UPDATE:
+		/* flags are checked by generic version only */
+		return (uintptr_t)bpf_map_update;
+	case RTE_BPF_MAP_FUNC_DELETE:
+		if (map == NULL)
+			return (uintptr_t)bpf_map_delete;
+		ops = bpf_map_ops + map->type;
+		return (uintptr_t)ops->delete;
+	default:
+		return 0;
+	}
+}
+
+static int
+bpf_map_check_prm(const struct rte_bpf_map_prm *prm)
+{
+	uint64_t sz;
+
+	if (prm == NULL || prm->name == NULL ||
+			strnlen(prm->name, RTE_BPF_MAP_NAMESIZE) ==
+			RTE_BPF_MAP_NAMESIZE ||
+			prm->value_size == 0 || prm->max_entries == 0)
+		return -EINVAL;
+
+	switch (prm->type) {
+	case RTE_BPF_MAP_TYPE_ARRAY:
+	case RTE_BPF_MAP_TYPE_PERCPU_ARRAY:
+		if (prm->key_size != sizeof(uint32_t))
+			return -EINVAL;
+		break;
+	case RTE_BPF_MAP_TYPE_HASH:
+		if (prm->key_size == 0)
+			return -EINVAL;
+		break;
+	case RTE_BPF_MAP_TYPE_LPM:
+		if (prm->key_size != sizeof(struct rte_bpf_map_lpm_key) ||
+				prm->max_entries > BPF_MAP_LPM_MAX_ENTRIES)
+			return -EINVAL;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/* total size of values must fit into 32-bit JIT offsets */
+	sz = (uint64_t)RTE_ALIGN_CEIL(prm->value_size, sizeof(uint64_t)) *
+		prm->max_entries;
+	if (sz > INT32_MAX)
+		return -EINVAL;
+
+	return 0;
+}
+
+static int
+bpf_map_slots_create(struct rte_bpf_map *map,
+	const struct rte_bpf_map_prm *prm)
+{
+	uint32_t i;
+
+	map->free_slots = rte_zmalloc_socket(prm->name,
+		prm->max_entries * sizeof(map->free_slots[0]), 0,
+		prm->socket_id);
+	if (map->free_slots == NULL)
+		return -ENOMEM;
+
+	/* hand out lower indexes first */
+	for (i = 0; i != prm->max_entries; i++)
+		map->free_slots[i] = prm->max_entries - i - 1;
+	map->nb_free = prm->max_entries;
+	rte_spinlock_init(&map->lock);
+
+	return 0;
+}
+
+static int
+bpf_map_hash_create(struct rte_bpf_map *map, const struct rte_bpf_map_prm *prm)
+{
+	int32_t rc;
+	struct rte_hash_parameters hprm = {
+		.name = prm->name,
+		.entries = RTE_MAX(prm->max_entries,
+			(uint32_t)BPF_MAP_HASH_MIN_ENTRIES),
+		.key_len = prm->key_size,
+		.socket_id = prm->socket_id,
+		/* lock-free lookups from the data-path */
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
+	};
+
+	rc = bpf_map_slots_create(map, prm);
+	if (rc != 0)
+		return rc;
+
+	map->hash = rte_hash_create(&hprm);
+	if (map->hash == NULL)
+		return -rte_errno;
+
+	return prm->max_entries;
+}
+
+static int
+bpf_map_lpm_create(struct rte_bpf_map *map, const struct rte_bpf_map_prm *prm)
+{
+	int32_t rc;
+	struct rte_lpm_config cfg = {
+		.max_rules = prm->max_entries,
+		.number_tbl8s = RTE_MIN(prm->max_entries,
+			(uint32_t)RTE_LPM_TBL8_NUM_GROUPS),
+	};
+
+	rc = bpf_map_slots_create(map, prm);
+	if (rc != 0)
+		return rc;
+
+	map->lpm = rte_lpm_create(prm->name, prm->socket_id, &cfg);
+	if (map->lpm == NULL)
+		return -rte_errno;
+
+	return prm->max_entries;
+}
+
+struct rte_bpf_map *
+rte_bpf_map_create(const struct rte_bpf_map_prm *prm)
+{
+	int32_t rc;
+	uint32_t n;
+	size_t sz;
+	struct rte_bpf_map *map;
+
+	rc = bpf_map_check_prm(prm);
+	if (rc != 0) {
+		rte_errno = -rc;
+		return NULL;
+	}
+
+	map = rte_zmalloc_socket(prm->name, sizeof(*map), RTE_CACHE_LINE_SIZE,
+		prm->socket_id);
+	if (map == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	strlcpy(map->name, prm->name, sizeof(map->name));
+	map->type = prm->type;
+	map->key_size = prm->key_size;
+	map->value_size = prm->value_size;
+	map->max_entries = prm->max_entries;
+	map->elem_size = RTE_ALIGN_CEIL(prm->value_size, sizeof(uint64_t));
+
+	/* number of value elements to allocate */
+	if (prm->type == RTE_BPF_MAP_TYPE_HASH)
+		rc = bpf_map_hash_create(map, prm);
+	else if (prm->type == RTE_BPF_MAP_TYPE_LPM)
+		rc = bpf_map_lpm_create(map, prm);
+	else
+		rc = prm->max_entries;
+
+	if (rc < 0) {
+		rte_bpf_map_free(map);
+		rte_errno = -rc;
+		return NULL;
+	}
+
+	n = rc;
+	sz = (size_t)n * map->elem_size;
+
+	/* keep per-lcore copies on separate cache lines */
+	if (prm->type == RTE_BPF_MAP_TYPE_PERCPU_ARRAY) {
+		map->lcore_stride = RTE_ALIGN_CEIL(sz, RTE_CACHE_LINE_SIZE);
+		sz = map->lcore_stride * RTE_MAX_LCORE;
+	}
+
+	map->values = rte_zmalloc_socket(prm->name, sz, RTE_CACHE_LINE_SIZE,
+		prm->socket_id);
+	if (map->values == NULL) {
+		rte_bpf_map_free(map);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	RTE_BPF_LOG_LINE(DEBUG, "%s(%s): type=%d, key_size=%u, value_size=%u, "
+		"max_entries=%u, values=%zu bytes",
+		__func__, map->name, map->type, map->key_size,
+		map->value_size, map->max_entries, sz);
+	return map;
+}
+
+void
+rte_bpf_map_free(struct rte_bpf_map *map)
+{
+	if (map == NULL)
+		return;
+
+	rte_rcu_qsbr_dq_delete(map->dq);
+	rte_hash_free(map->hash);
+	rte_lpm_free(map->lpm);
+	rte_free(map->free_slots);
+	rte_free(map->values);
+	rte_free(map);
+}
+
+int
+rte_bpf_map_rcu_qsbr_add(struct rte_bpf_map *map, struct rte_rcu_qsbr *v)
+{
+	char name[RTE_RCU_QSBR_DQ_NAMESIZE];
+	struct rte_rcu_qsbr_dq_parameters params = {
+		.name = name,
+		/* map updates are serialized by the map lock */
+		.flags = RTE_RCU_QSBR_DQ_MT_UNSAFE,
+		.size = map != NULL ? map->max_entries : 0,
+		.esize = sizeof(struct bpf_map_dq_elem),
+		/* reclaim on demand, when the map runs out of values */
+		.trigger_reclaim_limit = UINT32_MAX,
+		.max_reclaim_size = UINT32_MAX,
+		.free_fn = bpf_map_dq_free,
+		.p = map,
+		.v = v,
+	};
+
+	if (map == NULL || v == NULL || (map->type != RTE_BPF_MAP_TYPE_HASH &&
+			map->type != RTE_BPF_MAP_TYPE_LPM))
+		return -EINVAL;
+
+	rte_spinlock_lock(&map->lock);
+	if (map->dq != NULL) {
+		rte_spinlock_unlock(&map->lock);
+		return -EEXIST;
+	}
+
+	snprintf(name, sizeof(name), "BPF_DQ_%s", map->name);
+	map->dq = rte_rcu_qsbr_dq_create(&params);
+	rte_spinlock_unlock(&map->lock);
+
+	if (map->dq == NULL) {
+		RTE_BPF_LOG_LINE(ERR, "%s(%s): failed to create defer queue",
+			__func__, map->name);
+		return -rte_errno;
+	}
+
+	return 0;
+}
+
+void *
+rte_bpf_map_lookup_elem(const struct rte_bpf_map *map, const void *key)
+{
+	if (map == NULL || key == NULL)
+		return NULL;
+
+	return bpf_map_lookup(map, key);
+}
+
+void *
+rte_bpf_map_lookup_lcore_elem(const struct rte_bpf_map *map, const void *key,
+	uint32_t lcore_id)
+{
+	if (map == NULL || key == NULL ||
+			map->type != RTE_BPF_MAP_TYPE_PERCPU_ARRAY)
+		return NULL;
+
+	return percpu_array_lookup_lcore(map, key, lcore_id);
+}
+
+int
+rte_bpf_map_update_elem(struct rte_bpf_map *map, const void *key,
+	const void *value, uint64_t flags)
+{
+	if (map == NULL || key == NULL || value == NULL)
+		return -EINVAL;
+
+	return bpf_map_update(map, key, value, flags);
+}
+
+int
+rte_bpf_map_delete_elem(struct rte_bpf_map *map, const void *key)
+{
+	if (map == NULL || key == NULL)
+		return -EINVAL;
+
+	return bpf_map_delete(map, key);
+}
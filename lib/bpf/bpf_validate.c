@@ -15,6 +15,9 @@
 
 #define BPF_ARG_PTR_STACK RTE_BPF_ARG_RESERVED
 
+/* map handle, can't be dereferenced, only passed to map helpers */
+#define BPF_ARG_PTR_MAP (RTE_BPF_ARG_RESERVED + 1)
+
 struct bpf_reg_val {
 	struct rte_bpf_arg v;
 	uint64_t mask;
@@ -26,6 +29,7 @@ struct bpf_reg_val {
 		uint64_t min;
 		uint64_t max;
 	} u;
+	const struct rte_bpf_xsym *map; /* valid for BPF_ARG_PTR_MAP only */
 };
 
 struct bpf_eval_state {
@@ -65,6 +69,11 @@ struct inst_node {
 	uint8_t edge_type[MAX_EDGES];
 	uint32_t edge_dest[MAX_EDGES];
 	uint32_t prev_node;
+	/*
+	 * for map helper calls: 1 + xsym index of the map used,
+	 * -1 if different maps reach that call.
+	 */
+	int32_t map_xsym;
 	struct {
 		struct bpf_eval_state *cur;   /* save/restore for jcc targets */
 		struct bpf_eval_state *start;
@@ -212,6 +221,17 @@ eval_ld_imm64(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 			eval_fill_imm64(rd, UINT64_MAX, 0);
 			break;
 		}
+
+		/* load of external map handle */
+		if (bvf->prm->xsym[i].type == RTE_BPF_XTYPE_MAP &&
+				(uintptr_t)bvf->prm->xsym[i].map.val == val) {
+			rd->v.type = BPF_ARG_PTR_MAP;
+			rd->v.size = 0;
+			rd->v.buf_size = 0;
+			rd->map = bvf->prm->xsym + i;
+			eval_fill_imm64(rd, UINT64_MAX, 0);
+			break;
+		}
 	}
 
 	return NULL;
@@ -985,6 +1005,93 @@ eval_func_arg(struct bpf_verifier *bvf, const struct rte_bpf_arg *arg,
 	return err;
 }
 
+/*
+ * evaluate call to the built-in map helper:
+ * R1 - map, R2 - key, R3 - value and R4 - flags (for update only).
+ */
+static const char *
+eval_map_call(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
+{
+	int32_t idx;
+	uint32_t i, nb_args;
+	struct bpf_reg_val *rv;
+	struct inst_node *node;
+	const struct rte_bpf_map *map;
+	struct rte_bpf_arg args[EBPF_FUNC_MAX_ARGS - 1], ret;
+	const char *err;
+
+	/* for now don't support function calls on 32 bit platform */
+	if (sizeof(uint64_t) != sizeof(uintptr_t))
+		return "function calls are supported only for 64 bit apps";
+
+	rv = bvf->evst->rv + EBPF_REG_1;
+	if (rv->v.type != BPF_ARG_PTR_MAP || rv->mask != UINT64_MAX ||
+			rv->u.min != 0 || rv->u.max != 0)
+		return "invalid map argument";
+
+	map = rv->map->map.val;
+
+	memset(args, 0, sizeof(args));
+	args[0].type = RTE_BPF_ARG_PTR;
+	args[0].size = map->key_size;
+
+	memset(&ret, 0, sizeof(ret));
+	ret.type = RTE_BPF_ARG_RAW;
+	ret.size = sizeof(uint64_t);
+
+	switch (ins->imm) {
+	case RTE_BPF_MAP_FUNC_LOOKUP:
+		nb_args = 1;
+		ret.type = RTE_BPF_ARG_PTR;
+		ret.size = map->value_size;
+		break;
+	case RTE_BPF_MAP_FUNC_UPDATE:
+		nb_args = 3;
+		args[1].type = RTE_BPF_ARG_PTR;
+		args[1].size = map->value_size;
+		args[2].type = RTE_BPF_ARG_RAW;
+		args[2].size = sizeof(uint64_t);
+		break;
+	case RTE_BPF_MAP_FUNC_DELETE:
+		nb_args = 1;
+		break;
+	default:
+		return "invalid map helper id";
+	}
+
+	/* evaluate function arguments, following the map */
+	err = NULL;
+	for (i = 0; i != nb_args && err == NULL; i++) {
+		err = eval_func_arg(bvf, args + i,
+			bvf->evst->rv + EBPF_REG_2 + i);
+	}
+
+	/* remember which map is used at that call, JIT can make use of it */
+	node = bvf->evin;
+	idx = rv->map - bvf->prm->xsym + 1;
+	if (node->map_xsym == 0)
+		node->map_xsym = idx;
+	else if (node->map_xsym != idx)
+		node->map_xsym = -1;
+
+	/* R1-R5 argument/scratch registers */
+	for (i = EBPF_REG_1; i != EBPF_REG_6; i++)
+		bvf->evst->rv[i].v.type = RTE_BPF_ARG_UNDEF;
+
+	/*
+	 * update return value,
+	 * note that lookup returns NULL for missing elements.
+	 */
+	rv = bvf->evst->rv + EBPF_REG_0;
+	rv->v = ret;
+	if (rv->v.type == RTE_BPF_ARG_RAW)
+		eval_fill_max_bound(rv, UINT64_MAX);
+	else
+		eval_fill_imm64(rv, UINTPTR_MAX, 0);
+
+	return err;
+}
+
 static const char *
 eval_call(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 {
@@ -993,6 +1100,9 @@ eval_call(struct bpf_verifier *bvf, const struct ebpf_insn *ins)
 	const struct rte_bpf_xsym *xsym;
 	const char *err;
 
+	if (ins->src_reg == EBPF_PSEUDO_MAP_CALL)
+		return eval_map_call(bvf, ins);
+
 	idx = ins->imm;
 
 	if (idx >= bvf->prm->nb_xsym ||
@@ -1728,7 +1838,8 @@ static const struct bpf_ins_check ins_chk[UINT8_MAX + 1] = {
 	},
 	/* call instruction */
 	[(BPF_JMP | EBPF_CALL)] = {
-		.mask = { .dreg = ZERO_REG, .sreg = ZERO_REG},
+		.mask = { .dreg = ZERO_REG,
+			.sreg = ZERO_REG | 1 << EBPF_PSEUDO_MAP_CALL},
 		.off = { .min = 0, .max = 0},
 		.imm = { .min = 0, .max = UINT32_MAX},
 		.eval = eval_call,
@@ -2288,9 +2399,10 @@ cmp_reg_val_within(const struct bpf_reg_val *lv, const struct bpf_reg_val *rv)
 	if (memcmp(&lv->v, &rv->v, sizeof(lv->v)) != 0 || lv->mask != rv->mask)
 		return -1;
 
-	/* exact match only for mbuf and stack pointers */
+	/* exact match only for mbuf, stack and map pointers */
 	if (lv->v.type == RTE_BPF_ARG_PTR_MBUF ||
-			lv->v.type == BPF_ARG_PTR_STACK)
+			lv->v.type == BPF_ARG_PTR_STACK ||
+			lv->v.type == BPF_ARG_PTR_MAP)
 		return -1;
 
 	if (lv->u.min <= rv->u.min && lv->u.max >= rv->u.max &&
@@ -2508,6 +2620,29 @@ evaluate(struct bpf_verifier *bvf)
 	return rc;
 }
 
+/*
+ * For map helper calls that always get the same map,
+ * store 1 + xsym index of that map in the off field of the instruction.
+ * That allows JIT to generate code specialised for the map type.
+ */
+static void
+set_map_call_info(struct rte_bpf *bpf, const struct bpf_verifier *bvf)
+{
+	uint32_t i;
+	struct ebpf_insn *ins;
+
+	/* our own copy of the code, still writable at that point */
+	ins = (struct ebpf_insn *)(uintptr_t)bpf->prm.ins;
+
+	for (i = 0; i != bpf->prm.nb_ins; i++) {
+		if (ins[i].code == (BPF_JMP | EBPF_CALL) &&
+				ins[i].src_reg == EBPF_PSEUDO_MAP_CALL &&
+				bvf->in[i].map_xsym > 0 &&
+				bvf->in[i].map_xsym <= INT16_MAX)
+			ins[i].off = bvf->in[i].map_xsym;
+	}
+}
+
 int
 __rte_bpf_validate(struct rte_bpf *bpf)
 {
@@ -2538,6 +2673,9 @@ __rte_bpf_validate(struct rte_bpf *bpf)
 		evst_pool_fini(&bvf);
 	}
 
+	if (rc == 0)
+		set_map_call_info(bpf, &bvf);
+
 	free(bvf.in);
 
 	/* copy collected info */
@@ -17,6 +17,7 @@
  */
 
 #include <rte_common.h>
+#include <rte_byteorder.h>
 #include <rte_mbuf.h>
 #include <bpf_def.h>
 
@@ -59,9 +60,13 @@ struct rte_bpf_arg {
  */
 enum rte_bpf_xtype {
 	RTE_BPF_XTYPE_FUNC, /**< function */
-	RTE_BPF_XTYPE_VAR   /**< variable */
+	RTE_BPF_XTYPE_VAR,  /**< variable */
+	RTE_BPF_XTYPE_MAP   /**< map, see rte_bpf_map_create() */
 };
 
+struct rte_bpf_map;
+struct rte_rcu_qsbr;
+
 /**
  * Definition for external symbols available in the BPF program.
  */
@@ -81,6 +86,9 @@ struct rte_bpf_xsym {
 			void *val; /**< actual memory location */
 			struct rte_bpf_arg desc; /**< type, size, etc. */
 		} var; /**< external variable */
+		struct {
+			struct rte_bpf_map *val; /**< map handle */
+		} map; /**< external map */
 	};
 };
 
@@ -104,6 +112,15 @@ struct rte_bpf_jit {
 	size_t sz;                /**< size of JIT-ed code */
 };
 
+/**
+ * JIT-ed native code that runs the program over *num* contexts,
+ * stores return values in *rc* and returns *num*.
+ * Same as calling rte_bpf_jit.func for each context, but avoids per call
+ * overhead and prefetches the next context.
+ */
+typedef uint32_t (*rte_bpf_jit_burst_t)(void *ctx[], uint64_t rc[],
+	uint32_t num);
+
 struct rte_bpf;
 
 /**
@@ -136,6 +153,10 @@ rte_bpf_load(const struct rte_bpf_prm *prm);
  * Note that if the function will encounter EBPF_PSEUDO_CALL instruction
  * that references external symbol, it will treat is as standard BPF_CALL
  * to the external helper function.
+ * Calls to the external functions named rte_bpf_map_lookup_elem,
+ * rte_bpf_map_update_elem and rte_bpf_map_delete_elem
+ * (or bpf_map_lookup_elem, etc.) that are not present in *prm->xsym*
+ * are converted into built-in map helper calls.
  *
  * @param prm
  *  Parameters used to create and initialise the BPF execution context.
@@ -198,6 +219,25 @@ rte_bpf_exec_burst(const struct rte_bpf *bpf, void *ctx[], uint64_t rc[],
 int
 rte_bpf_get_jit(const struct rte_bpf *bpf, struct rte_bpf_jit *jit);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Provide the natively compiled burst entry point for given BPF handle.
+ *
+ * @param bpf
+ *   handle for the BPF code.
+ * @param burst
+ *   pointer to be filled with the burst entry point.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOTSUP if not supported by JIT compiler for given platform.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_bpf_get_jit_burst(const struct rte_bpf *bpf, rte_bpf_jit_burst_t *burst);
+
 /**
  * Dump epf instructions to a file.
  *
@@ -211,6 +251,221 @@ rte_bpf_get_jit(const struct rte_bpf *bpf, struct rte_bpf_jit *jit);
 void
 rte_bpf_dump(FILE *f, const struct ebpf_insn *buf, uint32_t len);
 
+/**
+ * Possible types of eBPF maps.
+ */
+enum rte_bpf_map_type {
+	RTE_BPF_MAP_TYPE_ARRAY,
+	/**< array of values indexed by uint32_t key */
+	RTE_BPF_MAP_TYPE_PERCPU_ARRAY,
+	/**< array with a separate copy of each value per lcore */
+	RTE_BPF_MAP_TYPE_HASH,
+	/**< hash table with arbitrary keys, backed by rte_hash */
+	RTE_BPF_MAP_TYPE_LPM,
+	/**< IPv4 longest prefix match table, backed by rte_lpm */
+};
+
+/**
+ * Ids of the map helper functions eBPF code can call
+ * with EBPF_PSEUDO_MAP_CALL, numbered as in the Linux kernel.
+ */
+enum rte_bpf_map_func {
+	RTE_BPF_MAP_FUNC_LOOKUP = 1, /**< rte_bpf_map_lookup_elem() */
+	RTE_BPF_MAP_FUNC_UPDATE = 2, /**< rte_bpf_map_update_elem() */
+	RTE_BPF_MAP_FUNC_DELETE = 3, /**< rte_bpf_map_delete_elem() */
+};
+
+/** Flags for rte_bpf_map_update_elem(). */
+#define RTE_BPF_MAP_ANY		0 /**< create new or update existing element */
+#define RTE_BPF_MAP_NOEXIST	1 /**< create new element only */
+#define RTE_BPF_MAP_EXIST	2 /**< update existing element only */
+
+/** Max length of the map name. */
+#define RTE_BPF_MAP_NAMESIZE	32
+
+/**
+ * Key format for RTE_BPF_MAP_TYPE_LPM maps.
+ */
+struct rte_bpf_map_lpm_key {
+	uint32_t prefixlen; /**< prefix length, ignored by lookup */
+	rte_be32_t addr;    /**< IPv4 address in network byte order */
+};
+
+/**
+ * Input parameters for creating eBPF map.
+ */
+struct rte_bpf_map_prm {
+	const char *name;           /**< unique map name */
+	enum rte_bpf_map_type type; /**< map type */
+	uint32_t key_size;
+	/**< key size, must be sizeof(uint32_t) for array maps and
+	 * sizeof(struct rte_bpf_map_lpm_key) for LPM maps
+	 */
+	uint32_t value_size;        /**< value size */
+	uint32_t max_entries;       /**< max number of elements */
+	int socket_id;              /**< NUMA socket to allocate memory on */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Create a new eBPF map.
+ * All values are zero initialized.
+ * To make the map available for eBPF code, pass it as
+ * RTE_BPF_XTYPE_MAP external symbol in *rte_bpf_prm*.
+ * eBPF code refers to the map by loading its address with
+ * (BPF_LD | BPF_IMM | EBPF_DW) instruction; for ELF files the loader
+ * resolves relocations against the map by symbol name.
+ *
+ * @param prm
+ *   Parameters used to create the map.
+ * @return
+ *   Map handle, or NULL on error, with error code set in rte_errno.
+ *   Possible rte_errno errors include:
+ *   - EINVAL - invalid parameter passed to function
+ *   - EEXIST - a map with the same name already exists
+ *   - ENOMEM - can't reserve enough memory
+ */
+__rte_experimental
+struct rte_bpf_map *
+rte_bpf_map_create(const struct rte_bpf_map_prm *prm);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * De-allocate all memory used by the map.
+ * The map must not be used by any loaded eBPF code.
+ *
+ * @param map
+ *   Map handle to free.
+ */
+__rte_experimental
+void
+rte_bpf_map_free(struct rte_bpf_map *map);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Attach RCU QSBR variable to a hash or LPM map,
+ * to defer the reuse of deleted elements until the lcores doing lookups
+ * went through a quiescent state.
+ * Lcores running eBPF code that accesses the map have to report
+ * their quiescent states on the given variable.
+ * Deleted elements are reclaimed when the map runs out of free elements.
+ *
+ * @param map
+ *   Map handle.
+ * @param v
+ *   RCU QSBR variable.
+ * @return
+ *   - Zero if operation completed successfully.
+ *   - -EINVAL if the parameters are invalid or not supported by the map.
+ *   - -EEXIST if a variable is already attached to the map.
+ *   - -ENOMEM if the defer queue can't be allocated.
+ */
+__rte_experimental
+int
+rte_bpf_map_rcu_qsbr_add(struct rte_bpf_map *map, struct rte_rcu_qsbr *v);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Find the map value for the given key.
+ * For RTE_BPF_MAP_TYPE_PERCPU_ARRAY maps the copy of the calling lcore
+ * is returned, NULL for non-EAL threads.
+ * This function is also available to eBPF code as a map helper,
+ * eBPF code has to check returned value for NULL.
+ *
+ * @param map
+ *   Map handle.
+ * @param key
+ *   Pointer to the key.
+ * @return
+ *   Pointer to the value, or NULL if the key is not found.
+ */
+__rte_experimental
+void *
+rte_bpf_map_lookup_elem(const struct rte_bpf_map *map, const void *key);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Find the given lcore copy of the map value for the given key
+ * in RTE_BPF_MAP_TYPE_PERCPU_ARRAY map.
+ *
+ * @param map
+ *   Map handle.
+ * @param key
+ *   Pointer to the key.
+ * @param lcore_id
+ *   Lcore id the value belongs to.
+ * @return
+ *   Pointer to the value, or NULL on error.
+ */
+__rte_experimental
+void *
+rte_bpf_map_lookup_lcore_elem(const struct rte_bpf_map *map, const void *key,
+		uint32_t lcore_id);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Create or update the map element.
+ * Updates of hash and LPM maps are serialized internally,
+ * lookups can run concurrently with them.
+ * This function is also available to eBPF code as a map helper.
+ *
+ * @param map
+ *   Map handle.
+ * @param key
+ *   Pointer to the key.
+ * @param value
+ *   Pointer to the new value.
+ * @param flags
+ *   One of RTE_BPF_MAP_ANY, RTE_BPF_MAP_NOEXIST, RTE_BPF_MAP_EXIST.
+ * @return
+ *   - Zero if operation completed successfully.
+ *   - -EINVAL if the parameters are invalid.
+ *   - -EEXIST if RTE_BPF_MAP_NOEXIST is set and the element exists.
+ *   - -ENOENT if RTE_BPF_MAP_EXIST is set and the element doesn't exist.
+ *   - -E2BIG if the map is full.
+ */
+__rte_experimental
+int
+rte_bpf_map_update_elem(struct rte_bpf_map *map, const void *key,
+		const void *value, uint64_t flags);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Delete the map element.
+ * Not supported for array maps.
+ * Unless the map has a RCU QSBR variable attached with
+ * rte_bpf_map_rcu_qsbr_add(), the value memory of the deleted element
+ * is reused right away, so the caller must make sure that no lcore
+ * still accesses it.
+ * This function is also available to eBPF code as a map helper.
+ *
+ * @param map
+ *   Map handle.
+ * @param key
+ *   Pointer to the key.
+ * @return
+ *   - Zero if operation completed successfully.
+ *   - -EINVAL if the parameters are invalid or not supported by the map.
+ *   - -ENOENT if the element doesn't exist.
+ */
+__rte_experimental
+int
+rte_bpf_map_delete_elem(struct rte_bpf_map *map, const void *key);
+
 struct bpf_program;
 
 /**
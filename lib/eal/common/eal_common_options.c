@@ -2237,7 +2237,7 @@ eal_common_usage(void)
 	       "                      'KBytes' and 'MBytes' respectively.\n"
 	       "                      Default is 1MB and parameter must be\n"
 	       "                      specified once only.\n"
-	       "  --"OPT_TRACE_MODE"=<o[verwrite] | d[iscard]>\n"
+	       "  --"OPT_TRACE_MODE"=<o[verwrite] | d[iscard] | s[tream]>\n"
 	       "                      Specify the mode of update of trace\n"
 	       "                      output file. Either update on a file can\n"
 	       "                      be wrapped or discarded when file size\n"
@@ -2,6 +2,7 @@
  * Copyright(C) 2020 Marvell International Ltd.
  */
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <fnmatch.h>
 #include <pthread.h>
@@ -21,7 +22,10 @@ RTE_DEFINE_PER_LCORE(void *, trace_mem);
 static RTE_DEFINE_PER_LCORE(char *, ctf_field);
 
 static struct trace_point_head tp_list = STAILQ_HEAD_INITIALIZER(tp_list);
-static struct trace trace = { .args = STAILQ_HEAD_INITIALIZER(trace.args), };
+static struct trace trace = {
+	.args = STAILQ_HEAD_INITIALIZER(trace.args),
+	.stream_lock = PTHREAD_MUTEX_INITIALIZER,
+};
 
 struct trace *
 trace_obj_get(void)
@@ -89,6 +93,7 @@ eal_trace_init(void)
 void
 eal_trace_fini(void)
 {
+	trace_stream_stop();
 	trace_mem_free();
 	trace_metadata_destroy();
 	eal_trace_args_free();
@@ -103,6 +108,13 @@ rte_trace_is_enabled(void)
 static void
 trace_mode_set(rte_trace_point_t *t, enum rte_trace_mode mode)
 {
+	if (mode == RTE_TRACE_MODE_STREAM)
+		rte_atomic_fetch_or_explicit(t, __RTE_TRACE_FIELD_ENABLE_STREAM,
+			rte_memory_order_release);
+	else
+		rte_atomic_fetch_and_explicit(t, ~__RTE_TRACE_FIELD_ENABLE_STREAM,
+			rte_memory_order_release);
+
 	if (mode == RTE_TRACE_MODE_OVERWRITE)
 		rte_atomic_fetch_and_explicit(t, ~__RTE_TRACE_FIELD_ENABLE_DISCARD,
 			rte_memory_order_release);
@@ -116,6 +128,21 @@ rte_trace_mode_set(enum rte_trace_mode mode)
 {
 	struct trace_point *tp;
 
+	/* the buffers are split in two halves in streaming mode */
+	if ((mode == RTE_TRACE_MODE_STREAM) !=
+			(trace.mode == RTE_TRACE_MODE_STREAM) &&
+			trace.nb_trace_mem_list != 0) {
+		trace_err("cannot change streaming mode, trace buffers are in use");
+		return;
+	}
+
+	if (mode == RTE_TRACE_MODE_STREAM) {
+		if (trace_stream_start() < 0)
+			return;
+	} else {
+		trace_stream_stop();
+	}
+
 	STAILQ_FOREACH(tp, &tp_list, next)
 		trace_mode_set(tp->handle, mode);
 
@@ -294,6 +321,15 @@ rte_trace_dump(FILE *f)
 	fprintf(f, "dir = %s\n", trace->dir);
 	fprintf(f, "buffer len = %d\n", trace->buff_len);
 	fprintf(f, "number of trace points = %d\n", trace->nb_trace_points);
+	if (trace->mode == RTE_TRACE_MODE_STREAM) {
+		struct rte_trace_stream_stats stats;
+
+		rte_trace_stream_stats_get(&stats);
+		fprintf(f, "stream bytes = %" PRIu64 "\n", stats.bytes);
+		fprintf(f, "stream flushes = %" PRIu64 "\n", stats.flushes);
+		fprintf(f, "stream drops = %" PRIu64 "\n", stats.drops);
+		fprintf(f, "stream lost = %" PRIu64 "\n", stats.lost);
+	}
 
 	trace_lcore_mem_dump(f);
 	fprintf(f, "\nTrace point info\n----------------\n");
@@ -365,6 +401,14 @@ __rte_trace_mem_per_thread_alloc(void)
 found:
 	header->offset = 0;
 	header->len = trace->buff_len;
+	header->stream_half = 0;
+	header->stream_half_len = RTE_ALIGN_FLOOR(trace->buff_len / 2,
+		__RTE_TRACE_EVENT_HEADER_SZ);
+	rte_atomic_store_explicit(&header->stream_full[0], 0, rte_memory_order_relaxed);
+	rte_atomic_store_explicit(&header->stream_full[1], 0, rte_memory_order_relaxed);
+	rte_atomic_store_explicit(&header->stream_drops, 0, rte_memory_order_relaxed);
+	if (trace->mode == RTE_TRACE_MODE_STREAM)
+		header->len = header->stream_half_len - __RTE_TRACE_EVENT_HEADER_SZ;
 	header->stream_header.magic = TRACE_CTF_MAGIC;
 	rte_uuid_copy(header->stream_header.uuid, trace->uuid);
 	header->stream_header.lcore_id = rte_lcore_id();
@@ -376,6 +420,7 @@ __rte_trace_mem_per_thread_alloc(void)
 		__RTE_TRACE_EMIT_STRING_LEN_MAX);
 
 	trace->lcore_meta[count].mem = header;
+	trace->lcore_meta[count].stream_fd = -1;
 	trace->nb_trace_mem_list++;
 fail:
 	RTE_PER_LCORE(trace_mem) = header;
@@ -396,43 +441,140 @@ trace_mem_per_thread_free(void)
 {
 	struct trace *trace = trace_obj_get();
 	struct __rte_trace_header *header;
+	struct thread_mem_meta *meta;
+	struct thread_mem_meta copy;
 	uint32_t count;
 
 	header = RTE_PER_LCORE(trace_mem);
 	if (header == NULL)
 		return;
 
+	/* The list is only shrunk with the stream lock held, so that the
+	 * trace file is written without holding the trace lock.
+	 */
+	pthread_mutex_lock(&trace->stream_lock);
 	rte_spinlock_lock(&trace->lock);
 	for (count = 0; count < trace->nb_trace_mem_list; count++) {
 		if (trace->lcore_meta[count].mem == header)
 			break;
 	}
-	if (count != trace->nb_trace_mem_list) {
-		struct thread_mem_meta *meta = &trace->lcore_meta[count];
-
-		trace_mem_per_thread_free_unlocked(meta);
-		if (count != trace->nb_trace_mem_list - 1) {
-			memmove(meta, meta + 1,
-				sizeof(*meta) *
-				 (trace->nb_trace_mem_list - count - 1));
-		}
-		trace->nb_trace_mem_list--;
+	if (count == trace->nb_trace_mem_list)
+		goto out;
+
+	copy = trace->lcore_meta[count];
+	rte_spinlock_unlock(&trace->lock);
+	trace_stream_close(&copy);
+	rte_spinlock_lock(&trace->lock);
+
+	/* the list may have been reallocated meanwhile */
+	meta = &trace->lcore_meta[count];
+	trace_mem_per_thread_free_unlocked(meta);
+	if (count != trace->nb_trace_mem_list - 1) {
+		memmove(meta, meta + 1,
+			sizeof(*meta) *
+			 (trace->nb_trace_mem_list - count - 1));
 	}
+	trace->nb_trace_mem_list--;
+out:
 	rte_spinlock_unlock(&trace->lock);
+	pthread_mutex_unlock(&trace->stream_lock);
 }
 
 void
 trace_mem_free(void)
 {
 	struct trace *trace = trace_obj_get();
+	struct thread_mem_meta meta;
 	uint32_t count;
 
+	pthread_mutex_lock(&trace->stream_lock);
+	for (count = 0; ; count++) {
+		rte_spinlock_lock(&trace->lock);
+		if (count >= trace->nb_trace_mem_list) {
+			rte_spinlock_unlock(&trace->lock);
+			break;
+		}
+		meta = trace->lcore_meta[count];
+		rte_spinlock_unlock(&trace->lock);
+		trace_stream_close(&meta);
+	}
+
 	rte_spinlock_lock(&trace->lock);
 	for (count = 0; count < trace->nb_trace_mem_list; count++) {
 		trace_mem_per_thread_free_unlocked(&trace->lcore_meta[count]);
 	}
 	trace->nb_trace_mem_list = 0;
 	rte_spinlock_unlock(&trace->lock);
+	pthread_mutex_unlock(&trace->stream_lock);
+}
+
+void *
+__rte_trace_mem_stream_get(struct __rte_trace_header *trace, uint16_t sz)
+{
+	const uint32_t half_len = trace->stream_half_len;
+	uint32_t half = trace->stream_half;
+	uint32_t offset = trace->offset;
+	uint32_t start = half * half_len;
+	bool other_free;
+
+	other_free = rte_atomic_load_explicit(&trace->stream_full[half ^ 1],
+		rte_memory_order_acquire) == 0;
+
+	/* Hand the current half over to the writer when it is full,
+	 * or when the writer asks for it by clearing len, if not empty.
+	 */
+	if (other_free && offset > start) {
+		rte_atomic_store_explicit(&trace->stream_full[half],
+			offset - start, rte_memory_order_release);
+		half ^= 1;
+		start = half * half_len;
+		offset = start;
+		trace->stream_half = half;
+	}
+	/* keep room for the alignment done after the check in fast path */
+	trace->len = start + half_len - __RTE_TRACE_EVENT_HEADER_SZ;
+
+	offset = RTE_ALIGN_CEIL(offset, __RTE_TRACE_EVENT_HEADER_SZ);
+	if (offset + sz >= trace->len) {
+		/* both halves are full */
+		rte_atomic_store_explicit(&trace->stream_drops,
+			rte_atomic_load_explicit(&trace->stream_drops,
+				rte_memory_order_relaxed) + 1,
+			rte_memory_order_relaxed);
+		trace->offset = offset;
+		return NULL;
+	}
+	trace->offset = offset + sz;
+
+	return RTE_PTR_ADD(&trace->mem[0], offset);
+}
+
+int
+rte_trace_stream_stats_get(struct rte_trace_stream_stats *stats)
+{
+	struct __rte_trace_header *header;
+	uint32_t count;
+
+	if (stats == NULL)
+		return -EINVAL;
+	if (trace.mode != RTE_TRACE_MODE_STREAM)
+		return -ENOTSUP;
+
+	pthread_mutex_lock(&trace.stream_lock);
+	rte_spinlock_lock(&trace.lock);
+	stats->bytes = trace.stream_bytes;
+	stats->flushes = trace.stream_flushes;
+	stats->drops = trace.stream_drops;
+	stats->lost = trace.stream_lost;
+	for (count = 0; count < trace.nb_trace_mem_list; count++) {
+		header = trace.lcore_meta[count].mem;
+		stats->drops += rte_atomic_load_explicit(&header->stream_drops,
+			rte_memory_order_relaxed);
+	}
+	rte_spinlock_unlock(&trace.lock);
+	pthread_mutex_unlock(&trace.stream_lock);
+
+	return 0;
 }
 
 void
@@ -2,14 +2,17 @@
  * Copyright(C) 2020 Marvell International Ltd.
  */
 
+#include <fcntl.h>
 #include <fnmatch.h>
 #include <pwd.h>
 #include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <rte_common.h>
 #include <rte_errno.h>
 #include <rte_string_fns.h>
+#include <rte_thread.h>
 
 #include "eal_filesystem.h"
 #include "eal_private.h"
@@ -21,6 +24,7 @@ trace_mode_to_string(enum rte_trace_mode mode)
 	switch (mode) {
 	case RTE_TRACE_MODE_OVERWRITE: return "overwrite";
 	case RTE_TRACE_MODE_DISCARD: return "discard";
+	case RTE_TRACE_MODE_STREAM: return "stream";
 	default: return "unknown";
 	}
 }
@@ -228,6 +232,8 @@ eal_trace_mode_args_save(const char *val)
 		tmp = RTE_TRACE_MODE_OVERWRITE;
 	else if (fnmatch(pattern, "discard", 0) == 0)
 		tmp = RTE_TRACE_MODE_DISCARD;
+	else if (fnmatch(pattern, "stream", 0) == 0)
+		tmp = RTE_TRACE_MODE_STREAM;
 	else {
 		free(pattern);
 		return -EINVAL;
@@ -420,6 +426,12 @@ rte_trace_save(void)
 	if (trace->nb_trace_mem_list == 0)
 		return rc;
 
+	/* the events are already being written to the trace files */
+	if (trace->mode == RTE_TRACE_MODE_STREAM) {
+		trace_stream_flush();
+		return 0;
+	}
+
 	rc = trace_mkdir();
 	if (rc < 0)
 		return rc;
@@ -438,3 +450,245 @@ rte_trace_save(void)
 	rte_spinlock_unlock(&trace->lock);
 	return rc;
 }
+
+/* Period of the streaming mode writer */
+#define TRACE_STREAM_PERIOD_MS 100
+
+static int
+trace_stream_file_open(struct trace *trace, struct thread_mem_meta *meta)
+{
+	struct __rte_trace_header *hdr = meta->mem;
+	char file_name[PATH_MAX];
+	int rc, fd;
+
+	if (!trace->stream_meta_saved) {
+		rc = trace_mkdir();
+		if (rc < 0)
+			return rc;
+		rc = trace_meta_save(trace);
+		if (rc < 0)
+			return rc;
+		trace->stream_meta_saved = true;
+	}
+
+	rc = snprintf(file_name, PATH_MAX, "%s/channel0_%u", trace->dir,
+		trace->stream_files);
+	if (rc < 0)
+		return rc;
+
+	fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	if (fd < 0)
+		return -errno;
+	if (write(fd, &hdr->stream_header, sizeof(hdr->stream_header)) !=
+			sizeof(hdr->stream_header)) {
+		close(fd);
+		return -EIO;
+	}
+
+	trace->stream_files++;
+	meta->stream_fd = fd;
+	return 0;
+}
+
+static int
+trace_stream_write(struct trace *trace, struct thread_mem_meta *meta,
+		const void *data, uint32_t len)
+{
+	ssize_t rc;
+	size_t off;
+
+	if (meta->stream_fd < 0) {
+		rc = trace_stream_file_open(trace, meta);
+		if (rc < 0)
+			return rc;
+	}
+
+	/* pad up to the alignment of the next event header */
+	len = RTE_ALIGN_CEIL(len, __RTE_TRACE_EVENT_HEADER_SZ);
+	for (off = 0; off < len; off += rc) {
+		rc = write(meta->stream_fd, RTE_PTR_ADD(data, off), len - off);
+		if (rc < 0 && errno == EINTR)
+			rc = 0;
+		else if (rc < 0)
+			return -errno;
+	}
+
+	trace->stream_bytes += len;
+	trace->stream_flushes++;
+	trace->stream_error = false;
+	return 0;
+}
+
+/* Log the first of a series of write errors, the writer retrying
+ * every period.
+ */
+static void
+trace_stream_error(struct trace *trace, int rc)
+{
+	if (trace->stream_error)
+		return;
+	trace->stream_error = true;
+	trace_err("cannot write trace file [%s], retrying", strerror(-rc));
+}
+
+/* Write the full half of a thread buffer, and ask the thread to hand over
+ * the half it is filling when there are events in it.
+ * A half which cannot be written is kept full for the next attempt,
+ * the thread meanwhile counting the events it discards as drops.
+ * Expects the stream lock to be held, the full halves belong to the writer
+ * until given back, so the trace lock is not needed for the I/O.
+ */
+static int
+trace_stream_drain(struct trace *trace, struct thread_mem_meta *meta)
+{
+	struct __rte_trace_header *hdr = meta->mem;
+	const uint32_t half_len = hdr->stream_half_len;
+	uint32_t half, len;
+	int rc;
+
+	for (half = 0; half < 2; half++) {
+		len = rte_atomic_load_explicit(&hdr->stream_full[half],
+			rte_memory_order_acquire);
+		if (len == 0)
+			continue;
+		rc = trace_stream_write(trace, meta,
+			&hdr->mem[half * half_len], len);
+		if (rc < 0) {
+			trace_stream_error(trace, rc);
+			return rc;
+		}
+		rte_atomic_store_explicit(&hdr->stream_full[half], 0,
+			rte_memory_order_release);
+	}
+
+	/* Racy read of the thread state: at worst, the thread finds the
+	 * half empty and goes on with it.
+	 */
+	if (hdr->offset > hdr->stream_half * half_len)
+		rte_atomic_store_explicit((uint32_t __rte_atomic *)&hdr->len, 0,
+			rte_memory_order_relaxed);
+	return 0;
+}
+
+void
+trace_stream_flush(void)
+{
+	struct trace *trace = trace_obj_get();
+	struct thread_mem_meta meta;
+	uint32_t count;
+	int fd;
+
+	/* The trace lock is only held to read the list, which the threads
+	 * extend when allocating their buffer, and which is not shrunk
+	 * while holding the stream lock.
+	 */
+	pthread_mutex_lock(&trace->stream_lock);
+	for (count = 0; ; count++) {
+		rte_spinlock_lock(&trace->lock);
+		if (count >= trace->nb_trace_mem_list) {
+			rte_spinlock_unlock(&trace->lock);
+			break;
+		}
+		meta = trace->lcore_meta[count];
+		rte_spinlock_unlock(&trace->lock);
+
+		fd = meta.stream_fd;
+		trace_stream_drain(trace, &meta);
+		if (meta.stream_fd != fd) {
+			rte_spinlock_lock(&trace->lock);
+			trace->lcore_meta[count].stream_fd = meta.stream_fd;
+			rte_spinlock_unlock(&trace->lock);
+		}
+	}
+	pthread_mutex_unlock(&trace->stream_lock);
+}
+
+/* Write all the events of the buffer of a thread which is gone, and
+ * close its trace file.
+ * There is no retry from here, the halves which cannot be written are
+ * counted as lost.
+ * Expects the stream lock to be held, and the trace lock not to be held.
+ */
+void
+trace_stream_close(struct thread_mem_meta *meta)
+{
+	struct trace *trace = trace_obj_get();
+	struct __rte_trace_header *hdr = meta->mem;
+	uint32_t half, start;
+	int rc;
+
+	if (trace->mode != RTE_TRACE_MODE_STREAM)
+		return;
+
+	if (trace_stream_drain(trace, meta) < 0) {
+		for (half = 0; half < 2; half++)
+			if (rte_atomic_load_explicit(&hdr->stream_full[half],
+					rte_memory_order_acquire) != 0)
+				trace->stream_lost++;
+	}
+	start = hdr->stream_half * hdr->stream_half_len;
+	if (hdr->offset > start) {
+		rc = trace_stream_write(trace, meta, &hdr->mem[start],
+			hdr->offset - start);
+		if (rc < 0) {
+			trace_stream_error(trace, rc);
+			trace->stream_lost++;
+		}
+	}
+	trace->stream_drops += rte_atomic_load_explicit(&hdr->stream_drops,
+		rte_memory_order_relaxed);
+
+	if (meta->stream_fd >= 0)
+		close(meta->stream_fd);
+	meta->stream_fd = -1;
+}
+
+static uint32_t
+trace_stream_writer(void *arg __rte_unused)
+{
+	struct trace *trace = trace_obj_get();
+
+	while (!rte_atomic_load_explicit(&trace->stream_stop,
+			rte_memory_order_acquire)) {
+		trace_stream_flush();
+		rte_delay_us_sleep(TRACE_STREAM_PERIOD_MS * 1000);
+	}
+
+	return 0;
+}
+
+int
+trace_stream_start(void)
+{
+	struct trace *trace = trace_obj_get();
+	int rc;
+
+	if (trace->stream_running)
+		return 0;
+
+	rte_atomic_store_explicit(&trace->stream_stop, false,
+		rte_memory_order_relaxed);
+	rc = rte_thread_create_internal_control(&trace->stream_thread,
+		"trace", trace_stream_writer, NULL);
+	if (rc != 0) {
+		trace_err("cannot create trace writer thread [%s]", strerror(rc));
+		return -rc;
+	}
+
+	trace->stream_running = true;
+	return 0;
+}
+
+void
+trace_stream_stop(void)
+{
+	struct trace *trace = trace_obj_get();
+
+	if (!trace->stream_running)
+		return;
+
+	rte_atomic_store_explicit(&trace->stream_stop, true,
+		rte_memory_order_release);
+	rte_thread_join(trace->stream_thread, NULL);
+	trace->stream_running = false;
+}
@@ -5,6 +5,8 @@
 #ifndef __EAL_TRACE_H
 #define __EAL_TRACE_H
 
+#include <pthread.h>
+
 #include <rte_cycles.h>
 #include <rte_log.h>
 #include <rte_malloc.h>
@@ -40,6 +42,7 @@ enum trace_area_e {
 struct thread_mem_meta {
 	void *mem;
 	enum trace_area_e area;
+	int stream_fd; /* trace file in streaming mode, -1 if not open */
 };
 
 struct trace_arg {
@@ -67,6 +70,19 @@ struct trace {
 	uint32_t ctf_meta_offset_freq_off;
 	RTE_ATOMIC(uint16_t) ctf_fixup_done;
 	rte_spinlock_t lock;
+	/* streaming mode writer */
+	/* serializes the file I/O out of lock, taken before it */
+	pthread_mutex_t stream_lock;
+	bool stream_running;
+	RTE_ATOMIC(bool) stream_stop;
+	rte_thread_t stream_thread;
+	bool stream_meta_saved;
+	uint32_t stream_files;
+	uint64_t stream_bytes;
+	uint64_t stream_flushes;
+	uint64_t stream_drops; /* of the threads already gone */
+	uint64_t stream_lost; /* halves of exited threads not written */
+	bool stream_error; /* logged, until the next successful write */
 };
 
 /* Helper functions */
@@ -103,6 +119,10 @@ char *trace_metadata_fixup_field(const char *field);
 int trace_epoch_time_save(void);
 void trace_mem_free(void);
 void trace_mem_per_thread_free(void);
+int trace_stream_start(void);
+void trace_stream_stop(void);
+void trace_stream_flush(void);
+void trace_stream_close(struct thread_mem_meta *meta);
 
 /* EAL interface */
 int eal_trace_init(void);
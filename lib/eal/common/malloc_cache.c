@@ -0,0 +1,255 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2014 Intel Corporation
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_memory.h>
+#include <rte_spinlock.h>
+#include <rte_stdatomic.h>
+
+#include "eal_private.h"
+#include "malloc_cache.h"
+#include "malloc_elem.h"
+#include "malloc_heap.h"
+
+/* Max number of elements cached per class */
+#define MALLOC_CACHE_CLASS_OBJS 32
+/* Max number of bytes cached per class */
+#define MALLOC_CACHE_CLASS_BYTES (64 * 1024)
+/* Caches not used for this long are given back to the heaps, in ms */
+#define MALLOC_CACHE_IDLE_MS 1000
+
+/* Size of the classes in cache lines, each about 1.5 times the previous one */
+static const uint8_t class_lines[MALLOC_CACHE_NUM_CLASSES] = {
+	1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64
+};
+
+struct malloc_cache_class {
+	unsigned int len;
+	struct malloc_elem *objs[MALLOC_CACHE_CLASS_OBJS];
+};
+
+struct __rte_cache_aligned malloc_cache {
+	rte_spinlock_t lock;
+	/**< only contended when the cache is flushed by another thread */
+	uint64_t n_ops;
+	/**< number of allocations and frees done with the cache */
+	uint64_t n_ops_seen;
+	/**< value of n_ops at the last idle check */
+	struct malloc_cache_class classes[MALLOC_CACHE_NUM_CLASSES];
+};
+
+/* the caches are local to the process, only the primary process uses them */
+static struct malloc_cache caches[RTE_MAX_LCORE];
+static RTE_ATOMIC(uint64_t) idle_check_tsc;
+
+static inline bool
+cache_enabled(unsigned int lcore_id)
+{
+#if defined(RTE_MALLOC_DEBUG) || defined(RTE_MALLOC_ASAN)
+	/* keep checking every allocation and free in the heap */
+	RTE_SET_USED(lcore_id);
+	return false;
+#else
+	/* cached elements would leak if a secondary process exits */
+	return lcore_id < RTE_MAX_LCORE &&
+			rte_eal_process_type() == RTE_PROC_PRIMARY;
+#endif
+}
+
+static inline int
+size_to_class(size_t size)
+{
+	size_t lines = (size + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
+	int cls;
+
+	if (lines > class_lines[MALLOC_CACHE_NUM_CLASSES - 1])
+		return -1;
+
+	for (cls = 0; lines > class_lines[cls]; cls++)
+		;
+
+	return cls;
+}
+
+static inline unsigned int
+class_capacity(unsigned int cls)
+{
+	unsigned int n = MALLOC_CACHE_CLASS_BYTES /
+			(class_lines[cls] * RTE_CACHE_LINE_SIZE);
+
+	return RTE_MAX(RTE_MIN(n, (unsigned int)MALLOC_CACHE_CLASS_OBJS), 2u);
+}
+
+static void
+elems_free(struct malloc_elem **elems, unsigned int n)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		elems[i]->cached = 0;
+		malloc_heap_free(elems[i]);
+	}
+}
+
+static unsigned int
+cache_flush(struct malloc_cache *cache)
+{
+	struct malloc_elem *elems[MALLOC_CACHE_NUM_CLASSES * MALLOC_CACHE_CLASS_OBJS];
+	struct malloc_cache_class *cc;
+	unsigned int cls, n = 0;
+
+	rte_spinlock_lock(&cache->lock);
+	for (cls = 0; cls < MALLOC_CACHE_NUM_CLASSES; cls++) {
+		cc = &cache->classes[cls];
+		memcpy(&elems[n], cc->objs, cc->len * sizeof(elems[0]));
+		n += cc->len;
+		cc->len = 0;
+	}
+	rte_spinlock_unlock(&cache->lock);
+
+	elems_free(elems, n);
+
+	return n;
+}
+
+/*
+ * Give back the elements of the lcores which did not use their cache
+ * since the last check, done at most once per idle period by a thread
+ * going to the heap.
+ */
+static void
+cache_idle_check(void)
+{
+	const uint64_t period = rte_get_tsc_hz() / MS_PER_S * MALLOC_CACHE_IDLE_MS;
+	uint64_t now = rte_get_tsc_cycles();
+	uint64_t last;
+	struct malloc_cache *cache;
+	unsigned int i;
+	bool idle;
+
+	last = rte_atomic_load_explicit(&idle_check_tsc, rte_memory_order_relaxed);
+	if (now - last < period)
+		return;
+	if (!rte_atomic_compare_exchange_strong_explicit(&idle_check_tsc,
+			&last, now, rte_memory_order_relaxed,
+			rte_memory_order_relaxed))
+		return;
+
+	for (i = 0; i < RTE_DIM(caches); i++) {
+		cache = &caches[i];
+		if (!rte_spinlock_trylock(&cache->lock))
+			continue;
+		idle = cache->n_ops == cache->n_ops_seen;
+		cache->n_ops_seen = cache->n_ops;
+		rte_spinlock_unlock(&cache->lock);
+
+		if (idle)
+			cache_flush(cache);
+	}
+}
+
+void *
+malloc_cache_alloc(size_t size, unsigned int align, int socket)
+{
+	const unsigned int lcore_id = rte_lcore_id();
+	struct malloc_elem *elem = NULL;
+	struct malloc_cache_class *cc;
+	struct malloc_cache *cache;
+	void *ptr;
+	int cls;
+
+	if (!cache_enabled(lcore_id) || align > RTE_CACHE_LINE_SIZE)
+		return NULL;
+	/* cached elements are all on the socket of the lcore */
+	if (socket != SOCKET_ID_ANY && socket != (int)rte_socket_id())
+		return NULL;
+	cls = size_to_class(size);
+	if (cls < 0)
+		return NULL;
+
+	cache = &caches[lcore_id];
+	cc = &cache->classes[cls];
+
+	rte_spinlock_lock(&cache->lock);
+	cache->n_ops++;
+	if (cc->len > 0)
+		elem = cc->objs[--cc->len];
+	rte_spinlock_unlock(&cache->lock);
+
+	if (elem != NULL) {
+		elem->cached = 0;
+		return RTE_PTR_ADD(elem, MALLOC_ELEM_HEADER_LEN + elem->pad);
+	}
+
+	cache_idle_check();
+
+	/* allocate the full class size, so the element can be cached later */
+	ptr = malloc_heap_alloc(class_lines[cls] * RTE_CACHE_LINE_SIZE, socket,
+			0, RTE_CACHE_LINE_SIZE, 0, false);
+	if (ptr != NULL)
+		malloc_elem_from_data(ptr)->cache_class = cls + 1;
+
+	return ptr;
+}
+
+int
+malloc_cache_free(struct malloc_elem *elem)
+{
+	struct malloc_elem *flush[MALLOC_CACHE_CLASS_OBJS];
+	const unsigned int lcore_id = rte_lcore_id();
+	struct malloc_cache_class *cc;
+	struct malloc_cache *cache;
+	unsigned int cls, cap, n = 0;
+
+	if (elem == NULL || elem->cache_class == 0 || !cache_enabled(lcore_id))
+		return 1;
+	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY ||
+			elem->cached)
+		return -1;
+	/* keep the lcore cache local to its socket */
+	if (elem->heap->socket_id != rte_socket_id() && rte_eal_has_hugepages())
+		return 1;
+
+	cls = elem->cache_class - 1;
+	cap = class_capacity(cls);
+	cache = &caches[lcore_id];
+	cc = &cache->classes[cls];
+
+	elem->cached = 1;
+	/* for rte_zmalloc() to clear it when it is reused */
+	elem->dirty = 1;
+
+	rte_spinlock_lock(&cache->lock);
+	cache->n_ops++;
+	if (cc->len == cap) {
+		/* full, give half of it back to the heap */
+		n = cap / 2;
+		cc->len -= n;
+		memcpy(flush, &cc->objs[cc->len], n * sizeof(flush[0]));
+	}
+	cc->objs[cc->len++] = elem;
+	rte_spinlock_unlock(&cache->lock);
+
+	elems_free(flush, n);
+
+	return 0;
+}
+
+unsigned int
+malloc_cache_flush_all(void)
+{
+	unsigned int i, n = 0;
+
+	for (i = 0; i < RTE_DIM(caches); i++)
+		n += cache_flush(&caches[i]);
+
+	return n;
+}
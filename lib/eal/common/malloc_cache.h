@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2014 Intel Corporation
+ */
+
+#ifndef MALLOC_CACHE_H
+#define MALLOC_CACHE_H
+
+#include <stddef.h>
+
+/* forward declarations */
+struct malloc_elem;
+
+/*
+ * Per-lcore caches of small elements, in front of the heaps.
+ *
+ * Freed elements of a size class are kept by the lcore freeing them,
+ * and handed out again to the next allocation of the same class on that
+ * lcore, without taking the heap lock. Elements are still marked busy in
+ * the heap while they are cached.
+ */
+
+/* Number of size classes, class sizes go up to 64 cache lines. */
+#define MALLOC_CACHE_NUM_CLASSES 12
+
+/**
+ * Allocate an element from the cache of the calling lcore.
+ *
+ * On a cache miss, a new element of the size class is allocated from
+ * the heap, so that it can be cached when freed.
+ *
+ * @return
+ *   Pointer to the data of the element, or NULL if the allocation
+ *   cannot be served by the caches.
+ */
+void *
+malloc_cache_alloc(size_t size, unsigned int align, int socket);
+
+/**
+ * Put a freed element in the cache of the calling lcore.
+ *
+ * @return
+ *   0 if the element was cached, -1 if it must be freed to the heap.
+ */
+int
+malloc_cache_free(struct malloc_elem *elem);
+
+/**
+ * Give the elements of all the caches back to the heaps.
+ *
+ * @return
+ *   Number of elements freed.
+ */
+unsigned int
+malloc_cache_flush_all(void);
+
+#endif /* MALLOC_CACHE_H */
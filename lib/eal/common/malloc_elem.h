@@ -34,8 +34,12 @@ struct __rte_cache_aligned malloc_elem {
 	enum elem_state state : 3;
 	/** If state == ELEM_FREE: the memory is not filled with zeroes. */
 	uint32_t dirty : 1;
+	/** If state == ELEM_BUSY: size class + 1 of the lcore caches, or 0. */
+	uint32_t cache_class : 4;
+	/** If state == ELEM_BUSY: the element is in an lcore cache. */
+	uint32_t cached : 1;
 	/** Reserved for future use. */
-	uint32_t reserved : 28;
+	uint32_t reserved : 23;
 	uint32_t pad;
 	size_t size;
 	struct malloc_elem *orig_elem;
@@ -23,6 +23,7 @@
 #include "eal_memalloc.h"
 #include "eal_memcfg.h"
 #include "eal_private.h"
+#include "malloc_cache.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 #include "malloc_mp.h"
@@ -727,9 +728,9 @@ malloc_get_numa_socket(void)
 	return rte_socket_id_by_idx(0);
 }
 
-void *
-malloc_heap_alloc(size_t size, int socket_arg, unsigned int flags,
-		  size_t align, size_t bound, bool contig)
+static void *
+heap_alloc_on_sockets(size_t size, int socket_arg, unsigned int flags,
+		size_t align, size_t bound, bool contig)
 {
 	int socket, heap_id, i;
 	void *ret;
@@ -769,6 +770,23 @@ malloc_heap_alloc(size_t size, int socket_arg, unsigned int flags,
 	return NULL;
 }
 
+void *
+malloc_heap_alloc(size_t size, int socket_arg, unsigned int flags,
+		  size_t align, size_t bound, bool contig)
+{
+	void *ret;
+
+	ret = heap_alloc_on_sockets(size, socket_arg, flags, align, bound,
+			contig);
+
+	/* memory may be held, or fragmented, by the lcore caches */
+	if (ret == NULL && malloc_cache_flush_all() != 0)
+		ret = heap_alloc_on_sockets(size, socket_arg, flags, align,
+				bound, contig);
+
+	return ret;
+}
+
 static void *
 heap_alloc_biggest_on_heap_id(unsigned int heap_id,
 		unsigned int flags, size_t align, bool contig)
@@ -798,6 +816,9 @@ malloc_heap_alloc_biggest(int socket_arg, unsigned int flags, size_t align, bool
 	if ((align && !rte_is_power_of_2(align)))
 		return NULL;
 
+	/* the biggest element may be split by the lcore caches */
+	malloc_cache_flush_all();
+
 	if (!rte_eal_has_hugepages())
 		socket_arg = SOCKET_ID_ANY;
 
@@ -884,6 +905,7 @@ malloc_heap_free(struct malloc_elem *elem)
 
 	/* mark element as free */
 	elem->state = ELEM_FREE;
+	elem->cache_class = 0;
 
 	elem = malloc_elem_free(elem);
 
@@ -19,6 +19,7 @@
 #include <eal_trace_internal.h>
 
 #include <rte_malloc.h>
+#include "malloc_cache.h"
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 #include "eal_memalloc.h"
@@ -30,11 +31,18 @@
 static void
 mem_free(void *addr, const bool trace_ena)
 {
+	struct malloc_elem *elem;
+	int ret;
+
 	if (trace_ena)
 		rte_eal_trace_mem_free(addr);
 
 	if (addr == NULL) return;
-	if (malloc_heap_free(malloc_elem_from_data(addr)) < 0)
+	elem = malloc_elem_from_data(addr);
+	ret = malloc_cache_free(elem);
+	if (ret == 0)
+		return;
+	if (ret < 0 || malloc_heap_free(elem) < 0)
 		EAL_LOG(ERR, "Error: Invalid memory");
 }
 
@@ -69,8 +77,11 @@ malloc_socket(const char *type, size_t size, unsigned int align,
 				!rte_eal_has_hugepages())
 		socket_arg = SOCKET_ID_ANY;
 
-	ptr = malloc_heap_alloc(size, socket_arg, 0,
-			align == 0 ? 1 : align, 0, false);
+	/* small allocations are served by the lcore caches when possible */
+	ptr = malloc_cache_alloc(size, align, socket_arg);
+	if (ptr == NULL)
+		ptr = malloc_heap_alloc(size, socket_arg, 0,
+				align == 0 ? 1 : align, 0, false);
 
 	if (trace_ena)
 		rte_eal_trace_mem_malloc(type, size, align, socket_arg, ptr);
@@ -188,6 +199,9 @@ rte_realloc_socket(void *ptr, size_t size, unsigned int align, int socket)
 			malloc_heap_resize(elem, size) == 0) {
 		rte_eal_trace_mem_realloc(size, align, socket, ptr);
 
+		/* the element does not match its size class anymore */
+		elem->cache_class = 0;
+
 		asan_set_redzone(elem, user_size);
 
 		return ptr;
@@ -243,6 +257,9 @@ rte_malloc_get_socket_stats(int socket,
 	if (heap_idx < 0)
 		return -1;
 
+	/* cached elements are accounted as free memory */
+	malloc_cache_flush_all();
+
 	return malloc_heap_get_stats(&mcfg->malloc_heaps[heap_idx],
 			socket_stats);
 }
@@ -256,6 +273,7 @@ rte_malloc_dump_heaps(FILE *f)
 	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
 	unsigned int idx;
 
+	malloc_cache_flush_all();
 	for (idx = 0; idx < RTE_MAX_HEAPS; idx++) {
 		fprintf(f, "Heap id: %u\n", idx);
 		malloc_heap_dump(&mcfg->malloc_heaps[idx], f);
@@ -333,6 +351,7 @@ rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 	unsigned int heap_id;
 	struct rte_malloc_socket_stats sock_stats;
 
+	malloc_cache_flush_all();
 	/* Iterate through all initialised heaps */
 	for (heap_id = 0; heap_id < RTE_MAX_HEAPS; heap_id++) {
 		struct malloc_heap *heap = &mcfg->malloc_heaps[heap_id];
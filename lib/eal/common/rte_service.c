@@ -31,6 +31,11 @@
 #define RUNSTATE_STOPPED 0
 #define RUNSTATE_RUNNING 1
 
+/* A rebalance moves a service only if the load difference between its
+ * cores is above this percentage of the service load.
+ */
+#define REBALANCE_GAIN_MIN_PERCENT 10
+
 /* internal representation of a service */
 struct __rte_cache_aligned rte_service_spec_impl {
 	/* public part of the struct */
@@ -53,6 +58,15 @@ struct __rte_cache_aligned rte_service_spec_impl {
 	 * on currently.
 	 */
 	RTE_ATOMIC(uint32_t) num_mapped_cores;
+
+	/* max number of calls in a row by a service core */
+	uint32_t priority;
+	/* cycles the service may use per budget period, 0 for no limit */
+	uint64_t cycle_budget;
+	RTE_ATOMIC(uint64_t) budget_used;
+	RTE_ATOMIC(uint64_t) budget_period_start;
+	/* service cycles at the previous rebalance */
+	uint64_t rebalance_cycles;
 };
 
 struct service_stats {
@@ -80,6 +94,12 @@ static struct rte_service_spec_impl *rte_services;
 static struct core_state *lcore_states;
 static uint32_t rte_service_library_initialized;
 
+static RTE_ATOMIC(uint32_t) sched_mode = RTE_SERVICE_SCHED_MAPPED;
+/* services mapped to any service core, run by all in shared mode */
+static RTE_ATOMIC(uint64_t) mapped_mask;
+/* TSC cycles of a cycle budget period */
+static uint64_t budget_period;
+
 int32_t
 rte_service_init(void)
 {
@@ -140,6 +160,8 @@ rte_service_finalize(void)
 	rte_free(rte_services);
 	rte_free(lcore_states);
 
+	rte_atomic_store_explicit(&sched_mode, RTE_SERVICE_SCHED_MAPPED,
+		rte_memory_order_relaxed);
 	rte_service_library_initialized = 0;
 }
 
@@ -183,6 +205,21 @@ service_mt_safe(struct rte_service_spec_impl *s)
 	return !!(s->spec.capabilities & RTE_SERVICE_CAP_MT_SAFE);
 }
 
+/* update the set of services mapped to any service core */
+static void
+service_mapped_mask_update(void)
+{
+	uint64_t mask = 0;
+	uint32_t i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (lcore_states[i].is_service_core)
+			mask |= lcore_states[i].service_mask;
+	}
+
+	rte_atomic_store_explicit(&mapped_mask, mask, rte_memory_order_relaxed);
+}
+
 int32_t
 rte_service_set_stats_enable(uint32_t id, int32_t enabled)
 {
@@ -274,6 +311,7 @@ rte_service_component_register(const struct rte_service_spec *spec,
 	struct rte_service_spec_impl *s = &rte_services[free_slot];
 	s->spec = *spec;
 	s->internal_flags |= SERVICE_F_REGISTERED | SERVICE_F_START_CHECK;
+	s->priority = 1;
 
 	rte_service_count++;
 
@@ -299,6 +337,7 @@ rte_service_component_unregister(uint32_t id)
 	/* clear the run-bit in all cores */
 	for (i = 0; i < RTE_MAX_LCORE; i++)
 		lcore_states[i].service_mask &= ~(UINT64_C(1) << id);
+	service_mapped_mask_update();
 
 	memset(&rte_services[id], 0, sizeof(struct rte_service_spec_impl));
 
@@ -387,15 +426,50 @@ service_counter_add(RTE_ATOMIC(uint64_t) *counter, uint64_t operand)
 }
 
 static inline void
+service_budget_consume(struct rte_service_spec_impl *s, uint64_t cycles)
+{
+	if (s->cycle_budget != 0)
+		rte_atomic_fetch_add_explicit(&s->budget_used, cycles,
+			rte_memory_order_relaxed);
+}
+
+static inline bool
+service_budget_exhausted(struct rte_service_spec_impl *s)
+{
+	uint64_t now, start;
+
+	if (likely(s->cycle_budget == 0))
+		return false;
+
+	now = rte_rdtsc();
+	start = rte_atomic_load_explicit(&s->budget_period_start,
+			rte_memory_order_relaxed);
+	if (now - start >= budget_period) {
+		/* the cores racing here all start the period at about the
+		 * same time, so any of them can win.
+		 */
+		rte_atomic_store_explicit(&s->budget_period_start, now,
+			rte_memory_order_relaxed);
+		rte_atomic_store_explicit(&s->budget_used, 0,
+			rte_memory_order_relaxed);
+		return false;
+	}
+
+	return rte_atomic_load_explicit(&s->budget_used,
+			rte_memory_order_relaxed) >= s->cycle_budget;
+}
+
+static inline int
 service_runner_do_callback(struct rte_service_spec_impl *s,
 			   struct core_state *cs, uint32_t service_idx)
 {
 	rte_eal_trace_service_run_begin(service_idx, rte_lcore_id());
 	void *userdata = s->spec.callback_userdata;
+	int rc;
 
 	if (service_stats_enabled(s)) {
 		uint64_t start = rte_rdtsc();
-		int rc = s->spec.callback(userdata);
+		rc = s->spec.callback(userdata);
 
 		struct service_stats *service_stats =
 			&cs->service_stats[service_idx];
@@ -413,18 +487,50 @@ service_runner_do_callback(struct rte_service_spec_impl *s,
 
 			service_counter_add(&cs->cycles, cycles);
 			service_counter_add(&service_stats->cycles, cycles);
+			service_budget_consume(s, cycles);
 		}
+	} else if (s->cycle_budget != 0) {
+		uint64_t start = rte_rdtsc();
+
+		rc = s->spec.callback(userdata);
+		if (likely(rc != -EAGAIN))
+			service_budget_consume(s, rte_rdtsc() - start);
 	} else {
-		s->spec.callback(userdata);
+		rc = s->spec.callback(userdata);
 	}
 	rte_eal_trace_service_run_end(service_idx, rte_lcore_id());
+
+	return rc;
 }
 
+/* Run the service once, or from a service core as much as its priority
+ * and budget allow while it has work.
+ */
+static inline void
+service_runner_do_callbacks(struct rte_service_spec_impl *s,
+			    struct core_state *cs, uint32_t service_idx,
+			    bool service_core)
+{
+	uint32_t n;
+
+	if (!service_core) {
+		service_runner_do_callback(s, cs, service_idx);
+		return;
+	}
+
+	for (n = 0; n < s->priority; n++) {
+		if (service_budget_exhausted(s))
+			break;
+		if (service_runner_do_callback(s, cs, service_idx) == -EAGAIN)
+			break;
+	}
+}
 
 /* Expects the service 's' is valid. */
 static int32_t
 service_run(uint32_t i, struct core_state *cs, uint64_t service_mask,
-	    struct rte_service_spec_impl *s, uint32_t serialize_mt_unsafe)
+	    struct rte_service_spec_impl *s, uint32_t serialize_mt_unsafe,
+	    bool service_core)
 {
 	if (!s)
 		return -EINVAL;
@@ -448,10 +554,10 @@ service_run(uint32_t i, struct core_state *cs, uint64_t service_mask,
 		if (!rte_spinlock_trylock(&s->execute_lock))
 			return -EBUSY;
 
-		service_runner_do_callback(s, cs, i);
+		service_runner_do_callbacks(s, cs, i, service_core);
 		rte_spinlock_unlock(&s->execute_lock);
 	} else
-		service_runner_do_callback(s, cs, i);
+		service_runner_do_callbacks(s, cs, i, service_core);
 
 	return 0;
 }
@@ -487,7 +593,7 @@ rte_service_run_iter_on_app_lcore(uint32_t id, uint32_t serialize_mt_unsafe)
 	 */
 	rte_atomic_fetch_add_explicit(&s->num_mapped_cores, 1, rte_memory_order_relaxed);
 
-	int ret = service_run(id, cs, UINT64_MAX, s, serialize_mt_unsafe);
+	int ret = service_run(id, cs, UINT64_MAX, s, serialize_mt_unsafe, false);
 
 	rte_atomic_fetch_sub_explicit(&s->num_mapped_cores, 1, rte_memory_order_relaxed);
 
@@ -511,9 +617,15 @@ service_runner_func(void *arg)
 	while (rte_atomic_load_explicit(&cs->runstate, rte_memory_order_acquire) ==
 			RUNSTATE_RUNNING) {
 
-		const uint64_t service_mask = cs->service_mask;
+		const bool shared = rte_atomic_load_explicit(&sched_mode,
+				rte_memory_order_relaxed) == RTE_SERVICE_SCHED_SHARED;
+		const uint64_t service_mask = shared ?
+				rte_atomic_load_explicit(&mapped_mask,
+					rte_memory_order_relaxed) :
+				cs->service_mask;
 		uint8_t start_id;
 		uint8_t end_id;
+		uint8_t n;
 
 		if (service_mask == 0)
 			continue;
@@ -521,9 +633,18 @@ service_runner_func(void *arg)
 		start_id = rte_ctz64(service_mask);
 		end_id = 64 - rte_clz64(service_mask);
 
-		for (i = start_id; i < end_id; i++) {
+		/* in shared mode, start from a different service at each
+		 * loop, so that the cores do not all wait on the same one.
+		 */
+		i = start_id;
+		if (shared)
+			i += cs->loops % (end_id - start_id);
+
+		for (n = start_id; n < end_id; n++) {
 			/* return value ignored as no change to code flow */
-			service_run(i, cs, service_mask, service_get(i), 1);
+			service_run(i, cs, service_mask, service_get(i), 1, true);
+			if (++i == end_id)
+				i = start_id;
 		}
 
 		rte_atomic_store_explicit(&cs->loops, cs->loops + 1, rte_memory_order_relaxed);
@@ -664,9 +785,22 @@ service_update(uint32_t sid, uint32_t lcore, uint32_t *set, uint32_t *enabled)
 		}
 		if (!*set && lcore_mapped) {
 			lcore_states[lcore].service_mask &= ~(sid_mask);
+			lcore_states[lcore].service_active_on_lcore[sid] = 0;
 			rte_atomic_fetch_sub_explicit(&rte_services[sid].num_mapped_cores,
 				1, rte_memory_order_relaxed);
 		}
+		service_mapped_mask_update();
+
+		/* in shared mode, an unmapped service may have run on any
+		 * service core, which will not visit it anymore.
+		 */
+		if (!*set && !(rte_atomic_load_explicit(&mapped_mask,
+				rte_memory_order_relaxed) & sid_mask)) {
+			uint32_t i;
+
+			for (i = 0; i < RTE_MAX_LCORE; i++)
+				lcore_states[i].service_active_on_lcore[sid] = 0;
+		}
 	}
 
 	if (enabled)
@@ -729,6 +863,7 @@ rte_service_lcore_reset_all(void)
 	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++)
 		rte_atomic_store_explicit(&rte_services[i].num_mapped_cores, 0,
 			rte_memory_order_relaxed);
+	service_mapped_mask_update();
 
 	return 0;
 }
@@ -745,6 +880,7 @@ rte_service_lcore_add(uint32_t lcore)
 
 	/* ensure that after adding a core the mask and state are defaults */
 	lcore_states[lcore].service_mask = 0;
+	service_mapped_mask_update();
 	/* Use store-release memory order here to synchronize with
 	 * load-acquire in runstate read functions.
 	 */
@@ -773,6 +909,7 @@ rte_service_lcore_del(uint32_t lcore)
 		return -EBUSY;
 
 	set_lcore_state(lcore, ROLE_RTE);
+	service_mapped_mask_update();
 
 	rte_smp_wmb();
 	return 0;
@@ -1104,3 +1241,142 @@ rte_service_dump(FILE *f, uint32_t id)
 
 	return 0;
 }
+
+int32_t
+rte_service_sched_mode_set(enum rte_service_sched_mode mode)
+{
+	if (mode != RTE_SERVICE_SCHED_MAPPED &&
+			mode != RTE_SERVICE_SCHED_SHARED)
+		return -EINVAL;
+
+	rte_atomic_store_explicit(&sched_mode, mode, rte_memory_order_relaxed);
+
+	return 0;
+}
+
+enum rte_service_sched_mode
+rte_service_sched_mode_get(void)
+{
+	return rte_atomic_load_explicit(&sched_mode, rte_memory_order_relaxed);
+}
+
+int32_t
+rte_service_set_priority(uint32_t id, uint32_t priority)
+{
+	struct rte_service_spec_impl *s;
+	SERVICE_VALID_GET_OR_ERR_RET(id, s, -EINVAL);
+
+	if (priority == 0 || priority > RTE_SERVICE_PRIORITY_MAX)
+		return -EINVAL;
+
+	s->priority = priority;
+
+	return 0;
+}
+
+int32_t
+rte_service_set_cycle_budget(uint32_t id, uint64_t cycles)
+{
+	struct rte_service_spec_impl *s;
+	SERVICE_VALID_GET_OR_ERR_RET(id, s, -EINVAL);
+
+	if (budget_period == 0)
+		budget_period = rte_get_tsc_hz() / MS_PER_S;
+
+	s->cycle_budget = cycles == 0 ? 0 :
+		RTE_MAX(cycles / MS_PER_S, UINT64_C(1));
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_rebalance(void)
+{
+	uint32_t ids[RTE_MAX_LCORE];
+	uint64_t lcore_load[RTE_MAX_LCORE] = {0};
+	uint32_t lcore_services[RTE_MAX_LCORE] = {0};
+	uint64_t load[RTE_SERVICE_NUM_MAX];
+	uint32_t order[RTE_SERVICE_NUM_MAX];
+	uint32_t n_lcores, n = 0, moved = 0;
+	uint32_t i, j, k, sid, cores, best, old;
+	uint32_t on = 1, off = 0;
+	uint64_t cycles, sid_mask;
+	int32_t ret;
+
+	ret = rte_service_lcore_list(ids, RTE_DIM(ids));
+	if (ret <= 0)
+		return -ENOTSUP;
+	n_lcores = ret;
+
+	for (sid = 0; sid < RTE_SERVICE_NUM_MAX; sid++) {
+		struct rte_service_spec_impl *s = &rte_services[sid];
+
+		if (!service_registered(sid))
+			continue;
+
+		/* load since the previous rebalance, or stats reset */
+		cycles = attr_get_service_cycles(sid);
+		load[sid] = cycles >= s->rebalance_cycles ?
+			cycles - s->rebalance_cycles : cycles;
+		s->rebalance_cycles = cycles;
+
+		sid_mask = UINT64_C(1) << sid;
+		cores = 0;
+		for (j = 0; j < n_lcores; j++)
+			cores += !!(lcore_states[ids[j]].service_mask & sid_mask);
+		if (cores == 0)
+			continue;
+
+		/* keep services mapped to several cores where they are */
+		if (cores > 1) {
+			for (j = 0; j < n_lcores; j++) {
+				if (!(lcore_states[ids[j]].service_mask & sid_mask))
+					continue;
+				lcore_load[j] += load[sid] / cores;
+				lcore_services[j]++;
+			}
+			continue;
+		}
+
+		/* sort by decreasing load */
+		for (k = n; k > 0 && load[order[k - 1]] < load[sid]; k--)
+			order[k] = order[k - 1];
+		order[k] = sid;
+		n++;
+	}
+
+	/* place the most loaded services first, each on the least loaded core,
+	 * unless the gain is too small to be worth moving the service.
+	 */
+	for (i = 0; i < n; i++) {
+		sid = order[i];
+		sid_mask = UINT64_C(1) << sid;
+
+		best = 0;
+		old = 0;
+		for (j = 0; j < n_lcores; j++) {
+			if (lcore_states[ids[j]].service_mask & sid_mask)
+				old = j;
+			if (lcore_load[j] < lcore_load[best] ||
+					(lcore_load[j] == lcore_load[best] &&
+					lcore_services[j] < lcore_services[best]))
+				best = j;
+		}
+		if (best != old && (load[sid] == 0 || lcore_load[old] -
+				lcore_load[best] <= load[sid] *
+				REBALANCE_GAIN_MIN_PERCENT / 100))
+			best = old;
+		lcore_load[best] += load[sid];
+		lcore_services[best]++;
+
+		if (best == old)
+			continue;
+
+		/* map the new core first, so the service keeps running */
+		service_update(sid, ids[best], &on, NULL);
+		service_update(sid, ids[old], &off, NULL);
+		moved++;
+	}
+
+	return moved;
+}
@@ -30,6 +30,7 @@ extern "C" {
 #include<stdio.h>
 #include <stdint.h>
 
+#include <rte_compat.h>
 #include <rte_config.h>
 #include <rte_lcore.h>
 
@@ -455,6 +456,121 @@ rte_service_lcore_attr_get(uint32_t lcore, uint32_t attr_id,
 int32_t
 rte_service_lcore_attr_reset_all(uint32_t lcore);
 
+/**
+ * Scheduling modes of the services on the service cores.
+ */
+enum rte_service_sched_mode {
+	/**
+	 * Each service core runs the services mapped to it, in turn.
+	 * This is the default mode.
+	 */
+	RTE_SERVICE_SCHED_MAPPED = 0,
+	/**
+	 * Service cores share the work of all the services mapped to any
+	 * service core: each running service core runs any of them, skipping
+	 * the multi-thread unsafe services already running on another core.
+	 * A busy service can thus use the cycles left by idle services,
+	 * whichever core they are mapped to.
+	 */
+	RTE_SERVICE_SCHED_SHARED,
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Set the scheduling mode of the services on the service cores.
+ *
+ * The mode can be changed while the service cores are running,
+ * service cores use the new mode from their next loop.
+ *
+ * @param mode The scheduling mode.
+ * @retval 0 Success
+ * @retval -EINVAL Invalid mode provided
+ */
+__rte_experimental
+int32_t rte_service_sched_mode_set(enum rte_service_sched_mode mode);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the scheduling mode of the services on the service cores.
+ *
+ * @return The scheduling mode.
+ */
+__rte_experimental
+enum rte_service_sched_mode rte_service_sched_mode_get(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Set the priority of a service.
+ *
+ * A service core calls a service up to *priority* times in a row in each
+ * of its loops, as long as the service has work to do (i.e., does not
+ * return -EAGAIN). The default priority is 1.
+ *
+ * @param id The service to set the priority of.
+ * @param priority The priority, from 1 to RTE_SERVICE_PRIORITY_MAX.
+ * @retval 0 Success
+ * @retval -EINVAL Invalid service id or priority provided
+ */
+__rte_experimental
+int32_t rte_service_set_priority(uint32_t id, uint32_t priority);
+
+/** Maximum priority of a service. */
+#define RTE_SERVICE_PRIORITY_MAX 64
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Set the cycle budget of a service.
+ *
+ * The service cores stop calling the service when it used its budget,
+ * accounted over all the service cores in periods of 1 ms, until the
+ * next period. Only the cycles spent in non-idle calls (i.e., calls not
+ * returning -EAGAIN) count. Calls done with
+ * rte_service_run_iter_on_app_lcore() are not limited.
+ *
+ * @param id The service to set the budget of.
+ * @param cycles Number of TSC cycles per second the service may use,
+ *   0 for no limit (the default).
+ * @retval 0 Success
+ * @retval -EINVAL Invalid service id provided
+ */
+__rte_experimental
+int32_t rte_service_set_cycle_budget(uint32_t id, uint64_t cycles);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Rebalance the services over the service cores, from their load.
+ *
+ * The services mapped to a single service core are remapped, so that the
+ * cycles used by the services since the previous rebalance
+ * (see RTE_SERVICE_ATTR_CYCLES) are spread as evenly as possible over the
+ * service cores. A service is only moved if the load difference between its
+ * current core and the new one is above a tenth of its own load, so that
+ * services of similar loads are not moved back and forth at each call.
+ * Services mapped to several service cores keep their
+ * mapping, their load being shared by their cores. Statistics must be
+ * enabled on the services for their load to be known,
+ * see rte_service_set_stats_enable().
+ *
+ * A service stays mapped to at least one core during the update, so the
+ * rebalance can be done while the service cores are running. As the other
+ * mapping functions, it must not be called concurrently with them.
+ *
+ * @retval >=0 Number of services which changed of service core.
+ * @retval -ENOTSUP No service core in use
+ */
+__rte_experimental
+int32_t rte_service_lcore_rebalance(void);
+
 #ifdef __cplusplus
 }
 #endif
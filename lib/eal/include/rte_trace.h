@@ -49,6 +49,15 @@ enum rte_trace_mode {
 	 * subsequent events shall not be recorded.
 	 */
 	RTE_TRACE_MODE_DISCARD,
+	/**
+	 * In this mode, the trace buffer is split in two halves. When one
+	 * is full, the events are recorded in the other one, while a control
+	 * thread appends the full one to the trace files. When no space is
+	 * left in both halves, the subsequent events are discarded and counted.
+	 * This mode can only be set before the trace buffers are allocated,
+	 * i.e. before the first event is recorded.
+	 */
+	RTE_TRACE_MODE_STREAM,
 };
 
 /**
@@ -106,6 +115,10 @@ int rte_trace_regexp(const char *regex, bool enable);
  * By default, trace directory will be created at $HOME directory and this can
  * be overridden by --trace-dir EAL parameter.
  *
+ * In streaming mode, the events are already written to the trace files
+ * in the background, this only writes the full buffers without waiting
+ * for the writer, and asks the threads to hand over the partial ones.
+ *
  * @return
  *   - 0: Success.
  *   - <0 : Failure.
@@ -113,6 +126,32 @@ int rte_trace_regexp(const char *regex, bool enable);
 __rte_experimental
 int rte_trace_save(void);
 
+/**
+ * Statistics of the streaming mode.
+ */
+struct rte_trace_stream_stats {
+	uint64_t bytes;   /**< Bytes of events written to the trace files. */
+	uint64_t flushes; /**< Buffer halves written to the trace files. */
+	uint64_t drops;   /**< Events discarded with both halves full. */
+	uint64_t lost;    /**< Buffer halves of exited threads not written. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the statistics of the streaming mode, for all the threads.
+ *
+ * @param stats
+ *   A pointer to the structure to fill.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): stats is NULL.
+ *   - (-ENOTSUP): The trace is not in streaming mode.
+ */
+__rte_experimental
+int rte_trace_stream_stats_get(struct rte_trace_stream_stats *stats);
+
 /**
  * Dump the trace metadata to a file.
  *
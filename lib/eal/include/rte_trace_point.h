@@ -239,6 +239,18 @@ __rte_trace_point_fp_is_enabled(void)
 __rte_experimental
 void __rte_trace_mem_per_thread_alloc(void);
 
+struct __rte_trace_header;
+
+/**
+ * @internal
+ *
+ * Get trace memory for an event when the current half of the thread
+ * buffer is full, or requested by the writer, in streaming mode.
+ */
+__rte_experimental
+void *__rte_trace_mem_stream_get(struct __rte_trace_header *trace,
+	uint16_t sz);
+
 /**
  * @internal
  *
@@ -291,6 +303,7 @@ int __rte_trace_point_register(rte_trace_point_t *trace, const char *name,
 #define __RTE_TRACE_FIELD_ID_MASK (0xffffULL << __RTE_TRACE_FIELD_ID_SHIFT)
 #define __RTE_TRACE_FIELD_ENABLE_MASK (1ULL << 63)
 #define __RTE_TRACE_FIELD_ENABLE_DISCARD (1ULL << 62)
+#define __RTE_TRACE_FIELD_ENABLE_STREAM (1ULL << 61)
 
 struct __rte_trace_stream_header {
 	uint32_t magic;
@@ -302,6 +315,14 @@ struct __rte_trace_stream_header {
 struct __rte_trace_header {
 	uint32_t offset;
 	uint32_t len;
+	/* In streaming mode, mem is split in two halves filled in turn,
+	 * len being the end of the current one.
+	 */
+	uint32_t stream_half;
+	uint32_t stream_half_len;
+	/* length of a full half to write, 0 when written */
+	RTE_ATOMIC(uint32_t) stream_full[2];
+	RTE_ATOMIC(uint64_t) stream_drops;
 	struct __rte_trace_stream_header stream_header;
 	uint8_t mem[];
 };
@@ -325,6 +346,8 @@ __rte_trace_mem_get(uint64_t in)
 	/* Check the wrap around case */
 	uint32_t offset = trace->offset;
 	if (unlikely((offset + sz) >= trace->len)) {
+		if (unlikely(in & __RTE_TRACE_FIELD_ENABLE_STREAM))
+			return __rte_trace_mem_stream_get(trace, sz);
 		/* Disable the trace event if it in DISCARD mode */
 		if (unlikely(in & __RTE_TRACE_FIELD_ENABLE_DISCARD))
 			return NULL;
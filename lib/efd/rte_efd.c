@@ -22,6 +22,8 @@
 #include <rte_jhash.h>
 #include <rte_hash_crc.h>
 #include <rte_tailq.h>
+#include <rte_seqcount.h>
+#include <rte_spinlock.h>
 
 #include "rte_efd.h"
 #if defined(RTE_ARCH_X86)
@@ -195,6 +197,11 @@ struct efd_offline_group_rules {
  * Those rules are split into EFD_CHUNK_NUM_GROUPS groups per chunk.
  */
 struct efd_offline_chunk_rules {
+	rte_spinlock_t lock;
+	/**< Serializes the updates of the chunk, so that writers working on
+	 * different chunks can proceed in parallel
+	 */
+
 	uint16_t num_rules;
 	/**< Number of rules in the entire chunk;
 	 * used to detect unbalanced groups
@@ -218,7 +225,13 @@ struct efd_online_group_entry {
  * A single chunk record, containing EFD_TARGET_CHUNK_NUM_RULES rules.
  * Those rules are split into EFD_CHUNK_NUM_GROUPS groups per chunk.
  */
-struct efd_online_chunk {
+struct __rte_cache_aligned efd_online_chunk {
+	rte_seqcount_t seqcount;
+	/**< Incremented before and after each update of the chunk,
+	 * so that lookups can detect a concurrent update and retry.
+	 * Shares the cache line with most of the bin choices.
+	 */
+
 	uint8_t bin_choice_list[(EFD_CHUNK_NUM_BINS * 2 + 7) / 8];
 	/**< This is a packed indirection index into the 'groups' array.
 	 * Each byte contains four two-bit values which index into
@@ -226,9 +239,13 @@ struct efd_online_chunk {
 	 * The efd_bin_to_group array returns the index into the groups array
 	 */
 
+	alignas(RTE_CACHE_LINE_SIZE)
 	struct efd_online_group_entry groups[EFD_CHUNK_NUM_GROUPS];
-	/**< Array of all the groups in the chunk. */
-} __rte_packed;
+	/**< Array of all the groups in the chunk.
+	 * A group entry may span two cache lines, depending on
+	 * RTE_EFD_VALUE_NUM_BITS; lookups rely on the sequence counter only.
+	 */
+};
 
 /**
  * EFD table structure
@@ -241,7 +258,7 @@ struct rte_efd_table {
 	uint32_t max_num_rules;
 	/**< Static maximum number of entries the table was constructed to hold. */
 
-	uint32_t num_rules;
+	RTE_ATOMIC(uint32_t) num_rules;
 	/**< Number of entries currently in the table . */
 
 	uint32_t num_chunks;
@@ -580,7 +597,6 @@ rte_efd_create(const char *name, uint32_t max_num_rules, uint32_t key_len,
 			"on socket %u", offline_cpu_socket);
 
 	table->max_num_rules = num_chunks * EFD_TARGET_CHUNK_MAX_NUM_RULES;
-	table->num_rules = 0;
 	table->num_chunks = num_chunks;
 	table->num_chunks_shift = num_chunks_shift;
 	table->key_len = key_len;
@@ -709,6 +725,9 @@ rte_efd_create(const char *name, uint32_t max_num_rules, uint32_t key_len,
 	for (i = 0; i < table->max_num_rules; i++)
 		rte_ring_sp_enqueue(r, (void *) ((uintptr_t) i));
 
+	for (i = 0; i < num_chunks; i++)
+		rte_spinlock_init(&table->offline_chunks[i].lock);
+
 	table->free_slots = r;
 	return table;
 
@@ -826,11 +845,12 @@ efd_apply_update(struct rte_efd_table * const table, const unsigned int socket_i
 	/* Update the online table with the new data across all sockets */
 	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
 		if (table->chunks[i] != NULL) {
-			memcpy(&(table->chunks[i][chunk_id].groups[group_id]),
-					new_group_entry,
+			chunk = &table->chunks[i][chunk_id];
+			rte_seqcount_write_begin(&chunk->seqcount);
+			memcpy(&chunk->groups[group_id], new_group_entry,
 					sizeof(struct efd_online_group_entry));
-			table->chunks[i][chunk_id].bin_choice_list[bin_index] =
-					choice_chunk;
+			chunk->bin_choice_list[bin_index] = choice_chunk;
+			rte_seqcount_write_end(&chunk->seqcount);
 		}
 	}
 }
@@ -1037,7 +1057,7 @@ efd_compute_update(struct rte_efd_table * const table,
 			status = RTE_EFD_UPDATE_WARN_GROUP_FULL;
 		}
 
-		if (rte_ring_sc_dequeue(table->free_slots, &slot_id) != 0)
+		if (rte_ring_dequeue(table->free_slots, &slot_id) != 0)
 			return RTE_EFD_UPDATE_FAILED;
 
 		new_k = RTE_PTR_ADD(table->keys, (uintptr_t) slot_id *
@@ -1050,7 +1070,8 @@ efd_compute_update(struct rte_efd_table * const table,
 		current_group->value[current_group->num_rules] = value;
 		current_group->bin_id[current_group->num_rules] = *bin_id;
 		current_group->num_rules++;
-		table->num_rules++;
+		rte_atomic_fetch_add_explicit(&table->num_rules, 1,
+				rte_memory_order_relaxed);
 		bin_size++;
 	} else {
 		uint32_t last = current_group->num_rules - 1;
@@ -1155,7 +1176,9 @@ efd_compute_update(struct rte_efd_table * const table,
 
 	if (!found) {
 		current_group->num_rules--;
-		table->num_rules--;
+		rte_atomic_fetch_sub_explicit(&table->num_rules, 1,
+				rte_memory_order_relaxed);
+		rte_ring_enqueue(table->free_slots, slot_id);
 	} else
 		current_group->value[current_group->num_rules - 1] =
 			key_changed_previous_value;
@@ -1166,22 +1189,28 @@ int
 rte_efd_update(struct rte_efd_table * const table, const unsigned int socket_id,
 		const void *key, const efd_value_t value)
 {
-	uint32_t chunk_id = 0, group_id = 0, bin_id = 0;
+	uint32_t chunk_id, group_id = 0, bin_id;
 	uint8_t new_bin_choice = 0;
 	struct efd_online_group_entry entry = {{0}};
+	rte_spinlock_t *lock;
+	int status;
+
+	efd_compute_ids(table, key, &chunk_id, &bin_id);
+	lock = &table->offline_chunks[chunk_id].lock;
+
+	rte_spinlock_lock(lock);
 
-	int status = efd_compute_update(table, socket_id, key, value,
+	status = efd_compute_update(table, socket_id, key, value,
 			&chunk_id, &group_id, &bin_id,
 			&new_bin_choice, &entry);
 
 	if (status == RTE_EFD_UPDATE_NO_CHANGE)
-		return EXIT_SUCCESS;
-
-	if (status == RTE_EFD_UPDATE_FAILED)
-		return status;
+		status = EXIT_SUCCESS;
+	else if (status != RTE_EFD_UPDATE_FAILED)
+		efd_apply_update(table, socket_id, chunk_id, group_id, bin_id,
+				new_bin_choice, &entry);
 
-	efd_apply_update(table, socket_id, chunk_id, group_id, bin_id,
-			new_bin_choice, &entry);
+	rte_spinlock_unlock(lock);
 	return status;
 }
 
@@ -1198,6 +1227,8 @@ rte_efd_delete(struct rte_efd_table * const table, const unsigned int socket_id,
 	struct efd_offline_chunk_rules * const chunk =
 			&table->offline_chunks[chunk_id];
 
+	rte_spinlock_lock(&chunk->lock);
+
 	uint8_t current_choice = efd_get_choice(table, socket_id,
 			chunk_id, bin_id);
 	uint32_t current_group_id = efd_bin_to_group[current_choice][bin_id];
@@ -1218,7 +1249,7 @@ rte_efd_delete(struct rte_efd_table * const table, const unsigned int socket_id,
 					*prev_value = current_group->value[i];
 
 				not_found = 0;
-				rte_ring_sp_enqueue(table->free_slots,
+				rte_ring_enqueue(table->free_slots,
 					(void *)((uintptr_t)current_group->key_idx[i]));
 			}
 		} else {
@@ -1235,10 +1266,12 @@ rte_efd_delete(struct rte_efd_table * const table, const unsigned int socket_id,
 	}
 
 	if (not_found == 0) {
-		table->num_rules--;
+		rte_atomic_fetch_sub_explicit(&table->num_rules, 1,
+				rte_memory_order_relaxed);
 		current_group->num_rules--;
 	}
 
+	rte_spinlock_unlock(&chunk->lock);
 	return not_found;
 }
 
@@ -1305,21 +1338,29 @@ efd_value_t
 rte_efd_lookup(const struct rte_efd_table * const table,
 		const unsigned int socket_id, const void *key)
 {
-	uint32_t chunk_id, group_id, bin_id;
+	uint32_t chunk_id, group_id, bin_id, sn;
 	uint8_t bin_choice;
+	efd_value_t value;
 	const struct efd_online_group_entry *group;
 	const struct efd_online_chunk * const chunks = table->chunks[socket_id];
+	const uint32_t hash_val_a = EFD_HASHFUNCA(key, table);
+	const uint32_t hash_val_b = EFD_HASHFUNCB(key, table);
 
 	/* Determine the chunk and group location for the given key */
 	efd_compute_ids(table, key, &chunk_id, &bin_id);
-	bin_choice = efd_get_choice(table, socket_id, chunk_id, bin_id);
-	group_id = efd_bin_to_group[bin_choice][bin_id];
-	group = &chunks[chunk_id].groups[group_id];
-
-	return efd_lookup_internal(group,
-			EFD_HASHFUNCA(key, table),
-			EFD_HASHFUNCB(key, table),
-			table->lookup_fn);
+
+	/* Retry if the chunk was updated while reading it */
+	do {
+		sn = rte_seqcount_read_begin(&chunks[chunk_id].seqcount);
+		bin_choice = efd_get_choice(table, socket_id, chunk_id, bin_id);
+		group_id = efd_bin_to_group[bin_choice][bin_id];
+		group = &chunks[chunk_id].groups[group_id];
+
+		value = efd_lookup_internal(group, hash_val_a, hash_val_b,
+				table->lookup_fn);
+	} while (rte_seqcount_read_retry(&chunks[chunk_id].seqcount, sn));
+
+	return value;
 }
 
 void rte_efd_lookup_bulk(const struct rte_efd_table * const table,
@@ -1331,6 +1372,7 @@ void rte_efd_lookup_bulk(const struct rte_efd_table * const table,
 	uint32_t bin_id_list[RTE_EFD_BURST_MAX];
 	uint8_t bin_choice_list[RTE_EFD_BURST_MAX];
 	uint32_t group_id_list[RTE_EFD_BURST_MAX];
+	uint32_t sn_list[RTE_EFD_BURST_MAX];
 	struct efd_online_group_entry *group;
 
 	struct efd_online_chunk *chunks = table->chunks[socket_id];
@@ -1342,6 +1384,8 @@ void rte_efd_lookup_bulk(const struct rte_efd_table * const table,
 	}
 
 	for (i = 0; i < num_keys; i++) {
+		sn_list[i] = rte_seqcount_read_begin(
+				&chunks[chunk_id_list[i]].seqcount);
 		bin_choice_list[i] = efd_get_choice(table, socket_id,
 				chunk_id_list[i], bin_id_list[i]);
 		group_id_list[i] =
@@ -1356,5 +1400,12 @@ void rte_efd_lookup_bulk(const struct rte_efd_table * const table,
 				EFD_HASHFUNCA(key_list[i], table),
 				EFD_HASHFUNCB(key_list[i], table),
 				table->lookup_fn);
+
+		/* The chunk was updated meanwhile, redo this key alone */
+		if (unlikely(rte_seqcount_read_retry(
+				&chunks[chunk_id_list[i]].seqcount,
+				sn_list[i])))
+			value_list[i] = rte_efd_lookup(table, socket_id,
+					key_list[i]);
 	}
 }
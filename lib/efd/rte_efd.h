@@ -172,8 +172,10 @@ rte_efd_find_existing(const char *name);
  * Computes an updated table entry for the supplied key/value pair.
  * The update is then immediately applied to the provided table and
  * all socket-local copies of the chunks are updated.
- * This operation is not multi-thread safe
- * and should only be called one from thread.
+ * This operation is multi-thread safe: updates of keys in different chunks
+ * proceed in parallel, updates in the same chunk are serialized.
+ * Concurrent lookups are never blocked, they retry if the chunk of
+ * the key is being updated.
  *
  * @param table
  *   EFD table to reference
@@ -203,8 +205,7 @@ rte_efd_update(struct rte_efd_table *table, unsigned int socket_id,
 
 /**
  * Removes any value currently associated with the specified key from the table
- * This operation is not multi-thread safe
- * and should only be called from one thread.
+ * This operation is multi-thread safe.
  *
  * @param table
  *   EFD table to reference
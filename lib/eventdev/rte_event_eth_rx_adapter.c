@@ -39,6 +39,23 @@
 
 #define RXA_NB_RX_WORK_DEFAULT 128
 
+/* rte_event::flow_id bits in rte_event::event */
+#define RXA_FLOW_ID_BITS	UINT64_C(0xFFFFF)
+
+/* A polled queue found empty this many times in a row is then skipped
+ * for an exponentially growing number of its WRR slots, up to
+ * 2^RXA_IDLE_SKIP_MAX_SHIFT, to save cycles for the busy queues.
+ */
+#define RXA_IDLE_POLL_THRESHOLD	8
+#define RXA_IDLE_SKIP_MAX_SHIFT	4
+
+/* With adaptive event vectors, vectors are sized to be filled within
+ * about this many Rx bursts at the average observed burst size. The
+ * average is kept in fixed point, scaled by 2^RXA_VECTOR_AVG_SHIFT.
+ */
+#define RXA_VECTOR_FILL_BURSTS	8
+#define RXA_VECTOR_AVG_SHIFT	3
+
 #define ETH_RX_ADAPTER_SERVICE_NAME_LEN	32
 #define ETH_RX_ADAPTER_MEM_NAME_LEN	32
 
@@ -70,6 +87,10 @@ struct eth_rx_poll_entry {
 	uint16_t eth_dev_id;
 	/* Eth rx queue to poll */
 	uint16_t eth_rx_qid;
+	/* Consecutive polls which found the queue empty */
+	uint16_t nb_empty_polls;
+	/* WRR slots of the queue to skip before polling it again */
+	uint16_t nb_skip;
 };
 
 struct __rte_cache_aligned eth_rx_vector_data {
@@ -77,6 +98,12 @@ struct __rte_cache_aligned eth_rx_vector_data {
 	uint16_t port;
 	uint16_t queue;
 	uint16_t max_vector_count;
+	/* Vector size in use, lower than max_vector_count if adaptive */
+	uint16_t vector_count;
+	/* Set if the vector size follows the arrival rate */
+	uint8_t adaptive;
+	/* Average Rx burst size, in fixed point */
+	uint16_t burst_avg;
 	uint64_t event;
 	uint64_t ts;
 	uint64_t vector_timeout_ticks;
@@ -886,7 +913,7 @@ rxa_create_event_vector(struct event_eth_rx_adapter *rx_adapter,
 		rxa_init_vector(rx_adapter, vec);
 	}
 	while (num) {
-		if (vec->vector_ev->nb_elem == vec->max_vector_count) {
+		if (vec->vector_ev->nb_elem >= vec->vector_count) {
 			/* Event ready. */
 			ev->event = vec->event;
 			ev->vec = vec->vector_ev;
@@ -902,7 +929,7 @@ rxa_create_event_vector(struct event_eth_rx_adapter *rx_adapter,
 			rxa_init_vector(rx_adapter, vec);
 		}
 
-		space = vec->max_vector_count - vec->vector_ev->nb_elem;
+		space = vec->vector_count - vec->vector_ev->nb_elem;
 		sz = num > space ? space : num;
 		memcpy(vec->vector_ev->mbufs + vec->vector_ev->nb_elem, mbufs,
 		       sizeof(void *) * sz);
@@ -912,7 +939,7 @@ rxa_create_event_vector(struct event_eth_rx_adapter *rx_adapter,
 		vec->ts = rte_rdtsc();
 	}
 
-	if (vec->vector_ev->nb_elem == vec->max_vector_count) {
+	if (vec->vector_ev->nb_elem >= vec->vector_count) {
 		ev->event = vec->event;
 		ev->vec = vec->vector_ev;
 		ev++;
@@ -924,6 +951,43 @@ rxa_create_event_vector(struct event_eth_rx_adapter *rx_adapter,
 	return filled;
 }
 
+/* Track the average Rx burst size of a queue using adaptive event
+ * vectors, and size its vectors to be filled within a few bursts.
+ * Empty polls count too, so that the size shrinks when the queue
+ * goes idle.
+ */
+static inline void
+rxa_vector_adapt(struct eth_rx_vector_data *vec, uint16_t nb_rx)
+{
+	uint32_t count;
+
+	vec->burst_avg += nb_rx - (vec->burst_avg >> RXA_VECTOR_AVG_SHIFT);
+
+	count = ((uint32_t)vec->burst_avg * RXA_VECTOR_FILL_BURSTS) >>
+		RXA_VECTOR_AVG_SHIFT;
+	count = rte_align32pow2(RTE_MAX(count, (uint32_t)MIN_VECTOR_SIZE));
+
+	vec->vector_count = RTE_MIN(count, vec->max_vector_count);
+}
+
+/* Fill the events of a burst of mbufs. The event word, including the
+ * flow id, is computed with plain 64-bit operations and stored with
+ * the mbuf pointer, with no bit-field access nor branch in the loop,
+ * so the compiler may vectorize it.
+ */
+static __rte_always_inline void
+rxa_fill_events(struct rte_event *ev, struct rte_mbuf **mbufs, uint16_t num,
+		uint64_t event, uint64_t rss_bits, const uint32_t *rss)
+{
+	const uint64_t base = event & ~rss_bits;
+	uint16_t i;
+
+	for (i = 0; i < num; i++) {
+		ev[i].event = base | (rss[i] & rss_bits);
+		ev[i].mbuf = mbufs[i];
+	}
+}
+
 static inline void
 rxa_buffer_mbufs(struct event_eth_rx_adapter *rx_adapter, uint16_t eth_dev_id,
 		 uint16_t rx_queue_id, struct rte_mbuf **mbufs, uint16_t num,
@@ -935,9 +999,9 @@ rxa_buffer_mbufs(struct event_eth_rx_adapter *rx_adapter, uint16_t eth_dev_id,
 					&rx_adapter->eth_devices[eth_dev_id];
 	struct eth_rx_queue_info *eth_rx_queue_info =
 					&dev_info->rx_queue[rx_queue_id];
-	uint16_t new_tail = buf->tail;
 	uint64_t event = eth_rx_queue_info->event;
 	uint32_t flow_id_mask = eth_rx_queue_info->flow_id_mask;
+	uint32_t rss_vals[BATCH_SIZE];
 	struct rte_mbuf *m = mbufs[0];
 	uint32_t rss_mask;
 	uint32_t rss;
@@ -959,23 +1023,27 @@ rxa_buffer_mbufs(struct event_eth_rx_adapter *rx_adapter, uint16_t eth_dev_id,
 		/* 0xffff ffff if RTE_MBUF_F_RX_RSS_HASH is set, otherwise 0 */
 		rss_mask = ~(((m->ol_flags & RTE_MBUF_F_RX_RSS_HASH) != 0) - 1);
 		do_rss = !rss_mask && !eth_rx_queue_info->flow_id_mask;
-		for (i = 0; i < num; i++) {
-			struct rte_event *ev;
 
-			m = mbufs[i];
-			*rxa_timestamp_dynfield(m) = ts |
+		/* Writing back the Rx timestamp is a no-op if the PMD set it */
+		if (ts != 0)
+			for (i = 0; i < num; i++) {
+				m = mbufs[i];
+				*rxa_timestamp_dynfield(m) = ts |
 					(*rxa_timestamp_dynfield(m) & ts_mask);
+			}
 
-			ev = &buf->events[new_tail];
-
+		for (i = 0; i < num; i++) {
+			m = mbufs[i];
 			rss = do_rss ? rxa_do_softrss(m, rx_adapter->rss_key_be)
 				     : m->hash.rss;
-			ev->event = event;
-			ev->flow_id = (rss & ~flow_id_mask) |
-				      (ev->flow_id & flow_id_mask);
-			ev->mbuf = m;
-			new_tail++;
+			rss_vals[i] = rss;
 		}
+
+		/* flow_id is the low 20 bits of the event word; the
+		 * application provided flow id, if any, is already in event.
+		 */
+		rxa_fill_events(&buf->events[buf->tail], mbufs, num, event,
+				~flow_id_mask & RXA_FLOW_ID_BITS, rss_vals);
 	} else {
 		num = rxa_create_event_vector(rx_adapter, eth_rx_queue_info,
 					      buf, mbufs, num);
@@ -1034,6 +1102,8 @@ rxa_eth_rx(struct event_eth_rx_adapter *rx_adapter, uint16_t port_id,
 	   struct rte_event_eth_rx_adapter_stats *stats)
 {
 	struct rte_mbuf *mbufs[BATCH_SIZE];
+	struct eth_rx_vector_data *vec =
+		&rx_adapter->eth_devices[port_id].rx_queue[queue_id].vector_data;
 	uint16_t n;
 	uint32_t nb_rx = 0;
 	uint32_t nb_flushed = 0;
@@ -1050,6 +1120,8 @@ rxa_eth_rx(struct event_eth_rx_adapter *rx_adapter, uint16_t port_id,
 
 		stats->rx_poll_count++;
 		n = rte_eth_rx_burst(port_id, queue_id, mbufs, BATCH_SIZE);
+		if (vec->adaptive)
+			rxa_vector_adapt(vec, n);
 		if (unlikely(!n)) {
 			if (rxq_empty)
 				*rxq_empty = 1;
@@ -1320,6 +1392,28 @@ rxa_intr_ring_dequeue(struct event_eth_rx_adapter *rx_adapter)
  * the hypervisor's switching layer where adjustments can be made to deal with
  * it.
  */
+/* Back off polling a queue which has been found empty several times in a
+ * row; any received packet brings it back to being polled at each of its
+ * WRR slots.
+ */
+static inline void
+rxa_poll_backoff(struct eth_rx_poll_entry *poll, uint32_t nb_rx)
+{
+	if (likely(nb_rx > 0)) {
+		poll->nb_empty_polls = 0;
+		return;
+	}
+
+	if (poll->nb_empty_polls <
+	    RXA_IDLE_POLL_THRESHOLD + RXA_IDLE_SKIP_MAX_SHIFT)
+		poll->nb_empty_polls++;
+
+	if (poll->nb_empty_polls < RXA_IDLE_POLL_THRESHOLD)
+		return;
+
+	poll->nb_skip = 1 << (poll->nb_empty_polls - RXA_IDLE_POLL_THRESHOLD);
+}
+
 static inline bool
 rxa_poll(struct event_eth_rx_adapter *rx_adapter)
 {
@@ -1337,8 +1431,15 @@ rxa_poll(struct event_eth_rx_adapter *rx_adapter)
 	/* Iterate through a WRR sequence */
 	for (num_queue = 0; num_queue < rx_adapter->wrr_len; num_queue++) {
 		unsigned int poll_idx = rx_adapter->wrr_sched[wrr_pos];
-		uint16_t qid = rx_adapter->eth_rx_poll[poll_idx].eth_rx_qid;
-		uint16_t d = rx_adapter->eth_rx_poll[poll_idx].eth_dev_id;
+		struct eth_rx_poll_entry *poll = &rx_adapter->eth_rx_poll[poll_idx];
+		uint16_t qid = poll->eth_rx_qid;
+		uint16_t d = poll->eth_dev_id;
+		uint32_t nb_queue_rx;
+
+		if (poll->nb_skip > 0) {
+			poll->nb_skip--;
+			goto poll_next_entry;
+		}
 
 		buf = rxa_event_buf_get(rx_adapter, d, qid, &stats);
 
@@ -1362,8 +1463,10 @@ rxa_poll(struct event_eth_rx_adapter *rx_adapter)
 			}
 		}
 
-		nb_rx += rxa_eth_rx(rx_adapter, d, qid, nb_rx, max_nb_rx,
+		nb_queue_rx = rxa_eth_rx(rx_adapter, d, qid, nb_rx, max_nb_rx,
 				NULL, buf, stats);
+		rxa_poll_backoff(poll, nb_queue_rx);
+		nb_rx += nb_queue_rx;
 		if (nb_rx > max_nb_rx) {
 			rx_adapter->wrr_pos =
 				    (wrr_pos + 1) % rx_adapter->wrr_len;
@@ -1992,6 +2095,8 @@ rxa_set_vector_data(struct eth_rx_queue_info *queue_info, uint16_t vector_count,
 
 	vector_data = &queue_info->vector_data;
 	vector_data->max_vector_count = vector_count;
+	vector_data->vector_count = vector_count;
+	vector_data->burst_avg = 0;
 	vector_data->port = port_id;
 	vector_data->queue = qid;
 	vector_data->vector_pool = mp;
@@ -2110,6 +2215,8 @@ rxa_add_queue(struct event_eth_rx_adapter *rx_adapter,
 		rxa_set_vector_data(queue_info, conf->vector_sz,
 				    conf->vector_timeout_ns, conf->vector_mp,
 				    rx_queue_id, dev_info->dev->data->port_id);
+		queue_info->vector_data.adaptive = !!(conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR_ADAPTIVE);
 		rx_adapter->ena_vector = 1;
 		rx_adapter->vector_tmo_ticks =
 			rx_adapter->vector_tmo_ticks ?
@@ -2723,6 +2830,25 @@ rte_event_eth_rx_adapter_queue_add(uint8_t id,
 		}
 	}
 
+	if (queue_conf->rx_queue_flags &
+	    RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR_ADAPTIVE) {
+		if (!(queue_conf->rx_queue_flags &
+		      RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR)) {
+			RTE_EDEV_LOG_ERR("Adaptive event vectors require event"
+					 " vectorization, eth port: %" PRIu16
+					 " adapter id: %" PRIu8,
+					 eth_dev_id, id);
+			return -EINVAL;
+		}
+		if (cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT) {
+			RTE_EDEV_LOG_ERR("Adaptive event vectors are not"
+					 " supported, eth port: %" PRIu16
+					 " adapter id: %" PRIu8,
+					 eth_dev_id, id);
+			return -ENOTSUP;
+		}
+	}
+
 	if ((cap & RTE_EVENT_ETH_RX_ADAPTER_CAP_MULTI_EVENTQ) == 0 &&
 		(rx_queue_id != -1)) {
 		RTE_EDEV_LOG_ERR("Rx queues can only be connected to single "
@@ -109,6 +109,15 @@ extern "C" {
 /**< This flag indicates that mbufs arriving on the queue need to be vectorized
  * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
  */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR_ADAPTIVE	0x4
+/**< This flag, valid along with RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR,
+ * lets the adapter size the vectors according to the arrival rate on the
+ * queue: vectors are smaller at low rates, to reduce latency, up to
+ * rte_event_eth_rx_adapter_queue_conf::vector_sz at high rates.
+ * Only supported by adapters without the
+ * RTE_EVENT_ETH_RX_ADAPTER_CAP_INTERNAL_PORT capability.
+ * @see rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
 
 /**
  * Adapter configuration structure that the adapter configuration callback
@@ -7,9 +7,12 @@
 #include <errno.h>
 
 #include <rte_string_fns.h>
+#include <rte_bitops.h>
 #include <rte_common.h>
 #include <rte_cycles.h>
 #include <rte_branch_prediction.h>
+#include <rte_spinlock.h>
+#include <rte_telemetry.h>
 
 #include "rte_jobstats.h"
 
@@ -260,3 +263,237 @@ rte_jobstats_reset(struct rte_jobstats *job)
 	RESET_TIME_MIN_MAX(job, exec);
 	job->exec_cnt = 0;
 }
+
+static inline void
+hist_add(struct rte_jobstats_ext *ext, uint64_t exec_time)
+{
+	uint32_t bucket;
+
+	if (likely(!ext->hist_enabled))
+		return;
+
+	bucket = RTE_MIN(rte_fls_u64(exec_time),
+		(uint32_t)RTE_JOBSTATS_HIST_BUCKETS - 1);
+	ext->hist[bucket]++;
+}
+
+int
+rte_jobstats_ext_init(struct rte_jobstats_ext *ext, struct rte_jobstats *job)
+{
+	if (ext == NULL || job == NULL)
+		return -EINVAL;
+
+	memset(ext, 0, sizeof(*ext));
+	ext->job = job;
+
+	return 0;
+}
+
+void
+rte_jobstats_ext_reset(struct rte_jobstats_ext *ext)
+{
+	rte_jobstats_reset(ext->job);
+	ext->sub_exec_time = 0;
+	memset(ext->hist, 0, sizeof(ext->hist));
+}
+
+void
+rte_jobstats_set_histogram(struct rte_jobstats_ext *ext, bool enable)
+{
+	ext->hist_enabled = enable;
+}
+
+int
+rte_jobstats_ext_finish(struct rte_jobstats_ext *ext, int64_t job_value)
+{
+	uint64_t exec_time;
+	int ret;
+
+	/* Some sanity check. */
+	if (unlikely(ext == NULL || ext->running_as_sub || ext->sub_running))
+		return -EINVAL;
+
+	exec_time = ext->job->exec_time;
+	ret = rte_jobstats_finish(ext->job, job_value);
+	if (ret >= 0)
+		hist_add(ext, ext->job->exec_time - exec_time);
+
+	return ret;
+}
+
+int
+rte_jobstats_sub_start(struct rte_jobstats_ext *parent,
+		struct rte_jobstats_ext *ext)
+{
+	/* Some sanity check. */
+	if (unlikely(parent == NULL || ext == NULL ||
+			(parent->job->context == NULL && !parent->running_as_sub) ||
+			ext->job->context != NULL || ext->running_as_sub))
+		return -EINVAL;
+
+	ext->parent = parent;
+	ext->running_as_sub = true;
+	parent->sub_running++;
+	ext->sub_start_time = get_time();
+
+	return 0;
+}
+
+int
+rte_jobstats_sub_finish(struct rte_jobstats_ext *ext)
+{
+	struct rte_jobstats *job;
+	uint64_t exec_time;
+
+	/* Some sanity check. */
+	if (unlikely(ext == NULL || !ext->running_as_sub || ext->sub_running))
+		return -EINVAL;
+
+	job = ext->job;
+	exec_time = get_time() - ext->sub_start_time;
+	ADD_TIME_MIN_MAX(job, exec, exec_time);
+	hist_add(ext, exec_time);
+	ext->parent->sub_exec_time += exec_time;
+	ext->parent->sub_running--;
+
+	job->exec_cnt++;
+	ext->running_as_sub = false;
+
+	return 0;
+}
+
+/* Max number of jobs reported by telemetry */
+#define JOBSTATS_TEL_MAX 256
+
+static struct rte_jobstats_ext *tel_jobs[JOBSTATS_TEL_MAX];
+static rte_spinlock_t tel_lock = RTE_SPINLOCK_INITIALIZER;
+
+/* Expects the telemetry lock to be held. */
+static int
+tel_job_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < JOBSTATS_TEL_MAX; i++)
+		if (tel_jobs[i] != NULL && strcmp(tel_jobs[i]->job->name, name) == 0)
+			return i;
+
+	return -1;
+}
+
+int
+rte_jobstats_telemetry_register(struct rte_jobstats_ext *ext)
+{
+	int i, ret = -ENOSPC;
+
+	if (ext == NULL || ext->job->name[0] == '\0')
+		return -EINVAL;
+
+	rte_spinlock_lock(&tel_lock);
+	if (tel_job_find(ext->job->name) >= 0) {
+		ret = -EEXIST;
+		goto out;
+	}
+	for (i = 0; i < JOBSTATS_TEL_MAX; i++) {
+		if (tel_jobs[i] == NULL) {
+			tel_jobs[i] = ext;
+			ret = 0;
+			break;
+		}
+	}
+out:
+	rte_spinlock_unlock(&tel_lock);
+	return ret;
+}
+
+int
+rte_jobstats_telemetry_unregister(struct rte_jobstats_ext *ext)
+{
+	int i, ret = -ENOENT;
+
+	rte_spinlock_lock(&tel_lock);
+	for (i = 0; i < JOBSTATS_TEL_MAX; i++) {
+		if (ext != NULL && tel_jobs[i] == ext) {
+			tel_jobs[i] = NULL;
+			ret = 0;
+			break;
+		}
+	}
+	rte_spinlock_unlock(&tel_lock);
+	return ret;
+}
+
+static int
+jobstats_handle_list(const char *cmd __rte_unused,
+		const char *params __rte_unused,
+		struct rte_tel_data *d)
+{
+	int i;
+
+	rte_tel_data_start_array(d, RTE_TEL_STRING_VAL);
+	rte_spinlock_lock(&tel_lock);
+	for (i = 0; i < JOBSTATS_TEL_MAX; i++)
+		if (tel_jobs[i] != NULL)
+			rte_tel_data_add_array_string(d, tel_jobs[i]->job->name);
+	rte_spinlock_unlock(&tel_lock);
+
+	return 0;
+}
+
+static int
+jobstats_handle_info(const char *cmd __rte_unused, const char *params,
+		struct rte_tel_data *d)
+{
+	const struct rte_jobstats_ext *ext;
+	const struct rte_jobstats *job;
+	struct rte_tel_data *hist;
+	int i, ret = 0;
+
+	if (params == NULL || params[0] == '\0')
+		return -EINVAL;
+
+	hist = rte_tel_data_alloc();
+	if (hist == NULL)
+		return -ENOMEM;
+
+	rte_spinlock_lock(&tel_lock);
+	i = tel_job_find(params);
+	if (i < 0) {
+		ret = -EINVAL;
+		goto out;
+	}
+	ext = tel_jobs[i];
+	job = ext->job;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_string(d, "name", job->name);
+	rte_tel_data_add_dict_string(d, "parent",
+		ext->parent != NULL ? ext->parent->job->name : "");
+	rte_tel_data_add_dict_uint(d, "exec_cnt", job->exec_cnt);
+	rte_tel_data_add_dict_uint(d, "exec_time", job->exec_time);
+	rte_tel_data_add_dict_uint(d, "min_exec_time",
+		job->exec_cnt != 0 ? job->min_exec_time : 0);
+	rte_tel_data_add_dict_uint(d, "max_exec_time", job->max_exec_time);
+	rte_tel_data_add_dict_uint(d, "sub_exec_time", ext->sub_exec_time);
+	rte_tel_data_add_dict_uint(d, "period", job->period);
+
+	if (ext->hist_enabled) {
+		rte_tel_data_start_array(hist, RTE_TEL_UINT_VAL);
+		for (i = 0; i < RTE_JOBSTATS_HIST_BUCKETS; i++)
+			rte_tel_data_add_array_uint(hist, ext->hist[i]);
+		rte_tel_data_add_dict_container(d, "hist", hist, 0);
+		hist = NULL;
+	}
+out:
+	rte_spinlock_unlock(&tel_lock);
+	rte_tel_data_free(hist);
+	return ret;
+}
+
+RTE_INIT(jobstats_init_telemetry)
+{
+	rte_telemetry_register_cmd("/jobstats/list", jobstats_handle_list,
+		"Returns the names of the registered jobs. Takes no parameters");
+	rte_telemetry_register_cmd("/jobstats/info", jobstats_handle_info,
+		"Returns the statistics of a job, with the log2 histogram of its execution times if enabled. Parameters: string job_name");
+}
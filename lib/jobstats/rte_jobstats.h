@@ -5,8 +5,10 @@
 #ifndef JOBSTATS_H_
 #define JOBSTATS_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include <rte_compat.h>
 #include <rte_memory.h>
 
 #ifdef __cplusplus
@@ -15,6 +17,13 @@ extern "C" {
 
 #define RTE_JOBSTATS_NAMESIZE 32
 
+/**
+ * Number of buckets of the execution time histogram of a job.
+ * Bucket 0 counts the executions of 0 cycles, bucket i the executions
+ * of [2^(i-1), 2^i) cycles, and the last bucket all the longer ones.
+ */
+#define RTE_JOBSTATS_HIST_BUCKETS 32
+
 /* Forward declarations. */
 struct rte_jobstats_context;
 struct rte_jobstats;
@@ -299,6 +308,194 @@ rte_jobstats_set_update_period_function(struct rte_jobstats *job,
 void
 rte_jobstats_reset(struct rte_jobstats *job);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice.
+ *
+ * Extended statistics of a job: histogram of the execution times,
+ * sub-jobs and telemetry. Allocated by the application next to
+ * the job it extends.
+ */
+struct __rte_cache_aligned rte_jobstats_ext {
+	struct rte_jobstats *job;
+	/**< Job extended by this object. */
+
+	struct rte_jobstats_ext *parent;
+	/**< Job of the last execution of this job as a sub-job, or NULL. */
+
+	uint64_t sub_exec_time;
+	/**< Total time spent in the sub-jobs of this job, part of exec_time. */
+
+	uint64_t sub_start_time;
+	/**< Start time of this job, when executing as a sub-job. */
+
+	uint32_t sub_running;
+	/**< Count of the sub-jobs of this job executing. */
+
+	bool running_as_sub;
+	/**< This job is executing as a sub-job. */
+
+	bool hist_enabled;
+	/**< Record the execution times in the histogram. */
+
+	uint64_t hist[RTE_JOBSTATS_HIST_BUCKETS];
+	/**< Count of executions per execution time bucket. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Initialize the extended statistics of a job, with the histogram disabled.
+ *
+ * The job must be finished with rte_jobstats_ext_finish() to be accounted
+ * in the extended statistics.
+ *
+ * @param ext
+ *  Extended statistics object.
+ * @param job
+ *  Job object, initialized with rte_jobstats_init().
+ * @return
+ *  0 on success
+ *  -EINVAL if *ext* or *job* is NULL.
+ */
+__rte_experimental
+int
+rte_jobstats_ext_init(struct rte_jobstats_ext *ext, struct rte_jobstats *job);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reset the statistics of a job and its extended statistics.
+ *
+ * @param ext
+ *  Extended statistics object.
+ */
+__rte_experimental
+void
+rte_jobstats_ext_reset(struct rte_jobstats_ext *ext);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable or disable the histogram of the execution times of a job.
+ *
+ * The histogram is reset by rte_jobstats_ext_reset().
+ *
+ * @param ext
+ *  Extended statistics object.
+ * @param enable
+ *  Record the execution times if true.
+ */
+__rte_experimental
+void
+rte_jobstats_set_histogram(struct rte_jobstats_ext *ext, bool enable);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Same as rte_jobstats_finish(), also updating the extended statistics.
+ *
+ * @param ext
+ *  Extended statistics of the job started with rte_jobstats_start().
+ * @param job_value
+ *  Job value. Job should pass in this parameter a value that it try to optimize
+ *  for example the number of packets it processed.
+ * @return
+ *  0 if job's period was not updated (job target equals job_value)
+ *  1 if job's period was updated
+ *  -EINVAL if *ext* is NULL, the job is not executing
+ *  or some of its sub-jobs are executing.
+ */
+__rte_experimental
+int
+rte_jobstats_ext_finish(struct rte_jobstats_ext *ext, int64_t job_value);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Mark that the job of *ext* is starting its execution as a sub-job of
+ * the job of *parent*, for example a stage of the processing done by
+ * *parent*.
+ *
+ * The time of the sub-job is part of the execution time of the parent,
+ * and is accounted in its sub_exec_time. It does not change the statistics
+ * of the context. Sub-jobs can be nested, and must be finished before
+ * their parent is finished or aborted.
+ *
+ * @param parent
+ *  Extended statistics of the job executing, started with
+ *  rte_jobstats_start() or rte_jobstats_sub_start().
+ * @param ext
+ *  Extended statistics of the sub-job.
+ * @return
+ *  0 on success
+ *  -EINVAL if *parent* or *ext* is NULL, *parent* is not executing
+ *  or *ext* is executing already.
+ */
+__rte_experimental
+int
+rte_jobstats_sub_start(struct rte_jobstats_ext *parent,
+		struct rte_jobstats_ext *ext);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Mark that a sub-job finished its execution.
+ *
+ * @param ext
+ *  Extended statistics of the sub-job.
+ * @return
+ *  0 on success
+ *  -EINVAL if *ext* is NULL, was not started with rte_jobstats_sub_start()
+ *  or some of its sub-jobs are executing.
+ */
+__rte_experimental
+int
+rte_jobstats_sub_finish(struct rte_jobstats_ext *ext);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Report the statistics of a job with the telemetry commands
+ * /jobstats/list and /jobstats/info, using its name.
+ *
+ * The job must be unregistered before its memory is released.
+ *
+ * @param ext
+ *  Extended statistics of a job with a unique name.
+ * @return
+ *  0 on success
+ *  -EINVAL if *ext* is NULL or its job has no name
+ *  -EEXIST if a job with the same name is registered
+ *  -ENOSPC if too many jobs are registered
+ */
+__rte_experimental
+int
+rte_jobstats_telemetry_register(struct rte_jobstats_ext *ext);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Stop reporting the statistics of a job with telemetry.
+ *
+ * @param ext
+ *  Extended statistics of the job.
+ * @return
+ *  0 on success
+ *  -ENOENT if *ext* is not registered
+ */
+__rte_experimental
+int
+rte_jobstats_telemetry_unregister(struct rte_jobstats_ext *ext);
+
 #ifdef __cplusplus
 }
 #endif
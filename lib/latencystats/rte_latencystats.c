@@ -2,7 +2,9 @@
  * Copyright(c) 2018 Intel Corporation
  */
 
+#include <ctype.h>
 #include <math.h>
+#include <stdlib.h>
 
 #include <rte_string_fns.h>
 #include <rte_mbuf_dyn.h>
@@ -12,6 +14,8 @@
 #include <rte_metrics.h>
 #include <rte_memzone.h>
 #include <rte_lcore.h>
+#include <rte_stdatomic.h>
+#include <rte_telemetry.h>
 
 #include "rte_latencystats.h"
 
@@ -19,7 +23,7 @@
 #define NS_PER_SEC 1E9
 
 /** Clock cycles per nano second */
-static uint64_t
+static double
 latencystat_cycles_per_ns(void)
 {
 	return rte_get_timer_hz() / NS_PER_SEC;
@@ -46,12 +50,39 @@ static uint64_t samp_intvl;
 static uint64_t timer_tsc;
 static uint64_t prev_tsc;
 
+/*
+ * Log-linear (HDR-style) latency histogram, in timer cycles.
+ * Latencies below 2 * LATENCY_HIST_SUB_BUCKETS cycles have their own bucket,
+ * larger ones are counted in LATENCY_HIST_SUB_BUCKETS buckets per power
+ * of two, which bounds the relative error of the percentiles to
+ * 1 / LATENCY_HIST_SUB_BUCKETS. Latencies of 2^LATENCY_HIST_MAX_BITS cycles
+ * and more are counted in the last bucket.
+ */
+#define LATENCY_HIST_SUB_BITS 5
+#define LATENCY_HIST_SUB_BUCKETS (1 << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_BITS 36
+#define LATENCY_HIST_BUCKETS \
+	((LATENCY_HIST_MAX_BITS - LATENCY_HIST_SUB_BITS + 1) << LATENCY_HIST_SUB_BITS)
+
+/*
+ * Latency stats of a Tx queue.
+ * Only updated by the thread transmitting on the queue, so no lock is
+ * needed; the stats of all the queues are merged when they are read.
+ */
+struct __rte_cache_aligned latency_queue_stats {
+	float min_latency; /**< Minimum latency in cycles */
+	float avg_latency; /**< Average latency in cycles */
+	float max_latency; /**< Maximum latency in cycles */
+	float jitter; /**< Latency variation */
+	float prev_latency; /**< Latency of the previous packet */
+	RTE_ATOMIC(uint64_t) hist[LATENCY_HIST_BUCKETS]; /**< Latency histogram */
+};
+
 struct rte_latency_stats {
-	float min_latency; /**< Minimum latency in nano seconds */
-	float avg_latency; /**< Average latency in nano seconds */
-	float max_latency; /**< Maximum latency in nano seconds */
-	float jitter; /** Latency variation */
-	rte_spinlock_t lock; /** Latency calculation lock */
+	uint32_t nb_queues; /**< Number of Tx queues */
+	uint32_t port_first_queue[RTE_MAX_ETHPORTS]; /**< First queue of a port */
+	uint16_t port_nb_queues[RTE_MAX_ETHPORTS]; /**< Tx queues of a port */
+	struct latency_queue_stats queues[]; /**< Tx queues stats */
 };
 
 static struct rte_latency_stats *glob_stats;
@@ -63,41 +94,165 @@ struct rxtx_cbs {
 static struct rxtx_cbs rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 static struct rxtx_cbs tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
-struct latency_stats_nameoff {
-	char name[RTE_ETH_XSTATS_NAME_SIZE];
-	unsigned int offset;
+static const char * const lat_stats_strings[] = {
+	"min_latency_ns",
+	"avg_latency_ns",
+	"max_latency_ns",
+	"jitter_ns",
+	"p50_latency_ns",
+	"p90_latency_ns",
+	"p99_latency_ns",
+	"p99_9_latency_ns",
 };
 
-static const struct latency_stats_nameoff lat_stats_strings[] = {
-	{"min_latency_ns", offsetof(struct rte_latency_stats, min_latency)},
-	{"avg_latency_ns", offsetof(struct rte_latency_stats, avg_latency)},
-	{"max_latency_ns", offsetof(struct rte_latency_stats, max_latency)},
-	{"jitter_ns", offsetof(struct rte_latency_stats, jitter)},
-};
+#define NUM_LATENCY_STATS RTE_DIM(lat_stats_strings)
+
+/* Index of the first percentile in lat_stats_strings */
+#define LATENCY_PCT_FIRST 4
+
+/* Percentiles, in parts per ten thousand */
+static const uint32_t lat_stats_pct[] = { 5000, 9000, 9900, 9990 };
+
+static inline unsigned int
+latency_hist_index(uint64_t latency)
+{
+	unsigned int shift;
+
+	if (latency < 2 * LATENCY_HIST_SUB_BUCKETS)
+		return latency;
+
+	latency = RTE_MIN(latency, (UINT64_C(1) << LATENCY_HIST_MAX_BITS) - 1);
+	shift = 63 - rte_clz64(latency) - LATENCY_HIST_SUB_BITS;
+
+	return (shift << LATENCY_HIST_SUB_BITS) + (latency >> shift);
+}
+
+/* Highest latency counted in a histogram bucket */
+static uint64_t
+latency_hist_value(unsigned int idx)
+{
+	unsigned int shift;
+
+	if (idx < 2 * LATENCY_HIST_SUB_BUCKETS)
+		return idx;
+
+	shift = (idx >> LATENCY_HIST_SUB_BITS) - 1;
+
+	return (((uint64_t)(idx & (LATENCY_HIST_SUB_BUCKETS - 1)) +
+		LATENCY_HIST_SUB_BUCKETS + 1) << shift) - 1;
+}
+
+/* Merge the stats of 'nb_queues' Tx queues starting at 'first',
+ * and fill 'values' with the resulting stats in nano seconds.
+ */
+static void
+latency_stats_merge(uint32_t first, uint32_t nb_queues, uint64_t *values)
+{
+	uint64_t hist[LATENCY_HIST_BUCKETS] = {0};
+	const struct latency_queue_stats *q;
+	float min = 0, max = 0, avg = 0, jitter = 0;
+	uint64_t total = 0, samples, sum, rank;
+	double cycles_per_ns = latencystat_cycles_per_ns();
+	unsigned int i, j;
+
+	for (i = first; i < first + nb_queues; i++) {
+		q = &glob_stats->queues[i];
+
+		samples = 0;
+		for (j = 0; j < LATENCY_HIST_BUCKETS; j++) {
+			uint64_t c = rte_atomic_load_explicit(&q->hist[j],
+					rte_memory_order_relaxed);
+
+			hist[j] += c;
+			samples += c;
+		}
+		if (samples == 0)
+			continue;
 
-#define NUM_LATENCY_STATS (sizeof(lat_stats_strings) / \
-				sizeof(lat_stats_strings[0]))
+		if (min == 0 || (q->min_latency != 0 && q->min_latency < min))
+			min = q->min_latency;
+		if (q->max_latency > max)
+			max = q->max_latency;
+		/* Weight the queue averages by the number of samples */
+		avg += q->avg_latency * samples;
+		jitter += q->jitter * samples;
+		total += samples;
+	}
+
+	memset(values, 0, NUM_LATENCY_STATS * sizeof(values[0]));
+	if (total == 0)
+		return;
+
+	values[0] = (uint64_t)floor(min / cycles_per_ns);
+	values[1] = (uint64_t)floor(avg / total / cycles_per_ns);
+	values[2] = (uint64_t)floor(max / cycles_per_ns);
+	values[3] = (uint64_t)floor(jitter / total / cycles_per_ns);
+
+	for (i = 0, j = 0, sum = 0; i < RTE_DIM(lat_stats_pct); i++) {
+		rank = RTE_MAX((total * lat_stats_pct[i] + 9999) / 10000, UINT64_C(1));
+		while (sum + hist[j] < rank)
+			sum += hist[j++];
+		/* A bucket can hold values above the highest latency seen */
+		values[LATENCY_PCT_FIRST + i] = (uint64_t)floor(
+			RTE_MIN((float)latency_hist_value(j), max) / cycles_per_ns);
+	}
+}
+
+/* Look up the stats shared memory when called from a secondary process */
+static int
+latency_stats_lookup(void)
+{
+	const struct rte_memzone *mz;
+
+	if (rte_eal_process_type() == RTE_PROC_SECONDARY) {
+		mz = rte_memzone_lookup(MZ_RTE_LATENCY_STATS);
+		if (mz == NULL) {
+			LATENCY_STATS_LOG(ERR,
+				"Latency stats memzone not found");
+			return -ENOMEM;
+		}
+		glob_stats = mz->addr;
+	}
+
+	if (glob_stats == NULL)
+		return -ENOMEM;
+
+	return 0;
+}
 
 int32_t
 rte_latencystats_update(void)
 {
-	unsigned int i;
-	float *stats_ptr = NULL;
-	uint64_t values[NUM_LATENCY_STATS] = {0};
+	uint64_t values[NUM_LATENCY_STATS];
+	uint16_t pid;
 	int ret;
 
-	for (i = 0; i < NUM_LATENCY_STATS; i++) {
-		stats_ptr = RTE_PTR_ADD(glob_stats,
-				lat_stats_strings[i].offset);
-		values[i] = (uint64_t)floor((*stats_ptr)/
-				latencystat_cycles_per_ns());
-	}
+	if (glob_stats == NULL)
+		return -ENOMEM;
 
+	latency_stats_merge(0, glob_stats->nb_queues, values);
 	ret = rte_metrics_update_values(RTE_METRICS_GLOBAL,
 					latency_stats_index,
 					values, NUM_LATENCY_STATS);
-	if (ret < 0)
+	if (ret < 0) {
 		LATENCY_STATS_LOG(INFO, "Failed to push the stats");
+		return ret;
+	}
+
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		if (glob_stats->port_nb_queues[pid] == 0)
+			continue;
+
+		latency_stats_merge(glob_stats->port_first_queue[pid],
+				glob_stats->port_nb_queues[pid], values);
+		ret = rte_metrics_update_values(pid, latency_stats_index,
+						values, NUM_LATENCY_STATS);
+		if (ret < 0) {
+			LATENCY_STATS_LOG(INFO,
+				"Failed to push the stats of port %u", pid);
+			return ret;
+		}
+	}
 
 	return ret;
 }
@@ -105,15 +260,13 @@ rte_latencystats_update(void)
 static void
 rte_latencystats_fill_values(struct rte_metric_value *values)
 {
+	uint64_t stats[NUM_LATENCY_STATS];
 	unsigned int i;
-	float *stats_ptr = NULL;
 
+	latency_stats_merge(0, glob_stats->nb_queues, stats);
 	for (i = 0; i < NUM_LATENCY_STATS; i++) {
-		stats_ptr = RTE_PTR_ADD(glob_stats,
-				lat_stats_strings[i].offset);
 		values[i].key = i;
-		values[i].value = (uint64_t)floor((*stats_ptr)/
-						latencystat_cycles_per_ns());
+		values[i].value = stats[i];
 	}
 }
 
@@ -155,12 +308,12 @@ calc_latency(uint16_t pid __rte_unused,
 		uint16_t qid __rte_unused,
 		struct rte_mbuf **pkts,
 		uint16_t nb_pkts,
-		void *_ __rte_unused)
+		void *user_param)
 {
-	unsigned int i;
-	uint64_t now;
+	struct latency_queue_stats *q = user_param;
+	unsigned int i, idx;
+	uint64_t now, cycles;
 	float latency;
-	static float prev_latency;
 	/*
 	 * Alpha represents degree of weighting decrease in EWMA,
 	 * a constant smoothing factor between 0 and 1. The value
@@ -170,12 +323,12 @@ calc_latency(uint16_t pid __rte_unused,
 
 	now = rte_rdtsc();
 
-	rte_spinlock_lock(&glob_stats->lock);
 	for (i = 0; i < nb_pkts; i++) {
 		if (!(pkts[i]->ol_flags & timestamp_dynflag))
 			continue;
 
-		latency = now - *timestamp_dynfield(pkts[i]);
+		cycles = now - *timestamp_dynfield(pkts[i]);
+		latency = cycles;
 
 		/*
 		 * The jitter is calculated as statistical mean of interpacket
@@ -188,24 +341,26 @@ calc_latency(uint16_t pid __rte_unused,
 		 * Reference: Calculated as per RFC 5481, sec 4.1,
 		 * RFC 3393 sec 4.5, RFC 1889 sec.
 		 */
-		glob_stats->jitter +=  (fabsf(prev_latency - latency)
-					- glob_stats->jitter)/16;
-		if (glob_stats->min_latency == 0)
-			glob_stats->min_latency = latency;
-		else if (latency < glob_stats->min_latency)
-			glob_stats->min_latency = latency;
-		else if (latency > glob_stats->max_latency)
-			glob_stats->max_latency = latency;
+		q->jitter += (fabsf(q->prev_latency - latency) - q->jitter) / 16;
+		if (q->min_latency == 0 || latency < q->min_latency)
+			q->min_latency = latency;
+		if (latency > q->max_latency)
+			q->max_latency = latency;
 		/*
 		 * The average latency is measured using exponential moving
 		 * average, i.e. using EWMA
 		 * https://en.wikipedia.org/wiki/Moving_average
 		 */
-		glob_stats->avg_latency +=
-			alpha * (latency - glob_stats->avg_latency);
-		prev_latency = latency;
+		q->avg_latency += alpha * (latency - q->avg_latency);
+		q->prev_latency = latency;
+
+		/* Single writer per queue, no atomic read-modify-write needed */
+		idx = latency_hist_index(cycles);
+		rte_atomic_store_explicit(&q->hist[idx],
+			rte_atomic_load_explicit(&q->hist[idx],
+				rte_memory_order_relaxed) + 1,
+			rte_memory_order_relaxed);
 	}
-	rte_spinlock_unlock(&glob_stats->lock);
 
 	return nb_pkts;
 }
@@ -218,7 +373,8 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 	uint16_t pid;
 	uint16_t qid;
 	struct rxtx_cbs *cbs = NULL;
-	const char *ptr_strings[NUM_LATENCY_STATS] = {0};
+	uint16_t port_nb_queues[RTE_MAX_ETHPORTS] = {0};
+	uint32_t nb_queues = 0;
 	const struct rte_memzone *mz = NULL;
 	const unsigned int flags = 0;
 	int ret;
@@ -226,9 +382,22 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 	if (rte_memzone_lookup(MZ_RTE_LATENCY_STATS))
 		return -EEXIST;
 
+	/* Count the Tx queues, each one having its own stats */
+	RTE_ETH_FOREACH_DEV(pid) {
+		struct rte_eth_dev_info dev_info;
+
+		if (rte_eth_dev_info_get(pid, &dev_info) != 0)
+			continue;
+
+		port_nb_queues[pid] = dev_info.nb_tx_queues;
+		nb_queues += dev_info.nb_tx_queues;
+	}
+
 	/** Allocate stats in shared memory fo multi process support */
-	mz = rte_memzone_reserve(MZ_RTE_LATENCY_STATS, sizeof(*glob_stats),
-					rte_socket_id(), flags);
+	mz = rte_memzone_reserve_aligned(MZ_RTE_LATENCY_STATS,
+			sizeof(*glob_stats) +
+			nb_queues * sizeof(struct latency_queue_stats),
+			rte_socket_id(), flags, RTE_CACHE_LINE_SIZE);
 	if (mz == NULL) {
 		LATENCY_STATS_LOG(ERR, "Cannot reserve memory: %s:%d",
 			__func__, __LINE__);
@@ -236,14 +405,17 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 	}
 
 	glob_stats = mz->addr;
-	rte_spinlock_init(&glob_stats->lock);
+	memset(glob_stats, 0, mz->len);
+	glob_stats->nb_queues = nb_queues;
+	for (pid = 0, nb_queues = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		glob_stats->port_first_queue[pid] = nb_queues;
+		glob_stats->port_nb_queues[pid] = port_nb_queues[pid];
+		nb_queues += port_nb_queues[pid];
+	}
 	samp_intvl = app_samp_intvl * latencystat_cycles_per_ns();
 
 	/** Register latency stats with stats library */
-	for (i = 0; i < NUM_LATENCY_STATS; i++)
-		ptr_strings[i] = lat_stats_strings[i].name;
-
-	latency_stats_index = rte_metrics_reg_names(ptr_strings,
+	latency_stats_index = rte_metrics_reg_names(lat_stats_strings,
 							NUM_LATENCY_STATS);
 	if (latency_stats_index < 0) {
 		LATENCY_STATS_LOG(DEBUG,
@@ -282,10 +454,11 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 					"register Rx callback for pid=%d, "
 					"qid=%d", pid, qid);
 		}
-		for (qid = 0; qid < dev_info.nb_tx_queues; qid++) {
+		for (qid = 0; qid < glob_stats->port_nb_queues[pid]; qid++) {
+			i = glob_stats->port_first_queue[pid] + qid;
 			cbs = &tx_cbs[pid][qid];
 			cbs->cb =  rte_eth_add_tx_callback(pid, qid,
-					calc_latency, user_cb);
+					calc_latency, &glob_stats->queues[i]);
 			if (!cbs->cb)
 				LATENCY_STATS_LOG(INFO, "Failed to "
 					"register Tx callback for pid=%d, "
@@ -325,7 +498,7 @@ rte_latencystats_uninit(void)
 					"remove Rx callback for pid=%d, "
 					"qid=%d", pid, qid);
 		}
-		for (qid = 0; qid < dev_info.nb_tx_queues; qid++) {
+		for (qid = 0; qid < glob_stats->port_nb_queues[pid]; qid++) {
 			cbs = &tx_cbs[pid][qid];
 			ret = rte_eth_remove_tx_callback(pid, qid, cbs->cb);
 			if (ret)
@@ -338,6 +511,7 @@ rte_latencystats_uninit(void)
 	/* free up the memzone */
 	mz = rte_memzone_lookup(MZ_RTE_LATENCY_STATS);
 	rte_memzone_free(mz);
+	glob_stats = NULL;
 
 	return 0;
 }
@@ -351,7 +525,7 @@ rte_latencystats_get_names(struct rte_metric_name *names, uint16_t size)
 		return NUM_LATENCY_STATS;
 
 	for (i = 0; i < NUM_LATENCY_STATS; i++)
-		strlcpy(names[i].name, lat_stats_strings[i].name,
+		strlcpy(names[i].name, lat_stats_strings[i],
 			sizeof(names[i].name));
 
 	return NUM_LATENCY_STATS;
@@ -360,22 +534,95 @@ rte_latencystats_get_names(struct rte_metric_name *names, uint16_t size)
 int
 rte_latencystats_get(struct rte_metric_value *values, uint16_t size)
 {
+	int ret;
+
 	if (size < NUM_LATENCY_STATS || values == NULL)
 		return NUM_LATENCY_STATS;
 
-	if (rte_eal_process_type() == RTE_PROC_SECONDARY) {
-		const struct rte_memzone *mz;
-		mz = rte_memzone_lookup(MZ_RTE_LATENCY_STATS);
-		if (mz == NULL) {
-			LATENCY_STATS_LOG(ERR,
-				"Latency stats memzone not found");
-			return -ENOMEM;
-		}
-		glob_stats =  mz->addr;
-	}
+	ret = latency_stats_lookup();
+	if (ret < 0)
+		return ret;
 
 	/* Retrieve latency stats */
 	rte_latencystats_fill_values(values);
 
 	return NUM_LATENCY_STATS;
 }
+
+static int
+handle_latencystats_list(const char *cmd __rte_unused,
+		const char *params __rte_unused,
+		struct rte_tel_data *d)
+{
+	uint16_t pid;
+
+	if (latency_stats_lookup() < 0)
+		return -ENOMEM;
+
+	rte_tel_data_start_array(d, RTE_TEL_INT_VAL);
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++)
+		if (glob_stats->port_nb_queues[pid] != 0)
+			rte_tel_data_add_array_int(d, pid);
+
+	return 0;
+}
+
+static int
+handle_latencystats_stats(const char *cmd __rte_unused,
+		const char *params,
+		struct rte_tel_data *d)
+{
+	uint64_t values[NUM_LATENCY_STATS];
+	uint32_t first, nb_queues;
+	unsigned long pid, qid;
+	char *end_param;
+	unsigned int i;
+
+	if (latency_stats_lookup() < 0)
+		return -ENOMEM;
+
+	first = 0;
+	nb_queues = glob_stats->nb_queues;
+
+	/* Optional "port_id[,queue_id]" parameters */
+	if (params != NULL && strlen(params) != 0) {
+		if (!isdigit(*params))
+			return -EINVAL;
+		pid = strtoul(params, &end_param, 0);
+		if (pid >= RTE_MAX_ETHPORTS ||
+				glob_stats->port_nb_queues[pid] == 0)
+			return -EINVAL;
+		first = glob_stats->port_first_queue[pid];
+		nb_queues = glob_stats->port_nb_queues[pid];
+
+		if (*end_param == ',') {
+			params = end_param + 1;
+			if (!isdigit(*params))
+				return -EINVAL;
+			qid = strtoul(params, &end_param, 0);
+			if (qid >= nb_queues)
+				return -EINVAL;
+			first += qid;
+			nb_queues = 1;
+		}
+		if (*end_param != '\0')
+			LATENCY_STATS_LOG(NOTICE,
+				"Extra parameters passed to latencystats telemetry command, ignoring");
+	}
+
+	latency_stats_merge(first, nb_queues, values);
+
+	rte_tel_data_start_dict(d);
+	for (i = 0; i < NUM_LATENCY_STATS; i++)
+		rte_tel_data_add_dict_uint(d, lat_stats_strings[i], values[i]);
+
+	return 0;
+}
+
+RTE_INIT(latencystats_init_telemetry)
+{
+	rte_telemetry_register_cmd("/latencystats/list", handle_latencystats_list,
+			"Returns list of ports with latency stats. Takes no parameters");
+	rte_telemetry_register_cmd("/latencystats/stats", handle_latencystats_stats,
+			"Returns the latency stats, of all ports if no parameters. Parameters: int port_id[,int queue_id]");
+}
@@ -65,6 +65,11 @@ int rte_latencystats_init(uint64_t samp_intvl,
 /**
  * Calculates the latency and jitter values internally, exposing the updated
  * values via *rte_latencystats_get* or the rte_metrics API.
+ *
+ * The latency of each Tx queue is recorded in its own histogram,
+ * the histograms are merged by this function to compute the latency
+ * percentiles of all the ports (global metrics) and of each port
+ * (metrics of the port).
  * @return:
  *  0      : on Success
  *  < 0    : Error in updating values.
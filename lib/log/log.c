@@ -16,6 +16,7 @@
 #include <rte_per_lcore.h>
 
 #include "log_internal.h"
+#include "log_private.h"
 
 #ifdef RTE_EXEC_ENV_WINDOWS
 #define strdup _strdup
@@ -479,6 +480,9 @@ rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
 	if (!rte_log_can_log(logtype, level))
 		return 0;
 
+	if (log_async_vlog(level, logtype, format, ap, &ret))
+		return ret;
+
 	/* save loglevel and logtype in a global per-lcore variable */
 	RTE_PER_LCORE(log_cur_msg).loglevel = level;
 	RTE_PER_LCORE(log_cur_msg).logtype = logtype;
@@ -488,6 +492,21 @@ rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
 	return ret;
 }
 
+/*
+ * Write a message queued by another thread in asynchronous mode.
+ */
+void
+log_write(uint32_t level, uint32_t logtype, const char *msg, size_t len)
+{
+	FILE *f = rte_log_get_stream();
+
+	RTE_PER_LCORE(log_cur_msg).loglevel = level;
+	RTE_PER_LCORE(log_cur_msg).logtype = logtype;
+
+	fwrite(msg, 1, len, f);
+	fflush(f);
+}
+
 /*
  * Generates a log message The message will be sent in the stream
  * defined by the previous call to rte_openlog_stream().
@@ -525,6 +544,8 @@ eal_log_set_default(FILE *default_log)
 void
 rte_eal_log_cleanup(void)
 {
+	log_async_cleanup();
+
 	if (default_log_stream) {
 		fclose(default_log_stream);
 		default_log_stream = NULL;
@@ -0,0 +1,444 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2014 Intel Corporation
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <rte_bitops.h>
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_per_lcore.h>
+#include <rte_stdatomic.h>
+
+#include "log_private.h"
+
+/* Minimum size of a ring */
+#define LOG_ASYNC_RING_SIZE_MIN 4096
+/* Longer messages are truncated */
+#define LOG_ASYNC_MSG_MAX 1024
+/* Sleep of the drainer when the rings are empty, in us */
+#define LOG_ASYNC_PERIOD_US 1000
+
+/*
+ * Header of a message in a ring, followed by the message padded to the
+ * header size, so that a header always fits before the end of the ring.
+ */
+struct log_record {
+	uint32_t len; /* LOG_RECORD_WRAP to go back to the start of the ring */
+	uint32_t level;
+	uint32_t logtype;
+	uint32_t reserved;
+};
+
+#define LOG_RECORD_WRAP UINT32_MAX
+
+/* Ring of the messages of a thread, with a single producer and consumer. */
+struct log_ring {
+	struct log_ring *next;
+	RTE_ATOMIC(bool) in_use; /* owned by a running thread */
+	uint32_t size;
+	RTE_ATOMIC(uint64_t) records;
+	RTE_ATOMIC(uint64_t) drops;
+	/* written by the owner thread */
+	alignas(RTE_CACHE_LINE_SIZE) RTE_ATOMIC(uint64_t) head;
+	/* written by the thread draining the ring */
+	alignas(RTE_CACHE_LINE_SIZE) RTE_ATOMIC(uint64_t) tail;
+	char data[];
+};
+
+static struct {
+	RTE_ATOMIC(bool) enabled;
+	RTE_ATOMIC(bool) stop;
+	/* serializes the draining, which does the I/O, taken before lock */
+	pthread_mutex_t drain_lock;
+	RTE_ATOMIC(uint64_t) written;
+	pthread_mutex_t lock; /* protects the fields below */
+	uint32_t ring_size;
+	/* Rings are only added at the head, so the list can be walked
+	 * without the lock, and only freed on cleanup, with both locks.
+	 */
+	RTE_ATOMIC(struct log_ring *) rings;
+	unsigned int generation; /* incremented when the rings are freed */
+	bool running;
+	pthread_t drainer;
+	bool key_created;
+	pthread_key_t key; /* releases the ring of an exiting thread */
+} log_async = {
+	.drain_lock = PTHREAD_MUTEX_INITIALIZER,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static RTE_DEFINE_PER_LCORE(struct log_ring *, log_ring);
+static RTE_DEFINE_PER_LCORE(unsigned int, log_ring_generation);
+
+static void
+log_ring_release(void *arg)
+{
+	struct log_ring *ring = arg;
+
+	rte_atomic_store_explicit(&ring->in_use, false, rte_memory_order_release);
+}
+
+/* Give the calling thread a ring, reusing one of an exited thread if any. */
+static struct log_ring *
+log_ring_attach(void)
+{
+	struct log_ring *ring;
+	bool in_use;
+	void *mem;
+
+	pthread_mutex_lock(&log_async.lock);
+	ring = rte_atomic_load_explicit(&log_async.rings,
+		rte_memory_order_relaxed);
+	for (; ring != NULL; ring = ring->next) {
+		in_use = false;
+		if (ring->size == log_async.ring_size &&
+				rte_atomic_compare_exchange_strong_explicit(
+					&ring->in_use, &in_use, true,
+					rte_memory_order_acquire,
+					rte_memory_order_relaxed))
+			break;
+	}
+
+	if (ring == NULL) {
+		if (posix_memalign(&mem, RTE_CACHE_LINE_SIZE,
+				sizeof(*ring) + log_async.ring_size) != 0)
+			goto out;
+		ring = mem;
+		memset(ring, 0, sizeof(*ring));
+		ring->size = log_async.ring_size;
+		rte_atomic_store_explicit(&ring->in_use, true,
+			rte_memory_order_relaxed);
+		ring->next = rte_atomic_load_explicit(&log_async.rings,
+			rte_memory_order_relaxed);
+		rte_atomic_store_explicit(&log_async.rings, ring,
+			rte_memory_order_release);
+	}
+
+	if (log_async.key_created)
+		pthread_setspecific(log_async.key, ring);
+	RTE_PER_LCORE(log_ring) = ring;
+	RTE_PER_LCORE(log_ring_generation) = log_async.generation;
+out:
+	pthread_mutex_unlock(&log_async.lock);
+	return ring;
+}
+
+static inline struct log_ring *
+log_ring_get(void)
+{
+	struct log_ring *ring = RTE_PER_LCORE(log_ring);
+
+	if (likely(ring != NULL &&
+			RTE_PER_LCORE(log_ring_generation) == log_async.generation))
+		return ring;
+
+	return log_ring_attach();
+}
+
+static inline void
+log_counter_inc(RTE_ATOMIC(uint64_t) *counter)
+{
+	/* only incremented by the owner of the ring */
+	rte_atomic_store_explicit(counter,
+		rte_atomic_load_explicit(counter, rte_memory_order_relaxed) + 1,
+		rte_memory_order_relaxed);
+}
+
+static int
+log_ring_enqueue(struct log_ring *ring, uint32_t level, uint32_t logtype,
+		const char *msg, uint32_t len)
+{
+	const uint32_t mask = ring->size - 1;
+	struct log_record *rec;
+	uint64_t head, tail;
+	uint32_t idx, need, pad = 0;
+
+	head = rte_atomic_load_explicit(&ring->head, rte_memory_order_relaxed);
+	tail = rte_atomic_load_explicit(&ring->tail, rte_memory_order_acquire);
+	idx = head & mask;
+	need = sizeof(*rec) + RTE_ALIGN_CEIL(len, sizeof(*rec));
+
+	/* a message is not split at the end of the ring */
+	if (need > ring->size - idx)
+		pad = ring->size - idx;
+	if (head + pad + need - tail > ring->size) {
+		log_counter_inc(&ring->drops);
+		return -ENOBUFS;
+	}
+
+	if (pad != 0) {
+		rec = (struct log_record *)&ring->data[idx];
+		rec->len = LOG_RECORD_WRAP;
+		head += pad;
+		idx = 0;
+	}
+
+	rec = (struct log_record *)&ring->data[idx];
+	rec->len = len;
+	rec->level = level;
+	rec->logtype = logtype;
+	memcpy(rec + 1, msg, len);
+
+	log_counter_inc(&ring->records);
+	/* seq_cst to be ordered with the check of the mode after enqueue */
+	rte_atomic_store_explicit(&ring->head, head + need,
+		rte_memory_order_seq_cst);
+
+	return 0;
+}
+
+/* Expects the drain lock to be held. */
+static unsigned int
+log_ring_drain(struct log_ring *ring)
+{
+	const uint32_t mask = ring->size - 1;
+	const struct log_record *rec;
+	uint64_t head, tail;
+	unsigned int n = 0;
+	uint32_t idx;
+
+	tail = rte_atomic_load_explicit(&ring->tail, rte_memory_order_relaxed);
+	/* seq_cst to be ordered with the disabling of the mode */
+	head = rte_atomic_load_explicit(&ring->head, rte_memory_order_seq_cst);
+
+	while (tail != head) {
+		idx = tail & mask;
+		rec = (const struct log_record *)&ring->data[idx];
+		if (rec->len == LOG_RECORD_WRAP) {
+			tail += ring->size - idx;
+			continue;
+		}
+
+		log_write(rec->level, rec->logtype,
+			(const char *)(rec + 1), rec->len);
+		tail += sizeof(*rec) + RTE_ALIGN_CEIL(rec->len, sizeof(*rec));
+		n++;
+
+		/* give the room back as soon as possible */
+		rte_atomic_store_explicit(&ring->tail, tail,
+			rte_memory_order_release);
+	}
+
+	return n;
+}
+
+static unsigned int
+log_async_drain(void)
+{
+	struct log_ring *ring;
+	unsigned int n = 0;
+
+	/* The list lock is not held while writing the messages,
+	 * so that threads logging for the first time are not blocked
+	 * by the I/O.
+	 */
+	pthread_mutex_lock(&log_async.drain_lock);
+	ring = rte_atomic_load_explicit(&log_async.rings,
+		rte_memory_order_acquire);
+	for (; ring != NULL; ring = ring->next)
+		n += log_ring_drain(ring);
+	rte_atomic_store_explicit(&log_async.written,
+		rte_atomic_load_explicit(&log_async.written,
+			rte_memory_order_relaxed) + n,
+		rte_memory_order_relaxed);
+	pthread_mutex_unlock(&log_async.drain_lock);
+
+	return n;
+}
+
+static void *
+log_async_drainer(__rte_unused void *arg)
+{
+	const struct timespec period = {
+		.tv_nsec = LOG_ASYNC_PERIOD_US * 1000,
+	};
+
+	while (!rte_atomic_load_explicit(&log_async.stop,
+			rte_memory_order_acquire)) {
+		if (log_async_drain() == 0)
+			nanosleep(&period, NULL);
+	}
+
+	return NULL;
+}
+
+bool
+log_async_vlog(uint32_t level, uint32_t logtype, const char *format,
+	va_list ap, int *ret)
+{
+	char msg[LOG_ASYNC_MSG_MAX];
+	struct log_ring *ring;
+	int len;
+
+	if (!rte_atomic_load_explicit(&log_async.enabled,
+			rte_memory_order_relaxed))
+		return false;
+
+	/* write critical messages right away, after the queued ones */
+	if (level <= RTE_LOG_CRIT) {
+		rte_log_async_flush();
+		return false;
+	}
+
+	ring = log_ring_get();
+	if (ring == NULL)
+		return false;
+
+	len = vsnprintf(msg, sizeof(msg), format, ap);
+	if (len < 0) {
+		*ret = len;
+		return true;
+	}
+	len = RTE_MIN(len, (int)sizeof(msg) - 1);
+
+	*ret = log_ring_enqueue(ring, level, logtype, msg, len);
+	if (*ret == 0)
+		*ret = len;
+
+	/* If the mode was disabled meanwhile, the final drain may have
+	 * missed this message: write it from here.
+	 */
+	if (unlikely(!rte_atomic_load_explicit(&log_async.enabled,
+			rte_memory_order_seq_cst)))
+		log_async_drain();
+
+	return true;
+}
+
+int
+rte_log_async_enable(unsigned int ring_size)
+{
+	int ret = 0;
+
+	if (ring_size == 0)
+		ring_size = RTE_LOG_ASYNC_RING_SIZE;
+	if (ring_size < LOG_ASYNC_RING_SIZE_MIN || !rte_is_power_of_2(ring_size))
+		return -EINVAL;
+
+	pthread_mutex_lock(&log_async.lock);
+	if (log_async.running) {
+		ret = -EALREADY;
+		goto out;
+	}
+
+	if (!log_async.key_created) {
+		ret = -pthread_key_create(&log_async.key, log_ring_release);
+		if (ret != 0)
+			goto out;
+		log_async.key_created = true;
+	}
+
+	log_async.ring_size = ring_size;
+	rte_atomic_store_explicit(&log_async.stop, false,
+		rte_memory_order_relaxed);
+	ret = -pthread_create(&log_async.drainer, NULL, log_async_drainer, NULL);
+	if (ret != 0)
+		goto out;
+#ifdef RTE_EXEC_ENV_LINUX
+	pthread_setname_np(log_async.drainer, "dpdk-log");
+#endif
+
+	log_async.running = true;
+	rte_atomic_store_explicit(&log_async.enabled, true,
+		rte_memory_order_release);
+out:
+	pthread_mutex_unlock(&log_async.lock);
+	return ret;
+}
+
+void
+rte_log_async_disable(void)
+{
+	pthread_t drainer;
+	bool running;
+
+	pthread_mutex_lock(&log_async.lock);
+	/* The threads which saw the mode enabled either queued their
+	 * message before the final drain sees it, or see the mode disabled
+	 * after queuing and drain it themselves.
+	 */
+	rte_atomic_store_explicit(&log_async.enabled, false,
+		rte_memory_order_seq_cst);
+	rte_atomic_store_explicit(&log_async.stop, true,
+		rte_memory_order_release);
+	running = log_async.running;
+	drainer = log_async.drainer;
+	log_async.running = false;
+	pthread_mutex_unlock(&log_async.lock);
+
+	if (running)
+		pthread_join(drainer, NULL);
+
+	log_async_drain();
+}
+
+void
+rte_log_async_flush(void)
+{
+	/* a critical message of the log stream itself */
+	if (log_async.running && pthread_equal(pthread_self(), log_async.drainer))
+		return;
+
+	log_async_drain();
+}
+
+int
+rte_log_async_stats_get(struct rte_log_async_stats *stats)
+{
+	struct log_ring *ring;
+
+	if (stats == NULL)
+		return -EINVAL;
+
+	memset(stats, 0, sizeof(*stats));
+	pthread_mutex_lock(&log_async.lock);
+	ring = rte_atomic_load_explicit(&log_async.rings,
+		rte_memory_order_relaxed);
+	for (; ring != NULL; ring = ring->next) {
+		stats->records += rte_atomic_load_explicit(&ring->records,
+			rte_memory_order_relaxed);
+		stats->drops += rte_atomic_load_explicit(&ring->drops,
+			rte_memory_order_relaxed);
+	}
+	stats->written = rte_atomic_load_explicit(&log_async.written,
+		rte_memory_order_relaxed);
+	pthread_mutex_unlock(&log_async.lock);
+
+	return 0;
+}
+
+void
+log_async_cleanup(void)
+{
+	struct log_ring *ring, *next;
+
+	rte_log_async_disable();
+
+	pthread_mutex_lock(&log_async.drain_lock);
+	pthread_mutex_lock(&log_async.lock);
+	ring = rte_atomic_load_explicit(&log_async.rings,
+		rte_memory_order_relaxed);
+	for (; ring != NULL; ring = next) {
+		next = ring->next;
+		free(ring);
+	}
+	rte_atomic_store_explicit(&log_async.rings, NULL,
+		rte_memory_order_relaxed);
+	log_async.generation++;
+	if (log_async.key_created) {
+		pthread_key_delete(log_async.key);
+		log_async.key_created = false;
+	}
+	rte_atomic_store_explicit(&log_async.written, 0,
+		rte_memory_order_relaxed);
+	pthread_mutex_unlock(&log_async.lock);
+	pthread_mutex_unlock(&log_async.drain_lock);
+}
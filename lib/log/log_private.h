@@ -0,0 +1,31 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2014 Intel Corporation
+ */
+
+#ifndef LOG_PRIVATE_H
+#define LOG_PRIVATE_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Write a formatted message to the log stream.
+ */
+void log_write(uint32_t level, uint32_t logtype, const char *msg, size_t len);
+
+/*
+ * Queue a message if the asynchronous mode is enabled.
+ * Return false if the message must be written by the caller,
+ * before consuming ap.
+ */
+bool log_async_vlog(uint32_t level, uint32_t logtype, const char *format,
+	va_list ap, int *ret);
+
+/*
+ * Stop the asynchronous mode and release its rings.
+ */
+void log_async_cleanup(void);
+
+#endif /* LOG_PRIVATE_H */
@@ -2,9 +2,12 @@
  * Copyright(c) 2017-2018 Intel Corporation
  */
 
+#include <errno.h>
+
 #include <rte_common.h>
 #include <rte_log.h>
 #include "log_internal.h"
+#include "log_private.h"
 
 /* set the log to default function, called during eal init process. */
 int
@@ -16,3 +19,39 @@ eal_log_init(__rte_unused const char *id, __rte_unused int facility)
 
 	return 0;
 }
+
+/* the asynchronous mode is not supported */
+bool
+log_async_vlog(__rte_unused uint32_t level, __rte_unused uint32_t logtype,
+	__rte_unused const char *format, __rte_unused va_list ap,
+	__rte_unused int *ret)
+{
+	return false;
+}
+
+void
+log_async_cleanup(void)
+{
+}
+
+int
+rte_log_async_enable(__rte_unused unsigned int ring_size)
+{
+	return -ENOTSUP;
+}
+
+void
+rte_log_async_disable(void)
+{
+}
+
+void
+rte_log_async_flush(void)
+{
+}
+
+int
+rte_log_async_stats_get(__rte_unused struct rte_log_async_stats *stats)
+{
+	return -ENOTSUP;
+}
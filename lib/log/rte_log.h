@@ -24,6 +24,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include <rte_common.h>
+#include <rte_compat.h>
 #include <rte_config.h>
 
 /* SDK log type */
@@ -310,6 +311,89 @@ int rte_log(uint32_t level, uint32_t logtype, const char *format, ...)
 int rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
 	__rte_format_printf(3, 0);
 
+/** Default size of the per-thread rings of the asynchronous log mode. */
+#define RTE_LOG_ASYNC_RING_SIZE (64 * 1024)
+
+/**
+ * Statistics of the asynchronous log mode.
+ */
+struct rte_log_async_stats {
+	uint64_t records; /**< Messages queued by the logging threads. */
+	uint64_t drops;   /**< Messages dropped because a ring was full. */
+	uint64_t written; /**< Messages written to the log stream. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable the asynchronous log mode.
+ *
+ * The messages are formatted by the logging thread and queued in a ring
+ * owned by the thread, without taking any lock. A control thread drains
+ * the rings to the log stream, so messages of different threads may be
+ * reordered. When a ring is full, the message is dropped and counted.
+ *
+ * Messages of critical or higher level are written synchronously,
+ * after the queued messages, so that the messages logged before a panic
+ * are not lost.
+ *
+ * Not supported on Windows.
+ *
+ * @param ring_size
+ *   Size in bytes of the ring of each logging thread, a power of 2 of at
+ *   least 4096, or 0 for RTE_LOG_ASYNC_RING_SIZE.
+ *   Messages are truncated to 1023 characters.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid ring size.
+ *   - (-EALREADY): Asynchronous mode already enabled.
+ *   - (-ENOTSUP): Not supported on this platform.
+ *   - Other negative errno: Cannot start the drainer thread.
+ */
+__rte_experimental
+int rte_log_async_enable(unsigned int ring_size);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Disable the asynchronous log mode, after writing the queued messages.
+ *
+ * The threads logging concurrently may queue messages after the last
+ * drain of this function; they write them synchronously on their own
+ * once they see the mode disabled.
+ */
+__rte_experimental
+void rte_log_async_disable(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Write the queued messages of all threads to the log stream
+ * without waiting for the drainer thread.
+ */
+__rte_experimental
+void rte_log_async_flush(void);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Get the statistics of the asynchronous log mode, since it was
+ * first enabled.
+ *
+ * @param stats
+ *   Statistics filled on success.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): NULL stats.
+ *   - (-ENOTSUP): Not supported on this platform.
+ */
+__rte_experimental
+int rte_log_async_stats_get(struct rte_log_async_stats *stats);
+
 /**
  * Generates a log message.
  *
@@ -16,6 +16,8 @@
 #include "rte_member_ht.h"
 #include "rte_member_vbf.h"
 #include "rte_member_sketch.h"
+#include "rte_member_cuckoo.h"
+#include "rte_member_cbf.h"
 
 TAILQ_HEAD(rte_member_list, rte_tailq_entry);
 static struct rte_tailq_elem rte_member_tailq = {
@@ -75,6 +77,12 @@ rte_member_free(struct rte_member_setsum *setsum)
 	case RTE_MEMBER_TYPE_VBF:
 		rte_member_free_vbf(setsum);
 		break;
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		rte_member_free_cuckoo(setsum);
+		break;
+	case RTE_MEMBER_TYPE_CBF:
+		rte_member_free_cbf(setsum);
+		break;
 	case RTE_MEMBER_TYPE_SKETCH:
 		rte_member_free_sketch(setsum);
 		break;
@@ -163,6 +171,12 @@ rte_member_create(const struct rte_member_parameters *params)
 	case RTE_MEMBER_TYPE_VBF:
 		ret = rte_member_create_vbf(setsum, params);
 		break;
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		ret = rte_member_create_cuckoo(setsum, params);
+		break;
+	case RTE_MEMBER_TYPE_CBF:
+		ret = rte_member_create_cbf(setsum, params);
+		break;
 	case RTE_MEMBER_TYPE_SKETCH:
 		ret = rte_member_create_sketch(setsum, params, sketch_key_ring);
 		break;
@@ -200,6 +214,10 @@ rte_member_add(const struct rte_member_setsum *setsum, const void *key,
 		return rte_member_add_ht(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_add_vbf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		return rte_member_add_cuckoo(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CBF:
+		return rte_member_add_cbf(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_SKETCH:
 		return rte_member_add_sketch(setsum, key, set_id);
 	default:
@@ -234,6 +252,10 @@ rte_member_lookup(const struct rte_member_setsum *setsum, const void *key,
 		return rte_member_lookup_ht(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_lookup_vbf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		return rte_member_lookup_cuckoo(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CBF:
+		return rte_member_lookup_cbf(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_SKETCH:
 		return rte_member_lookup_sketch(setsum, key, set_id);
 	default:
@@ -256,6 +278,12 @@ rte_member_lookup_bulk(const struct rte_member_setsum *setsum,
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_lookup_bulk_vbf(setsum, keys, num_keys,
 				set_ids);
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		return rte_member_lookup_bulk_cuckoo(setsum, keys, num_keys,
+				set_ids);
+	case RTE_MEMBER_TYPE_CBF:
+		return rte_member_lookup_bulk_cbf(setsum, keys, num_keys,
+				set_ids);
 	default:
 		return -EINVAL;
 	}
@@ -275,6 +303,12 @@ rte_member_lookup_multi(const struct rte_member_setsum *setsum, const void *key,
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_lookup_multi_vbf(setsum, key, match_per_key,
 				set_id);
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		return rte_member_lookup_multi_cuckoo(setsum, key,
+				match_per_key, set_id);
+	case RTE_MEMBER_TYPE_CBF:
+		return rte_member_lookup_multi_cbf(setsum, key, match_per_key,
+				set_id);
 	default:
 		return -EINVAL;
 	}
@@ -297,6 +331,13 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_lookup_multi_bulk_vbf(setsum, keys, num_keys,
 				max_match_per_key, match_count, set_ids);
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		return rte_member_lookup_multi_bulk_cuckoo(setsum, keys,
+				num_keys, max_match_per_key, match_count,
+				set_ids);
+	case RTE_MEMBER_TYPE_CBF:
+		return rte_member_lookup_multi_bulk_cbf(setsum, keys, num_keys,
+				max_match_per_key, match_count, set_ids);
 	default:
 		return -EINVAL;
 	}
@@ -342,6 +383,10 @@ rte_member_delete(const struct rte_member_setsum *setsum, const void *key,
 	switch (setsum->type) {
 	case RTE_MEMBER_TYPE_HT:
 		return rte_member_delete_ht(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		return rte_member_delete_cuckoo(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_CBF:
+		return rte_member_delete_cbf(setsum, key, set_id);
 	/* current vBF implementation does not support delete function */
 	case RTE_MEMBER_TYPE_SKETCH:
 		return rte_member_delete_sketch(setsum, key);
@@ -363,6 +408,12 @@ rte_member_reset(const struct rte_member_setsum *setsum)
 	case RTE_MEMBER_TYPE_VBF:
 		rte_member_reset_vbf(setsum);
 		return;
+	case RTE_MEMBER_TYPE_CUCKOO_FILTER:
+		rte_member_reset_cuckoo(setsum);
+		return;
+	case RTE_MEMBER_TYPE_CBF:
+		rte_member_reset_cbf(setsum);
+		return;
 	case RTE_MEMBER_TYPE_SKETCH:
 		rte_member_reset_sketch(setsum);
 		return;
@@ -13,7 +13,8 @@
  * used to test if a key belongs to certain sets. Two types of such
  * "set-summary" structures are implemented: hash-table based (HT) and vector
  * bloom filter (vBF). For HT setsummary, two subtypes or modes are available,
- * cache and non-cache modes. The table below summarize some properties of
+ * cache and non-cache modes. The cuckoo filter and the counting vBF are
+ * compact variants of non-cache HT and vBF, both supporting deletion. The table below summarize some properties of
  * the different implementations.
  */
 
@@ -48,6 +49,20 @@
  * |properties| used for heavy hitter       |
  * |          | detection.                  |
  * +----------+-----------------------------+
+ * +==========+=====================+=========================+
+ * |   type   |   cuckoo filter     |     counting vbf        |
+ * +==========+=====================+=========================+
+ * |structure | 16-bit entries, 4   | 4-bit counter array     |
+ * |          | per 64-bit bucket   |                         |
+ * +----------+---------------------+-------------------------+
+ * |set id    | up to 256           | limited by bf count     |
+ * |          |                     | up to 16.               |
+ * +----------+---------------------+-------------------------+
+ * |usages &  | can delete, half the| can delete, 4 times the |
+ * |properties| memory of HT, false| memory of vBF, user-    |
+ * |          | positive grows with | specified false-positive|
+ * |          | set count.          | rate.                   |
+ * +----------+---------------------+-------------------------+
  * -->
  */
 
@@ -76,6 +91,11 @@ typedef uint16_t member_set_t;
 #define RTE_MEMBER_BUCKET_ENTRIES 16
 /** Maximum number of characters in setsum name. */
 #define RTE_MEMBER_NAMESIZE 32
+/**
+ * Return value of rte_member_add() in cuckoo filter mode when the key was
+ * added, but the entry of another key had to be kept aside as a victim.
+ */
+#define RTE_MEMBER_ADD_VICTIM 2
 /** Max value of the random number */
 #define RTE_RAND_MAX      ~0LLU
 /**
@@ -115,6 +135,8 @@ enum rte_member_setsum_type {
 	RTE_MEMBER_TYPE_HT = 0,  /**< Hash table based set summary. */
 	RTE_MEMBER_TYPE_VBF,     /**< Vector of bloom filters. */
 	RTE_MEMBER_TYPE_SKETCH,
+	RTE_MEMBER_TYPE_CUCKOO_FILTER, /**< Cuckoo filter. */
+	RTE_MEMBER_TYPE_CBF,     /**< Vector of counting bloom filters. */
 	RTE_MEMBER_NUM_TYPE
 };
 
@@ -204,6 +226,14 @@ struct __rte_cache_aligned rte_member_parameters {
 	 *
 	 * vBF setsummary is a vector of bloom filters. It is used when number
 	 * of sets is not big (less than 32 for current implementation).
+	 *
+	 * Cuckoo filter setsummary stores a fingerprint and the set id of each
+	 * key in a 16-bit entry. It uses half the memory of HT and supports
+	 * deletion, but the fingerprint gets shorter as the number of sets
+	 * grows (up to 256 sets).
+	 *
+	 * Counting vBF setsummary is a vBF with 4-bit counters instead of bits,
+	 * so that keys can be deleted (up to 16 sets).
 	 */
 	enum rte_member_setsum_type type;
 
@@ -242,7 +272,10 @@ struct __rte_cache_aligned rte_member_parameters {
 	 * evenly distributed to each BF in vBF. This is used to calculate the
 	 * number of bits we need for each BF. User does not specify the size of
 	 * each BF directly because the optimal size depends on the num_keys
-	 * and false positive rate.
+	 * and false positive rate. The same applies to counting vBF.
+	 *
+	 * For cuckoo filter, num_keys is the expected number of keys, the
+	 * table is sized to hold them at 95% load.
 	 */
 	uint32_t num_keys;
 
@@ -253,19 +286,23 @@ struct __rte_cache_aligned rte_member_parameters {
 	uint32_t key_len;
 
 	/**
-	 * num_set is only used for vBF, but not used for HT setsummary.
+	 * num_set is not used for HT setsummary.
 	 *
 	 * num_set is equal to the number of BFs in vBF. For current
 	 * implementation, it only supports 1,2,4,8,16,32 BFs in one vBF set
 	 * summary. If other number of sets are needed, for example 5, the user
 	 * should allocate the minimum available value that larger than 5,
 	 * which is 8.
+	 *
+	 * For counting vBF, num_set is the number of BFs as for vBF, up to 16.
+	 * For cuckoo filter, num_set is the maximum set id, up to 256. Each
+	 * doubling of num_set takes one bit from the 16-bit fingerprint.
 	 */
 	uint32_t num_set;
 
 	/**
-	 * false_positive_rate is only used for vBF, but not used for HT
-	 * setsummary.
+	 * false_positive_rate is only used for vBF and counting vBF, but not
+	 * used for HT setsummary.
 	 *
 	 * For vBF, false_positive_rate is the user-defined false positive rate
 	 * given expected number of inserted keys (num_keys). It is used to
@@ -462,6 +499,9 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
  *   For HT mode, the set_id has range as [1, 0x7FFF], MSB is reserved.
  *   For vBF mode the set id is limited by the num_set parameter when create
  *   the set-summary. For sketch mode, this id is ignored.
+ *   For cuckoo filter and counting vBF modes, the set id is limited by the
+ *   num_set parameter, and a key added several times must be deleted as
+ *   many times.
  * @return
  *   HT (cache mode) and vBF should never fail unless the set_id is not in the
  *   valid range. In such case -EINVAL is returned.
@@ -472,7 +512,12 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
  *   Return 0 for HT (cache mode) if the add does not cause
  *   eviction, return 1 otherwise. Return 0 for non-cache mode if success,
  *   -ENOSPC for full, and 1 if cuckoo eviction happens.
- *   Always returns 0 for vBF mode and sketch.
+ *   Always returns 0 for vBF mode, counting vBF mode and sketch.
+ *   Return 0 for cuckoo filter mode if success, 1 if cuckoo eviction
+ *   happens, RTE_MEMBER_ADD_VICTIM if an entry could not be placed after
+ *   the maximum number of kicks and was kept aside, and -ENOSPC if the
+ *   victim could not be placed back in the table, in which case the key is
+ *   not added.
  */
 int
 rte_member_add(const struct rte_member_setsum *setsum, const void *key,
@@ -561,6 +606,7 @@ rte_member_reset(const struct rte_member_setsum *setsum);
  *   For HT mode, we need both key and its corresponding set_id to
  *   properly delete the key. Without set_id, we may delete other keys with the
  *   same signature.
+ *   The set_id is also needed for cuckoo filter and counting vBF modes.
  * @return
  *   If no entry found to delete, an error code of -ENOENT could be returned.
  */
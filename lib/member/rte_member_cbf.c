@@ -0,0 +1,296 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#include <string.h>
+
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_prefetch.h>
+
+#include "member.h"
+#include "rte_member.h"
+#include "rte_member_vbf.h"
+#include "rte_member_cbf.h"
+
+/*
+ * The vector of counting bloom filters (counting vBF) uses the same vertical
+ * layout as vBF, with each bit replaced by a 4-bit counter: the counters of
+ * the same location in all the BFs are next to each other, so that a single
+ * 64-bit read returns the counters of one location for up to 16 BFs. This
+ * allows the deletion of keys at the cost of 4 times more memory than vBF.
+ *
+ * A counter saturates at its maximum value and is never decremented after
+ * that, so a deletion never results in a false negative.
+ *
+ * Currently the implementation supports counting vBF containing
+ * 1,2,4,8,16 BFs.
+ */
+
+#define CBF_COUNTER_MAX 0xF
+
+static inline size_t
+cbf_size(const struct rte_member_setsum *ss)
+{
+	/* 4 bits per counter, rounded up to a 64-bit word. */
+	return RTE_MAX(((size_t)ss->bits * ss->num_set) >> 1, sizeof(uint64_t));
+}
+
+int
+rte_member_create_cbf(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	int ret;
+
+	if (params->num_set > RTE_MEMBER_MAX_CBF ||
+			!rte_is_power_of_2(params->num_set) ||
+			params->num_keys == 0 ||
+			params->false_positive_rate == 0 ||
+			params->false_positive_rate > 1) {
+		rte_errno = EINVAL;
+		MEMBER_LOG(ERR, "Membership counting vBF create with invalid parameters");
+		return -EINVAL;
+	}
+
+	ret = rte_member_size_vbf(ss, params);
+	if (ret < 0)
+		return ret;
+
+	ss->table = rte_zmalloc_socket(NULL, cbf_size(ss),
+					RTE_CACHE_LINE_SIZE, ss->socket_id);
+	if (ss->table == NULL)
+		return -ENOMEM;
+
+	return 0;
+}
+
+/*
+ * Gather bit 0 of each 4-bit field of the 64-bit word into the 16 lower bits
+ * of the result.
+ */
+static inline uint32_t
+nibble_flags_compress(uint64_t x)
+{
+	x &= 0x1111111111111111ULL;
+	x = (x | (x >> 3)) & 0x0303030303030303ULL;
+	x = (x | (x >> 6)) & 0x000F000F000F000FULL;
+	x = (x | (x >> 12)) & 0x000000FF000000FFULL;
+	x = (x | (x >> 24)) & 0xFFFF;
+	return x;
+}
+
+static inline uint32_t
+counter_index(uint32_t loc, const struct rte_member_setsum *ss)
+{
+	return loc << ss->mul_shift;
+}
+
+static inline const uint64_t *
+counter_word(uint32_t idx, const struct rte_member_setsum *ss)
+{
+	const uint64_t *cbf = ss->table;
+
+	return &cbf[idx >> 4];
+}
+
+/* Return the bit mask of the BFs with a non-zero counter at this location. */
+static inline uint32_t
+test_counters(uint32_t loc, const struct rte_member_setsum *ss)
+{
+	uint32_t idx = counter_index(loc, ss);
+	uint64_t x = *counter_word(idx, ss) >> ((idx & 15) << 2);
+
+	x |= x >> 1;
+	x |= x >> 2;
+	return nibble_flags_compress(x) & (uint32_t)((1ULL << ss->num_set) - 1);
+}
+
+static inline void
+update_counter(uint32_t loc, const struct rte_member_setsum *ss,
+		member_set_t set, int inc)
+{
+	uint32_t idx = counter_index(loc, ss) + set - 1;
+	uint64_t *word = (uint64_t *)(uintptr_t)counter_word(idx, ss);
+	uint32_t shift = (idx & 15) << 2;
+	uint64_t counter = (*word >> shift) & CBF_COUNTER_MAX;
+
+	if (counter == CBF_COUNTER_MAX)
+		return;
+
+	if (inc)
+		*word += 1ULL << shift;
+	else
+		*word -= 1ULL << shift;
+}
+
+static inline void
+get_hashes(const struct rte_member_setsum *ss, const void *key,
+		uint32_t *h1, uint32_t *h2)
+{
+	*h1 = MEMBER_HASH_FUNC(key, ss->key_len, ss->prim_hash_seed);
+	*h2 = MEMBER_HASH_FUNC(h1, sizeof(uint32_t), ss->sec_hash_seed);
+}
+
+static inline uint32_t
+test_key(uint32_t h1, uint32_t h2, const struct rte_member_setsum *ss)
+{
+	uint32_t mask = ~0;
+	uint32_t j;
+
+	for (j = 0; j < ss->num_hashes; j++)
+		mask &= test_counters((h1 + j * h2) & ss->bit_mask, ss);
+
+	return mask;
+}
+
+static inline void
+prefetch_key(uint32_t h1, uint32_t h2, const struct rte_member_setsum *ss)
+{
+	uint32_t j;
+
+	for (j = 0; j < ss->num_hashes; j++)
+		rte_prefetch0(counter_word(counter_index((h1 + j * h2) &
+					ss->bit_mask, ss), ss));
+}
+
+int
+rte_member_lookup_cbf(const struct rte_member_setsum *ss, const void *key,
+		member_set_t *set_id)
+{
+	uint32_t h1, h2, mask;
+
+	get_hashes(ss, key, &h1, &h2);
+	mask = test_key(h1, h2, ss);
+
+	if (mask) {
+		*set_id = rte_ctz32(mask) + 1;
+		return 1;
+	}
+
+	*set_id = RTE_MEMBER_NO_MATCH;
+	return 0;
+}
+
+uint32_t
+rte_member_lookup_bulk_cbf(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, member_set_t *set_ids)
+{
+	uint32_t i, mask;
+	uint32_t num_matches = 0;
+	uint32_t h1[RTE_MEMBER_LOOKUP_BULK_MAX], h2[RTE_MEMBER_LOOKUP_BULK_MAX];
+
+	for (i = 0; i < num_keys; i++) {
+		get_hashes(ss, keys[i], &h1[i], &h2[i]);
+		prefetch_key(h1[i], h2[i], ss);
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		mask = test_key(h1[i], h2[i], ss);
+		if (mask) {
+			set_ids[i] = rte_ctz32(mask) + 1;
+			num_matches++;
+		} else
+			set_ids[i] = RTE_MEMBER_NO_MATCH;
+	}
+	return num_matches;
+}
+
+static inline uint32_t
+mask_to_set_ids(uint32_t mask, uint32_t match_per_key, member_set_t *set_id)
+{
+	uint32_t num_matches = 0;
+
+	while (mask && num_matches < match_per_key) {
+		uint32_t loc = rte_ctz32(mask);
+
+		set_id[num_matches++] = loc + 1;
+		mask &= ~(1UL << loc);
+	}
+	return num_matches;
+}
+
+uint32_t
+rte_member_lookup_multi_cbf(const struct rte_member_setsum *ss,
+		const void *key, uint32_t match_per_key,
+		member_set_t *set_id)
+{
+	uint32_t h1, h2;
+
+	get_hashes(ss, key, &h1, &h2);
+	return mask_to_set_ids(test_key(h1, h2, ss), match_per_key, set_id);
+}
+
+uint32_t
+rte_member_lookup_multi_bulk_cbf(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, uint32_t match_per_key,
+		uint32_t *match_count,
+		member_set_t *set_ids)
+{
+	uint32_t i;
+	uint32_t num_matches = 0;
+	uint32_t h1[RTE_MEMBER_LOOKUP_BULK_MAX], h2[RTE_MEMBER_LOOKUP_BULK_MAX];
+
+	for (i = 0; i < num_keys; i++) {
+		get_hashes(ss, keys[i], &h1[i], &h2[i]);
+		prefetch_key(h1[i], h2[i], ss);
+	}
+
+	for (i = 0; i < num_keys; i++) {
+		match_count[i] = mask_to_set_ids(test_key(h1[i], h2[i], ss),
+				match_per_key, &set_ids[i * match_per_key]);
+		if (match_count[i] != 0)
+			num_matches++;
+	}
+	return num_matches;
+}
+
+int
+rte_member_add_cbf(const struct rte_member_setsum *ss,
+		const void *key, member_set_t set_id)
+{
+	uint32_t j, h1, h2;
+
+	if (set_id > ss->num_set || set_id == RTE_MEMBER_NO_MATCH)
+		return -EINVAL;
+
+	get_hashes(ss, key, &h1, &h2);
+
+	for (j = 0; j < ss->num_hashes; j++)
+		update_counter((h1 + j * h2) & ss->bit_mask, ss, set_id, 1);
+
+	return 0;
+}
+
+int
+rte_member_delete_cbf(const struct rte_member_setsum *ss,
+		const void *key, member_set_t set_id)
+{
+	uint32_t j, h1, h2;
+
+	if (set_id > ss->num_set || set_id == RTE_MEMBER_NO_MATCH)
+		return -EINVAL;
+
+	get_hashes(ss, key, &h1, &h2);
+
+	/* Do not decrement any counter unless the key is in the set. */
+	if (!(test_key(h1, h2, ss) & (1U << (set_id - 1))))
+		return -ENOENT;
+
+	for (j = 0; j < ss->num_hashes; j++)
+		update_counter((h1 + j * h2) & ss->bit_mask, ss, set_id, 0);
+
+	return 0;
+}
+
+void
+rte_member_free_cbf(struct rte_member_setsum *ss)
+{
+	rte_free(ss->table);
+}
+
+void
+rte_member_reset_cbf(const struct rte_member_setsum *ss)
+{
+	memset(ss->table, 0, cbf_size(ss));
+}
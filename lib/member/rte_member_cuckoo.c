@@ -0,0 +1,479 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#include <string.h>
+
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+#include <rte_random.h>
+#include <rte_log.h>
+#include <rte_vect.h>
+
+#include "member.h"
+#include "rte_member.h"
+#include "rte_member_cuckoo.h"
+
+#if defined(RTE_ARCH_X86)
+#include "rte_member_cuckoo_x86.h"
+#endif
+
+/*
+ * Cuckoo filter as described in B. Fan, et al's paper "Cuckoo Filter:
+ * Practically Better Than Bloom". Unlike the HT setsummary, which keeps a
+ * 16-bit signature and a 16-bit set id per entry in 64-byte buckets, each
+ * entry is a single 16-bit word holding both the fingerprint and the set id,
+ * and a bucket of 4 entries is a single 64-bit word. This halves the memory
+ * per key compared to HT, at the cost of a fingerprint that gets shorter as
+ * the number of sets grows, hence a higher false positive rate.
+ *
+ * The alternative bucket of an entry is derived from its current bucket and
+ * its fingerprint only, so that entries can be moved and deleted without
+ * knowing the key.
+ */
+
+#define CUCKOO_ALT_HASH_MUL 0x5bd1e995
+
+/* Target table load when sizing the filter, in percent. */
+#define CUCKOO_LOAD_FACTOR 95
+
+int
+rte_member_create_cuckoo(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	struct member_cuckoo_filter *f;
+	uint32_t num_buckets;
+
+	if (params->num_set == 0 ||
+			params->num_set > RTE_MEMBER_MAX_CUCKOO_SET ||
+			params->num_keys == 0 ||
+			params->num_keys > RTE_MEMBER_ENTRIES_MAX) {
+		rte_errno = EINVAL;
+		MEMBER_LOG(ERR,
+			"Membership cuckoo filter create with invalid parameters");
+		return -EINVAL;
+	}
+
+	num_buckets = ((uint64_t)params->num_keys * 100 +
+			RTE_MEMBER_CUCKOO_BUCKET_ENTRIES * CUCKOO_LOAD_FACTOR - 1) /
+			(RTE_MEMBER_CUCKOO_BUCKET_ENTRIES * CUCKOO_LOAD_FACTOR);
+	num_buckets = RTE_MAX(rte_align32pow2(num_buckets), 2U);
+
+	f = rte_zmalloc_socket(NULL, sizeof(*f) +
+			num_buckets * sizeof(struct member_cuckoo_bucket),
+			RTE_CACHE_LINE_SIZE, ss->socket_id);
+	if (f == NULL) {
+		MEMBER_LOG(ERR, "memory allocation failed for cuckoo filter "
+						"setsummary");
+		return -ENOMEM;
+	}
+
+	f->set_bits = rte_ctz32(rte_align32pow2(params->num_set));
+	f->fp_bits = sizeof(member_cuckoo_entry_t) * 8 - f->set_bits;
+	f->set_mask = (1U << f->set_bits) - 1;
+	f->fp_mask = (member_cuckoo_entry_t)~f->set_mask;
+
+	ss->table = f;
+	ss->num_set = params->num_set;
+	ss->bucket_cnt = num_buckets;
+	ss->bucket_mask = num_buckets - 1;
+
+#if defined(RTE_ARCH_X86)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256)
+		ss->sig_cmp_fn = RTE_MEMBER_COMPARE_AVX2;
+	else
+#endif
+		ss->sig_cmp_fn = RTE_MEMBER_COMPARE_SCALAR;
+
+	MEMBER_LOG(DEBUG, "Cuckoo filter created, "
+			"the table has %u buckets, %u-bit fingerprints",
+			ss->bucket_cnt, f->fp_bits);
+	return 0;
+}
+
+static inline uint32_t
+alt_bucket_index(const struct rte_member_setsum *ss, uint32_t bkt,
+		uint32_t fp)
+{
+	return (bkt ^ (fp * CUCKOO_ALT_HASH_MUL)) & ss->bucket_mask;
+}
+
+/*
+ * Compute the primary and secondary bucket locations and the fingerprint of
+ * the key, shifted to its place in an entry (tag). Like the non-cache HT
+ * mode, the first hash value gives the fingerprint and the second hash value
+ * the primary bucket.
+ */
+static inline void
+get_buckets_index(const struct rte_member_setsum *ss,
+		const struct member_cuckoo_filter *f, const void *key,
+		uint32_t *prim_bkt, uint32_t *sec_bkt,
+		member_cuckoo_entry_t *tag)
+{
+	uint32_t first_hash = MEMBER_HASH_FUNC(key, ss->key_len,
+						ss->prim_hash_seed);
+	uint32_t sec_hash = MEMBER_HASH_FUNC(&first_hash, sizeof(uint32_t),
+						ss->sec_hash_seed);
+	uint32_t fp = first_hash >> (32 - f->fp_bits);
+
+	/* Zero marks an empty entry. */
+	if (fp == 0)
+		fp = 1;
+
+	*tag = fp << f->set_bits;
+	*prim_bkt = sec_hash & ss->bucket_mask;
+	*sec_bkt = alt_bucket_index(ss, *prim_bkt, fp);
+}
+
+/* Same hit mask layout as search_buckets_sse(). */
+static inline uint32_t
+search_buckets_scalar(const struct member_cuckoo_bucket *prim,
+		const struct member_cuckoo_bucket *sec,
+		member_cuckoo_entry_t fp_mask, member_cuckoo_entry_t tag)
+{
+	uint32_t i, hitmask = 0;
+
+	for (i = 0; i < RTE_MEMBER_CUCKOO_BUCKET_ENTRIES; i++) {
+		if ((prim->entries[i] & fp_mask) == tag)
+			hitmask |= 3U << (i << 1);
+		if ((sec->entries[i] & fp_mask) == tag)
+			hitmask |= 3U << ((i + RTE_MEMBER_CUCKOO_BUCKET_ENTRIES) << 1);
+	}
+	return hitmask;
+}
+
+static inline uint32_t
+search_buckets(const struct rte_member_setsum *ss,
+		const struct member_cuckoo_filter *f,
+		uint32_t prim, uint32_t sec, member_cuckoo_entry_t tag)
+{
+	switch (ss->sig_cmp_fn) {
+#if defined(RTE_ARCH_X86) && defined(__AVX2__)
+	case RTE_MEMBER_COMPARE_AVX2:
+		return search_buckets_sse(&f->buckets[prim], &f->buckets[sec],
+				f->fp_mask, tag);
+#endif
+	default:
+		return search_buckets_scalar(&f->buckets[prim], &f->buckets[sec],
+				f->fp_mask, tag);
+	}
+}
+
+/* Return the entry of the first hit in the mask, consuming the hit. */
+static inline member_cuckoo_entry_t
+next_hit(const struct member_cuckoo_filter *f, uint32_t prim, uint32_t sec,
+		uint32_t *hitmask)
+{
+	uint32_t hit_idx = rte_ctz32(*hitmask) >> 1;
+	uint32_t bkt = hit_idx < RTE_MEMBER_CUCKOO_BUCKET_ENTRIES ? prim : sec;
+
+	*hitmask &= ~(3U << (hit_idx << 1));
+	return f->buckets[bkt].entries[hit_idx &
+			(RTE_MEMBER_CUCKOO_BUCKET_ENTRIES - 1)];
+}
+
+static inline int
+victim_match(const struct member_cuckoo_filter *f, uint32_t prim, uint32_t sec,
+		member_cuckoo_entry_t tag)
+{
+	return f->victim_entry != 0 &&
+		(f->victim_bucket == prim || f->victim_bucket == sec) &&
+		(f->victim_entry & f->fp_mask) == tag;
+}
+
+static inline member_set_t
+entry_set(const struct member_cuckoo_filter *f, member_cuckoo_entry_t entry)
+{
+	return (entry & f->set_mask) + 1;
+}
+
+static inline int
+resolve_single(const struct member_cuckoo_filter *f, uint32_t prim,
+		uint32_t sec, member_cuckoo_entry_t tag, uint32_t hitmask,
+		member_set_t *set_id)
+{
+	if (hitmask) {
+		*set_id = entry_set(f, next_hit(f, prim, sec, &hitmask));
+		return 1;
+	}
+	if (victim_match(f, prim, sec, tag)) {
+		*set_id = entry_set(f, f->victim_entry);
+		return 1;
+	}
+	*set_id = RTE_MEMBER_NO_MATCH;
+	return 0;
+}
+
+static inline uint32_t
+resolve_multi(const struct member_cuckoo_filter *f, uint32_t prim,
+		uint32_t sec, member_cuckoo_entry_t tag, uint32_t hitmask,
+		uint32_t match_per_key, member_set_t *set_id)
+{
+	uint32_t counter = 0;
+
+	while (hitmask && counter < match_per_key)
+		set_id[counter++] = entry_set(f, next_hit(f, prim, sec,
+					&hitmask));
+
+	if (counter < match_per_key && victim_match(f, prim, sec, tag))
+		set_id[counter++] = entry_set(f, f->victim_entry);
+
+	return counter;
+}
+
+/*
+ * Compute the bucket locations of all the keys and prefetch the buckets, then
+ * compute the hit mask of each key, two keys at a time with AVX2.
+ */
+static inline void
+search_bulk(const struct rte_member_setsum *ss, const void **keys,
+		uint32_t num_keys, uint32_t *prim, uint32_t *sec,
+		member_cuckoo_entry_t *tag, uint32_t *hitmask)
+{
+	const struct member_cuckoo_filter *f = ss->table;
+	uint32_t i;
+
+	for (i = 0; i < num_keys; i++) {
+		get_buckets_index(ss, f, keys[i], &prim[i], &sec[i], &tag[i]);
+		rte_prefetch0(&f->buckets[prim[i]]);
+		rte_prefetch0(&f->buckets[sec[i]]);
+	}
+
+	i = 0;
+#if defined(RTE_ARCH_X86) && defined(__AVX2__)
+	if (ss->sig_cmp_fn == RTE_MEMBER_COMPARE_AVX2) {
+		for (; i + 1 < num_keys; i += 2) {
+			uint32_t m = search_buckets_x2_avx(
+				&f->buckets[prim[i]], &f->buckets[sec[i]],
+				&f->buckets[prim[i + 1]], &f->buckets[sec[i + 1]],
+				f->fp_mask, tag[i], tag[i + 1]);
+
+			hitmask[i] = m & 0xFFFF;
+			hitmask[i + 1] = m >> 16;
+		}
+	}
+#endif
+	for (; i < num_keys; i++)
+		hitmask[i] = search_buckets(ss, f, prim[i], sec[i], tag[i]);
+}
+
+int
+rte_member_lookup_cuckoo(const struct rte_member_setsum *ss,
+		const void *key, member_set_t *set_id)
+{
+	const struct member_cuckoo_filter *f = ss->table;
+	uint32_t prim, sec;
+	member_cuckoo_entry_t tag;
+
+	get_buckets_index(ss, f, key, &prim, &sec, &tag);
+	return resolve_single(f, prim, sec, tag,
+			search_buckets(ss, f, prim, sec, tag), set_id);
+}
+
+uint32_t
+rte_member_lookup_bulk_cuckoo(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, member_set_t *set_ids)
+{
+	const struct member_cuckoo_filter *f = ss->table;
+	uint32_t i;
+	uint32_t num_matches = 0;
+	uint32_t prim[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t sec[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t hitmask[RTE_MEMBER_LOOKUP_BULK_MAX];
+	member_cuckoo_entry_t tag[RTE_MEMBER_LOOKUP_BULK_MAX];
+
+	search_bulk(ss, keys, num_keys, prim, sec, tag, hitmask);
+
+	for (i = 0; i < num_keys; i++)
+		num_matches += resolve_single(f, prim[i], sec[i], tag[i],
+				hitmask[i], &set_ids[i]);
+
+	return num_matches;
+}
+
+uint32_t
+rte_member_lookup_multi_cuckoo(const struct rte_member_setsum *ss,
+		const void *key, uint32_t match_per_key,
+		member_set_t *set_id)
+{
+	const struct member_cuckoo_filter *f = ss->table;
+	uint32_t prim, sec;
+	member_cuckoo_entry_t tag;
+
+	get_buckets_index(ss, f, key, &prim, &sec, &tag);
+	return resolve_multi(f, prim, sec, tag,
+			search_buckets(ss, f, prim, sec, tag),
+			match_per_key, set_id);
+}
+
+uint32_t
+rte_member_lookup_multi_bulk_cuckoo(const struct rte_member_setsum *ss,
+		const void **keys, uint32_t num_keys, uint32_t match_per_key,
+		uint32_t *match_count,
+		member_set_t *set_ids)
+{
+	const struct member_cuckoo_filter *f = ss->table;
+	uint32_t i;
+	uint32_t num_matches = 0;
+	uint32_t prim[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t sec[RTE_MEMBER_LOOKUP_BULK_MAX];
+	uint32_t hitmask[RTE_MEMBER_LOOKUP_BULK_MAX];
+	member_cuckoo_entry_t tag[RTE_MEMBER_LOOKUP_BULK_MAX];
+
+	search_bulk(ss, keys, num_keys, prim, sec, tag, hitmask);
+
+	for (i = 0; i < num_keys; i++) {
+		match_count[i] = resolve_multi(f, prim[i], sec[i], tag[i],
+				hitmask[i], match_per_key,
+				&set_ids[i * match_per_key]);
+		if (match_count[i] != 0)
+			num_matches++;
+	}
+	return num_matches;
+}
+
+static inline int
+try_insert(struct member_cuckoo_filter *f, uint32_t bkt,
+		member_cuckoo_entry_t entry)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_MEMBER_CUCKOO_BUCKET_ENTRIES; i++) {
+		if (f->buckets[bkt].entries[i] == 0) {
+			f->buckets[bkt].entries[i] = entry;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Insert an entry in one of its two buckets, kicking random entries to their
+ * alternative bucket if both are full. Return 0 if no entry was moved and 1
+ * otherwise. If no room was found after the maximum number of kicks, the last
+ * kicked entry is kept as the victim and -ENOSPC is returned.
+ */
+static int
+cuckoo_insert(const struct rte_member_setsum *ss,
+		struct member_cuckoo_filter *f, uint32_t prim, uint32_t sec,
+		member_cuckoo_entry_t entry)
+{
+	uint32_t bkt, slot, i;
+	member_cuckoo_entry_t tmp;
+
+	if (try_insert(f, prim, entry) == 0 || try_insert(f, sec, entry) == 0)
+		return 0;
+
+	bkt = (rte_rand() & 1) ? sec : prim;
+	for (i = 0; i < RTE_MEMBER_CUCKOO_MAX_KICKS; i++) {
+		slot = rte_rand() & (RTE_MEMBER_CUCKOO_BUCKET_ENTRIES - 1);
+		tmp = f->buckets[bkt].entries[slot];
+		f->buckets[bkt].entries[slot] = entry;
+		entry = tmp;
+
+		bkt = alt_bucket_index(ss, bkt, entry >> f->set_bits);
+		if (try_insert(f, bkt, entry) == 0)
+			return 1;
+	}
+
+	f->victim_bucket = bkt;
+	f->victim_entry = entry;
+	return -ENOSPC;
+}
+
+int
+rte_member_add_cuckoo(const struct rte_member_setsum *ss,
+		const void *key, member_set_t set_id)
+{
+	struct member_cuckoo_filter *f = ss->table;
+	uint32_t prim, sec;
+	member_cuckoo_entry_t tag, entry;
+	int ret;
+
+	if (set_id > ss->num_set || set_id == RTE_MEMBER_NO_MATCH)
+		return -EINVAL;
+
+	/*
+	 * Place the victim of a previous insertion back in the table first,
+	 * deletions may have made room since. If there is still no room, the
+	 * last kicked entry becomes the victim and the key is refused, so that
+	 * no key is ever lost.
+	 */
+	if (f->victim_entry != 0) {
+		entry = f->victim_entry;
+		f->victim_entry = 0;
+		if (cuckoo_insert(ss, f, f->victim_bucket,
+				alt_bucket_index(ss, f->victim_bucket,
+					entry >> f->set_bits), entry) < 0)
+			return -ENOSPC;
+	}
+
+	get_buckets_index(ss, f, key, &prim, &sec, &tag);
+	ret = cuckoo_insert(ss, f, prim, sec, tag | (set_id - 1));
+
+	return ret < 0 ? RTE_MEMBER_ADD_VICTIM : ret;
+}
+
+int
+rte_member_delete_cuckoo(const struct rte_member_setsum *ss,
+		const void *key, member_set_t set_id)
+{
+	struct member_cuckoo_filter *f = ss->table;
+	uint32_t prim, sec, i, j;
+	uint32_t bkts[2];
+	member_cuckoo_entry_t tag, entry;
+
+	if (set_id > ss->num_set || set_id == RTE_MEMBER_NO_MATCH)
+		return -EINVAL;
+
+	get_buckets_index(ss, f, key, &prim, &sec, &tag);
+	entry = tag | (set_id - 1);
+	bkts[0] = prim;
+	bkts[1] = sec;
+
+	for (i = 0; i < RTE_DIM(bkts); i++) {
+		struct member_cuckoo_bucket *b = &f->buckets[bkts[i]];
+
+		for (j = 0; j < RTE_MEMBER_CUCKOO_BUCKET_ENTRIES; j++) {
+			if (b->entries[j] != entry)
+				continue;
+
+			b->entries[j] = 0;
+			/* Try to move the victim back into the table. */
+			if (f->victim_entry != 0 &&
+					(try_insert(f, f->victim_bucket,
+						f->victim_entry) == 0 ||
+					try_insert(f, alt_bucket_index(ss,
+						f->victim_bucket,
+						f->victim_entry >> f->set_bits),
+						f->victim_entry) == 0))
+				f->victim_entry = 0;
+			return 0;
+		}
+	}
+
+	if (f->victim_entry == entry &&
+			(f->victim_bucket == prim || f->victim_bucket == sec)) {
+		f->victim_entry = 0;
+		return 0;
+	}
+
+	return -ENOENT;
+}
+
+void
+rte_member_free_cuckoo(struct rte_member_setsum *ss)
+{
+	rte_free(ss->table);
+}
+
+void
+rte_member_reset_cuckoo(const struct rte_member_setsum *ss)
+{
+	struct member_cuckoo_filter *f = ss->table;
+
+	memset(f->buckets, 0, ss->bucket_cnt * sizeof(f->buckets[0]));
+	f->victim_entry = 0;
+}
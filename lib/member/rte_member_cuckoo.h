@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#ifndef _RTE_MEMBER_CUCKOO_H_
+#define _RTE_MEMBER_CUCKOO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of sets, the set id takes the low bits of an entry. */
+#define RTE_MEMBER_MAX_CUCKOO_SET 256
+
+/* Entry count per bucket in cuckoo filter mode. */
+#define RTE_MEMBER_CUCKOO_BUCKET_ENTRIES 4
+
+/* Maximum number of kicks before the insertion is stopped. */
+#define RTE_MEMBER_CUCKOO_MAX_KICKS 500
+
+/*
+ * Each entry packs a fingerprint (high bits, never zero) and the set id minus
+ * one (low bits), an entry with value zero is empty.
+ */
+typedef uint16_t member_cuckoo_entry_t;
+
+/* The bucket struct for cuckoo filter setsum, one 64-bit word. */
+struct __rte_aligned(8) member_cuckoo_bucket {
+	member_cuckoo_entry_t entries[RTE_MEMBER_CUCKOO_BUCKET_ENTRIES];
+};
+
+/* Cuckoo filter table, pointed to by the setsum table field. */
+struct member_cuckoo_filter {
+	uint32_t fp_bits;		/* Number of fingerprint bits. */
+	uint32_t set_bits;		/* Number of set id bits. */
+	member_cuckoo_entry_t fp_mask;	/* Entry mask of the fingerprint. */
+	member_cuckoo_entry_t set_mask;	/* Entry mask of the set id. */
+
+	/* Entry that could not be placed after the maximum number of kicks. */
+	uint32_t victim_bucket;
+	member_cuckoo_entry_t victim_entry;
+
+	struct member_cuckoo_bucket buckets[];
+};
+
+int
+rte_member_create_cuckoo(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params);
+
+int
+rte_member_lookup_cuckoo(const struct rte_member_setsum *setsum,
+		const void *key, member_set_t *set_id);
+
+uint32_t
+rte_member_lookup_bulk_cuckoo(const struct rte_member_setsum *setsum,
+		const void **keys, uint32_t num_keys,
+		member_set_t *set_ids);
+
+uint32_t
+rte_member_lookup_multi_cuckoo(const struct rte_member_setsum *setsum,
+		const void *key, uint32_t match_per_key,
+		member_set_t *set_id);
+
+uint32_t
+rte_member_lookup_multi_bulk_cuckoo(const struct rte_member_setsum *setsum,
+		const void **keys, uint32_t num_keys, uint32_t match_per_key,
+		uint32_t *match_count,
+		member_set_t *set_ids);
+
+int
+rte_member_add_cuckoo(const struct rte_member_setsum *setsum,
+		const void *key, member_set_t set_id);
+
+int
+rte_member_delete_cuckoo(const struct rte_member_setsum *setsum,
+		const void *key, member_set_t set_id);
+
+void
+rte_member_free_cuckoo(struct rte_member_setsum *setsum);
+
+void
+rte_member_reset_cuckoo(const struct rte_member_setsum *setsum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MEMBER_CUCKOO_H_ */
@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#ifndef _RTE_MEMBER_CUCKOO_X86_H_
+#define _RTE_MEMBER_CUCKOO_X86_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <x86intrin.h>
+
+#if defined(__AVX2__)
+
+/*
+ * Compare the fingerprint against the entries of both candidate buckets.
+ * Return a hit mask with 2 bits per entry, the primary bucket entries in
+ * bits 0-7 and the secondary bucket entries in bits 8-15.
+ */
+static inline uint32_t
+search_buckets_sse(const struct member_cuckoo_bucket *prim,
+		const struct member_cuckoo_bucket *sec,
+		member_cuckoo_entry_t fp_mask, member_cuckoo_entry_t tag)
+{
+	__m128i x = _mm_unpacklo_epi64(
+		_mm_loadl_epi64((__m128i const *)prim->entries),
+		_mm_loadl_epi64((__m128i const *)sec->entries));
+
+	x = _mm_and_si128(x, _mm_set1_epi16(fp_mask));
+	return _mm_movemask_epi8(_mm_cmpeq_epi16(x, _mm_set1_epi16(tag)));
+}
+
+/*
+ * Same as above for two keys at once, the hit mask of the first key is in
+ * the low 16 bits of the result and the hit mask of the second key in the
+ * high 16 bits.
+ */
+static inline uint32_t
+search_buckets_x2_avx(const struct member_cuckoo_bucket *prim0,
+		const struct member_cuckoo_bucket *sec0,
+		const struct member_cuckoo_bucket *prim1,
+		const struct member_cuckoo_bucket *sec1,
+		member_cuckoo_entry_t fp_mask,
+		member_cuckoo_entry_t tag0, member_cuckoo_entry_t tag1)
+{
+	__m128i lo = _mm_unpacklo_epi64(
+		_mm_loadl_epi64((__m128i const *)prim0->entries),
+		_mm_loadl_epi64((__m128i const *)sec0->entries));
+	__m128i hi = _mm_unpacklo_epi64(
+		_mm_loadl_epi64((__m128i const *)prim1->entries),
+		_mm_loadl_epi64((__m128i const *)sec1->entries));
+	__m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+	__m256i tags = _mm256_inserti128_si256(
+		_mm256_castsi128_si256(_mm_set1_epi16(tag0)),
+		_mm_set1_epi16(tag1), 1);
+
+	x = _mm256_and_si256(x, _mm256_set1_epi16(fp_mask));
+	return _mm256_movemask_epi8(_mm256_cmpeq_epi16(x, tags));
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MEMBER_CUCKOO_X86_H_ */
@@ -25,21 +25,16 @@
  *
  * Currently the implementation supports vBF containing 1,2,4,8,16,32 BFs.
  */
+
+/*
+ * Compute the number of bits and the number of hash values of each BF, given
+ * the expected number of keys and the false positive rate. Also used by the
+ * counting vBF, where each bit is replaced by a counter.
+ */
 int
-rte_member_create_vbf(struct rte_member_setsum *ss,
+rte_member_size_vbf(struct rte_member_setsum *ss,
 		const struct rte_member_parameters *params)
 {
-
-	if (params->num_set > RTE_MEMBER_MAX_BF ||
-			!rte_is_power_of_2(params->num_set) ||
-			params->num_keys == 0 ||
-			params->false_positive_rate == 0 ||
-			params->false_positive_rate > 1) {
-		rte_errno = EINVAL;
-		MEMBER_LOG(ERR, "Membership vBF create with invalid parameters");
-		return -EINVAL;
-	}
-
 	/* We assume expected keys evenly distribute to all BFs */
 	uint32_t num_keys_per_bf = 1 + (params->num_keys - 1) / ss->num_set;
 
@@ -112,12 +107,35 @@ rte_member_create_vbf(struct rte_member_setsum *ss,
 	ss->mul_shift = rte_ctz32(ss->num_set);
 	ss->div_shift = rte_ctz32(32 >> ss->mul_shift);
 
-	MEMBER_LOG(DEBUG, "vector bloom filter created, "
+	MEMBER_LOG(DEBUG, "vector bloom filter sized, "
 		"each bloom filter expects %u keys, needs %u bits, %u hashes, "
 		"with false positive rate set as %.5f, "
 		"The new calculated vBF false positive rate is %.5f",
 		num_keys_per_bf, ss->bits, ss->num_hashes, fp_one_bf, new_fp);
 
+	return 0;
+}
+
+int
+rte_member_create_vbf(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	int ret;
+
+	if (params->num_set > RTE_MEMBER_MAX_BF ||
+			!rte_is_power_of_2(params->num_set) ||
+			params->num_keys == 0 ||
+			params->false_positive_rate == 0 ||
+			params->false_positive_rate > 1) {
+		rte_errno = EINVAL;
+		MEMBER_LOG(ERR, "Membership vBF create with invalid parameters");
+		return -EINVAL;
+	}
+
+	ret = rte_member_size_vbf(ss, params);
+	if (ret < 0)
+		return ret;
+
 	ss->table = rte_zmalloc_socket(NULL, ss->num_set * (ss->bits >> 3),
 					RTE_CACHE_LINE_SIZE, ss->socket_id);
 	if (ss->table == NULL)
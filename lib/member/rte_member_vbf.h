@@ -12,6 +12,10 @@ extern "C" {
 /* Currently we only support up to 32 sets in vBF */
 #define RTE_MEMBER_MAX_BF 32
 
+int
+rte_member_size_vbf(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params);
+
 int
 rte_member_create_vbf(struct rte_member_setsum *ss,
 		const struct rte_member_parameters *params);
@@ -10,7 +10,9 @@
 #include <rte_string_fns.h>
 #include <rte_metrics.h>
 #include <rte_memzone.h>
+#include <rte_seqcount.h>
 #include <rte_spinlock.h>
+#include <rte_stdatomic.h>
 
 int metrics_initialized;
 
@@ -25,15 +27,38 @@ struct rte_metrics_meta_s {
 	/** Name of metric */
 	char name[RTE_METRICS_MAX_NAME_LEN];
 	/** Current value for metric */
-	uint64_t value[RTE_MAX_ETHPORTS];
+	RTE_ATOMIC(uint64_t) value[RTE_MAX_ETHPORTS];
 	/** Used for global metrics */
-	uint64_t global_value;
+	RTE_ATOMIC(uint64_t) global_value;
 	/** Index of next root element (zero for none) */
 	uint16_t idx_next_set;
 	/** Index of next metric in set (zero for none) */
 	uint16_t idx_next_stat;
+	/** Index of the first metric of the set */
+	uint16_t idx_set;
 };
 
+/**
+ * Internal update synchronization of a set of metrics of a port.
+ *
+ * @internal
+ * Metric values are written by the publishers without taking the
+ * global lock, but under the lock of the set and port they update,
+ * which also moves the sequence counter of that set and port around
+ * the writes. Readers check the sequence counter to get all the values
+ * of a set from the same update, and only retry the sets updated in
+ * the meantime.
+ */
+struct rte_metrics_set_sync_s {
+	/** Serializes the writers of the set */
+	rte_spinlock_t lock;
+	/** Sequence counter of the updates of the set */
+	rte_seqcount_t sc;
+};
+
+/* Index of the global metrics in the set synchronization array. */
+#define RTE_METRICS_SYNC_GLOBAL RTE_MAX_ETHPORTS
+
 /**
  * Internal stats info structure.
  *
@@ -48,18 +73,87 @@ struct rte_metrics_data_s {
 	 */
 	uint16_t idx_last_set;
 	/**   Number of metrics. */
-	uint16_t cnt_stats;
+	RTE_ATOMIC(uint16_t) cnt_stats;
 	/** Metric data memory block. */
 	struct rte_metrics_meta_s metadata[RTE_METRICS_MAX_METRICS];
-	/** Metric data access lock */
+	/** Metric registration lock */
 	rte_spinlock_t lock;
+	/** Update synchronization, per first metric of a set and per port,
+	 * the last one being for global metrics
+	 */
+	struct rte_metrics_set_sync_s
+		set_sync[RTE_METRICS_MAX_METRICS][RTE_METRICS_SYNC_GLOBAL + 1];
 };
 
+/* Metrics shared memory, cached to keep the memzone lookup
+ * out of the update path.
+ */
+static struct rte_metrics_data_s *metrics_data;
+
+static struct rte_metrics_data_s *
+metrics_data_get(void)
+{
+	const struct rte_memzone *memzone;
+
+	if (likely(metrics_data != NULL))
+		return metrics_data;
+
+	memzone = rte_memzone_lookup(RTE_METRICS_MEMZONE_NAME);
+	if (memzone == NULL)
+		return NULL;
+	metrics_data = memzone->addr;
+
+	return metrics_data;
+}
+
+/* Copy the values of the first 'count' metrics, each set of metrics
+ * being read as a snapshot consistent with its updates.
+ */
+static void
+metrics_read(struct rte_metrics_data_s *stats, int port_id,
+	struct rte_metric_value *values, uint16_t count)
+{
+	unsigned int sync_id;
+	struct rte_metrics_meta_s *entry;
+	rte_seqcount_t *sc;
+	uint16_t idx_set, i;
+	uint32_t sn;
+
+	sync_id = port_id == RTE_METRICS_GLOBAL ?
+		RTE_METRICS_SYNC_GLOBAL : (unsigned int)port_id;
+
+	for (idx_set = 0; idx_set < count; idx_set = i + 1) {
+		sc = &stats->set_sync[idx_set][sync_id].sc;
+
+		do {
+			sn = rte_seqcount_read_begin(sc);
+
+			for (i = idx_set; ; i++) {
+				entry = &stats->metadata[i];
+				values[i].key = i;
+				if (port_id == RTE_METRICS_GLOBAL)
+					values[i].value = rte_atomic_load_explicit(
+						&entry->global_value,
+						rte_memory_order_relaxed);
+				else
+					values[i].value = rte_atomic_load_explicit(
+						&entry->value[port_id],
+						rte_memory_order_relaxed);
+
+				/* Last metric of the set */
+				if (entry->idx_next_stat == 0 || i + 1 >= count)
+					break;
+			}
+		} while (rte_seqcount_read_retry(sc, sn));
+	}
+}
+
 int
 rte_metrics_init(int socket_id)
 {
 	struct rte_metrics_data_s *stats;
 	const struct rte_memzone *memzone;
+	unsigned int i, j;
 
 	if (metrics_initialized)
 		return 0;
@@ -76,6 +170,12 @@ rte_metrics_init(int socket_id)
 	stats = memzone->addr;
 	memset(stats, 0, sizeof(struct rte_metrics_data_s));
 	rte_spinlock_init(&stats->lock);
+	for (i = 0; i < RTE_METRICS_MAX_METRICS; i++)
+		for (j = 0; j < RTE_METRICS_SYNC_GLOBAL + 1; j++) {
+			rte_spinlock_init(&stats->set_sync[i][j].lock);
+			rte_seqcount_init(&stats->set_sync[i][j].sc);
+		}
+	metrics_data = stats;
 	metrics_initialized = 1;
 	return 0;
 }
@@ -98,8 +198,10 @@ rte_metrics_deinit(void)
 	memset(stats, 0, sizeof(struct rte_metrics_data_s));
 
 	ret = rte_memzone_free(memzone);
-	if (ret == 0)
+	if (ret == 0) {
+		metrics_data = NULL;
 		metrics_initialized = 0;
+	}
 	return ret;
 }
 
@@ -116,7 +218,7 @@ rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
 {
 	struct rte_metrics_meta_s *entry = NULL;
 	struct rte_metrics_data_s *stats;
-	const struct rte_memzone *memzone;
+	uint16_t cnt_stats;
 	uint16_t idx_name;
 	uint16_t idx_base;
 
@@ -127,30 +229,36 @@ rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
 		if (names[idx_name] == NULL)
 			return -EINVAL;
 
-	memzone = rte_memzone_lookup(RTE_METRICS_MEMZONE_NAME);
-	if (memzone == NULL)
+	stats = metrics_data_get();
+	if (stats == NULL)
 		return -EIO;
-	stats = memzone->addr;
-
-	if (stats->cnt_stats + cnt_names >= RTE_METRICS_MAX_METRICS)
-		return -ENOMEM;
 
 	rte_spinlock_lock(&stats->lock);
 
+	cnt_stats = stats->cnt_stats;
+	if (cnt_stats + cnt_names >= RTE_METRICS_MAX_METRICS) {
+		rte_spinlock_unlock(&stats->lock);
+		return -ENOMEM;
+	}
+
 	/* Overwritten later if this is actually first set.. */
-	stats->metadata[stats->idx_last_set].idx_next_set = stats->cnt_stats;
+	stats->metadata[stats->idx_last_set].idx_next_set = cnt_stats;
 
-	stats->idx_last_set = idx_base = stats->cnt_stats;
+	stats->idx_last_set = idx_base = cnt_stats;
 
 	for (idx_name = 0; idx_name < cnt_names; idx_name++) {
-		entry = &stats->metadata[idx_name + stats->cnt_stats];
+		entry = &stats->metadata[idx_name + cnt_stats];
 		strlcpy(entry->name, names[idx_name], RTE_METRICS_MAX_NAME_LEN);
 		memset(entry->value, 0, sizeof(entry->value));
-		entry->idx_next_stat = idx_name + stats->cnt_stats + 1;
+		entry->idx_next_stat = idx_name + cnt_stats + 1;
+		entry->idx_set = idx_base;
 	}
 	entry->idx_next_stat = 0;
 	entry->idx_next_set = 0;
-	stats->cnt_stats += cnt_names;
+
+	/* Publish the new metrics to the updates and reads */
+	rte_atomic_store_explicit(&stats->cnt_stats, cnt_stats + cnt_names,
+		rte_memory_order_release);
 
 	rte_spinlock_unlock(&stats->lock);
 
@@ -171,10 +279,11 @@ rte_metrics_update_values(int port_id,
 {
 	struct rte_metrics_meta_s *entry;
 	struct rte_metrics_data_s *stats;
-	const struct rte_memzone *memzone;
+	struct rte_metrics_set_sync_s *sync;
 	uint16_t idx_metric;
 	uint16_t idx_value;
 	uint16_t cnt_setsize;
+	uint16_t cnt_stats;
 
 	if (port_id != RTE_METRICS_GLOBAL &&
 			(port_id < 0 || port_id >= RTE_MAX_ETHPORTS))
@@ -183,20 +292,17 @@ rte_metrics_update_values(int port_id,
 	if (values == NULL)
 		return -EINVAL;
 
-	memzone = rte_memzone_lookup(RTE_METRICS_MEMZONE_NAME);
-	if (memzone == NULL)
+	stats = metrics_data_get();
+	if (stats == NULL)
 		return -EIO;
-	stats = memzone->addr;
-
-	rte_spinlock_lock(&stats->lock);
 
-	if (key >= stats->cnt_stats) {
-		rte_spinlock_unlock(&stats->lock);
+	cnt_stats = rte_atomic_load_explicit(&stats->cnt_stats,
+			rte_memory_order_acquire);
+	if (key >= cnt_stats)
 		return -EINVAL;
-	}
 	idx_metric = key;
 	cnt_setsize = 1;
-	while (idx_metric < stats->cnt_stats) {
+	while (idx_metric < cnt_stats) {
 		entry = &stats->metadata[idx_metric];
 		if (entry->idx_next_stat == 0)
 			break;
@@ -204,24 +310,32 @@ rte_metrics_update_values(int port_id,
 		idx_metric++;
 	}
 	/* Check update does not cross set border */
-	if (count > cnt_setsize) {
-		rte_spinlock_unlock(&stats->lock);
+	if (count > cnt_setsize)
 		return -ERANGE;
-	}
+
+	sync = &stats->set_sync[stats->metadata[key].idx_set]
+		[port_id == RTE_METRICS_GLOBAL ? RTE_METRICS_SYNC_GLOBAL : port_id];
+
+	rte_spinlock_lock(&sync->lock);
+	rte_seqcount_write_begin(&sync->sc);
 
 	if (port_id == RTE_METRICS_GLOBAL)
 		for (idx_value = 0; idx_value < count; idx_value++) {
 			idx_metric = key + idx_value;
-			stats->metadata[idx_metric].global_value =
-				values[idx_value];
+			rte_atomic_store_explicit(
+				&stats->metadata[idx_metric].global_value,
+				values[idx_value], rte_memory_order_relaxed);
 		}
 	else
 		for (idx_value = 0; idx_value < count; idx_value++) {
 			idx_metric = key + idx_value;
-			stats->metadata[idx_metric].value[port_id] =
-				values[idx_value];
+			rte_atomic_store_explicit(
+				&stats->metadata[idx_metric].value[port_id],
+				values[idx_value], rte_memory_order_relaxed);
 		}
-	rte_spinlock_unlock(&stats->lock);
+
+	rte_seqcount_write_end(&sync->sc);
+	rte_spinlock_unlock(&sync->lock);
 	return 0;
 }
 
@@ -230,15 +344,13 @@ rte_metrics_get_names(struct rte_metric_name *names,
 	uint16_t capacity)
 {
 	struct rte_metrics_data_s *stats;
-	const struct rte_memzone *memzone;
 	uint16_t idx_name;
 	int return_value;
 
-	memzone = rte_memzone_lookup(RTE_METRICS_MEMZONE_NAME);
-	if (memzone == NULL)
+	stats = metrics_data_get();
+	if (stats == NULL)
 		return -EIO;
 
-	stats = memzone->addr;
 	rte_spinlock_lock(&stats->lock);
 	if (names != NULL) {
 		if (capacity < stats->cnt_stats) {
@@ -261,47 +373,23 @@ rte_metrics_get_values(int port_id,
 	struct rte_metric_value *values,
 	uint16_t capacity)
 {
-	struct rte_metrics_meta_s *entry;
 	struct rte_metrics_data_s *stats;
-	const struct rte_memzone *memzone;
-	uint16_t idx_name;
-	int return_value;
+	uint16_t cnt_stats;
 
 	if (port_id != RTE_METRICS_GLOBAL &&
 			(port_id < 0 || port_id >= RTE_MAX_ETHPORTS))
 		return -EINVAL;
 
-	memzone = rte_memzone_lookup(RTE_METRICS_MEMZONE_NAME);
-	if (memzone == NULL)
+	stats = metrics_data_get();
+	if (stats == NULL)
 		return -EIO;
 
-	stats = memzone->addr;
-	rte_spinlock_lock(&stats->lock);
-
+	cnt_stats = rte_atomic_load_explicit(&stats->cnt_stats,
+			rte_memory_order_acquire);
 	if (values != NULL) {
-		if (capacity < stats->cnt_stats) {
-			return_value = stats->cnt_stats;
-			rte_spinlock_unlock(&stats->lock);
-			return return_value;
-		}
-		if (port_id == RTE_METRICS_GLOBAL)
-			for (idx_name = 0;
-					idx_name < stats->cnt_stats;
-					idx_name++) {
-				entry = &stats->metadata[idx_name];
-				values[idx_name].key = idx_name;
-				values[idx_name].value = entry->global_value;
-			}
-		else
-			for (idx_name = 0;
-					idx_name < stats->cnt_stats;
-					idx_name++) {
-				entry = &stats->metadata[idx_name];
-				values[idx_name].key = idx_name;
-				values[idx_name].value = entry->value[port_id];
-			}
+		if (capacity < cnt_stats)
+			return cnt_stats;
+		metrics_read(stats, port_id, values, cnt_stats);
 	}
-	return_value = stats->cnt_stats;
-	rte_spinlock_unlock(&stats->lock);
-	return return_value;
+	return cnt_stats;
 }
@@ -215,6 +215,9 @@ int rte_metrics_update_value(
  * Updates a metric set. Note that it is an error to try to
  * update across a set boundary.
  *
+ * The update only takes the lock of the set and port, not the global
+ * metrics lock. Readers get all the values of the set from the same update.
+ *
  * @param port_id
  *   Port to update metrics for
  * @param key
@@ -6,7 +6,6 @@
 #include <string.h>
 #include <stdio.h>
 #include <sys/queue.h>
-#include <unistd.h>
 
 #include <rte_common.h>
 #include <rte_byteorder.h>
@@ -149,6 +148,11 @@ struct rte_swx_ctl_pipeline {
 	struct rte_swx_table_state *ts;
 	struct rte_swx_table_state *ts_next;
 	int numa_node;
+
+	/* Set when the data plane switched to the new table state, but the previous table state
+	 * could not be brought in sync with it yet.
+	 */
+	int commit_pending;
 };
 
 static struct action *
@@ -1559,6 +1563,7 @@ rte_swx_ctl_pipeline_table_entry_add(struct rte_swx_ctl_pipeline *ctl,
 	uint32_t table_id;
 
 	CHECK(ctl, EINVAL);
+	CHECK(!ctl->commit_pending, EBUSY);
 	CHECK(table_name && table_name[0], EINVAL);
 
 	table = table_find(ctl, table_name);
@@ -1673,6 +1678,7 @@ rte_swx_ctl_pipeline_table_entry_delete(struct rte_swx_ctl_pipeline *ctl,
 	uint32_t table_id;
 
 	CHECK(ctl, EINVAL);
+	CHECK(!ctl->commit_pending, EBUSY);
 
 	CHECK(table_name && table_name[0], EINVAL);
 	table = table_find(ctl, table_name);
@@ -1763,6 +1769,7 @@ rte_swx_ctl_pipeline_table_default_entry_add(struct rte_swx_ctl_pipeline *ctl,
 	uint32_t table_id;
 
 	CHECK(ctl, EINVAL);
+	CHECK(!ctl->commit_pending, EBUSY);
 
 	CHECK(table_name && table_name[0], EINVAL);
 	table = table_find(ctl, table_name);
@@ -2102,6 +2109,9 @@ rte_swx_ctl_pipeline_selector_group_add(struct rte_swx_ctl_pipeline *ctl,
 	if (!ctl || !selector_name || !selector_name[0] || !group_id)
 		return -EINVAL;
 
+	if (ctl->commit_pending)
+		return -EBUSY;
+
 	s = selector_find(ctl, selector_name);
 	if (!s)
 		return -EINVAL;
@@ -2129,6 +2139,9 @@ rte_swx_ctl_pipeline_selector_group_delete(struct rte_swx_ctl_pipeline *ctl,
 	if (!ctl || !selector_name || !selector_name[0])
 		return -EINVAL;
 
+	if (ctl->commit_pending)
+		return -EBUSY;
+
 	s = selector_find(ctl, selector_name);
 	if (!s ||
 	   (group_id >= s->info.n_groups_max) ||
@@ -2189,6 +2202,9 @@ rte_swx_ctl_pipeline_selector_group_member_add(struct rte_swx_ctl_pipeline *ctl,
 	if (!ctl || !selector_name || !selector_name[0])
 		return -EINVAL;
 
+	if (ctl->commit_pending)
+		return -EBUSY;
+
 	s = selector_find(ctl, selector_name);
 	if (!s ||
 	   (group_id >= s->info.n_groups_max) ||
@@ -2241,6 +2257,9 @@ rte_swx_ctl_pipeline_selector_group_member_delete(struct rte_swx_ctl_pipeline *c
 	if (!ctl || !selector_name || !selector_name[0])
 		return -EINVAL;
 
+	if (ctl->commit_pending)
+		return -EBUSY;
+
 	s = selector_find(ctl, selector_name);
 	if (!s ||
 	    (group_id >= s->info.n_groups_max) ||
@@ -2490,6 +2509,7 @@ rte_swx_ctl_pipeline_learner_default_entry_add(struct rte_swx_ctl_pipeline *ctl,
 	uint32_t learner_id;
 
 	CHECK(ctl, EINVAL);
+	CHECK(!ctl->commit_pending, EBUSY);
 
 	CHECK(learner_name && learner_name[0], EINVAL);
 	l = learner_find(ctl, learner_name);
@@ -2553,6 +2573,46 @@ learner_abort(struct rte_swx_ctl_pipeline *ctl, uint32_t learner_id)
 	learner_pending_default_free(l);
 }
 
+/* Complete the pending commit, if any: once no pipeline thread uses the previous table state any
+ * more, bring it in sync with the current table state, so that it can become the next one.
+ */
+static int
+commit_complete(struct rte_swx_ctl_pipeline *ctl)
+{
+	uint32_t i;
+
+	if (!ctl->commit_pending)
+		return 0;
+
+	if (rte_swx_pipeline_table_state_sync(ctl->p))
+		return -EBUSY;
+
+	ctl->commit_pending = 0;
+
+	/* Operate the changes on the current ts_next, which is the previous ts, in order to get
+	 * the current ts_next in sync with the current ts. Since the changes that can fail did
+	 * not fail on the previous ts_next, it is guaranteed that they will not fail on the
+	 * current ts_next, hence no error checking is needed.
+	 */
+	for (i = 0; i < ctl->info.n_tables; i++) {
+		table_rollfwd0(ctl, i, 1);
+		table_rollfwd1(ctl, i);
+		table_rollfwd2(ctl, i);
+	}
+
+	for (i = 0; i < ctl->info.n_selectors; i++) {
+		selector_rollfwd(ctl, i);
+		selector_rollfwd_finalize(ctl, i);
+	}
+
+	for (i = 0; i < ctl->info.n_learners; i++) {
+		learner_rollfwd(ctl, i);
+		learner_rollfwd_finalize(ctl, i);
+	}
+
+	return 0;
+}
+
 int
 rte_swx_ctl_pipeline_commit(struct rte_swx_ctl_pipeline *ctl, int abort_on_fail)
 {
@@ -2562,6 +2622,11 @@ rte_swx_ctl_pipeline_commit(struct rte_swx_ctl_pipeline *ctl, int abort_on_fail)
 
 	CHECK(ctl, EINVAL);
 
+	/* The previous commit has to be completed first. */
+	status = commit_complete(ctl);
+	if (status)
+		return status;
+
 	/* Operate the changes on the current ts_next before it becomes the new ts. First, operate
 	 * all the changes that can fail; if no failure, then operate the changes that cannot fail.
 	 * We must be able to fully revert all the changes that can fail as if they never happened.
@@ -2587,37 +2652,19 @@ rte_swx_ctl_pipeline_commit(struct rte_swx_ctl_pipeline *ctl, int abort_on_fail)
 	for (i = 0; i < ctl->info.n_learners; i++)
 		learner_rollfwd(ctl, i);
 
-	/* Swap the table state for the data plane. The current ts and ts_next
-	 * become the new ts_next and ts, respectively.
+	/* Swap the table state for the data plane. The current ts and ts_next become the new
+	 * ts_next and ts, respectively. The previous ts can only be modified once no pipeline
+	 * thread uses it any more; when the pipeline threads do not get in sync in time (e.g.
+	 * because they are not running), the commit stays pending and is completed by the next
+	 * commit or abort operation.
 	 */
 	rte_swx_pipeline_table_state_set(ctl->p, ctl->ts_next);
-	usleep(100);
 	ts = ctl->ts;
 	ctl->ts = ctl->ts_next;
 	ctl->ts_next = ts;
+	ctl->commit_pending = 1;
 
-	/* Operate the changes on the current ts_next, which is the previous ts, in order to get
-	 * the current ts_next in sync with the current ts. Since the changes that can fail did
-	 * not fail on the previous ts_next, it is guaranteed that they will not fail on the
-	 * current ts_next, hence no error checking is needed.
-	 */
-	for (i = 0; i < ctl->info.n_tables; i++) {
-		table_rollfwd0(ctl, i, 1);
-		table_rollfwd1(ctl, i);
-		table_rollfwd2(ctl, i);
-	}
-
-	for (i = 0; i < ctl->info.n_selectors; i++) {
-		selector_rollfwd(ctl, i);
-		selector_rollfwd_finalize(ctl, i);
-	}
-
-	for (i = 0; i < ctl->info.n_learners; i++) {
-		learner_rollfwd(ctl, i);
-		learner_rollfwd_finalize(ctl, i);
-	}
-
-	return 0;
+	return commit_complete(ctl);
 
 rollback:
 	for (i = 0; i < ctl->info.n_tables; i++) {
@@ -2647,6 +2694,10 @@ rte_swx_ctl_pipeline_abort(struct rte_swx_ctl_pipeline *ctl)
 	if (!ctl)
 		return;
 
+	/* The pending changes of a pending commit can no longer be aborted. */
+	if (commit_complete(ctl))
+		return;
+
 	for (i = 0; i < ctl->info.n_tables; i++)
 		table_abort(ctl, i);
 
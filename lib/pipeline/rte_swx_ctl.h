@@ -814,6 +814,29 @@ int
 rte_swx_pipeline_table_state_set(struct rte_swx_pipeline *p,
 				 struct rte_swx_table_state *table_state);
 
+/**
+ * Pipeline table state synchronize
+ *
+ * Wait until all the threads of the pipeline and of all its workers use the current table state,
+ * i.e. the one set by the latest invocation of function *rte_swx_pipeline_table_state_set*. After
+ * successful execution, the previous table state is no longer referenced by the data plane, so it
+ * can be safely modified or freed by the caller. A pipeline thread picks up the current table
+ * state on every input port poll, so this function times out when the pipeline or any of its
+ * workers stopped running after their first run. A pipeline or worker that never ran does not
+ * hold any table state, so it is always in sync. The timeout is measured
+ * against the TSC and is set by RTE_SWX_PIPELINE_TABLE_STATE_SYNC_TIMEOUT_US (10 ms).
+ *
+ * @param[in] p
+ *   Pipeline handle.
+ * @return
+ *   0 on success or the following error codes otherwise:
+ *   -EINVAL: Invalid argument;
+ *   -ETIMEDOUT: Some pipeline threads still use the previous table state.
+ */
+__rte_experimental
+int
+rte_swx_pipeline_table_state_sync(struct rte_swx_pipeline *p);
+
 /*
  * High Level Reference Table Update API.
  */
@@ -859,7 +882,8 @@ rte_swx_ctl_pipeline_create(struct rte_swx_pipeline *p);
  *   Entry to be added to the table.
  * @return
  *   0 on success or the following error codes otherwise:
- *   -EINVAL: Invalid argument.
+ *   -EINVAL: Invalid argument;
+ *   -EBUSY: The previous commit is still pending.
  */
 __rte_experimental
 int
@@ -881,7 +905,8 @@ rte_swx_ctl_pipeline_table_entry_add(struct rte_swx_ctl_pipeline *ctl,
  *   ignored.
  * @return
  *   0 on success or the following error codes otherwise:
- *   -EINVAL: Invalid argument.
+ *   -EINVAL: Invalid argument;
+ *   -EBUSY: The previous commit is still pending.
  */
 __rte_experimental
 int
@@ -904,7 +929,8 @@ rte_swx_ctl_pipeline_table_default_entry_add(struct rte_swx_ctl_pipeline *ctl,
  *   fields are ignored.
  * @return
  *   0 on success or the following error codes otherwise:
- *   -EINVAL: Invalid argument.
+ *   -EINVAL: Invalid argument;
+ *   -EBUSY: The previous commit is still pending.
  */
 __rte_experimental
 int
@@ -929,7 +955,8 @@ rte_swx_ctl_pipeline_table_entry_delete(struct rte_swx_ctl_pipeline *ctl,
  * @return
  *   0 on success or the following error codes otherwise:
  *   -EINVAL: Invalid argument;
- *   -ENOSPC: All groups are currently in use, no group available.
+ *   -ENOSPC: All groups are currently in use, no group available;
+ *   -EBUSY: The previous commit is still pending.
  */
 __rte_experimental
 int
@@ -952,7 +979,8 @@ rte_swx_ctl_pipeline_selector_group_add(struct rte_swx_ctl_pipeline *ctl,
  * @return
  *   0 on success or the following error codes otherwise:
  *   -EINVAL: Invalid argument;
- *   -ENOMEM: Not enough memory.
+ *   -ENOMEM: Not enough memory;
+ *   -EBUSY: The previous commit is still pending.
  */
 __rte_experimental
 int
@@ -982,7 +1010,8 @@ rte_swx_ctl_pipeline_selector_group_delete(struct rte_swx_ctl_pipeline *ctl,
  *   0 on success or the following error codes otherwise:
  *   -EINVAL: Invalid argument;
  *   -ENOMEM: Not enough memory;
- *   -ENOSPC: The group is full.
+ *   -ENOSPC: The group is full;
+ *   -EBUSY: The previous commit is still pending.
  */
 __rte_experimental
 int
@@ -1008,7 +1037,8 @@ rte_swx_ctl_pipeline_selector_group_member_add(struct rte_swx_ctl_pipeline *ctl,
  *   The member to be added to the group. Must be valid.
  * @return
  *   0 on success or the following error codes otherwise:
- *   -EINVAL: Invalid argument.
+ *   -EINVAL: Invalid argument;
+ *   -EBUSY: The previous commit is still pending.
  */
 __rte_experimental
 int
@@ -1030,7 +1060,8 @@ rte_swx_ctl_pipeline_selector_group_member_delete(struct rte_swx_ctl_pipeline *c
  *   The new table default entry. The *key* and *key_mask* entry fields are ignored.
  * @return
  *   0 on success or the following error codes otherwise:
- *   -EINVAL: Invalid argument.
+ *   -EINVAL: Invalid argument;
+ *   -EBUSY: The previous commit is still pending.
  */
 __rte_experimental
 int
@@ -1043,6 +1074,15 @@ rte_swx_ctl_pipeline_learner_default_entry_add(struct rte_swx_ctl_pipeline *ctl,
  *
  * Perform all the scheduled table work.
  *
+ * Once the new table state is handed over to the data plane, this function waits for all the
+ * threads of the pipeline and of its workers to use it, see function
+ * *rte_swx_pipeline_table_state_sync*, before bringing the previous table state up to date. When
+ * this wait times out, e.g. because the pipeline or some of its workers were stopped, -EBUSY is
+ * returned: the new table state is already in use by the data plane, but the commit is still
+ * pending and all the table update functions return -EBUSY until the commit is completed by a
+ * later invocation of this function or of function *rte_swx_ctl_pipeline_abort*, which has to be
+ * done once the pipeline and its workers run again.
+ *
  * @param[in] ctl
  *   Pipeline control handle.
  * @param[in] abort_on_fail
@@ -1051,7 +1091,8 @@ rte_swx_ctl_pipeline_learner_default_entry_add(struct rte_swx_ctl_pipeline *ctl,
  *   commit.
  * @return
  *   0 on success or the following error codes otherwise:
- *   -EINVAL: Invalid argument.
+ *   -EINVAL: Invalid argument;
+ *   -EBUSY: The new table state is in use by the data plane, but the commit is still pending.
  */
 __rte_experimental
 int
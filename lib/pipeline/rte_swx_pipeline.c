@@ -8,6 +8,8 @@
 
 #include <rte_tailq.h>
 #include <rte_eal_memconfig.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
 #include <rte_jhash.h>
 #include <rte_hash_crc.h>
 
@@ -306,6 +308,7 @@ rte_swx_pipeline_port_in_config(struct rte_swx_pipeline *p,
 	void *obj = NULL;
 
 	CHECK(p, EINVAL);
+	CHECK(!p->build_done, EEXIST);
 
 	CHECK(!port_in_find(p, port_id), EINVAL);
 
@@ -313,6 +316,13 @@ rte_swx_pipeline_port_in_config(struct rte_swx_pipeline *p,
 	type = port_in_type_find(p, port_type_name);
 	CHECK(type, EINVAL);
 
+	/* Worker: the port must be of the same type as the parent pipeline port. */
+	if (p->parent) {
+		port = port_in_find(p->parent, port_id);
+		CHECK(port && (port->type == type), EINVAL);
+		port = NULL;
+	}
+
 	obj = type->ops.create(args);
 	CHECK(obj, ENODEV);
 
@@ -352,6 +362,7 @@ port_in_build(struct rte_swx_pipeline *p)
 
 		in->pkt_rx = port->type->ops.pkt_rx;
 		in->obj = port->obj;
+		in->id = port->id;
 	}
 
 	return 0;
@@ -469,6 +480,7 @@ rte_swx_pipeline_port_out_config(struct rte_swx_pipeline *p,
 	void *obj = NULL;
 
 	CHECK(p, EINVAL);
+	CHECK(!p->build_done, EEXIST);
 
 	CHECK(!port_out_find(p, port_id), EINVAL);
 
@@ -476,6 +488,13 @@ rte_swx_pipeline_port_out_config(struct rte_swx_pipeline *p,
 	type = port_out_type_find(p, port_type_name);
 	CHECK(type, EINVAL);
 
+	/* Worker: the port must be of the same type as the parent pipeline port. */
+	if (p->parent) {
+		port = port_out_find(p->parent, port_id);
+		CHECK(port && (port->type == type), EINVAL);
+		port = NULL;
+	}
+
 	obj = type->ops.create(args);
 	CHECK(obj, ENODEV);
 
@@ -584,7 +603,7 @@ rte_swx_pipeline_mirroring_config(struct rte_swx_pipeline *p,
 }
 
 static void
-mirroring_build_free(struct rte_swx_pipeline *p)
+mirroring_slots_build_free(struct rte_swx_pipeline *p)
 {
 	uint32_t i;
 
@@ -595,6 +614,12 @@ mirroring_build_free(struct rte_swx_pipeline *p)
 		free(t->mirroring_slots);
 		t->mirroring_slots = NULL;
 	}
+}
+
+static void
+mirroring_build_free(struct rte_swx_pipeline *p)
+{
+	mirroring_slots_build_free(p);
 
 	/* mirroring_sessions. */
 	free(p->mirroring_sessions);
@@ -608,7 +633,7 @@ mirroring_free(struct rte_swx_pipeline *p)
 }
 
 static int
-mirroring_build(struct rte_swx_pipeline *p)
+mirroring_slots_build(struct rte_swx_pipeline *p)
 {
 	uint32_t i;
 
@@ -617,10 +642,21 @@ mirroring_build(struct rte_swx_pipeline *p)
 
 		/* mirroring_slots. */
 		t->mirroring_slots = calloc(p->n_mirroring_slots, sizeof(uint32_t));
-		if (!t->mirroring_slots)
-			goto error;
+		if (!t->mirroring_slots) {
+			mirroring_slots_build_free(p);
+			return -ENOMEM;
+		}
 	}
 
+	return 0;
+}
+
+static int
+mirroring_build(struct rte_swx_pipeline *p)
+{
+	if (mirroring_slots_build(p))
+		goto error;
+
 	/* mirroring_sessions. */
 	p->mirroring_sessions = calloc(p->n_mirroring_sessions, sizeof(struct mirroring_session));
 	if (!p->mirroring_sessions)
@@ -9657,6 +9693,12 @@ learner_params_get(struct learner *l)
 
 	params->n_key_timeouts = l->n_timeouts;
 
+	/* Concurrent mode: the learner table is shared with the pipeline workers. It is only
+	 * supported up to a maximum action data size, see rte_swx_pipeline_worker_create().
+	 */
+	params->concurrent = params->action_data_size <=
+		RTE_SWX_TABLE_LEARNER_CONCURRENT_ACTION_DATA_SIZE_MAX;
+
 	return params;
 
 error:
@@ -10303,6 +10345,212 @@ pipeline_unregister(struct rte_swx_pipeline *p)
 	rte_mcfg_tailq_write_unlock();
 }
 
+/*
+ * Worker.
+ */
+static void
+worker_free(struct rte_swx_pipeline *w)
+{
+	struct rte_swx_pipeline *p = w->parent;
+
+	TAILQ_REMOVE(&p->workers, w, worker_node);
+
+	learner_build_free(w);
+	selector_build_free(w);
+	table_build_free(w);
+	metadata_build_free(w);
+	header_build_free(w);
+	extern_func_build_free(w);
+	extern_obj_build_free(w);
+	mirroring_slots_build_free(w);
+	struct_build_free(w);
+
+	/* Output ports. */
+	port_out_build_free(w);
+
+	for ( ; ; ) {
+		struct port_out *port;
+
+		port = TAILQ_FIRST(&w->ports_out);
+		if (!port)
+			break;
+
+		TAILQ_REMOVE(&w->ports_out, port, node);
+		port->type->ops.free(port->obj);
+		free(port);
+	}
+
+	/* Input ports. */
+	port_in_build_free(w);
+
+	for ( ; ; ) {
+		struct port_in *port;
+
+		port = TAILQ_FIRST(&w->ports_in);
+		if (!port)
+			break;
+
+		TAILQ_REMOVE(&w->ports_in, port, node);
+		port->type->ops.free(port->obj);
+		free(port);
+	}
+
+	free(w);
+}
+
+int
+rte_swx_pipeline_worker_create(struct rte_swx_pipeline **worker,
+			       struct rte_swx_pipeline *p)
+{
+	struct rte_swx_pipeline *w;
+	struct learner *l;
+	uint32_t i;
+	int status;
+
+	CHECK(worker, EINVAL);
+	CHECK(p, EINVAL);
+	CHECK(p->build_done, EINVAL);
+	CHECK(!p->parent, EINVAL);
+
+	/* The learner tables can only be shared when they are in concurrent mode. */
+	TAILQ_FOREACH(l, &p->learners, node)
+		CHECK(l->action_data_size_max <=
+		      RTE_SWX_TABLE_LEARNER_CONCURRENT_ACTION_DATA_SIZE_MAX, ENOTSUP);
+
+	w = calloc(1, sizeof(struct rte_swx_pipeline));
+	CHECK(w, ENOMEM);
+
+	/* Share the parent pipeline configuration, tables, register arrays, meters, etc. */
+	memcpy(w, p, sizeof(struct rte_swx_pipeline));
+
+	w->name[0] = 0;
+	w->parent = p;
+	TAILQ_INIT(&w->workers);
+	TAILQ_INSERT_TAIL(&p->workers, w, worker_node);
+
+	/* Per worker: ports. */
+	TAILQ_INIT(&w->ports_in);
+	TAILQ_INIT(&w->ports_out);
+	w->in = NULL;
+	w->out = NULL;
+	w->port_id = 0;
+
+	/* Per worker: threads and statistics counters. */
+	memset(w->threads, 0, sizeof(w->threads));
+	w->thread_id = 0;
+	w->table_stats = NULL;
+	w->selector_stats = NULL;
+	w->learner_stats = NULL;
+	w->lib = NULL;
+	w->build_done = 0;
+
+	status = struct_build(w);
+	if (status)
+		goto error;
+
+	status = mirroring_slots_build(w);
+	if (status)
+		goto error;
+
+	status = extern_obj_build(w);
+	if (status)
+		goto error;
+
+	status = extern_func_build(w);
+	if (status)
+		goto error;
+
+	status = header_build(w);
+	if (status)
+		goto error;
+
+	status = metadata_build(w);
+	if (status)
+		goto error;
+
+	status = table_build(w);
+	if (status)
+		goto error;
+
+	status = selector_build(w);
+	if (status)
+		goto error;
+
+	status = learner_build(w);
+	if (status)
+		goto error;
+
+	for (i = 0; i < RTE_SWX_PIPELINE_THREADS_MAX; i++)
+		thread_ip_reset(w, &w->threads[i]);
+
+	*worker = w;
+	return 0;
+
+error:
+	worker_free(w);
+	return status;
+}
+
+static int
+worker_build(struct rte_swx_pipeline *w)
+{
+	struct rte_swx_port_sink_params drop_port_params = {
+		.file_name = NULL,
+	};
+	struct rte_swx_pipeline *p = w->parent;
+	uint32_t n_ports_in = 0, i;
+	int status;
+
+	/* Input ports: only the ports configured for this worker are polled. */
+	for (i = 0; i < p->n_ports_in; i++)
+		if (port_in_find(w, i))
+			n_ports_in++;
+
+	CHECK(n_ports_in, EINVAL);
+
+	w->in = calloc(n_ports_in, sizeof(struct port_in_runtime));
+	CHECK(w->in, ENOMEM);
+
+	for (i = 0, n_ports_in = 0; i < p->n_ports_in; i++) {
+		struct port_in *port = port_in_find(w, i);
+		struct port_in_runtime *in = &w->in[n_ports_in];
+
+		if (!port)
+			continue;
+
+		in->pkt_rx = port->type->ops.pkt_rx;
+		in->obj = port->obj;
+		in->id = port->id;
+		n_ports_in++;
+	}
+
+	w->n_ports_in = n_ports_in;
+
+	/* Output ports: all of them are required, except for the drop port. */
+	if (!port_out_find(w, p->n_ports_out - 1)) {
+		status = rte_swx_pipeline_port_out_config(w,
+							  p->n_ports_out - 1,
+							  "sink",
+							  &drop_port_params);
+		if (status)
+			goto error;
+	}
+
+	status = port_out_build(w);
+	if (status)
+		goto error;
+
+	w->table_state = p->table_state;
+	w->build_done = 1;
+
+	return 0;
+
+error:
+	port_in_build_free(w);
+	w->n_ports_in = p->n_ports_in;
+	return status;
+}
+
 void
 rte_swx_pipeline_free(struct rte_swx_pipeline *p)
 {
@@ -10311,6 +10559,21 @@ rte_swx_pipeline_free(struct rte_swx_pipeline *p)
 	if (!p)
 		return;
 
+	if (p->parent) {
+		worker_free(p);
+		return;
+	}
+
+	for ( ; ; ) {
+		struct rte_swx_pipeline *w;
+
+		w = TAILQ_FIRST(&p->workers);
+		if (!w)
+			break;
+
+		worker_free(w);
+	}
+
 	if (p->name[0])
 		pipeline_unregister(p);
 
@@ -10488,6 +10751,7 @@ rte_swx_pipeline_config(struct rte_swx_pipeline **p, const char *name, int numa_
 	TAILQ_INIT(&pipeline->regarrays);
 	TAILQ_INIT(&pipeline->meter_profiles);
 	TAILQ_INIT(&pipeline->metarrays);
+	TAILQ_INIT(&pipeline->workers);
 
 	pipeline->n_structs = 1; /* Struct 0 is reserved for action_data. */
 	pipeline->n_mirroring_slots = RTE_SWX_PACKET_MIRRORING_SLOTS_DEFAULT;
@@ -10557,6 +10821,9 @@ rte_swx_pipeline_build(struct rte_swx_pipeline *p)
 	CHECK(p, EINVAL);
 	CHECK(p->build_done == 0, EEXIST);
 
+	if (p->parent)
+		return worker_build(p);
+
 	status = port_in_build(p);
 	if (status)
 		goto error;
@@ -10669,6 +10936,12 @@ rte_swx_pipeline_run(struct rte_swx_pipeline *p, uint32_t n_instructions)
 {
 	uint32_t i;
 
+	/* Order the first read of the table state after this store, see table_state_in_sync(). */
+	if (unlikely(!rte_atomic_load_explicit(&p->started, rte_memory_order_relaxed))) {
+		rte_atomic_store_explicit(&p->started, 1, rte_memory_order_relaxed);
+		rte_atomic_thread_fence(rte_memory_order_seq_cst);
+	}
+
 	for (i = 0; i < n_instructions; i++)
 		instr_exec(p);
 }
@@ -11106,18 +11379,89 @@ int
 rte_swx_pipeline_table_state_set(struct rte_swx_pipeline *p,
 				 struct rte_swx_table_state *table_state)
 {
-	if (!p || !table_state || !p->build_done)
+	struct rte_swx_pipeline *w;
+
+	if (!p || !table_state || !p->build_done || p->parent)
 		return -EINVAL;
 
 	p->table_state = table_state;
+
+	TAILQ_FOREACH(w, &p->workers, worker_node)
+		w->table_state = table_state;
+
 	return 0;
 }
 
+/* Returns 1 when none of the pipeline threads uses the previous table state. A thread picks up
+ * the current table state each time it executes the rx instruction, which it does even when there
+ * is no packet to receive, so an idle thread also gets in sync as long as the pipeline is running.
+ *
+ * A pipeline that never ran is in sync, as it sets its started flag before reading the table state
+ * for the first time, while the table state is set before reading the flag, both with a full
+ * barrier in between. Once started, a thread with a NULL table state may be about to store the
+ * previous one, so it is not in sync.
+ */
+static int
+table_state_in_sync(struct rte_swx_pipeline *p)
+{
+	struct rte_swx_table_state *ts = p->table_state;
+	uint32_t i;
+
+	if (!rte_atomic_load_explicit(&p->started, rte_memory_order_relaxed))
+		return 1;
+
+	for (i = 0; i < RTE_SWX_PIPELINE_THREADS_MAX; i++) {
+		const volatile struct thread *t = &p->threads[i];
+		struct rte_swx_table_state *t_ts = t->table_state;
+
+		if (t_ts != ts)
+			return 0;
+	}
+
+	return 1;
+}
+
+#ifndef RTE_SWX_PIPELINE_TABLE_STATE_SYNC_TIMEOUT_US
+#define RTE_SWX_PIPELINE_TABLE_STATE_SYNC_TIMEOUT_US 10000
+#endif
+
+int
+rte_swx_pipeline_table_state_sync(struct rte_swx_pipeline *p)
+{
+	uint64_t start, timeout;
+
+	if (!p || !p->build_done || p->parent)
+		return -EINVAL;
+
+	timeout = rte_get_tsc_hz() * RTE_SWX_PIPELINE_TABLE_STATE_SYNC_TIMEOUT_US / 1000000;
+	start = rte_get_tsc_cycles();
+
+	for ( ; ; ) {
+		struct rte_swx_pipeline *w;
+		int in_sync;
+
+		rte_smp_mb();
+
+		in_sync = table_state_in_sync(p);
+		TAILQ_FOREACH(w, &p->workers, worker_node)
+			in_sync = in_sync && table_state_in_sync(w);
+
+		if (in_sync)
+			return 0;
+
+		if (rte_get_tsc_cycles() - start >= timeout)
+			return -ETIMEDOUT;
+
+		rte_delay_us_sleep(1);
+	}
+}
+
 int
 rte_swx_ctl_pipeline_port_in_stats_read(struct rte_swx_pipeline *p,
 					uint32_t port_id,
 					struct rte_swx_port_in_stats *stats)
 {
+	struct rte_swx_pipeline *w;
 	struct port_in *port;
 
 	if (!p || !stats)
@@ -11128,6 +11472,21 @@ rte_swx_ctl_pipeline_port_in_stats_read(struct rte_swx_pipeline *p,
 		return -EINVAL;
 
 	port->type->ops.stats_read(port->obj, stats);
+
+	TAILQ_FOREACH(w, &p->workers, worker_node) {
+		struct rte_swx_port_in_stats w_stats;
+
+		port = port_in_find(w, port_id);
+		if (!port)
+			continue;
+
+		port->type->ops.stats_read(port->obj, &w_stats);
+
+		stats->n_pkts += w_stats.n_pkts;
+		stats->n_bytes += w_stats.n_bytes;
+		stats->n_empty += w_stats.n_empty;
+	}
+
 	return 0;
 }
 
@@ -11136,6 +11495,7 @@ rte_swx_ctl_pipeline_port_out_stats_read(struct rte_swx_pipeline *p,
 					 uint32_t port_id,
 					 struct rte_swx_port_out_stats *stats)
 {
+	struct rte_swx_pipeline *w;
 	struct port_out *port;
 
 	if (!p || !stats)
@@ -11146,6 +11506,24 @@ rte_swx_ctl_pipeline_port_out_stats_read(struct rte_swx_pipeline *p,
 		return -EINVAL;
 
 	port->type->ops.stats_read(port->obj, stats);
+
+	TAILQ_FOREACH(w, &p->workers, worker_node) {
+		struct rte_swx_port_out_stats w_stats;
+
+		port = port_out_find(w, port_id);
+		if (!port)
+			continue;
+
+		port->type->ops.stats_read(port->obj, &w_stats);
+
+		stats->n_pkts += w_stats.n_pkts;
+		stats->n_bytes += w_stats.n_bytes;
+		stats->n_pkts_drop += w_stats.n_pkts_drop;
+		stats->n_bytes_drop += w_stats.n_bytes_drop;
+		stats->n_pkts_clone += w_stats.n_pkts_clone;
+		stats->n_pkts_clone_err += w_stats.n_pkts_clone_err;
+	}
+
 	return 0;
 }
 
@@ -11154,8 +11532,10 @@ rte_swx_ctl_pipeline_table_stats_read(struct rte_swx_pipeline *p,
 				      const char *table_name,
 				      struct rte_swx_table_stats *stats)
 {
+	struct rte_swx_pipeline *w;
 	struct table *table;
 	struct table_statistics *table_stats;
+	uint32_t i;
 
 	if (!p || !table_name || !table_name[0] || !stats || !stats->n_pkts_action)
 		return -EINVAL;
@@ -11173,6 +11553,16 @@ rte_swx_ctl_pipeline_table_stats_read(struct rte_swx_pipeline *p,
 	stats->n_pkts_hit = table_stats->n_pkts_hit[1];
 	stats->n_pkts_miss = table_stats->n_pkts_hit[0];
 
+	TAILQ_FOREACH(w, &p->workers, worker_node) {
+		table_stats = &w->table_stats[table->id];
+
+		for (i = 0; i < p->n_actions; i++)
+			stats->n_pkts_action[i] += table_stats->n_pkts_action[i];
+
+		stats->n_pkts_hit += table_stats->n_pkts_hit[1];
+		stats->n_pkts_miss += table_stats->n_pkts_hit[0];
+	}
+
 	return 0;
 }
 
@@ -11181,6 +11571,7 @@ rte_swx_ctl_pipeline_selector_stats_read(struct rte_swx_pipeline *p,
 	const char *selector_name,
 	struct rte_swx_pipeline_selector_stats *stats)
 {
+	struct rte_swx_pipeline *w;
 	struct selector *s;
 
 	if (!p || !selector_name || !selector_name[0] || !stats)
@@ -11192,6 +11583,9 @@ rte_swx_ctl_pipeline_selector_stats_read(struct rte_swx_pipeline *p,
 
 	stats->n_pkts = p->selector_stats[s->id].n_pkts;
 
+	TAILQ_FOREACH(w, &p->workers, worker_node)
+		stats->n_pkts += w->selector_stats[s->id].n_pkts;
+
 	return 0;
 }
 
@@ -11200,8 +11594,10 @@ rte_swx_ctl_pipeline_learner_stats_read(struct rte_swx_pipeline *p,
 					const char *learner_name,
 					struct rte_swx_learner_stats *stats)
 {
+	struct rte_swx_pipeline *w;
 	struct learner *l;
 	struct learner_statistics *learner_stats;
+	uint32_t i;
 
 	if (!p || !learner_name || !learner_name[0] || !stats || !stats->n_pkts_action)
 		return -EINVAL;
@@ -11225,6 +11621,22 @@ rte_swx_ctl_pipeline_learner_stats_read(struct rte_swx_pipeline *p,
 	stats->n_pkts_rearm = learner_stats->n_pkts_rearm;
 	stats->n_pkts_forget = learner_stats->n_pkts_forget;
 
+	TAILQ_FOREACH(w, &p->workers, worker_node) {
+		learner_stats = &w->learner_stats[l->id];
+
+		for (i = 0; i < p->n_actions; i++)
+			stats->n_pkts_action[i] += learner_stats->n_pkts_action[i];
+
+		stats->n_pkts_hit += learner_stats->n_pkts_hit[1];
+		stats->n_pkts_miss += learner_stats->n_pkts_hit[0];
+
+		stats->n_pkts_learn_ok += learner_stats->n_pkts_learn[0];
+		stats->n_pkts_learn_err += learner_stats->n_pkts_learn[1];
+
+		stats->n_pkts_rearm += learner_stats->n_pkts_rearm;
+		stats->n_pkts_forget += learner_stats->n_pkts_forget;
+	}
+
 	return 0;
 }
 
@@ -1034,6 +1034,47 @@ rte_swx_pipeline_build_from_lib(struct rte_swx_pipeline **p,
 				FILE *iospec_file,
 				int numa_node);
 
+/**
+ * Pipeline worker create
+ *
+ * A worker runs the same pipeline as its parent pipeline, so a single pipeline instance can be
+ * run by several lcores concurrently: the parent pipeline on one lcore and each of its workers on
+ * another lcore. The worker shares the tables, selectors, learner tables, register arrays, meter
+ * arrays, extern objects and mirroring sessions with the parent pipeline, which keeps being the
+ * only handle used by the control plane. Each worker has its own pipeline threads, statistics
+ * counters and ports.
+ *
+ * After creation, the worker input and output ports are configured with functions
+ * *rte_swx_pipeline_port_in_config* and *rte_swx_pipeline_port_out_config* respectively, using
+ * the same port IDs and port types as the parent pipeline. Only the input ports configured for the
+ * worker are polled by the worker. All the output ports of the parent pipeline, except for the
+ * drop port, have to be configured for the worker. The worker configuration is completed with
+ * function *rte_swx_pipeline_build*, then the worker is run with function *rte_swx_pipeline_run*
+ * and freed with function *rte_swx_pipeline_free*. The workers are freed when their parent
+ * pipeline is freed.
+ *
+ * The table updates performed through the control plane API are picked up by all the workers.
+ * The statistics counters read through the control plane API are aggregated across the parent
+ * pipeline and all its workers. The data plane updates of the learner tables, register arrays and
+ * meter arrays are not synchronized between workers. The learner tables are shared in concurrent
+ * mode, which limits their action data size to
+ * *RTE_SWX_TABLE_LEARNER_CONCURRENT_ACTION_DATA_SIZE_MAX* bytes.
+ *
+ * @param[out] worker
+ *   Worker handle.
+ * @param[in] p
+ *   Parent pipeline handle. Must be already built.
+ * @return
+ *   0 on success or the following error codes otherwise:
+ *   -EINVAL: Invalid argument;
+ *   -ENOMEM: Not enough space/cannot allocate memory;
+ *   -ENOTSUP: Learner table action data too big to share the table.
+ */
+__rte_experimental
+int
+rte_swx_pipeline_worker_create(struct rte_swx_pipeline **worker,
+			       struct rte_swx_pipeline *p);
+
 /**
  * Pipeline run
  *
@@ -81,6 +81,7 @@ TAILQ_HEAD(port_in_tailq, port_in);
 struct port_in_runtime {
 	rte_swx_port_in_pkt_rx_t pkt_rx;
 	void *obj;
+	uint32_t id;
 };
 
 /*
@@ -1539,6 +1540,8 @@ __extension__ ({                                                               \
 #define RTE_SWX_PIPELINE_INSTRUCTION_TABLE_SIZE_MAX 1024
 #endif
 
+TAILQ_HEAD(worker_tailq, rte_swx_pipeline);
+
 struct rte_swx_pipeline {
 	char name[RTE_SWX_NAME_SIZE];
 
@@ -1583,6 +1586,13 @@ struct rte_swx_pipeline {
 	struct thread threads[RTE_SWX_PIPELINE_THREADS_MAX];
 	void *lib;
 
+	/* Workers running the same pipeline on other lcores. A worker shares everything with its
+	 * parent pipeline except the threads, the ports and the statistics counters.
+	 */
+	struct rte_swx_pipeline *parent;
+	TAILQ_ENTRY(rte_swx_pipeline) worker_node;
+	struct worker_tailq workers;
+
 	uint32_t n_structs;
 	uint32_t n_ports_in;
 	uint32_t n_ports_out;
@@ -1604,6 +1614,9 @@ struct rte_swx_pipeline {
 	uint32_t n_instructions;
 	int build_done;
 	int numa_node;
+
+	/* Set on the first run, written by the data plane. */
+	RTE_ATOMIC(int) started;
 };
 
 /*
@@ -1721,7 +1734,7 @@ __instr_rx_exec(struct rte_swx_pipeline *p, struct thread *t, const struct instr
 	t->n_headers_out = 0;
 
 	/* Meta-data. */
-	METADATA_WRITE(t, ip->io.io.offset, ip->io.io.n_bits, p->port_id);
+	METADATA_WRITE(t, ip->io.io.offset, ip->io.io.n_bits, port->id);
 
 	/* Tables. */
 	t->table_state = p->table_state;
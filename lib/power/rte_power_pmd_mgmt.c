@@ -2,6 +2,7 @@
  * Copyright(c) 2020 Intel Corporation
  */
 
+#include <ctype.h>
 #include <stdlib.h>
 
 #include <rte_lcore.h>
@@ -10,6 +11,8 @@
 #include <rte_malloc.h>
 #include <rte_ethdev.h>
 #include <rte_power_intrinsics.h>
+#include <rte_spinlock.h>
+#include <rte_telemetry.h>
 
 #include "rte_power_pmd_mgmt.h"
 #include "power_common.h"
@@ -18,6 +21,7 @@ unsigned int emptypoll_max;
 unsigned int pause_duration;
 unsigned int scale_freq_min[RTE_MAX_LCORE];
 unsigned int scale_freq_max[RTE_MAX_LCORE];
+static unsigned int latency_slo;
 
 /* store some internal state */
 static struct pmd_conf_data {
@@ -39,6 +43,25 @@ enum pmd_mgmt_state {
 	PMD_MGMT_ENABLED
 };
 
+/**
+ * States of a queue in adaptive mode.
+ */
+enum pmd_adaptive_state {
+	/** Busy polling at full frequency. */
+	PMD_ADAPTIVE_POLL = 0,
+	/** Polling at scaled down frequency. */
+	PMD_ADAPTIVE_SCALE,
+	/** Sleeping with monitor or pause between polls. */
+	PMD_ADAPTIVE_SLEEP,
+	PMD_ADAPTIVE_STATE_MAX
+};
+
+static const char * const adaptive_state_names[PMD_ADAPTIVE_STATE_MAX] = {
+	[PMD_ADAPTIVE_POLL] = "poll",
+	[PMD_ADAPTIVE_SCALE] = "scale",
+	[PMD_ADAPTIVE_SLEEP] = "sleep",
+};
+
 union queue {
 	uint32_t val;
 	struct {
@@ -53,6 +76,18 @@ struct queue_list_entry {
 	uint64_t n_empty_polls;
 	uint64_t n_sleeps;
 	const struct rte_eth_rxtx_callback *cb;
+	uint64_t last_rx_tsc;
+	/**< Time of the last non-empty poll, used by adaptive mode */
+	uint64_t avg_gap;
+	/**< Average time between two non-empty polls, used by adaptive mode */
+	enum pmd_adaptive_state state;
+	/**< Current adaptive mode state */
+	uint64_t state_tsc;
+	/**< Time the current adaptive mode state was entered */
+	uint64_t n_decisions[PMD_ADAPTIVE_STATE_MAX];
+	/**< Number of times each adaptive mode state was entered */
+	uint64_t state_time[PMD_ADAPTIVE_STATE_MAX];
+	/**< Time spent in each adaptive mode state, but the current one */
 };
 
 struct __rte_cache_aligned pmd_core_cfg {
@@ -68,9 +103,21 @@ struct __rte_cache_aligned pmd_core_cfg {
 	/**< Number of queues ready to enter power optimized state */
 	uint64_t sleep_target;
 	/**< Prevent a queue from triggering sleep multiple times */
+	bool adaptive_monitor;
+	/**< Adaptive mode sleeps with monitoring rather than pause */
+	bool adaptive_scale;
+	/**< Adaptive mode can scale the frequency */
+	bool freq_scaled;
+	/**< Frequency has been scaled down by adaptive mode */
 };
 static struct pmd_core_cfg lcore_cfgs[RTE_MAX_LCORE];
 
+/*
+ * Protects the queue lists against the telemetry commands, the Rx callbacks
+ * do not need it since the queues must be stopped to change the lists.
+ */
+static rte_spinlock_t queue_list_lock = RTE_SPINLOCK_INITIALIZER;
+
 static inline bool
 queue_equal(const union queue *l, const union queue *r)
 {
@@ -110,6 +157,7 @@ queue_list_add(struct pmd_core_cfg *cfg, const union queue *q)
 	memset(qle, 0, sizeof(*qle));
 
 	queue_copy(&qle->queue, q);
+	qle->state_tsc = rte_rdtsc();
 	TAILQ_INSERT_TAIL(&cfg->head, qle, next);
 	cfg->n_queues++;
 
@@ -384,6 +432,150 @@ clb_scale_freq(uint16_t port_id __rte_unused, uint16_t qidx __rte_unused,
 	return nb_rx;
 }
 
+static inline void
+adaptive_set_state(struct pmd_core_cfg *cfg, struct queue_list_entry *qcfg,
+		enum pmd_adaptive_state state, uint64_t now)
+{
+	if (qcfg->state == state)
+		return;
+
+	qcfg->state_time[qcfg->state] += now - qcfg->state_tsc;
+	qcfg->state_tsc = now;
+	qcfg->state = state;
+	qcfg->n_decisions[state]++;
+
+	/* frequency is shared by all the queues of the lcore */
+	if (state == PMD_ADAPTIVE_SCALE && !cfg->freq_scaled) {
+		rte_power_freq_min(rte_lcore_id());
+		cfg->freq_scaled = true;
+	} else if (state == PMD_ADAPTIVE_POLL && cfg->freq_scaled) {
+		rte_power_freq_max(rte_lcore_id());
+		cfg->freq_scaled = false;
+	}
+}
+
+/*
+ * Expected time between two non-empty polls of the queue: the learnt
+ * average, unless the queue has already been idle for longer.
+ */
+static inline uint64_t
+adaptive_expected_gap(const struct queue_list_entry *qcfg, uint64_t now)
+{
+	/* no traffic seen yet */
+	if (qcfg->last_rx_tsc == 0)
+		return UINT64_MAX;
+
+	return RTE_MAX(qcfg->avg_gap, now - qcfg->last_rx_tsc);
+}
+
+static inline void
+adaptive_sleep(struct pmd_core_cfg *cfg, uint64_t gap, uint64_t idle,
+		uint64_t slo_tsc)
+{
+	uint64_t duration, i;
+
+	if (cfg->adaptive_monitor) {
+		struct rte_power_monitor_cond pmc[cfg->n_queues];
+
+		/* woken up by the traffic, so the latency is the wake up time */
+		if (get_monitor_addresses(cfg, pmc, cfg->n_queues) < 0)
+			return;
+		if (cfg->n_queues > 1)
+			rte_power_monitor_multi(pmc, cfg->n_queues, UINT64_MAX);
+		else
+			rte_power_monitor(&pmc[0], UINT64_MAX);
+		return;
+	}
+
+	/*
+	 * sleep until the next packet is expected, or for the latency target
+	 * if it is already late, but never longer than the latency target.
+	 */
+	duration = gap > idle ? RTE_MIN(gap - idle, slo_tsc) : slo_tsc;
+	duration = RTE_MAX(duration, global_data.tsc_per_us);
+
+	if (global_data.intrinsics_support.power_pause) {
+		rte_power_pause(rte_rdtsc() + duration);
+	} else {
+		duration = duration / global_data.tsc_per_us *
+				global_data.pause_per_us;
+		for (i = 0; i < duration; i++)
+			rte_pause();
+	}
+}
+
+static uint16_t
+clb_adaptive(uint16_t port_id __rte_unused, uint16_t qidx __rte_unused,
+		struct rte_mbuf **pkts __rte_unused, uint16_t nb_rx,
+		uint16_t max_pkts, void *arg)
+{
+	const uint64_t slo_tsc = global_data.tsc_per_us * latency_slo;
+	struct queue_list_entry *queue_conf = arg;
+	struct queue_list_entry *qle;
+	struct pmd_core_cfg *lcore_conf;
+	uint64_t now, gap, idle;
+
+	lcore_conf = &lcore_cfgs[rte_lcore_id()];
+	now = rte_rdtsc();
+
+	if (likely(nb_rx != 0)) {
+		/* learn the traffic pattern */
+		if (queue_conf->last_rx_tsc == 0)
+			queue_conf->avg_gap = slo_tsc;
+		else
+			queue_conf->avg_gap += ((int64_t)(now -
+				queue_conf->last_rx_tsc) -
+				(int64_t)queue_conf->avg_gap) / 8;
+		queue_conf->last_rx_tsc = now;
+
+		queue_reset(lcore_conf, queue_conf);
+
+		/* traffic burst, go back to full speed polling */
+		if (nb_rx >= max_pkts)
+			adaptive_set_state(lcore_conf, queue_conf,
+					PMD_ADAPTIVE_POLL, now);
+		/* woken up, keep the frequency scaled at moderate load */
+		else if (queue_conf->state == PMD_ADAPTIVE_SLEEP)
+			adaptive_set_state(lcore_conf, queue_conf,
+				lcore_conf->adaptive_scale &&
+				queue_conf->avg_gap < slo_tsc ?
+				PMD_ADAPTIVE_SCALE : PMD_ADAPTIVE_POLL, now);
+
+		return nb_rx;
+	}
+
+	/* can this queue sleep? */
+	if (!queue_can_sleep(lcore_conf, queue_conf))
+		return nb_rx;
+
+	/* can this lcore sleep? */
+	if (!lcore_can_sleep(lcore_conf))
+		return nb_rx;
+
+	/* the lcore is as busy as its busiest queue */
+	gap = UINT64_MAX;
+	idle = UINT64_MAX;
+	TAILQ_FOREACH(qle, &lcore_conf->head, next) {
+		gap = RTE_MIN(gap, adaptive_expected_gap(qle, now));
+		idle = RTE_MIN(idle, now - qle->last_rx_tsc);
+	}
+
+	if (gap >= slo_tsc) {
+		/* light load: packets are sparser than the latency target */
+		TAILQ_FOREACH(qle, &lcore_conf->head, next)
+			adaptive_set_state(lcore_conf, qle,
+					PMD_ADAPTIVE_SLEEP, now);
+		adaptive_sleep(lcore_conf, gap, idle, slo_tsc);
+	} else if (lcore_conf->adaptive_scale) {
+		/* moderate load: sleeping would delay the packets */
+		TAILQ_FOREACH(qle, &lcore_conf->head, next)
+			adaptive_set_state(lcore_conf, qle,
+					PMD_ADAPTIVE_SCALE, now);
+	}
+
+	return nb_rx;
+}
+
 static int
 queue_stopped(const uint16_t port_id, const uint16_t queue_id)
 {
@@ -565,14 +757,38 @@ rte_power_ethdev_pmgmt_queue_enable(unsigned int lcore_id, uint16_t port_id,
 
 		clb = clb_pause;
 		break;
+	case RTE_POWER_MGMT_TYPE_ADAPTIVE:
+		/* figure out various time-to-tsc conversions */
+		if (global_data.tsc_per_us == 0)
+			calc_tsc();
+
+		clb = clb_adaptive;
+
+		/* sleep with monitoring if all the queues support it */
+		if (lcore_cfg->pwr_mgmt_state == PMD_MGMT_DISABLED)
+			lcore_cfg->adaptive_monitor =
+				check_monitor(lcore_cfg, &qdata) == 0;
+		else if (lcore_cfg->adaptive_monitor)
+			lcore_cfg->adaptive_monitor =
+				check_monitor(lcore_cfg, &qdata) == 0;
+
+		/* we only have to check this when enabling first queue */
+		if (lcore_cfg->pwr_mgmt_state != PMD_MGMT_DISABLED)
+			break;
+		/* frequency scaling is optional in adaptive mode */
+		lcore_cfg->adaptive_scale = check_scale(lcore_id) == 0;
+		lcore_cfg->freq_scaled = false;
+		break;
 	default:
 		POWER_LOG(DEBUG, "Invalid power management type");
 		ret = -EINVAL;
 		goto end;
 	}
 	/* add this queue to the list */
+	rte_spinlock_lock(&queue_list_lock);
 	ret = queue_list_add(lcore_cfg, &qdata);
 	if (ret < 0) {
+		rte_spinlock_unlock(&queue_list_lock);
 		POWER_LOG(DEBUG, "Failed to add queue to list: %s",
 				strerror(-ret));
 		goto end;
@@ -589,6 +805,7 @@ rte_power_ethdev_pmgmt_queue_enable(unsigned int lcore_id, uint16_t port_id,
 		lcore_cfg->cb_mode = mode;
 		lcore_cfg->pwr_mgmt_state = PMD_MGMT_ENABLED;
 	}
+	rte_spinlock_unlock(&queue_list_lock);
 	queue_cfg->cb = rte_eth_add_rx_callback(port_id, queue_id,
 			clb, queue_cfg);
 
@@ -637,13 +854,17 @@ rte_power_ethdev_pmgmt_queue_disable(unsigned int lcore_id,
 	 * has read the documentation and has ensured that ports are stopped at
 	 * the time we enter the API functions.
 	 */
+	rte_spinlock_lock(&queue_list_lock);
 	queue_cfg = queue_list_take(lcore_cfg, &qdata);
-	if (queue_cfg == NULL)
+	if (queue_cfg == NULL) {
+		rte_spinlock_unlock(&queue_list_lock);
 		return -ENOENT;
+	}
 
 	/* if we've removed all queues from the lists, set state to disabled */
 	if (lcore_cfg->n_queues == 0)
 		lcore_cfg->pwr_mgmt_state = PMD_MGMT_DISABLED;
+	rte_spinlock_unlock(&queue_list_lock);
 
 	switch (lcore_cfg->cb_mode) {
 	case RTE_POWER_MGMT_TYPE_MONITOR: /* fall-through */
@@ -658,6 +879,17 @@ rte_power_ethdev_pmgmt_queue_disable(unsigned int lcore_id,
 			rte_power_exit(lcore_id);
 		}
 		break;
+	case RTE_POWER_MGMT_TYPE_ADAPTIVE:
+		rte_eth_remove_rx_callback(port_id, queue_id, queue_cfg->cb);
+		/* disable power library on this lcore if this was last queue */
+		if (lcore_cfg->pwr_mgmt_state == PMD_MGMT_DISABLED &&
+				lcore_cfg->adaptive_scale) {
+			rte_power_freq_max(lcore_id);
+			rte_power_exit(lcore_id);
+			lcore_cfg->adaptive_scale = false;
+			lcore_cfg->freq_scaled = false;
+		}
+		break;
 	}
 	/*
 	 * the API doc mandates that the user stops all processing on affected
@@ -700,6 +932,24 @@ rte_power_pmd_mgmt_get_pause_duration(void)
 	return pause_duration;
 }
 
+int
+rte_power_pmd_mgmt_set_latency_slo(unsigned int latency)
+{
+	if (latency == 0) {
+		POWER_LOG(ERR, "Latency target must be greater than 0, value unchanged");
+		return -EINVAL;
+	}
+	latency_slo = latency;
+
+	return 0;
+}
+
+unsigned int
+rte_power_pmd_mgmt_get_latency_slo(void)
+{
+	return latency_slo;
+}
+
 int
 rte_power_pmd_mgmt_set_scaling_freq_min(unsigned int lcore, unsigned int min)
 {
@@ -768,6 +1018,104 @@ rte_power_pmd_mgmt_get_scaling_freq_max(unsigned int lcore)
 	return scale_freq_max[lcore];
 }
 
+static const char * const pmd_mgmt_type_names[] = {
+	[RTE_POWER_MGMT_TYPE_MONITOR] = "monitor",
+	[RTE_POWER_MGMT_TYPE_PAUSE] = "pause",
+	[RTE_POWER_MGMT_TYPE_SCALE] = "scale",
+	[RTE_POWER_MGMT_TYPE_ADAPTIVE] = "adaptive",
+};
+
+static int
+handle_pmd_mgmt_lcores(const char *cmd __rte_unused,
+		const char *params __rte_unused,
+		struct rte_tel_data *d)
+{
+	unsigned int i;
+
+	rte_tel_data_start_array(d, RTE_TEL_INT_VAL);
+	for (i = 0; i < RTE_DIM(lcore_cfgs); i++)
+		if (lcore_cfgs[i].pwr_mgmt_state == PMD_MGMT_ENABLED)
+			rte_tel_data_add_array_int(d, i);
+
+	return 0;
+}
+
+static int
+handle_pmd_mgmt_stats(const char *cmd __rte_unused,
+		const char *params,
+		struct rte_tel_data *d)
+{
+	const struct queue_list_entry *qle;
+	const struct pmd_core_cfg *cfg;
+	struct rte_tel_data *qd;
+	char name[RTE_TEL_MAX_STRING_LEN];
+	unsigned long lcore_id;
+	uint64_t tsc_per_us, now, t;
+	char *end_param;
+	unsigned int i;
+	int ret;
+
+	if (params == NULL || strlen(params) == 0 || !isdigit(*params))
+		return -EINVAL;
+
+	lcore_id = strtoul(params, &end_param, 0);
+	if (*end_param != '\0')
+		POWER_LOG(NOTICE,
+			"Extra parameters passed to power telemetry command, ignoring");
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	cfg = &lcore_cfgs[lcore_id];
+	/* the queues cannot be removed and freed while they are reported */
+	rte_spinlock_lock(&queue_list_lock);
+	if (cfg->pwr_mgmt_state != PMD_MGMT_ENABLED) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	tsc_per_us = RTE_MAX(global_data.tsc_per_us, UINT64_C(1));
+	now = rte_rdtsc();
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_string(d, "mode", pmd_mgmt_type_names[cfg->cb_mode]);
+	TAILQ_FOREACH(qle, &cfg->head, next) {
+		qd = rte_tel_data_alloc();
+		if (qd == NULL) {
+			ret = -ENOMEM;
+			goto out;
+		}
+		rte_tel_data_start_dict(qd);
+		rte_tel_data_add_dict_uint(qd, "port_id", qle->queue.portid);
+		rte_tel_data_add_dict_uint(qd, "queue_id", qle->queue.qid);
+		rte_tel_data_add_dict_uint(qd, "empty_polls", qle->n_empty_polls);
+		if (cfg->cb_mode == RTE_POWER_MGMT_TYPE_ADAPTIVE) {
+			rte_tel_data_add_dict_string(qd, "state",
+					adaptive_state_names[qle->state]);
+			rte_tel_data_add_dict_uint(qd, "avg_gap_us",
+					qle->avg_gap / tsc_per_us);
+			for (i = 0; i < PMD_ADAPTIVE_STATE_MAX; i++) {
+				snprintf(name, sizeof(name), "%s_decisions",
+						adaptive_state_names[i]);
+				rte_tel_data_add_dict_uint(qd, name,
+						qle->n_decisions[i]);
+				t = qle->state_time[i];
+				if (i == qle->state)
+					t += now - qle->state_tsc;
+				snprintf(name, sizeof(name), "%s_time_us",
+						adaptive_state_names[i]);
+				rte_tel_data_add_dict_uint(qd, name, t / tsc_per_us);
+			}
+		}
+		snprintf(name, sizeof(name), "port%u_queue%u",
+				qle->queue.portid, qle->queue.qid);
+		rte_tel_data_add_dict_container(d, name, qd, 0);
+	}
+	ret = 0;
+out:
+	rte_spinlock_unlock(&queue_list_lock);
+	return ret;
+}
+
 RTE_INIT(rte_power_ethdev_pmgmt_init) {
 	size_t i;
 	int j;
@@ -781,9 +1129,15 @@ RTE_INIT(rte_power_ethdev_pmgmt_init) {
 	/* initialize config defaults */
 	emptypoll_max = 512;
 	pause_duration = 1;
+	latency_slo = 20;
 	/* scaling defaults out of range to ensure not used unless set by user or app */
 	for (j = 0; j < RTE_MAX_LCORE; j++) {
 		scale_freq_min[j] = 0;
 		scale_freq_max[j] = UINT32_MAX;
 	}
+
+	rte_telemetry_register_cmd("/power/pmd_mgmt/lcores", handle_pmd_mgmt_lcores,
+			"Returns list of lcores with PMD power management enabled. Takes no parameters");
+	rte_telemetry_register_cmd("/power/pmd_mgmt/stats", handle_pmd_mgmt_stats,
+			"Returns the PMD power management stats of the queues of an lcore. Parameters: int lcore_id");
 }
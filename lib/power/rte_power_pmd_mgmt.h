@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 
+#include <rte_compat.h>
 #include <rte_log.h>
 #include <rte_power.h>
 
@@ -29,6 +30,12 @@ enum rte_power_pmd_mgmt_type {
 	RTE_POWER_MGMT_TYPE_PAUSE,
 	/** Use frequency scaling when traffic is low */
 	RTE_POWER_MGMT_TYPE_SCALE,
+	/**
+	 * Pick one of the above depending on the traffic pattern learnt
+	 * on the queue, within the latency set with
+	 * rte_power_pmd_mgmt_set_latency_slo()
+	 */
+	RTE_POWER_MGMT_TYPE_ADAPTIVE,
 };
 
 /**
@@ -120,6 +127,39 @@ rte_power_pmd_mgmt_set_pause_duration(unsigned int duration);
 unsigned int
 rte_power_pmd_mgmt_get_pause_duration(void);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice.
+ *
+ * Set the latency target of the adaptive mode, in microseconds.
+ * The adaptive mode only sleeps when the traffic learnt on the queues
+ * is sparse compared to this latency, and never sleeps longer than it.
+ *
+ * @note Latency must be greater than zero.
+ *
+ * @param latency
+ *   The latency target, in microseconds.
+ * @return
+ *   0 on success
+ *   <0 on error
+ */
+__rte_experimental
+int
+rte_power_pmd_mgmt_set_latency_slo(unsigned int latency);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice.
+ *
+ * Get the latency target of the adaptive mode.
+ *
+ * @return
+ *   The latency target, in microseconds.
+ */
+__rte_experimental
+unsigned int
+rte_power_pmd_mgmt_get_latency_slo(void);
+
 /**
  * Set the min frequency to be used for frequency scaling or zero to use defaults.
  *
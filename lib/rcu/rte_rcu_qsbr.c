@@ -22,6 +22,12 @@
 #define RCU_LOG(level, ...) \
 	RTE_LOG_LINE_PREFIX(level, RCU, "%s(): ", __func__, __VA_ARGS__)
 
+/* Maximum number of resources dequeued at once from the defer queue,
+ * and size of the buffer they are copied to.
+ */
+#define RCU_QSBR_DQ_RECLAIM_BURST 32
+#define RCU_QSBR_DQ_RECLAIM_BUF_SIZE 1024
+
 /* Get the memory size of QSBR variable */
 size_t
 rte_rcu_qsbr_get_memsize(uint32_t max_threads)
@@ -43,6 +49,9 @@ rte_rcu_qsbr_get_memsize(uint32_t max_threads)
 	/* Add the size of the registered thread ID bitmap array */
 	sz += __RTE_QSBR_THRID_ARRAY_SIZE(max_threads);
 
+	/* Add the size of the thread group acknowledged token array */
+	sz += __RTE_QSBR_GROUP_ARRAY_SIZE(max_threads);
+
 	return sz;
 }
 
@@ -108,10 +117,15 @@ rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, unsigned int thread_id)
 
 	do {
 		new_bmap = old_bmap | (1UL << id);
+		/* Synchronize with the previous unregistration of this
+		 * thread ID, so that the token loaded when going online is
+		 * not older than the counter of the previous thread, which
+		 * may be cached in the thread group.
+		 */
 		success = rte_atomic_compare_exchange_strong_explicit(
 					__RTE_QSBR_THRID_ARRAY_ELM(v, i),
 					&old_bmap, new_bmap,
-					rte_memory_order_release, rte_memory_order_relaxed);
+					rte_memory_order_acq_rel, rte_memory_order_relaxed);
 
 		if (success)
 			rte_atomic_fetch_add_explicit(&v->num_threads,
@@ -407,7 +421,7 @@ rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n,
 			unsigned int *freed, unsigned int *pending,
 			unsigned int *available)
 {
-	uint32_t cnt;
+	uint32_t cnt, burst, num, i, j;
 	__rte_rcu_qsbr_dq_elem_t *dq_elem;
 
 	if (dq == NULL || n == 0) {
@@ -419,25 +433,42 @@ rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n,
 
 	cnt = 0;
 
-	char data[dq->esize];
+	/* Dequeue the resources in bursts to amortize the ring operations.
+	 * Only the first token of a burst usually needs to scan the reader
+	 * threads, the following ones are covered by the acknowledged token
+	 * cached by that scan.
+	 */
+	burst = RTE_MAX(1U, RTE_MIN((uint32_t)RCU_QSBR_DQ_RECLAIM_BURST,
+			RCU_QSBR_DQ_RECLAIM_BUF_SIZE / dq->esize));
+	char data[burst * dq->esize];
 	/* Check reader threads quiescent state and reclaim resources */
-	while (cnt < n &&
-		rte_ring_dequeue_bulk_elem_start(dq->r, &data,
-					dq->esize, 1, available) != 0) {
-		dq_elem = (__rte_rcu_qsbr_dq_elem_t *)data;
-
-		/* Reclaim the resource */
-		if (rte_rcu_qsbr_check(dq->v, dq_elem->token, false) != 1) {
-			rte_ring_dequeue_elem_finish(dq->r, 0);
+	while (cnt < n) {
+		num = rte_ring_dequeue_burst_elem_start(dq->r, &data, dq->esize,
+					RTE_MIN(burst, n - cnt), available);
+		if (num == 0)
 			break;
+
+		for (i = 0; i < num; i++) {
+			dq_elem = (__rte_rcu_qsbr_dq_elem_t *)
+					(data + i * dq->esize);
+			if (rte_rcu_qsbr_check(dq->v, dq_elem->token,
+					false) != 1)
+				break;
 		}
-		rte_ring_dequeue_elem_finish(dq->r, 1);
+		rte_ring_dequeue_elem_finish(dq->r, i);
 
-		RCU_LOG(INFO, "Reclaimed token = %" PRIu64, dq_elem->token);
+		/* Reclaim the resources */
+		for (j = 0; j < i; j++) {
+			dq_elem = (__rte_rcu_qsbr_dq_elem_t *)
+					(data + j * dq->esize);
+			RCU_LOG(INFO, "Reclaimed token = %" PRIu64, dq_elem->token);
 
-		dq->free_fn(dq->p, dq_elem->elem, 1);
+			dq->free_fn(dq->p, dq_elem->elem, 1);
+		}
 
-		cnt++;
+		cnt += i;
+		if (i < num)
+			break;
 	}
 
 	RCU_LOG(INFO, "Reclaimed %u resources", cnt);
@@ -69,6 +69,28 @@ extern int rte_rcu_log_type;
 #define __RTE_QSBR_THRID_MASK 0x3f
 #define RTE_QSBR_THRID_INVALID 0xffffffff
 
+/* Threads are also split in groups of 16, each group caching the least
+ * token acknowledged by its threads when it was last scanned. Groups
+ * which already acknowledged the token being checked are skipped, so
+ * a writer polling for a grace period only re-reads the counters of
+ * the groups still lagging behind. The group array is stored after
+ * the registered thread ID array.
+ *
+ * Only the groups with all their threads registered and online are
+ * cached. A thread coming online stores a token it may have loaded
+ * before the writer started the grace period, so a group in which any
+ * thread was seen offline has to be scanned again on the next check.
+ */
+#define __RTE_QSBR_GROUP_SHIFT 4
+#define __RTE_QSBR_GROUP_SIZE (1 << __RTE_QSBR_GROUP_SHIFT)
+#define __RTE_QSBR_GROUP_MASK ((UINT64_C(1) << __RTE_QSBR_GROUP_SIZE) - 1)
+#define __RTE_QSBR_GROUP_ARRAY_SIZE(max_threads) \
+	RTE_ALIGN((RTE_ALIGN_MUL_CEIL(max_threads, __RTE_QSBR_GROUP_SIZE) >> \
+		__RTE_QSBR_GROUP_SHIFT) * sizeof(uint64_t), RTE_CACHE_LINE_SIZE)
+#define __RTE_QSBR_GROUP_ACK(v, g) ((uint64_t __rte_atomic *) \
+	((uint8_t *)__RTE_QSBR_THRID_ARRAY_ELM(v, 0) + \
+	__RTE_QSBR_THRID_ARRAY_SIZE(v->max_threads)) + g)
+
 /* Worker thread counter */
 struct __rte_cache_aligned rte_rcu_qsbr_cnt {
 	RTE_ATOMIC(uint64_t) cnt;
@@ -87,10 +109,11 @@ struct __rte_cache_aligned rte_rcu_qsbr_cnt {
 #define __RTE_QSBR_TOKEN_SIZE sizeof(uint64_t)
 
 /* RTE Quiescent State variable structure.
- * This structure has two elements that vary in size based on the
+ * This structure has three elements that vary in size based on the
  * 'max_threads' parameter.
  * 1) Quiescent state counter array
  * 2) Register thread ID array
+ * 3) Thread group acknowledged token array
  */
 struct __rte_cache_aligned rte_rcu_qsbr {
 	alignas(RTE_CACHE_LINE_SIZE) RTE_ATOMIC(uint64_t) token;
@@ -113,6 +136,10 @@ struct __rte_cache_aligned rte_rcu_qsbr {
 	/**< Registered thread IDs are stored in a bitmap array,
 	 *   after the quiescent state counter array.
 	 */
+
+	/**< Least token acknowledged by each group of threads is stored
+	 *   in an array, after the registered thread ID array.
+	 */
 };
 
 /**
@@ -504,15 +531,123 @@ rte_rcu_qsbr_quiescent(struct rte_rcu_qsbr *v, unsigned int thread_id)
 		__func__, t, thread_id);
 }
 
+/* Check the quiescent state counter of the threads of group 'g' set in
+ * 'gmap', re-reading the registered thread bitmap element 'reg_thread_id'
+ * while waiting when it is not NULL. On success, the least token
+ * acknowledged by the online threads of the group is folded into
+ * 'acked_token', and cached in the group when all the threads of the
+ * group are registered and online.
+ */
+static __rte_always_inline int
+__rte_rcu_qsbr_check_group(struct rte_rcu_qsbr *v, uint32_t g, uint64_t gmap,
+	RTE_ATOMIC(uint64_t) *reg_thread_id, uint64_t t, bool wait,
+	uint64_t *acked_token)
+{
+	uint32_t j, id, shift, n;
+	uint64_t c;
+	uint64_t group_acked = __RTE_QSBR_CNT_MAX;
+	bool cache;
+
+	id = g << __RTE_QSBR_GROUP_SHIFT;
+	shift = id & __RTE_QSBR_THRID_MASK;
+
+	/* The threads not registered yet are not scanned, so the group
+	 * can only be cached when all its threads are registered.
+	 */
+	n = RTE_MIN(v->max_threads - id, (uint32_t)__RTE_QSBR_GROUP_SIZE);
+	cache = gmap == (__RTE_QSBR_GROUP_MASK >> (__RTE_QSBR_GROUP_SIZE - n));
+
+	while (gmap) {
+		j = rte_ctz64(gmap);
+		__RTE_RCU_DP_LOG(DEBUG,
+			"%s: check: token = %" PRIu64 ", wait = %d, Bit Map = 0x%" PRIx64 ", Thread ID = %d",
+			__func__, t, wait, gmap, id + j);
+		c = rte_atomic_load_explicit(&v->qsbr_cnt[id + j].cnt,
+				rte_memory_order_acquire);
+		__RTE_RCU_DP_LOG(DEBUG,
+			"%s: status: token = %" PRIu64 ", wait = %d, Thread QS cnt = %" PRIu64 ", Thread ID = %d",
+			__func__, t, wait, c, id + j);
+
+		/* Counter is not checked for wrap-around condition
+		 * as it is a 64b counter.
+		 */
+		if (unlikely(c != __RTE_QSBR_CNT_THR_OFFLINE && c < t)) {
+			/* This thread is not in quiescent state */
+			if (!wait)
+				return 0;
+
+			rte_pause();
+			/* This thread might have unregistered.
+			 * Re-read the bitmap.
+			 */
+			if (reg_thread_id != NULL)
+				gmap = (rte_atomic_load_explicit(reg_thread_id,
+						rte_memory_order_acquire) >> shift) &
+					__RTE_QSBR_GROUP_MASK;
+
+			continue;
+		}
+
+		/* This thread is in quiescent state. Use the counter
+		 * to find the least acknowledged token among all the
+		 * online readers of the group. An offline reader may
+		 * come online with an older token at any time, so the
+		 * group cannot be cached.
+		 */
+		if (c == __RTE_QSBR_CNT_THR_OFFLINE)
+			cache = false;
+		else if (group_acked > c)
+			group_acked = c;
+
+		gmap &= ~(1UL << j);
+	}
+
+	/* All the threads of the group are offline. */
+	if (group_acked == __RTE_QSBR_CNT_MAX)
+		return 1;
+
+	/* The counters of online threads only move forward, so the token
+	 * cannot become un-acknowledged by the group. There is no need to
+	 * update this very accurately when multiple writers race on it.
+	 */
+	if (cache)
+		rte_atomic_store_explicit(__RTE_QSBR_GROUP_ACK(v, g),
+			group_acked, rte_memory_order_release);
+
+	if (*acked_token > group_acked)
+		*acked_token = group_acked;
+
+	return 1;
+}
+
+/* Check if the group 'g' already acknowledged the token 't' in an
+ * earlier scan. Fold its cached token into 'acked_token' if so.
+ */
+static __rte_always_inline int
+__rte_rcu_qsbr_group_acked(struct rte_rcu_qsbr *v, uint32_t g, uint64_t t,
+	uint64_t *acked_token)
+{
+	uint64_t group_acked;
+
+	group_acked = rte_atomic_load_explicit(__RTE_QSBR_GROUP_ACK(v, g),
+			rte_memory_order_acquire);
+	if (group_acked < t)
+		return 0;
+
+	if (*acked_token > group_acked)
+		*acked_token = group_acked;
+
+	return 1;
+}
+
 /* Check the quiescent state counter for registered threads only, assuming
  * that not all threads have registered.
  */
 static __rte_always_inline int
 __rte_rcu_qsbr_check_selective(struct rte_rcu_qsbr *v, uint64_t t, bool wait)
 {
-	uint32_t i, j, id;
-	uint64_t bmap;
-	uint64_t c;
+	uint32_t i, k, g;
+	uint64_t bmap, gmap;
 	RTE_ATOMIC(uint64_t) *reg_thread_id;
 	uint64_t acked_token = __RTE_QSBR_CNT_MAX;
 
@@ -523,47 +658,21 @@ __rte_rcu_qsbr_check_selective(struct rte_rcu_qsbr *v, uint64_t t, bool wait)
 		 * loading the reader thread quiescent state counters.
 		 */
 		bmap = rte_atomic_load_explicit(reg_thread_id, rte_memory_order_acquire);
-		id = i << __RTE_QSBR_THRID_INDEX_SHIFT;
-
-		while (bmap) {
-			j = rte_ctz64(bmap);
-			__RTE_RCU_DP_LOG(DEBUG,
-				"%s: check: token = %" PRIu64 ", wait = %d, Bit Map = 0x%" PRIx64 ", Thread ID = %d",
-				__func__, t, wait, bmap, id + j);
-			c = rte_atomic_load_explicit(
-					&v->qsbr_cnt[id + j].cnt,
-					rte_memory_order_acquire);
-			__RTE_RCU_DP_LOG(DEBUG,
-				"%s: status: token = %" PRIu64 ", wait = %d, Thread QS cnt = %" PRIu64 ", Thread ID = %d",
-				__func__, t, wait, c, id+j);
-
-			/* Counter is not checked for wrap-around condition
-			 * as it is a 64b counter.
-			 */
-			if (unlikely(c !=
-				__RTE_QSBR_CNT_THR_OFFLINE && c < t)) {
-				/* This thread is not in quiescent state */
-				if (!wait)
-					return 0;
-
-				rte_pause();
-				/* This thread might have unregistered.
-				 * Re-read the bitmap.
-				 */
-				bmap = rte_atomic_load_explicit(reg_thread_id,
-						rte_memory_order_acquire);
 
+		for (k = 0; bmap != 0; k++, bmap >>= __RTE_QSBR_GROUP_SIZE) {
+			gmap = bmap & __RTE_QSBR_GROUP_MASK;
+			if (gmap == 0)
 				continue;
-			}
 
-			/* This thread is in quiescent state. Use the counter
-			 * to find the least acknowledged token among all the
-			 * readers.
-			 */
-			if (c != __RTE_QSBR_CNT_THR_OFFLINE && acked_token > c)
-				acked_token = c;
+			g = (i << (__RTE_QSBR_THRID_INDEX_SHIFT -
+				__RTE_QSBR_GROUP_SHIFT)) + k;
+			if (__rte_rcu_qsbr_group_acked(v, g, t, &acked_token))
+				continue;
 
-			bmap &= ~(1UL << j);
+			if (__rte_rcu_qsbr_check_group(v, g, gmap,
+					reg_thread_id, t, wait,
+					&acked_token) == 0)
+				return 0;
 		}
 	}
 
@@ -584,39 +693,21 @@ __rte_rcu_qsbr_check_selective(struct rte_rcu_qsbr *v, uint64_t t, bool wait)
 static __rte_always_inline int
 __rte_rcu_qsbr_check_all(struct rte_rcu_qsbr *v, uint64_t t, bool wait)
 {
-	uint32_t i;
-	struct rte_rcu_qsbr_cnt *cnt;
-	uint64_t c;
+	uint32_t g, n;
+	uint64_t gmap;
 	uint64_t acked_token = __RTE_QSBR_CNT_MAX;
 
-	for (i = 0, cnt = v->qsbr_cnt; i < v->max_threads; i++, cnt++) {
-		__RTE_RCU_DP_LOG(DEBUG,
-			"%s: check: token = %" PRIu64 ", wait = %d, Thread ID = %d",
-			__func__, t, wait, i);
-		while (1) {
-			c = rte_atomic_load_explicit(&cnt->cnt, rte_memory_order_acquire);
-			__RTE_RCU_DP_LOG(DEBUG,
-				"%s: status: token = %" PRIu64 ", wait = %d, Thread QS cnt = %" PRIu64 ", Thread ID = %d",
-				__func__, t, wait, c, i);
-
-			/* Counter is not checked for wrap-around condition
-			 * as it is a 64b counter.
-			 */
-			if (likely(c == __RTE_QSBR_CNT_THR_OFFLINE || c >= t))
-				break;
+	for (g = 0; (g << __RTE_QSBR_GROUP_SHIFT) < v->max_threads; g++) {
+		if (__rte_rcu_qsbr_group_acked(v, g, t, &acked_token))
+			continue;
 
-			/* This thread is not in quiescent state */
-			if (!wait)
-				return 0;
+		n = RTE_MIN(v->max_threads - (g << __RTE_QSBR_GROUP_SHIFT),
+			(uint32_t)__RTE_QSBR_GROUP_SIZE);
+		gmap = __RTE_QSBR_GROUP_MASK >> (__RTE_QSBR_GROUP_SIZE - n);
 
-			rte_pause();
-		}
-
-		/* This thread is in quiescent state. Use the counter to find
-		 * the least acknowledged token among all the readers.
-		 */
-		if (likely(c != __RTE_QSBR_CNT_THR_OFFLINE && acked_token > c))
-			acked_token = c;
+		if (__rte_rcu_qsbr_check_group(v, g, gmap, NULL, t, wait,
+				&acked_token) == 0)
+			return 0;
 	}
 
 	/* All readers are checked, update least acknowledged token.
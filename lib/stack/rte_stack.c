@@ -31,6 +31,8 @@ rte_stack_init(struct rte_stack *s, unsigned int count, uint32_t flags)
 
 	if (flags & RTE_STACK_F_LF)
 		rte_stack_lf_init(s, count);
+	else if (flags & RTE_STACK_F_ELIM)
+		rte_stack_elim_init(s, count);
 	else
 		rte_stack_std_init(s);
 }
@@ -40,6 +42,8 @@ rte_stack_get_memsize(unsigned int count, uint32_t flags)
 {
 	if (flags & RTE_STACK_F_LF)
 		return rte_stack_lf_get_memsize(count);
+	else if (flags & RTE_STACK_F_ELIM)
+		return rte_stack_elim_get_memsize(count);
 	else
 		return rte_stack_std_get_memsize(count);
 }
@@ -56,16 +60,22 @@ rte_stack_create(const char *name, unsigned int count, int socket_id,
 	unsigned int sz;
 	int ret;
 
-	if (flags & ~(RTE_STACK_F_LF)) {
+	if (flags & ~(RTE_STACK_F_LF | RTE_STACK_F_ELIM)) {
 		STACK_LOG_ERR("Unsupported stack flags %#x", flags);
 		return NULL;
 	}
 
+	if ((flags & RTE_STACK_F_LF) && (flags & RTE_STACK_F_ELIM)) {
+		STACK_LOG_ERR("RTE_STACK_F_LF and RTE_STACK_F_ELIM are exclusive");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
 #ifdef RTE_ARCH_64
 	RTE_BUILD_BUG_ON(sizeof(struct rte_stack_lf_head) != 16);
 #endif
 #if !defined(RTE_STACK_LF_SUPPORTED)
-	if (flags & RTE_STACK_F_LF) {
+	if (flags & (RTE_STACK_F_LF | RTE_STACK_F_ELIM)) {
 		STACK_LOG_ERR("Lock-free stack is not supported on your platform");
 		rte_errno = ENOTSUP;
 		return NULL;
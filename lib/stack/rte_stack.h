@@ -61,6 +61,43 @@ struct rte_stack_lf {
 	alignas(RTE_CACHE_LINE_SIZE) struct rte_stack_lf_elem elems[];
 };
 
+/** Number of elimination slots per NUMA socket. */
+#define RTE_STACK_ELIM_SLOTS 4
+
+/* Elimination slot, where a push that lost the race for the list head offers
+ * its linked list of elements to a concurrent pop. The top pointer is the
+ * first element of the offered list, the counter holds the number of
+ * elements in its low 32 bits and a modification tag in its high 32 bits.
+ */
+struct rte_stack_elim_slot {
+	/** Offered list of elements */
+	alignas(RTE_CACHE_LINE_SIZE) struct rte_stack_lf_head chain;
+};
+
+/* Per NUMA socket part of the elimination stack. */
+struct rte_stack_elim_socket {
+	/** LIFO list of elements */
+	alignas(RTE_CACHE_LINE_SIZE) struct rte_stack_lf_list used;
+	/** LIFO list of free elements */
+	alignas(RTE_CACHE_LINE_SIZE) struct rte_stack_lf_list free;
+	/** Elimination slots */
+	struct rte_stack_elim_slot slots[RTE_STACK_ELIM_SLOTS];
+};
+
+/* Structure containing one pair of lock-free LIFO lists per NUMA socket,
+ * located in the stack memzone after the rte_stack structure.
+ */
+struct rte_stack_elim {
+	/** Per socket lists */
+	struct rte_stack_elim_socket *sockets;
+	/** Index in sockets[] of each socket ID */
+	uint8_t *socket_idx;
+	/** LIFO elements */
+	struct rte_stack_lf_elem *elems;
+	/** Number of sockets */
+	unsigned int n_sockets;
+};
+
 /* Structure containing the LIFO, its current length, and a lock for mutual
  * exclusion.
  */
@@ -83,6 +120,8 @@ struct __rte_cache_aligned rte_stack {
 	union {
 		struct rte_stack_lf stack_lf; /**< Lock-free LIFO structure. */
 		struct rte_stack_std stack_std;	/**< LIFO structure. */
+		/** Per socket lock-free LIFO structure with elimination. */
+		struct rte_stack_elim stack_elim;
 	};
 };
 
@@ -92,8 +131,19 @@ struct __rte_cache_aligned rte_stack {
  */
 #define RTE_STACK_F_LF 0x0001
 
+/**
+ * The stack uses lock-free push and pop functions on one list per NUMA socket,
+ * with an elimination array where concurrent push and pop operations of the
+ * same size exchange their objects without accessing the list.
+ * Threads push on their socket list and pop from it first, then from the other
+ * sockets. This flag cannot be combined with RTE_STACK_F_LF, and is supported
+ * on the same platforms.
+ */
+#define RTE_STACK_F_ELIM 0x0002
+
 #include "rte_stack_std.h"
 #include "rte_stack_lf.h"
+#include "rte_stack_elim.h"
 
 /**
  * Push several objects on the stack (MT-safe).
@@ -115,6 +165,8 @@ rte_stack_push(struct rte_stack *s, void * const *obj_table, unsigned int n)
 
 	if (s->flags & RTE_STACK_F_LF)
 		return __rte_stack_lf_push(s, obj_table, n);
+	else if (s->flags & RTE_STACK_F_ELIM)
+		return __rte_stack_elim_push(s, obj_table, n);
 	else
 		return __rte_stack_std_push(s, obj_table, n);
 }
@@ -139,6 +191,8 @@ rte_stack_pop(struct rte_stack *s, void **obj_table, unsigned int n)
 
 	if (s->flags & RTE_STACK_F_LF)
 		return __rte_stack_lf_pop(s, obj_table, n);
+	else if (s->flags & RTE_STACK_F_ELIM)
+		return __rte_stack_elim_pop(s, obj_table, n);
 	else
 		return __rte_stack_std_pop(s, obj_table, n);
 }
@@ -158,6 +212,8 @@ rte_stack_count(struct rte_stack *s)
 
 	if (s->flags & RTE_STACK_F_LF)
 		return __rte_stack_lf_count(s);
+	else if (s->flags & RTE_STACK_F_ELIM)
+		return __rte_stack_elim_count(s);
 	else
 		return __rte_stack_std_count(s);
 }
@@ -197,6 +253,8 @@ rte_stack_free_count(struct rte_stack *s)
  *    - RTE_STACK_F_LF: If this flag is set, the stack uses lock-free
  *      variants of the push and pop functions. Otherwise, it achieves
  *      thread-safety using a lock.
+ *    - RTE_STACK_F_ELIM: If this flag is set, the stack uses lock-free
+ *      per NUMA socket lists with an elimination array.
  * @return
  *   On success, the pointer to the new allocated stack. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
@@ -205,6 +263,7 @@ rte_stack_free_count(struct rte_stack *s)
  *    - ENOMEM - insufficient memory to create the stack
  *    - ENAMETOOLONG - name size exceeds RTE_STACK_NAMESIZE
  *    - ENOTSUP - platform does not support given flags combination.
+ *    - EINVAL - invalid flags combination.
  */
 struct rte_stack *
 rte_stack_create(const char *name, unsigned int count, int socket_id,
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#include <string.h>
+
+#include <rte_lcore.h>
+
+#include "rte_stack.h"
+
+static unsigned int
+rte_stack_elim_socket_count(void)
+{
+	return RTE_MAX(rte_socket_count(), 1U);
+}
+
+void
+rte_stack_elim_init(struct rte_stack *s, unsigned int count)
+{
+	struct rte_stack_elim *stack_elim = &s->stack_elim;
+	unsigned int i, n_sockets;
+
+	n_sockets = rte_stack_elim_socket_count();
+
+	/* Lists first, then the socket map and the elements. */
+	stack_elim->n_sockets = n_sockets;
+	stack_elim->sockets = (struct rte_stack_elim_socket *)(s + 1);
+	stack_elim->socket_idx = (uint8_t *)&stack_elim->sockets[n_sockets];
+	stack_elim->elems = (struct rte_stack_lf_elem *)
+		RTE_PTR_ALIGN_CEIL(stack_elim->socket_idx + RTE_MAX_NUMA_NODES,
+				   RTE_CACHE_LINE_SIZE);
+
+	memset(stack_elim->sockets, 0,
+	       n_sockets * sizeof(struct rte_stack_elim_socket));
+
+	/* Socket IDs without lcores at creation time use the first lists. */
+	memset(stack_elim->socket_idx, 0, RTE_MAX_NUMA_NODES);
+	for (i = 0; i < n_sockets; i++) {
+		int socket_id = rte_socket_id_by_idx(i);
+
+		if (socket_id >= 0 && socket_id < RTE_MAX_NUMA_NODES)
+			stack_elim->socket_idx[socket_id] = i;
+	}
+
+	/* Spread the free elements over the sockets. */
+	for (i = 0; i < count; i++)
+		__rte_stack_lf_push_elems(&stack_elim->sockets[i % n_sockets].free,
+					  &stack_elim->elems[i],
+					  &stack_elim->elems[i], 1);
+}
+
+ssize_t
+rte_stack_elim_get_memsize(unsigned int count)
+{
+	ssize_t sz = sizeof(struct rte_stack);
+
+	sz += rte_stack_elim_socket_count() *
+		sizeof(struct rte_stack_elim_socket);
+	sz += RTE_CACHE_LINE_ROUNDUP(RTE_MAX_NUMA_NODES);
+	sz += RTE_CACHE_LINE_ROUNDUP(count * sizeof(struct rte_stack_lf_elem));
+
+	/* Add padding to avoid false sharing conflicts caused by
+	 * next-line hardware prefetchers.
+	 */
+	sz += 2 * RTE_CACHE_LINE_SIZE;
+
+	return sz;
+}
@@ -0,0 +1,496 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2019 Intel Corporation
+ */
+
+#ifndef _RTE_STACK_ELIM_H_
+#define _RTE_STACK_ELIM_H_
+
+#include <rte_branch_prediction.h>
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_pause.h>
+#include <rte_prefetch.h>
+
+/* Number of pause iterations a push waits for a pop to take its offer. */
+#define RTE_STACK_ELIM_WAIT 64
+
+#define RTE_STACK_ELIM_TAG_INC (UINT64_C(1) << 32)
+#define RTE_STACK_ELIM_TAG_MASK (~(RTE_STACK_ELIM_TAG_INC - 1))
+
+#if defined(RTE_STACK_LF_SUPPORTED)
+
+/**
+ * @internal Return the index of the lists of the calling thread's socket.
+ */
+static __rte_always_inline unsigned int
+__rte_stack_elim_socket_idx(struct rte_stack *s)
+{
+	unsigned int socket_id = rte_socket_id();
+
+	/* Unregistered non-EAL threads use the first socket. */
+	return socket_id < RTE_MAX_NUMA_NODES ?
+		s->stack_elim.socket_idx[socket_id] : 0;
+}
+
+static __rte_always_inline struct rte_stack_lf_list *
+__rte_stack_elim_list(struct rte_stack *s, unsigned int socket_idx, int used)
+{
+	struct rte_stack_elim_socket *sock = &s->stack_elim.sockets[socket_idx];
+
+	return used ? &sock->used : &sock->free;
+}
+
+static __rte_always_inline unsigned int
+__rte_stack_elim_count(struct rte_stack *s)
+{
+	unsigned int i, count = 0;
+
+	/* Same approximation as the lock-free stack count: the objects being
+	 * pushed or exchanged through an elimination slot are not counted.
+	 */
+	for (i = 0; i < s->stack_elim.n_sockets; i++)
+		count += rte_atomic_load_explicit(&s->stack_elim.sockets[i].used.len,
+				rte_memory_order_relaxed);
+
+	return count;
+}
+
+/**
+ * @internal Reserve up to num elements of a list, return the number reserved.
+ */
+static __rte_always_inline unsigned int
+__rte_stack_elim_reserve(struct rte_stack_lf_list *list, unsigned int num)
+{
+	uint64_t len, n;
+
+	len = rte_atomic_load_explicit(&list->len, rte_memory_order_relaxed);
+
+	do {
+		n = RTE_MIN(len, (uint64_t)num);
+		if (n == 0)
+			return 0;
+		/* len is updated on failure */
+	} while (!rte_atomic_compare_exchange_weak_explicit(&list->len,
+				&len, len - n,
+				rte_memory_order_acquire,
+				rte_memory_order_relaxed));
+
+	return (unsigned int)n;
+}
+
+/**
+ * @internal Try once to push a linked list of elements on a list.
+ * On failure, old_head is updated with the current list head.
+ */
+static __rte_always_inline int
+__rte_stack_elim_try_push(struct rte_stack_lf_list *list,
+			  struct rte_stack_lf_head *old_head,
+			  struct rte_stack_lf_elem *first,
+			  struct rte_stack_lf_elem *last,
+			  unsigned int num)
+{
+	struct rte_stack_lf_head new_head;
+
+	new_head.top = first;
+	new_head.cnt = old_head->cnt + 1;
+
+	last->next = old_head->top;
+
+	/* Release: the element writes are visible before the head update. */
+	if (rte_atomic128_cmp_exchange((rte_int128_t *)&list->head,
+			(rte_int128_t *)old_head, (rte_int128_t *)&new_head,
+			1, rte_memory_order_release,
+			rte_memory_order_relaxed) == 0)
+		return 0;
+
+	rte_atomic_fetch_add_explicit(&list->len, num, rte_memory_order_release);
+	return 1;
+}
+
+/**
+ * @internal Try once to pop num reserved elements from a list.
+ * On failure, NULL is returned and old_head is updated with the current list
+ * head.
+ */
+static __rte_always_inline struct rte_stack_lf_elem *
+__rte_stack_elim_try_pop(struct rte_stack_lf_list *list,
+			 struct rte_stack_lf_head *old_head,
+			 unsigned int num,
+			 void **obj_table,
+			 struct rte_stack_lf_elem **last)
+{
+	struct rte_stack_lf_head new_head;
+	struct rte_stack_lf_elem *tmp;
+	unsigned int i;
+
+	/* Order the element reads after the head read, see the lock-free
+	 * stack for the rationale of the memory orders used below.
+	 */
+	rte_atomic_thread_fence(rte_memory_order_acquire);
+
+	tmp = old_head->top;
+
+	for (i = 0; i < num && tmp != NULL; i++) {
+		rte_prefetch0(tmp->next);
+		if (obj_table)
+			obj_table[i] = tmp->data;
+		*last = tmp;
+		tmp = tmp->next;
+	}
+
+	/* The list was modified while traversing it. */
+	if (i != num) {
+		*old_head = list->head;
+		return NULL;
+	}
+
+	new_head.top = tmp;
+	new_head.cnt = old_head->cnt + 1;
+
+	if (rte_atomic128_cmp_exchange((rte_int128_t *)&list->head,
+			(rte_int128_t *)old_head, (rte_int128_t *)&new_head,
+			0, rte_memory_order_relaxed,
+			rte_memory_order_relaxed) == 0)
+		return NULL;
+
+	return old_head->top;
+}
+
+/**
+ * @internal Offer a linked list of num elements to a concurrent pop through
+ * an elimination slot. Return 1 if a pop took the elements, 0 if the offer
+ * was withdrawn or could not be made.
+ */
+static __rte_always_inline int
+__rte_stack_elim_offer(struct rte_stack_elim_slot *slot,
+		       struct rte_stack_lf_elem *first,
+		       unsigned int num)
+{
+	struct rte_stack_lf_head old, offer, withdrawn;
+	unsigned int i;
+
+	/* A torn read makes the CAS below fail. */
+	old = slot->chain;
+	if (old.top != NULL)
+		return 0;
+
+	offer.top = first;
+	offer.cnt = (old.cnt & RTE_STACK_ELIM_TAG_MASK) +
+		RTE_STACK_ELIM_TAG_INC + num;
+
+	/* Release: the element writes are visible before the offer. */
+	if (rte_atomic128_cmp_exchange((rte_int128_t *)&slot->chain,
+			(rte_int128_t *)&old, (rte_int128_t *)&offer,
+			0, rte_memory_order_release,
+			rte_memory_order_relaxed) == 0)
+		return 0;
+
+	/* A pop taking the offer bumps the tag. */
+	for (i = 0; i < RTE_STACK_ELIM_WAIT; i++) {
+		if (rte_atomic_load_explicit(
+				(uint64_t __rte_atomic *)&slot->chain.cnt,
+				rte_memory_order_relaxed) != offer.cnt)
+			return 1;
+		rte_pause();
+	}
+
+	withdrawn.top = NULL;
+	withdrawn.cnt = (offer.cnt & RTE_STACK_ELIM_TAG_MASK) +
+		RTE_STACK_ELIM_TAG_INC;
+
+	/* Only one of this CAS and the one of the pop can succeed. */
+	return rte_atomic128_cmp_exchange((rte_int128_t *)&slot->chain,
+			(rte_int128_t *)&offer, (rte_int128_t *)&withdrawn,
+			0, rte_memory_order_relaxed,
+			rte_memory_order_relaxed) == 0;
+}
+
+/**
+ * @internal Take a linked list of num elements offered by a concurrent push,
+ * store its objects in obj_table. Return the first element, or NULL if no
+ * offer of num elements was found.
+ */
+static __rte_always_inline struct rte_stack_lf_elem *
+__rte_stack_elim_take(struct rte_stack_elim_socket *sock,
+		      unsigned int num,
+		      void **obj_table,
+		      struct rte_stack_lf_elem **last)
+{
+	struct rte_stack_lf_head old, taken;
+	struct rte_stack_lf_elem *tmp;
+	unsigned int i;
+
+	for (i = 0; i < RTE_STACK_ELIM_SLOTS; i++) {
+		struct rte_stack_elim_slot *slot = &sock->slots[i];
+
+		old = slot->chain;
+		if (old.top == NULL || (uint32_t)old.cnt != num)
+			continue;
+
+		taken.top = NULL;
+		taken.cnt = (old.cnt & RTE_STACK_ELIM_TAG_MASK) +
+			RTE_STACK_ELIM_TAG_INC;
+
+		if (rte_atomic128_cmp_exchange((rte_int128_t *)&slot->chain,
+				(rte_int128_t *)&old, (rte_int128_t *)&taken,
+				0, rte_memory_order_acquire,
+				rte_memory_order_relaxed) != 0)
+			break;
+	}
+
+	if (i == RTE_STACK_ELIM_SLOTS)
+		return NULL;
+
+	for (tmp = old.top, i = 0; i < num; i++, tmp = tmp->next) {
+		obj_table[i] = tmp->data;
+		*last = tmp;
+	}
+
+	return old.top;
+}
+
+/**
+ * @internal Pop num elements from the lists of all sockets, starting with the
+ * local one, and chain them. Used to get free elements for a push, and to
+ * steal objects from the other sockets when the local list is short.
+ * Return NULL if the lists do not hold num elements in total.
+ */
+static __rte_always_inline struct rte_stack_lf_elem *
+__rte_stack_elim_gather(struct rte_stack *s,
+			unsigned int socket_idx,
+			int used,
+			unsigned int num,
+			void **obj_table,
+			struct rte_stack_lf_elem **last)
+{
+	struct rte_stack_lf_elem *first = NULL, *piece, *piece_last = NULL;
+	unsigned int n_sockets = s->stack_elim.n_sockets;
+	unsigned int reserved[RTE_MAX_NUMA_NODES];
+	unsigned int i, idx, n_lists, total = 0;
+
+	for (n_lists = 0, idx = socket_idx; n_lists < n_sockets && total < num;
+			n_lists++, idx = idx + 1 < n_sockets ? idx + 1 : 0) {
+		reserved[n_lists] = __rte_stack_elim_reserve(
+				__rte_stack_elim_list(s, idx, used), num - total);
+		total += reserved[n_lists];
+	}
+
+	if (unlikely(total < num)) {
+		for (i = 0, idx = socket_idx; i < n_lists;
+				i++, idx = idx + 1 < n_sockets ? idx + 1 : 0)
+			if (reserved[i] != 0)
+				rte_atomic_fetch_add_explicit(
+					&__rte_stack_elim_list(s, idx, used)->len,
+					reserved[i], rte_memory_order_relaxed);
+		return NULL;
+	}
+
+	for (i = 0, idx = socket_idx, total = 0; i < n_lists;
+			i++, idx = idx + 1 < n_sockets ? idx + 1 : 0) {
+		struct rte_stack_lf_list *list;
+		struct rte_stack_lf_head old_head;
+
+		if (reserved[i] == 0)
+			continue;
+
+		list = __rte_stack_elim_list(s, idx, used);
+
+		/* If a torn read occurs, the CAS will fail and set old_head
+		 * to the correct/latest value.
+		 */
+		old_head = list->head;
+
+		do {
+			rte_prefetch0(old_head.top);
+			piece = __rte_stack_elim_try_pop(list, &old_head,
+					reserved[i],
+					obj_table ? &obj_table[total] : NULL,
+					last);
+		} while (piece == NULL);
+
+		if (first == NULL)
+			first = piece;
+		else
+			piece_last->next = piece;
+		piece_last = *last;
+		total += reserved[i];
+	}
+
+	return first;
+}
+
+/**
+ * @internal Push several objects on the elimination stack (MT-safe).
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to push on the stack from the obj_table.
+ * @return
+ *   Actual number of objects pushed (either 0 or *n*).
+ */
+static __rte_always_inline unsigned int
+__rte_stack_elim_push(struct rte_stack *s,
+		      void * const *obj_table,
+		      unsigned int n)
+{
+	struct rte_stack_lf_elem *tmp, *first, *last = NULL;
+	struct rte_stack_elim_socket *sock;
+	struct rte_stack_lf_head old_head;
+	struct rte_stack_elim_slot *slot;
+	unsigned int socket_idx, i;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	socket_idx = __rte_stack_elim_socket_idx(s);
+	sock = &s->stack_elim.sockets[socket_idx];
+
+	/* Pop n free elements, from the other sockets if needed */
+	first = __rte_stack_elim_gather(s, socket_idx, 0, n, NULL, &last);
+	if (unlikely(first == NULL))
+		return 0;
+
+	/* Construct the list elements */
+	for (tmp = first, i = 0; i < n; i++, tmp = tmp->next)
+		tmp->data = obj_table[n - i - 1];
+
+	slot = &sock->slots[rte_lcore_id() % RTE_STACK_ELIM_SLOTS];
+	old_head = sock->used.head;
+
+	/* On contention for the list head, try to hand the elements over to a
+	 * concurrent pop before retrying.
+	 */
+	while (!__rte_stack_elim_try_push(&sock->used, &old_head,
+			first, last, n)) {
+		if (__rte_stack_elim_offer(slot, first, n))
+			return n;
+	}
+
+	return n;
+}
+
+/**
+ * @internal Pop several objects from the elimination stack (MT-safe).
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to pull from the stack.
+ * @return
+ *   Actual number of objects popped (either 0 or *n*).
+ */
+static __rte_always_inline unsigned int
+__rte_stack_elim_pop(struct rte_stack *s, void **obj_table, unsigned int n)
+{
+	struct rte_stack_lf_elem *first, *last = NULL;
+	struct rte_stack_elim_socket *sock;
+	struct rte_stack_lf_head old_head;
+	unsigned int socket_idx, reserved;
+
+	if (unlikely(n == 0))
+		return 0;
+
+	socket_idx = __rte_stack_elim_socket_idx(s);
+	sock = &s->stack_elim.sockets[socket_idx];
+
+	reserved = __rte_stack_elim_reserve(&sock->used, n);
+	if (likely(reserved == n)) {
+		old_head = sock->used.head;
+
+		/* On contention for the list head, look for a concurrent
+		 * push to take the objects from before retrying.
+		 */
+		while ((first = __rte_stack_elim_try_pop(&sock->used,
+				&old_head, n, obj_table, &last)) == NULL) {
+			first = __rte_stack_elim_take(sock, n, obj_table,
+					&last);
+			if (first != NULL) {
+				rte_atomic_fetch_add_explicit(&sock->used.len,
+						n, rte_memory_order_relaxed);
+				break;
+			}
+		}
+	} else {
+		if (reserved != 0)
+			rte_atomic_fetch_add_explicit(&sock->used.len,
+					reserved, rte_memory_order_relaxed);
+
+		/* The local list is short: try a concurrent push, then steal
+		 * from the other sockets.
+		 */
+		first = __rte_stack_elim_take(sock, n, obj_table, &last);
+		if (first == NULL)
+			first = __rte_stack_elim_gather(s, socket_idx, 1, n,
+					obj_table, &last);
+		if (unlikely(first == NULL))
+			return 0;
+	}
+
+	/* Push the list elements to the local free list */
+	__rte_stack_lf_push_elems(&sock->free, first, last, n);
+
+	return n;
+}
+
+#else /* RTE_STACK_LF_SUPPORTED */
+
+static __rte_always_inline unsigned int
+__rte_stack_elim_count(struct rte_stack *s)
+{
+	RTE_SET_USED(s);
+
+	return 0;
+}
+
+static __rte_always_inline unsigned int
+__rte_stack_elim_push(struct rte_stack *s,
+		      void * const *obj_table,
+		      unsigned int n)
+{
+	RTE_SET_USED(s);
+	RTE_SET_USED(obj_table);
+	RTE_SET_USED(n);
+
+	return 0;
+}
+
+static __rte_always_inline unsigned int
+__rte_stack_elim_pop(struct rte_stack *s, void **obj_table, unsigned int n)
+{
+	RTE_SET_USED(s);
+	RTE_SET_USED(obj_table);
+	RTE_SET_USED(n);
+
+	return 0;
+}
+
+#endif /* RTE_STACK_LF_SUPPORTED */
+
+/**
+ * @internal Initialize an elimination stack.
+ *
+ * @param s
+ *   A pointer to the stack structure.
+ * @param count
+ *   The size of the stack.
+ */
+void
+rte_stack_elim_init(struct rte_stack *s, unsigned int count);
+
+/**
+ * @internal Return the memory required for an elimination stack.
+ *
+ * @param count
+ *   The size of the stack.
+ * @return
+ *   The bytes to allocate for an elimination stack.
+ */
+ssize_t
+rte_stack_elim_get_memsize(unsigned int count);
+
+#endif /* _RTE_STACK_ELIM_H_ */
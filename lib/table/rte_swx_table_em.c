@@ -9,6 +9,9 @@
 #include <rte_prefetch.h>
 #include <rte_jhash.h>
 #include <rte_hash_crc.h>
+#if defined(RTE_ARCH_X86)
+#include <rte_vect.h>
+#endif
 
 #include "rte_swx_keycmp.h"
 #include "rte_swx_table_em.h"
@@ -143,6 +146,32 @@ bkt_keycmp(struct table *t,
 	return t->keycmp_func(bkt_key, input_key, t->params.key_size);
 }
 
+/* Return: signature match bitmask, with bit i set when the signature of the
+ * bucket key position i is equal to the input signature.
+ */
+static inline uint32_t
+bkt_sig_match(struct bucket_extension *bkt, uint32_t input_sig)
+{
+#if defined(RTE_ARCH_X86)
+	__m128i bkt_sig, sig, cmp;
+
+	bkt_sig = _mm_loadl_epi64((const __m128i *)bkt->sig);
+	sig = _mm_set1_epi16((int16_t)input_sig);
+	cmp = _mm_cmpeq_epi16(bkt_sig, sig);
+
+	return _mm_movemask_epi8(_mm_packs_epi16(cmp, cmp)) & 0xF;
+#else
+	uint32_t mask0, mask1, mask2, mask3;
+
+	mask0 = (input_sig == bkt->sig[0]) ? 1 << 0 : 0;
+	mask1 = (input_sig == bkt->sig[1]) ? 1 << 1 : 0;
+	mask2 = (input_sig == bkt->sig[2]) ? 1 << 2 : 0;
+	mask3 = (input_sig == bkt->sig[3]) ? 1 << 3 : 0;
+
+	return (mask0 | mask1) | (mask2 | mask3);
+#endif
+}
+
 static inline void
 bkt_key_install(struct table *t,
 		struct bucket_extension *bkt,
@@ -526,31 +555,12 @@ table_lookup(void *table,
 
 	case 1: {
 		struct bucket_extension *bkt = m->bkt;
-		uint32_t input_sig = m->input_sig;
-		uint32_t bkt_sig0, bkt_sig1, bkt_sig2, bkt_sig3;
-		uint32_t mask0 = 0, mask1 = 0, mask2 = 0, mask3 = 0, mask_all;
+		uint32_t mask_all = bkt_sig_match(bkt, m->input_sig);
 		uint32_t sig_match = LUT_MATCH;
 		uint32_t sig_match_many = LUT_MATCH_MANY;
 		uint32_t sig_match_pos = LUT_MATCH_POS;
 		uint32_t bkt_key_id;
 
-		bkt_sig0 = input_sig ^ bkt->sig[0];
-		if (!bkt_sig0)
-			mask0 = 1 << 0;
-
-		bkt_sig1 = input_sig ^ bkt->sig[1];
-		if (!bkt_sig1)
-			mask1 = 1 << 1;
-
-		bkt_sig2 = input_sig ^ bkt->sig[2];
-		if (!bkt_sig2)
-			mask2 = 1 << 2;
-
-		bkt_sig3 = input_sig ^ bkt->sig[3];
-		if (!bkt_sig3)
-			mask3 = 1 << 3;
-
-		mask_all = (mask0 | mask1) | (mask2 | mask3);
 		sig_match = (sig_match >> mask_all) & 1;
 		sig_match_many = (sig_match_many >> mask_all) & 1;
 		sig_match_pos = (sig_match_pos >> (mask_all << 1)) & 3;
@@ -7,7 +7,9 @@
 
 #include <rte_common.h>
 #include <rte_cycles.h>
+#include <rte_pause.h>
 #include <rte_prefetch.h>
+#include <rte_stdatomic.h>
 #include <rte_jhash.h>
 #include <rte_hash_crc.h>
 
@@ -75,12 +77,18 @@ table_keycpy(void *dst, void *src, uint32_t n_bytes)
 #define TABLE_KEYS_PER_BUCKET_LOG2 2
 
 #define TABLE_BUCKET_USEFUL_SIZE \
-	(TABLE_KEYS_PER_BUCKET * (sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t)))
+	(sizeof(uint32_t) + \
+	 TABLE_KEYS_PER_BUCKET * (sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint8_t)))
 
 #define TABLE_BUCKET_PAD_SIZE \
 	(RTE_CACHE_LINE_SIZE - TABLE_BUCKET_USEFUL_SIZE)
 
 struct table_bucket {
+	/* Bucket version: odd while a bucket update is in progress, incremented by 2 for each
+	 * bucket update. Used by the lookup operation to detect the concurrent bucket updates and
+	 * by the update operations to serialize the concurrent updates of the same bucket.
+	 */
+	RTE_ATOMIC(uint32_t) version;
 	uint32_t time[TABLE_KEYS_PER_BUCKET];
 	uint32_t sig[TABLE_KEYS_PER_BUCKET];
 	uint8_t key_timeout_id[TABLE_KEYS_PER_BUCKET];
@@ -141,6 +149,9 @@ struct table_params {
 	/* Number of key timeout values. */
 	uint32_t n_key_timeouts;
 
+	/* Concurrent mode: the table is updated from multiple threads. */
+	int concurrent;
+
 	/* Total memory size. */
 	size_t total_size;
 };
@@ -239,6 +250,12 @@ table_params_get(struct table_params *p, struct rte_swx_table_learner_params *pa
 	for ( ; i < p->n_key_timeouts; i++)
 		p->key_timeout[i] = p->key_timeout[0];
 
+	if (params->concurrent &&
+	    params->action_data_size > RTE_SWX_TABLE_LEARNER_CONCURRENT_ACTION_DATA_SIZE_MAX)
+		return -EINVAL;
+
+	p->concurrent = params->concurrent;
+
 	/* Total size. */
 	p->total_size = sizeof(struct table) + p->n_buckets * p->bucket_size;
 
@@ -264,6 +281,61 @@ table_bucket_data_get(struct table *t, struct table_bucket *b, size_t bucket_key
 				   (bucket_key_pos << t->params.data_size_log2)];
 }
 
+/* Return: 1 when the bucket lock was taken, 0 when the bucket is being updated by another thread. */
+static inline int
+table_bucket_lock(struct table_bucket *b, uint32_t *version)
+{
+	uint32_t v = rte_atomic_load_explicit(&b->version, rte_memory_order_relaxed);
+
+	if (v & 1)
+		return 0;
+
+	if (!rte_atomic_compare_exchange_strong_explicit(&b->version,
+							  &v,
+							  v + 1,
+							  rte_memory_order_acquire,
+							  rte_memory_order_relaxed))
+		return 0;
+
+	/* Order the bucket writes after the version update. */
+	rte_atomic_thread_fence(rte_memory_order_release);
+
+	*version = v + 1;
+	return 1;
+}
+
+static inline void
+table_bucket_unlock(struct table_bucket *b, uint32_t version)
+{
+	rte_atomic_store_explicit(&b->version, version + 1, rte_memory_order_release);
+}
+
+/* Return: the bucket position of the input key or TABLE_KEYS_PER_BUCKET when not found. */
+static inline uint32_t
+table_bucket_search(struct table *t,
+		    struct table_bucket *b,
+		    uint8_t *input_key,
+		    uint32_t input_sig,
+		    uint64_t input_time)
+{
+	uint32_t i;
+
+	for (i = 0; i < TABLE_KEYS_PER_BUCKET; i++) {
+		uint64_t time = b->time[i];
+		uint32_t sig = b->sig[i];
+		uint8_t *key = table_bucket_key_get(t, b, i);
+
+		time <<= 32;
+
+		if ((time > input_time) &&
+		    (sig == input_sig) &&
+		    t->params.keycmp_func(key, input_key, t->params.key_size))
+			return i;
+	}
+
+	return TABLE_KEYS_PER_BUCKET;
+}
+
 static inline size_t
 table_entry_id_get(struct table *t, struct table_bucket *b, size_t bucket_key_pos)
 {
@@ -352,6 +424,12 @@ struct mailbox {
 
 	/* State. */
 	int state;
+
+	/* Writer: lookup state 1. Reader(s): lookup caller. Concurrent mode only: copy of the
+	 * action data of the key found, taken while the bucket was not being updated.
+	 */
+	uint64_t action_data[RTE_ALIGN_CEIL(RTE_SWX_TABLE_LEARNER_CONCURRENT_ACTION_DATA_SIZE_MAX,
+					    sizeof(uint64_t)) / sizeof(uint64_t)];
 };
 
 uint64_t
@@ -360,6 +438,24 @@ rte_swx_table_learner_mailbox_size_get(void)
 	return sizeof(struct mailbox);
 }
 
+/* Return: 1 when the bucket key position still holds the mailbox key, 0 otherwise. */
+static inline int
+table_bucket_key_check(struct table *t,
+		       struct mailbox *m,
+		       size_t bucket_key_pos,
+		       uint64_t input_time)
+{
+	struct table_bucket *b = m->bucket;
+	uint64_t time = b->time[bucket_key_pos];
+	uint8_t *key = table_bucket_key_get(t, b, bucket_key_pos);
+
+	time <<= 32;
+
+	return (time > input_time) &&
+	       (b->sig[bucket_key_pos] == m->input_sig) &&
+	       t->params.keycmp_func(key, m->input_key, t->params.key_size);
+}
+
 int
 rte_swx_table_learner_lookup(void *table,
 			     void *mailbox,
@@ -398,34 +494,49 @@ rte_swx_table_learner_lookup(void *table,
 
 	case 1: {
 		struct table_bucket *b = m->bucket;
-		uint32_t i;
+		uint64_t *data = NULL;
+		uint64_t data_action_id = 0;
+		uint32_t version, i;
+
+		/* Search the input key through the bucket keys. The search is repeated when the
+		 * bucket is updated by another thread in the meantime. The action ID and, in
+		 * concurrent mode, the action data are read as part of the search, so that they
+		 * belong to the key that was found, even if its position is reused later on.
+		 */
+		for ( ; ; ) {
+			version = rte_atomic_load_explicit(&b->version, rte_memory_order_acquire);
+			if (version & 1) {
+				rte_pause();
+				continue;
+			}
 
-		/* Search the input key through the bucket keys. */
-		for (i = 0; i < TABLE_KEYS_PER_BUCKET; i++) {
-			uint64_t time = b->time[i];
-			uint32_t sig = b->sig[i];
-			uint8_t *key = table_bucket_key_get(t, b, i);
+			i = table_bucket_search(t, b, m->input_key, m->input_sig, input_time);
+			if (i < TABLE_KEYS_PER_BUCKET) {
+				data = table_bucket_data_get(t, b, i);
+				data_action_id = data[0];
 
-			time <<= 32;
+				if (t->params.concurrent)
+					memcpy(m->action_data, &data[1], t->params.action_data_size);
+			}
 
-			if ((time > input_time) &&
-			    (sig == m->input_sig) &&
-			    t->params.keycmp_func(key, m->input_key, t->params.key_size)) {
-				uint64_t *data = table_bucket_data_get(t, b, i);
+			rte_atomic_thread_fence(rte_memory_order_acquire);
+			if (rte_atomic_load_explicit(&b->version, rte_memory_order_relaxed) == version)
+				break;
+		}
 
-				/* Hit. */
-				rte_prefetch0(data);
+		if (i < TABLE_KEYS_PER_BUCKET) {
+			/* Hit. */
+			rte_prefetch0(data);
 
-				m->hit = 1;
-				m->bucket_key_pos = i;
-				m->state = 0;
+			m->hit = 1;
+			m->bucket_key_pos = i;
+			m->state = 0;
 
-				*action_id = data[0];
-				*action_data = (uint8_t *)&data[1];
-				*entry_id = table_entry_id_get(t, b, i);
-				*hit = 1;
-				return 1;
-			}
+			*action_id = data_action_id;
+			*action_data = (uint8_t *)(t->params.concurrent ? m->action_data : &data[1]);
+			*entry_id = table_entry_id_get(t, b, i);
+			*hit = 1;
+			return 1;
 		}
 
 		/* Miss. */
@@ -456,7 +567,7 @@ rte_swx_table_learner_rearm(void *table,
 	struct table_bucket *b;
 	size_t bucket_key_pos;
 	uint64_t key_timeout;
-	uint32_t key_timeout_id;
+	uint32_t key_timeout_id, time, version;
 
 	if (!m->hit)
 		return;
@@ -466,7 +577,28 @@ rte_swx_table_learner_rearm(void *table,
 
 	key_timeout_id = b->key_timeout_id[bucket_key_pos];
 	key_timeout = t->params.key_timeout[key_timeout_id];
-	b->time[bucket_key_pos] = (input_time + key_timeout) >> 32;
+	time = (input_time + key_timeout) >> 32;
+
+	/* The key time is stored with a granularity of 2^32 cycles, so most of the rearm operations
+	 * on a frequently hit key do not change it. Skip the write in this case, as the bucket cache
+	 * line is otherwise bounced between all the CPU cores hitting the same key.
+	 */
+	if (b->time[bucket_key_pos] == time)
+		return;
+
+	if (!t->params.concurrent) {
+		b->time[bucket_key_pos] = time;
+		return;
+	}
+
+	if (!table_bucket_lock(b, &version))
+		return;
+
+	/* Do not revive the key if it was deleted or replaced in the meantime. */
+	if (table_bucket_key_check(t, m, bucket_key_pos, input_time))
+		b->time[bucket_key_pos] = time;
+
+	table_bucket_unlock(b, version);
 }
 
 void
@@ -480,6 +612,7 @@ rte_swx_table_learner_rearm_new(void *table,
 	struct table_bucket *b;
 	size_t bucket_key_pos;
 	uint64_t key_timeout;
+	uint32_t time, version;
 
 	if (!m->hit)
 		return;
@@ -489,20 +622,39 @@ rte_swx_table_learner_rearm_new(void *table,
 
 	key_timeout_id &= t->params.n_key_timeouts - 1;
 	key_timeout = t->params.key_timeout[key_timeout_id];
-	b->time[bucket_key_pos] = (input_time + key_timeout) >> 32;
-	b->key_timeout_id[bucket_key_pos] = (uint8_t)key_timeout_id;
+	time = (input_time + key_timeout) >> 32;
+
+	/* Skip the write when nothing changes, same as for rearm. */
+	if ((b->time[bucket_key_pos] == time) &&
+	    (b->key_timeout_id[bucket_key_pos] == key_timeout_id))
+		return;
+
+	if (!t->params.concurrent) {
+		b->time[bucket_key_pos] = time;
+		b->key_timeout_id[bucket_key_pos] = (uint8_t)key_timeout_id;
+		return;
+	}
+
+	if (!table_bucket_lock(b, &version))
+		return;
+
+	/* Do not revive the key if it was deleted or replaced in the meantime. */
+	if (table_bucket_key_check(t, m, bucket_key_pos, input_time)) {
+		b->time[bucket_key_pos] = time;
+		b->key_timeout_id[bucket_key_pos] = (uint8_t)key_timeout_id;
+	}
+
+	table_bucket_unlock(b, version);
 }
 
-uint32_t
-rte_swx_table_learner_add(void *table,
-			  void *mailbox,
-			  uint64_t input_time,
-			  uint64_t action_id,
-			  uint8_t *action_data,
-			  uint32_t key_timeout_id)
+static inline uint32_t
+table_add(struct table *t,
+	  struct mailbox *m,
+	  uint64_t input_time,
+	  uint64_t action_id,
+	  uint8_t *action_data,
+	  uint32_t key_timeout_id)
 {
-	struct table *t = table;
-	struct mailbox *m = mailbox;
 	struct table_bucket *b = m->bucket;
 	uint64_t key_timeout;
 	uint32_t i;
@@ -546,16 +698,19 @@ rte_swx_table_learner_add(void *table,
 			uint8_t *key = table_bucket_key_get(t, b, i);
 			uint64_t *data = table_bucket_data_get(t, b, i);
 
-			/* Install the key and the key timeout. */
-			b->time[i] = (input_time + key_timeout) >> 32;
+			/* Install the key data first, as the position may be reused from a previous
+			 * key, then the key, then the key time, which makes the key visible.
+			 */
+			data[0] = action_id;
+			if (t->params.action_data_size && action_data)
+				memcpy(&data[1], action_data, t->params.action_data_size);
+
 			b->sig[i] = m->input_sig;
 			b->key_timeout_id[i] = (uint8_t)key_timeout_id;
 			table_keycpy(key, m->input_key, t->params.key_size);
 
-			/* Install the key data. */
-			data[0] = action_id;
-			if (t->params.action_data_size && action_data)
-				memcpy(&data[1], action_data, t->params.action_data_size);
+			rte_atomic_thread_fence(rte_memory_order_release);
+			b->time[i] = (input_time + key_timeout) >> 32;
 
 			/* Mailbox. */
 			m->hit = 1;
@@ -569,19 +724,73 @@ rte_swx_table_learner_add(void *table,
 	return 1;
 }
 
+uint32_t
+rte_swx_table_learner_add(void *table,
+			  void *mailbox,
+			  uint64_t input_time,
+			  uint64_t action_id,
+			  uint8_t *action_data,
+			  uint32_t key_timeout_id)
+{
+	struct table *t = table;
+	struct mailbox *m = mailbox;
+	struct table_bucket *b = m->bucket;
+	uint32_t version, bucket_key_pos, status;
+
+	if (!t->params.concurrent)
+		return table_add(t, m, input_time, action_id, action_data, key_timeout_id);
+
+	/* Concurrent mode: the input key could have been added, deleted or replaced by another
+	 * thread since the lookup, so the bucket is searched again once locked. The add operation
+	 * fails when the bucket is being updated by another thread.
+	 */
+	if (!table_bucket_lock(b, &version))
+		return 1;
+
+	bucket_key_pos = table_bucket_search(t, b, m->input_key, m->input_sig, input_time);
+	m->hit = (bucket_key_pos < TABLE_KEYS_PER_BUCKET) ? 1 : 0;
+	m->bucket_key_pos = bucket_key_pos;
+
+	status = table_add(t, m, input_time, action_id, action_data, key_timeout_id);
+
+	table_bucket_unlock(b, version);
+
+	return status;
+}
+
 void
-rte_swx_table_learner_delete(void *table __rte_unused,
+rte_swx_table_learner_delete(void *table,
 			     void *mailbox)
 {
+	struct table *t = table;
 	struct mailbox *m = mailbox;
+	struct table_bucket *b = m->bucket;
+	uint32_t version;
 
-	if (m->hit) {
-		struct table_bucket *b = m->bucket;
+	if (!m->hit)
+		return;
 
+	if (!t->params.concurrent) {
 		/* Expire the key. */
 		b->time[m->bucket_key_pos] = 0;
 
 		/* Mailbox. */
 		m->hit = 0;
+		return;
 	}
+
+	/* Concurrent mode: unlike add, delete waits for the bucket to be available, as the key
+	 * would otherwise stay in the table until its timeout.
+	 */
+	while (!table_bucket_lock(b, &version))
+		rte_pause();
+
+	/* Expire the key, unless it was deleted or replaced in the meantime. */
+	if (table_bucket_key_check(t, m, m->bucket_key_pos, 0))
+		b->time[m->bucket_key_pos] = 0;
+
+	table_bucket_unlock(b, version);
+
+	/* Mailbox. */
+	m->hit = 0;
 }
@@ -44,6 +44,15 @@ extern "C" {
  *      d) Do nothing: Keep the expiration timer of the current input key running down. This key
  *              will thus expire naturally, unless it is hit again as part of a subsequent lookup
  *              operation, when the key timer can be rearmed or re-added to prolong its life.
+ *
+ * In concurrent mode, the same table can be looked up and updated from multiple threads, e.g. by
+ * the workers of the same pipeline running on different CPU cores. The lookup operation is
+ * lock-free, while the update operations of the same table bucket are serialized by a per-bucket
+ * lock, which is only held for the duration of the bucket update. The add operation fails instead
+ * of waiting when the bucket is locked by another thread. The action ID returned by the lookup
+ * operation always belongs to the input key. The action data returned by the lookup operation is
+ * read in place, so it is not protected against a concurrent add operation for the same key, nor
+ * against the reuse of the key position by another key after the input key is deleted.
  */
 
 #include <stdint.h>
@@ -58,6 +67,11 @@ extern "C" {
 #define RTE_SWX_TABLE_LEARNER_N_KEY_TIMEOUTS_MAX 16
 #endif
 
+/** Maximum action data size (in bytes) of a learner table in concurrent mode. */
+#ifndef RTE_SWX_TABLE_LEARNER_CONCURRENT_ACTION_DATA_SIZE_MAX
+#define RTE_SWX_TABLE_LEARNER_CONCURRENT_ACTION_DATA_SIZE_MAX 64
+#endif
+
 /** Learner table creation parameters. */
 struct rte_swx_table_learner_params {
 	/** Key size in bytes. Must be non-zero. */
@@ -97,6 +111,13 @@ struct rte_swx_table_learner_params {
 	 * than or equal to *RTE_SWX_TABLE_LEARNER_N_KEY_TIMEOUTS_MAX*.
 	 */
 	uint32_t n_key_timeouts;
+
+	/** Concurrent mode. When non-zero, the table can be looked up and updated from multiple
+	 * threads at the same time. The lookup operation then returns a copy of the action data
+	 * stored in the mailbox, so the *action_data_size* must not be bigger than
+	 * *RTE_SWX_TABLE_LEARNER_CONCURRENT_ACTION_DATA_SIZE_MAX*.
+	 */
+	int concurrent;
 };
 
 /**
@@ -195,7 +216,9 @@ rte_swx_table_learner_timeout_update(void *table,
  *   when the function returns 1 and *hit* is set to true.
  * @param[out] action_data
  *   Action data for the *action_id* action. Must point to a valid array of table *action_data_size*
- *   bytes. Only valid when the function returns 1 and *hit* is set to true.
+ *   bytes. Only valid when the function returns 1 and *hit* is set to true. In concurrent mode, it
+ *   points to a copy stored in the *mailbox*, which stays valid until the next lookup operation
+ *   using the same *mailbox*.
  * @param[out] entry_id
  *   Table entry unique ID. Must point to a valid 32-bit variable. Only valid when the function
  *   returns 1 and *hit* is set to true.
@@ -237,7 +260,7 @@ rte_swx_table_learner_lookup(void *table,
  * @param[in] key_timeout_id
  *   Key timeout ID.
  * @return
- *   0 on success, 1 or error (table full).
+ *   0 on success, 1 or error (table full or, in concurrent mode, bucket locked by another thread).
  */
 __rte_experimental
 uint32_t
@@ -12,6 +12,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "table_hash_key_x86.h"
 
 #include "table_log.h"
 
@@ -78,6 +79,7 @@ struct rte_table_hash {
 	uint64_t key_mask[2];
 	rte_table_hash_op_hash f_hash;
 	uint64_t seed;
+	table_hash_key_cmp_t f_cmp;
 
 	/* Extendible buckets */
 	uint32_t n_buckets_ext;
@@ -213,6 +215,7 @@ rte_table_hash_create_key16_lru(void *params,
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	f->f_cmp = table_hash_key_cmp_select(KEY_SIZE);
 
 	if (p->key_mask != NULL) {
 		f->key_mask[0] = ((uint64_t *)p->key_mask)[0];
@@ -423,6 +426,7 @@ rte_table_hash_create_key16_ext(void *params,
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	f->f_cmp = table_hash_key_cmp_select(KEY_SIZE);
 
 	f->n_buckets_ext = n_buckets_ext;
 	f->stack_pos = n_buckets_ext;
@@ -596,7 +600,7 @@ rte_table_hash_entry_delete_key16_ext(
 	return 0;
 }
 
-#define lookup_key16_cmp(key_in, bucket, pos, f)			\
+#define lookup_key16_cmp_scalar(key_in, bucket, pos, f)			\
 {								\
 	uint64_t xor[4][2], or[4], signature[4], k[2];		\
 								\
@@ -635,6 +639,20 @@ rte_table_hash_entry_delete_key16_ext(
 		pos = 3;					\
 }
 
+#define lookup_key16_cmp(key_in, bucket, pos, f)			\
+{								\
+	if (f->f_cmp == NULL) {					\
+		lookup_key16_cmp_scalar(key_in, bucket, pos, f)	\
+	} else {						\
+		uint64_t k[2];					\
+								\
+		k[0] = key_in[0] & f->key_mask[0];		\
+		k[1] = key_in[1] & f->key_mask[1];		\
+								\
+		pos = f->f_cmp(k, &bucket->key[0][0], bucket->signature); \
+	}							\
+}
+
 #define lookup1_stage0(pkt0_index, mbuf0, pkts, pkts_mask, f)	\
 {								\
 	uint64_t pkt_mask;					\
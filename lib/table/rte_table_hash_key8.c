@@ -12,6 +12,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "table_hash_key_x86.h"
 
 #include "table_log.h"
 
@@ -74,6 +75,7 @@ struct rte_table_hash {
 	uint64_t key_mask;
 	rte_table_hash_op_hash f_hash;
 	uint64_t seed;
+	table_hash_key_cmp_t f_cmp;
 
 	/* Extendible buckets */
 	uint32_t n_buckets_ext;
@@ -206,6 +208,7 @@ rte_table_hash_create_key8_lru(void *params, int socket_id, uint32_t entry_size)
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	f->f_cmp = table_hash_key_cmp_select(KEY_SIZE);
 
 	if (p->key_mask != NULL)
 		f->key_mask = ((uint64_t *)p->key_mask)[0];
@@ -410,6 +413,7 @@ rte_table_hash_create_key8_ext(void *params, int socket_id, uint32_t entry_size)
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	f->f_cmp = table_hash_key_cmp_select(KEY_SIZE);
 
 	f->n_buckets_ext = n_buckets_ext;
 	f->stack_pos = n_buckets_ext;
@@ -584,7 +588,7 @@ rte_table_hash_entry_delete_key8_ext(
 	return 0;
 }
 
-#define lookup_key8_cmp(key_in, bucket, pos, f)			\
+#define lookup_key8_cmp_scalar(key_in, bucket, pos, f)			\
 {								\
 	uint64_t xor[4], signature, k;				\
 								\
@@ -607,6 +611,17 @@ rte_table_hash_entry_delete_key8_ext(
 		pos = 3;					\
 }
 
+#define lookup_key8_cmp(key_in, bucket, pos, f)			\
+{								\
+	if (f->f_cmp == NULL) {					\
+		lookup_key8_cmp_scalar(key_in, bucket, pos, f)	\
+	} else {						\
+		uint64_t k = key_in[0] & f->key_mask;		\
+								\
+		pos = f->f_cmp(&k, bucket->key, &bucket->signature); \
+	}							\
+}
+
 #define lookup1_stage0(pkt0_index, mbuf0, pkts, pkts_mask, f)	\
 {								\
 	uint64_t pkt_mask;					\
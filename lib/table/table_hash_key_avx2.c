@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2017 Intel Corporation
+ */
+
+#include "table_hash_key_x86.h"
+
+/* Bitmask of the valid positions, from the signature[0 .. 3] array of the
+ * key16 and key32 buckets: an entry is valid when bit 0 of its signature
+ * is set, which is moved to the sign bit to use the movemask instruction.
+ */
+static inline uint32_t
+table_hash_key_valid(const uint64_t *signature)
+{
+	__m256i sig = _mm256_loadu_si256((const __m256i *)signature);
+
+	return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(sig, 63)));
+}
+
+uint32_t
+table_hash_key8_cmp_avx2(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature)
+{
+	__m256i keys = _mm256_loadu_si256((const __m256i *)bucket_key);
+	__m256i cmp = _mm256_cmpeq_epi64(keys, _mm256_set1_epi64x((int64_t)key[0]));
+	uint32_t hits;
+
+	hits = _mm256_movemask_pd(_mm256_castsi256_pd(cmp));
+	hits &= signature[0];
+
+	/* Keys are unique within a bucket, position 4 is the miss */
+	return rte_ctz32(hits | 0x10);
+}
+
+uint32_t
+table_hash_key16_cmp_avx2(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature)
+{
+	__m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)key));
+	__m256i keys01 = _mm256_loadu_si256((const __m256i *)&bucket_key[0]);
+	__m256i keys23 = _mm256_loadu_si256((const __m256i *)&bucket_key[4]);
+	uint32_t m01, m23, hits;
+
+	m01 = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(keys01, k)));
+	m23 = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(keys23, k)));
+
+	hits = table_hash_key16_hits(m01 | (m23 << 4));
+	hits &= table_hash_key_valid(signature);
+
+	return rte_ctz32(hits | 0x10);
+}
+
+uint32_t
+table_hash_key32_cmp_avx2(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature)
+{
+	__m256i k = _mm256_loadu_si256((const __m256i *)key);
+	uint32_t hits = 0, i;
+
+	for (i = 0; i < 4; i++) {
+		__m256i keys = _mm256_loadu_si256((const __m256i *)&bucket_key[4 * i]);
+		__m256i cmp = _mm256_cmpeq_epi64(keys, k);
+
+		hits |= (uint32_t)(_mm256_movemask_pd(_mm256_castsi256_pd(cmp)) == 0xF) << i;
+	}
+
+	hits &= table_hash_key_valid(signature);
+
+	return rte_ctz32(hits | 0x10);
+}
@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2017 Intel Corporation
+ */
+
+#include "table_hash_key_x86.h"
+
+/* Bitmask of the valid positions, from bit 0 of signature[0 .. 3]. */
+static inline uint32_t
+table_hash_key_valid(const uint64_t *signature)
+{
+	__m256i sig = _mm256_loadu_si256((const __m256i *)signature);
+
+	return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(sig, 63)));
+}
+
+uint32_t
+table_hash_key16_cmp_avx512(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature)
+{
+	__m512i k = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)key));
+	__m512i keys = _mm512_loadu_si512(bucket_key);
+	uint32_t hits;
+
+	hits = table_hash_key16_hits(_mm512_cmpeq_epi64_mask(keys, k));
+	hits &= table_hash_key_valid(signature);
+
+	/* Keys are unique within a bucket, position 4 is the miss */
+	return rte_ctz32(hits | 0x10);
+}
+
+uint32_t
+table_hash_key32_cmp_avx512(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature)
+{
+	__m512i k = _mm512_broadcast_i64x4(_mm256_loadu_si256((const __m256i *)key));
+	__m512i keys01 = _mm512_loadu_si512(&bucket_key[0]);
+	__m512i keys23 = _mm512_loadu_si512(&bucket_key[8]);
+	uint32_t m01, m23, hits;
+
+	m01 = _mm512_cmpeq_epi64_mask(keys01, k);
+	m23 = _mm512_cmpeq_epi64_mask(keys23, k);
+
+	hits = ((m01 & 0xF) == 0xF) | (((m01 >> 4) == 0xF) << 1) |
+		(((m23 & 0xF) == 0xF) << 2) | (((m23 >> 4) == 0xF) << 3);
+	hits &= table_hash_key_valid(signature);
+
+	return rte_ctz32(hits | 0x10);
+}
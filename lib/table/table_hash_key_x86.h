@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2010-2017 Intel Corporation
+ */
+
+#ifndef TABLE_HASH_KEY_X86_H
+#define TABLE_HASH_KEY_X86_H
+
+/*
+ * Vector bucket probing for the key8, key16 and key32 hash tables.
+ *
+ * The buckets of these tables hold 4 keys stored back to back, so the
+ * input key can be compared against the whole bucket with a handful of
+ * vector compares instead of the 4 x (key_size / 8) scalar XORs.
+ *
+ * The AVX2 and AVX-512 versions are built in separate files with their
+ * own compiler flags, and picked at table creation from the CPU flags
+ * and the EAL max SIMD bitwidth, whatever the build target.
+ */
+
+#include <stdint.h>
+
+#include <rte_bitops.h>
+#include <rte_common.h>
+#include <rte_cpuflags.h>
+#include <rte_vect.h>
+
+/* Return the position (0 .. 3) of the valid bucket key equal to the
+ * (already masked) input key, or 4 on miss. The valid positions are
+ * given by bit 0 of signature[0 .. 3] for the key16 and key32 buckets,
+ * and by bits 0 .. 3 of signature[0] for the key8 buckets.
+ */
+typedef uint32_t (*table_hash_key_cmp_t)(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature);
+
+#ifdef RTE_ARCH_X86
+
+uint32_t
+table_hash_key8_cmp_avx2(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature);
+
+uint32_t
+table_hash_key16_cmp_avx2(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature);
+
+uint32_t
+table_hash_key32_cmp_avx2(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature);
+
+#endif
+
+#ifdef CC_AVX512_SUPPORT
+
+uint32_t
+table_hash_key16_cmp_avx512(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature);
+
+uint32_t
+table_hash_key32_cmp_avx512(const uint64_t *key,
+	const uint64_t *bucket_key, const uint64_t *signature);
+
+#endif
+
+/* Pick the widest key compare supported by both the compiler and the CPU,
+ * NULL meaning the scalar compare of the table.
+ * The AVX-512 version is only worth it for buckets larger than 32 bytes.
+ */
+static inline table_hash_key_cmp_t
+table_hash_key_cmp_select(uint32_t key_size)
+{
+#ifdef CC_AVX512_SUPPORT
+	if (key_size > 8 &&
+			rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_512)
+		return key_size == 16 ? table_hash_key16_cmp_avx512 :
+			table_hash_key32_cmp_avx512;
+#endif
+#ifdef RTE_ARCH_X86
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256) {
+		if (key_size == 8)
+			return table_hash_key8_cmp_avx2;
+		return key_size == 16 ? table_hash_key16_cmp_avx2 :
+			table_hash_key32_cmp_avx2;
+	}
+#endif
+	RTE_SET_USED(key_size);
+	return NULL;
+}
+
+/* Gather the "both 64-bit words equal" bits of a 16-byte key compare:
+ * bit 2i of m covers the low word of key i, bit 2i + 1 its high word.
+ */
+static inline uint32_t
+table_hash_key16_hits(uint32_t m)
+{
+	m &= m >> 1;
+
+	return (m & 1) | ((m >> 1) & 2) | ((m >> 2) & 4) | ((m >> 3) & 8);
+}
+
+#endif /* TABLE_HASH_KEY_X86_H */
@@ -389,6 +389,45 @@ rte_tel_data_alloc(void);
 void
 rte_tel_data_free(struct rte_tel_data *data);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: the streaming format may change without prior notice.
+ *
+ * Magic number starting the binary messages of a telemetry subscription,
+ * distinguishing them from the JSON replies sent on the same socket.
+ *
+ * A client of the v2 socket subscribes to the numeric values returned by
+ * commands with "/subscribe/add,<command>[,<params>]", then asks for the
+ * changes to be pushed with "/subscribe/start,<interval in ms>".
+ * At each interval, the commands are run and the values which changed are
+ * sent in messages made of a struct rte_tel_stream_hdr followed by
+ * nb_entries struct rte_tel_stream_entry, in host byte order.
+ */
+#define RTE_TEL_STREAM_MAGIC 0x5354454c /* "LETS" in little endian */
+
+/** Version of the binary streaming format. */
+#define RTE_TEL_STREAM_VERSION 1
+
+/** Flag of the last message of an update. */
+#define RTE_TEL_STREAM_F_LAST 0x1
+
+/** Header of a binary message of a telemetry subscription. */
+struct rte_tel_stream_hdr {
+	uint32_t magic;       /**< RTE_TEL_STREAM_MAGIC */
+	uint16_t version;     /**< RTE_TEL_STREAM_VERSION */
+	uint16_t flags;       /**< RTE_TEL_STREAM_F_* */
+	uint32_t nb_entries;  /**< number of entries following the header */
+	uint32_t reserved;
+	uint64_t seq;         /**< update number, from 0 */
+	uint64_t timestamp;   /**< time of the update, in ns (monotonic clock) */
+};
+
+/** Change of a subscribed value. */
+struct rte_tel_stream_entry {
+	uint32_t index;  /**< index of the value, as listed by /subscribe/add */
+	int64_t delta;   /**< difference with the previous value, modulo 2^64 */
+} __rte_packed;
+
 #ifdef __cplusplus
 }
 #endif
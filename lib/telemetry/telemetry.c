@@ -8,6 +8,7 @@
 #ifndef RTE_EXEC_ENV_WINDOWS
 #include <unistd.h>
 #include <pthread.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/stat.h>
@@ -109,6 +110,23 @@ rte_telemetry_register_cmd(const char *cmd, telemetry_cb fn, const char *help)
 	return 0;
 }
 
+telemetry_cb
+telemetry_cmd_lookup(const char *cmd)
+{
+	telemetry_cb fn = NULL;
+	int i;
+
+	rte_spinlock_lock(&callback_sl);
+	for (i = 0; i < num_callbacks; i++)
+		if (strcmp(cmd, callbacks[i].cmd) == 0) {
+			fn = callbacks[i].fn;
+			break;
+		}
+	rte_spinlock_unlock(&callback_sl);
+
+	return fn;
+}
+
 #ifndef RTE_EXEC_ENV_WINDOWS
 
 static int
@@ -376,6 +394,7 @@ static void *
 client_handler(void *sock_id)
 {
 	int s = (int)(uintptr_t)sock_id;
+	struct tel_stream *stream = NULL;
 	char buffer[1024];
 	char info_str[1024];
 	snprintf(info_str, sizeof(info_str),
@@ -386,28 +405,39 @@ client_handler(void *sock_id)
 		goto exit;
 	}
 
-	/* receive data is not null terminated */
-	int bytes = read(s, buffer, sizeof(buffer) - 1);
-	while (bytes > 0) {
+	/* subscriptions are not available on allocation failure */
+	stream = telemetry_stream_create(s);
+
+	while (1) {
+		/* wait for a command until the next update of subscriptions */
+		int timeout = telemetry_stream_timeout(stream);
+		if (timeout == 0) {
+			telemetry_stream_update(stream);
+			continue;
+		}
+		if (timeout > 0) {
+			struct pollfd pfd = { .fd = s, .events = POLLIN };
+			int rc = poll(&pfd, 1, timeout);
+			if (rc == 0 || (rc < 0 && errno == EINTR))
+				continue;
+			if (rc < 0)
+				break;
+		}
+
+		/* receive data is not null terminated */
+		int bytes = read(s, buffer, sizeof(buffer) - 1);
+		if (bytes <= 0)
+			break;
 		buffer[bytes] = 0;
 		const char *cmd = strtok(buffer, ",");
 		const char *param = strtok(NULL, "\0");
-		telemetry_cb fn = unknown_command;
-		int i;
-
-		if (cmd && strlen(cmd) < MAX_CMD_LEN) {
-			rte_spinlock_lock(&callback_sl);
-			for (i = 0; i < num_callbacks; i++)
-				if (strcmp(cmd, callbacks[i].cmd) == 0) {
-					fn = callbacks[i].fn;
-					break;
-				}
-			rte_spinlock_unlock(&callback_sl);
-		}
-		perform_command(fn, cmd, param, s);
+		telemetry_cb fn = NULL;
 
-		bytes = read(s, buffer, sizeof(buffer) - 1);
+		if (cmd && strlen(cmd) < MAX_CMD_LEN)
+			fn = telemetry_cmd_lookup(cmd);
+		perform_command(fn != NULL ? fn : unknown_command, cmd, param, s);
 	}
+	telemetry_stream_free(stream);
 exit:
 	close(s);
 	rte_atomic_fetch_sub_explicit(&v2_clients, 1, rte_memory_order_relaxed);
@@ -588,6 +618,7 @@ telemetry_v2_init(void)
 			"Returns DPDK Telemetry information. Takes no parameters");
 	rte_telemetry_register_cmd("/help", command_help,
 			"Returns help text for a command. Parameters: string command");
+	telemetry_stream_register_cmds();
 	v2_socket.fn = client_handler;
 	if (strlcpy(spath, get_socket_path(socket_dir, 2), sizeof(spath)) >= sizeof(spath)) {
 		TMTY_LOG_LINE(ERR, "Error with socket binding, path too long");
@@ -82,6 +82,29 @@ rte_telemetry_legacy_register(const char *cmd,
 		enum rte_telemetry_legacy_data_req data_req,
 		telemetry_legacy_cb fn);
 
+/* Callback of a registered command, NULL if not found. */
+telemetry_cb
+telemetry_cmd_lookup(const char *cmd);
+
+/* Subscriptions of a v2 socket client, handled by the thread of the client. */
+struct tel_stream;
+
+struct tel_stream *
+telemetry_stream_create(int sock);
+
+void
+telemetry_stream_free(struct tel_stream *stream);
+
+/* Time until the next update in ms, -1 if not streaming. */
+int
+telemetry_stream_timeout(const struct tel_stream *stream);
+
+void
+telemetry_stream_update(struct tel_stream *stream);
+
+void
+telemetry_stream_register_cmds(void);
+
 /**
  * @internal
  * Log function type, to allow passing as parameter if necessary
@@ -0,0 +1,441 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Intel Corporation
+ */
+
+#ifndef RTE_EXEC_ENV_WINDOWS
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/uio.h>
+
+/* we won't link against libbsd, so just always use DPDKs-specific strlcpy */
+#undef RTE_USE_LIBBSD
+#include <rte_string_fns.h>
+#include <rte_common.h>
+#include <rte_per_lcore.h>
+
+#include "rte_telemetry.h"
+#include "telemetry_data.h"
+#include "telemetry_internal.h"
+
+/*
+ * Subscriptions of the v2 socket clients.
+ *
+ * A client subscribes to the numeric values returned by some commands.
+ * The commands are then run by the thread of the client connection at a
+ * fixed interval, and the values which changed since the previous update
+ * are sent as binary deltas, instead of formatting the whole output in JSON.
+ */
+
+#define STREAM_MAX_SUBS 128
+#define STREAM_MAX_VALUES RTE_TEL_MAX_ARRAY_ENTRIES /* per command */
+#define STREAM_MAX_INTERVAL_MS (60 * 1000)
+#define STREAM_NAME_LEN RTE_TEL_MAX_STRING_LEN /* as sent to the client */
+#define STREAM_MSG_LEN (1024 * 16)
+#define STREAM_MSG_ENTRIES ((STREAM_MSG_LEN - \
+		sizeof(struct rte_tel_stream_hdr)) / \
+		sizeof(struct rte_tel_stream_entry))
+
+/* values returned by a subscribed command */
+struct stream_sub {
+	char *cmd;
+	const char *params; /* in the same allocation as cmd */
+	telemetry_cb fn;
+	uint32_t first; /* index of the first value in the stream */
+	uint32_t nb_values;
+	uint32_t pos; /* position of the next value in the command output */
+	char **names;
+	uint64_t *values; /* as last sent to the client */
+};
+
+struct tel_stream {
+	struct stream_sub subs[STREAM_MAX_SUBS];
+	unsigned int nb_subs;
+	uint32_t nb_values;
+	unsigned int interval_ms; /* 0 when not streaming */
+	uint64_t next_update; /* in ms */
+	uint64_t seq;
+	uint64_t timestamp; /* of the current update, in ns */
+	bool partial; /* part of the current update already sent */
+	int sock;
+	int error;
+	unsigned int nb_entries;
+	struct rte_tel_stream_entry entries[STREAM_MSG_ENTRIES];
+	struct rte_tel_data data; /* output of the subscribed commands */
+};
+
+typedef void (*stream_value_fn)(struct tel_stream *stream,
+		struct stream_sub *sub, const char *name, uint64_t value);
+
+/* stream of the client handled by the calling thread */
+static RTE_DEFINE_PER_LCORE(struct tel_stream *, client_stream);
+
+static uint64_t
+stream_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t
+stream_time_ms(void)
+{
+	return stream_time_ns() / 1000000;
+}
+
+/* Call fn for each numeric value of the data, in the JSON output order,
+ * naming the values of nested containers "<container>/<name or index>".
+ * The values whose name does not fit in a telemetry string are skipped,
+ * so that the names sent to the client are the streamed ones.
+ * Containers are freed as when formatting the JSON output.
+ */
+static void
+stream_walk(struct tel_stream *stream, struct stream_sub *sub,
+		const struct rte_tel_data *d, const char *prefix,
+		stream_value_fn fn)
+{
+	char name[STREAM_NAME_LEN];
+	char index[16];
+	unsigned int i;
+
+	if (d->type != TEL_DICT && d->type != TEL_ARRAY_INT &&
+			d->type != TEL_ARRAY_UINT && d->type != TEL_ARRAY_CONTAINER)
+		return;
+
+	for (i = 0; i < d->data_len; i++) {
+		enum rte_tel_value_type type;
+		const union tel_value *v;
+		const char *key;
+
+		if (d->type == TEL_DICT) {
+			type = d->data.dict[i].type;
+			v = &d->data.dict[i].value;
+			key = d->data.dict[i].name;
+		} else {
+			if (d->type == TEL_ARRAY_INT)
+				type = RTE_TEL_INT_VAL;
+			else if (d->type == TEL_ARRAY_UINT)
+				type = RTE_TEL_UINT_VAL;
+			else
+				type = RTE_TEL_CONTAINER;
+			v = &d->data.array[i];
+			snprintf(index, sizeof(index), "%u", i);
+			key = index;
+		}
+		if (prefix != NULL) {
+			if (snprintf(name, sizeof(name), "%s/%s", prefix, key) >=
+					(int)sizeof(name)) {
+				if (type == RTE_TEL_CONTAINER && !v->container.keep)
+					rte_tel_data_free(v->container.data);
+				continue;
+			}
+			key = name;
+		}
+
+		switch (type) {
+		case RTE_TEL_INT_VAL:
+			fn(stream, sub, key, (uint64_t)v->ival);
+			break;
+		case RTE_TEL_UINT_VAL:
+			fn(stream, sub, key, v->uval);
+			break;
+		case RTE_TEL_CONTAINER:
+			stream_walk(stream, sub, v->container.data, key, fn);
+			if (!v->container.keep)
+				rte_tel_data_free(v->container.data);
+			break;
+		case RTE_TEL_STRING_VAL:
+			break;
+		}
+	}
+}
+
+static int
+stream_run(struct tel_stream *stream, struct stream_sub *sub,
+		stream_value_fn fn)
+{
+	struct rte_tel_data *d = &stream->data;
+
+	d->type = TEL_NULL;
+	d->data_len = 0;
+	if (sub->fn(sub->cmd, sub->params, d) < 0)
+		return -1;
+	stream_walk(stream, sub, d, NULL, fn);
+
+	return 0;
+}
+
+static void
+stream_send(struct tel_stream *stream, uint16_t flags)
+{
+	struct rte_tel_stream_hdr hdr = {
+		.magic = RTE_TEL_STREAM_MAGIC,
+		.version = RTE_TEL_STREAM_VERSION,
+		.flags = flags,
+		.nb_entries = stream->nb_entries,
+		.seq = stream->seq,
+		.timestamp = stream->timestamp,
+	};
+	struct iovec iov[2] = {
+		{ .iov_base = &hdr, .iov_len = sizeof(hdr) },
+		{ .iov_base = stream->entries,
+		  .iov_len = stream->nb_entries * sizeof(stream->entries[0]) },
+	};
+
+	/* one message per call on the sequenced packet socket */
+	if (!stream->error && writev(stream->sock, iov, RTE_DIM(iov)) < 0)
+		stream->error = errno;
+	stream->nb_entries = 0;
+	stream->partial = !(flags & RTE_TEL_STREAM_F_LAST);
+}
+
+static void
+stream_name_add(struct tel_stream *stream __rte_unused,
+		struct stream_sub *sub, const char *name,
+		uint64_t value __rte_unused)
+{
+	if (sub->names == NULL || sub->nb_values == STREAM_MAX_VALUES)
+		return;
+
+	sub->names[sub->nb_values] = strdup(name);
+	if (sub->names[sub->nb_values] == NULL) {
+		/* drop all the names, reported as an error */
+		while (sub->nb_values > 0)
+			free(sub->names[--sub->nb_values]);
+		free(sub->names);
+		sub->names = NULL;
+		return;
+	}
+	sub->nb_values++;
+}
+
+static void
+stream_value_update(struct tel_stream *stream, struct stream_sub *sub,
+		const char *name, uint64_t value)
+{
+	uint32_t i = sub->pos++;
+
+	if (i >= sub->nb_values || strcmp(sub->names[i], name) != 0) {
+		/* the output of the command changed, look the name up */
+		for (i = 0; i < sub->nb_values; i++)
+			if (strcmp(sub->names[i], name) == 0)
+				break;
+		if (i == sub->nb_values)
+			return;
+	}
+	if (value == sub->values[i])
+		return;
+
+	if (stream->nb_entries == RTE_DIM(stream->entries))
+		stream_send(stream, 0);
+	stream->entries[stream->nb_entries].index = sub->first + i;
+	stream->entries[stream->nb_entries].delta = (int64_t)(value - sub->values[i]);
+	stream->nb_entries++;
+	sub->values[i] = value;
+}
+
+static void
+stream_sub_free(struct stream_sub *sub)
+{
+	uint32_t i;
+
+	if (sub->names != NULL)
+		for (i = 0; i < sub->nb_values; i++)
+			free(sub->names[i]);
+	free(sub->names);
+	free(sub->values);
+	free(sub->cmd);
+	memset(sub, 0, sizeof(*sub));
+}
+
+struct tel_stream *
+telemetry_stream_create(int sock)
+{
+	struct tel_stream *stream = calloc(1, sizeof(*stream));
+
+	if (stream != NULL)
+		stream->sock = sock;
+	RTE_PER_LCORE(client_stream) = stream;
+
+	return stream;
+}
+
+void
+telemetry_stream_free(struct tel_stream *stream)
+{
+	unsigned int i;
+
+	RTE_PER_LCORE(client_stream) = NULL;
+	if (stream == NULL)
+		return;
+
+	for (i = 0; i < stream->nb_subs; i++)
+		stream_sub_free(&stream->subs[i]);
+	free(stream);
+}
+
+int
+telemetry_stream_timeout(const struct tel_stream *stream)
+{
+	uint64_t now;
+
+	if (stream == NULL || stream->interval_ms == 0)
+		return -1;
+
+	now = stream_time_ms();
+	return stream->next_update > now ? (int)(stream->next_update - now) : 0;
+}
+
+void
+telemetry_stream_update(struct tel_stream *stream)
+{
+	uint64_t now;
+	unsigned int i;
+
+	stream->timestamp = stream_time_ns();
+	for (i = 0; i < stream->nb_subs; i++) {
+		stream->subs[i].pos = 0;
+		stream_run(stream, &stream->subs[i], stream_value_update);
+	}
+	/* nothing is sent when no value changed */
+	if (stream->nb_entries > 0 || stream->partial) {
+		stream_send(stream, RTE_TEL_STREAM_F_LAST);
+		stream->seq++;
+	}
+
+	/* skip the updates missed when the commands are too slow */
+	now = stream_time_ms();
+	stream->next_update += stream->interval_ms;
+	if (stream->next_update <= now)
+		stream->next_update = now + stream->interval_ms;
+
+	/* the client is disconnected when its socket is read */
+	if (stream->error != 0)
+		stream->interval_ms = 0;
+}
+
+static int
+stream_add(const char *cmd __rte_unused, const char *params,
+		struct rte_tel_data *d)
+{
+	struct tel_stream *stream = RTE_PER_LCORE(client_stream);
+	struct rte_tel_data *names;
+	struct stream_sub *sub;
+	char *sep;
+	uint32_t i;
+
+	if (stream == NULL || params == NULL)
+		return -EINVAL;
+	if (stream->nb_subs == STREAM_MAX_SUBS)
+		return -ENOSPC;
+
+	sub = &stream->subs[stream->nb_subs];
+	sub->cmd = strdup(params);
+	if (sub->cmd == NULL)
+		return -ENOMEM;
+	sep = strchr(sub->cmd, ',');
+	if (sep != NULL) {
+		*sep = '\0';
+		sub->params = sep + 1;
+	}
+
+	/* the subscription commands cannot be streamed themselves */
+	sub->fn = telemetry_cmd_lookup(sub->cmd);
+	if (sub->fn == NULL || strncmp(sub->cmd, "/subscribe",
+			strlen("/subscribe")) == 0)
+		goto error;
+
+	sub->first = stream->nb_values;
+	sub->names = calloc(STREAM_MAX_VALUES, sizeof(sub->names[0]));
+	if (sub->names == NULL)
+		goto error;
+	if (stream_run(stream, sub, stream_name_add) < 0 || sub->names == NULL)
+		goto error;
+	/* sent as deltas from zero at the first update */
+	sub->values = calloc(RTE_MAX(sub->nb_values, 1u), sizeof(sub->values[0]));
+	if (sub->values == NULL)
+		goto error;
+
+	names = rte_tel_data_alloc();
+	if (names == NULL)
+		goto error;
+	rte_tel_data_start_array(names, RTE_TEL_STRING_VAL);
+	for (i = 0; i < sub->nb_values; i++)
+		rte_tel_data_add_array_string(names, sub->names[i]);
+
+	stream->nb_values += sub->nb_values;
+	stream->nb_subs++;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_uint(d, "first", sub->first);
+	rte_tel_data_add_dict_container(d, "values", names, 0);
+
+	return 0;
+
+error:
+	stream_sub_free(sub);
+	return -EINVAL;
+}
+
+static int
+stream_start(const char *cmd __rte_unused, const char *params,
+		struct rte_tel_data *d)
+{
+	struct tel_stream *stream = RTE_PER_LCORE(client_stream);
+	unsigned long interval;
+	char *end;
+
+	if (stream == NULL || params == NULL)
+		return -EINVAL;
+
+	errno = 0;
+	interval = strtoul(params, &end, 0);
+	if (errno != 0 || *end != '\0' || interval == 0 ||
+			interval > STREAM_MAX_INTERVAL_MS)
+		return -EINVAL;
+
+	/* first update right after this reply */
+	stream->interval_ms = interval;
+	stream->next_update = stream_time_ms();
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_uint(d, "interval_ms", interval);
+	rte_tel_data_add_dict_uint(d, "nb_values", stream->nb_values);
+
+	return 0;
+}
+
+static int
+stream_stop(const char *cmd __rte_unused, const char *params __rte_unused,
+		struct rte_tel_data *d)
+{
+	struct tel_stream *stream = RTE_PER_LCORE(client_stream);
+
+	if (stream == NULL)
+		return -EINVAL;
+
+	stream->interval_ms = 0;
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_uint(d, "updates", stream->seq);
+
+	return 0;
+}
+
+void
+telemetry_stream_register_cmds(void)
+{
+	rte_telemetry_register_cmd("/subscribe/add", stream_add,
+			"Subscribes to the numeric values returned by a command. Parameters: string command, string params");
+	rte_telemetry_register_cmd("/subscribe/start", stream_start,
+			"Starts sending the changes of the subscribed values in binary. Parameters: int interval in ms");
+	rte_telemetry_register_cmd("/subscribe/stop", stream_stop,
+			"Stops sending the changes of the subscribed values. Takes no parameters");
+}
+
+#endif /* !RTE_EXEC_ENV_WINDOWS */
@@ -1478,8 +1478,6 @@ virtio_dev_rx_sync_batch_check(struct virtio_net *dev,
 		return -1;
 
 	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
-		if (unlikely(pkts[i]->next != NULL))
-			return -1;
 		if (unlikely(!desc_is_avail(&descs[avail_idx + i],
 					    wrap_counter)))
 			return -1;
@@ -1488,6 +1486,10 @@ virtio_dev_rx_sync_batch_check(struct virtio_net *dev,
 	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE)
 		lens[i] = descs[avail_idx + i].len;
 
+	/*
+	 * Chained mbufs are accepted as long as the whole packet fits in
+	 * the single descriptor, segments are copied one after the other.
+	 */
 	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
 		if (unlikely(pkts[i]->pkt_len > (lens[i] - buf_offset)))
 			return -1;
@@ -1530,8 +1532,6 @@ virtio_dev_rx_async_batch_check(struct vhost_virtqueue *vq,
 		return -1;
 
 	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
-		if (unlikely(pkts[i]->next != NULL))
-			return -1;
 		if (unlikely(!desc_is_avail(&descs[avail_idx + i],
 					    wrap_counter)))
 			return -1;
@@ -1561,6 +1561,19 @@ virtio_dev_rx_async_batch_check(struct vhost_virtqueue *vq,
 	return 0;
 }
 
+static __rte_always_inline void
+vhost_copy_chain_to_desc(struct rte_mbuf *m, uint64_t desc_addr)
+{
+	uint32_t offset = 0;
+
+	while (m != NULL) {
+		rte_memcpy((void *)(uintptr_t)(desc_addr + offset),
+			   rte_pktmbuf_mtod(m, void *), m->data_len);
+		offset += m->data_len;
+		m = m->next;
+	}
+}
+
 static __rte_always_inline void
 virtio_dev_rx_batch_packed_copy(struct virtio_net *dev,
 			   struct vhost_virtqueue *vq,
@@ -1596,9 +1609,13 @@ virtio_dev_rx_batch_packed_copy(struct virtio_net *dev,
 	vq_inc_last_avail_packed(vq, PACKED_BATCH_SIZE);
 
 	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
-		rte_memcpy((void *)(uintptr_t)(desc_addrs[i] + buf_offset),
-			   rte_pktmbuf_mtod_offset(pkts[i], void *, 0),
-			   pkts[i]->pkt_len);
+		if (likely(pkts[i]->next == NULL))
+			rte_memcpy((void *)(uintptr_t)(desc_addrs[i] + buf_offset),
+				   rte_pktmbuf_mtod_offset(pkts[i], void *, 0),
+				   pkts[i]->pkt_len);
+		else
+			vhost_copy_chain_to_desc(pkts[i],
+				desc_addrs[i] + buf_offset);
 	}
 
 	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE)
@@ -1994,7 +2011,34 @@ virtio_dev_rx_async_packed(struct virtio_net *dev, struct vhost_virtqueue *vq,
 	return 0;
 }
 
-static __rte_always_inline void
+static __rte_always_inline int
+async_fill_chain(struct virtio_net *dev, struct vhost_virtqueue *vq,
+		struct rte_mbuf *m, uint64_t buf_iova)
+	__rte_shared_locks_required(&vq->access_lock)
+	__rte_shared_locks_required(&vq->iotlb_lock)
+{
+	struct vhost_async *async = vq->async;
+	uint64_t buf_offset = 0;
+
+	if (unlikely(async_iter_initialize(dev, async)))
+		return -1;
+
+	while (m != NULL) {
+		if (unlikely(async_fill_seg(dev, vq, m, 0, buf_iova + buf_offset,
+					m->data_len, true) < 0)) {
+			async_iter_cancel(async);
+			return -1;
+		}
+		buf_offset += m->data_len;
+		m = m->next;
+	}
+
+	async_iter_finalize(async);
+
+	return 0;
+}
+
+static __rte_always_inline int
 virtio_dev_rx_async_packed_batch_enqueue(struct virtio_net *dev,
 			   struct vhost_virtqueue *vq,
 			   struct rte_mbuf **pkts,
@@ -2008,21 +2052,32 @@ virtio_dev_rx_async_packed_batch_enqueue(struct virtio_net *dev,
 	struct vring_packed_desc *descs = vq->desc_packed;
 	struct vhost_async *async = vq->async;
 	uint16_t avail_idx = vq->last_avail_idx;
-	uint32_t mbuf_offset = 0;
 	uint16_t ids[PACKED_BATCH_SIZE];
-	uint64_t mapped_len[PACKED_BATCH_SIZE];
-	void *host_iova[PACKED_BATCH_SIZE];
+	struct vhost_iov_iter *iter;
 	uintptr_t desc;
 	uint16_t i;
 
 	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
 		rte_prefetch0((void *)(uintptr_t)desc_addrs[i]);
 		desc = vhost_iova_to_vva(dev, vq, desc_addrs[i], &lens[i], VHOST_ACCESS_RW);
+		if (unlikely(!desc || lens[i] < buf_offset))
+			return -1;
 		hdrs[i] = (struct virtio_net_hdr_mrg_rxbuf *)(uintptr_t)desc;
 		lens[i] = pkts[i]->pkt_len +
 			sizeof(struct virtio_net_hdr_mrg_rxbuf);
 	}
 
+	/*
+	 * Build the copy iterators before touching the ring, so that a
+	 * packet whose segments cannot all be mapped leaves the batch
+	 * untouched and the caller falls back to the single packet path.
+	 */
+	for (i = 0; i < PACKED_BATCH_SIZE; i++) {
+		if (unlikely(async_fill_chain(dev, vq, pkts[i],
+					desc_addrs[i] + buf_offset) < 0))
+			goto cancel;
+	}
+
 	if (rxvq_is_mergeable(dev)) {
 		vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
 			ASSIGN_UNLESS_EQUAL(hdrs[i]->num_buffers, 1);
@@ -2034,20 +2089,6 @@ virtio_dev_rx_async_packed_batch_enqueue(struct virtio_net *dev,
 
 	vq_inc_last_avail_packed(vq, PACKED_BATCH_SIZE);
 
-	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
-		host_iova[i] = (void *)(uintptr_t)gpa_to_first_hpa(dev,
-			desc_addrs[i] + buf_offset, lens[i], &mapped_len[i]);
-	}
-
-	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE) {
-		async_iter_initialize(dev, async);
-		async_iter_add_iovec(dev, async,
-				(void *)(uintptr_t)rte_pktmbuf_iova_offset(pkts[i], mbuf_offset),
-				host_iova[i],
-				mapped_len[i]);
-		async->iter_idx++;
-	}
-
 	vhost_for_each_try_unroll(i, 0, PACKED_BATCH_SIZE)
 		vhost_log_cache_write_iova(dev, vq, descs[avail_idx + i].addr, lens[i]);
 
@@ -2055,6 +2096,19 @@ virtio_dev_rx_async_packed_batch_enqueue(struct virtio_net *dev,
 		ids[i] = descs[avail_idx + i].id;
 
 	vhost_async_shadow_enqueue_packed_batch(vq, lens, ids);
+
+	return 0;
+
+cancel:
+	while (i--) {
+		async->iter_idx--;
+		iter = async->iov_iter + async->iter_idx;
+		async->iovec_idx -= iter->nr_segs;
+		iter->nr_segs = 0;
+		iter->iov = NULL;
+	}
+
+	return -1;
 }
 
 static __rte_always_inline int
@@ -2071,9 +2125,7 @@ virtio_dev_rx_async_packed_batch(struct virtio_net *dev,
 	if (virtio_dev_rx_async_batch_check(vq, pkts, desc_addrs, lens, dma_id, vchan_id) == -1)
 		return -1;
 
-	virtio_dev_rx_async_packed_batch_enqueue(dev, vq, pkts, desc_addrs, lens);
-
-	return 0;
+	return virtio_dev_rx_async_packed_batch_enqueue(dev, vq, pkts, desc_addrs, lens);
 }
 
 static __rte_always_inline void